@@ -903,6 +903,8 @@ void ndAuthor::ShowMainMenuBar()
 			ImGui::RadioButton("cuda", &solverMode, ndWorld::ndCudaSolver);
 			ImGui::RadioButton("syclCpu", &solverMode, ndWorld::ndSyclSolverCpu);
 			ImGui::RadioButton("syclGpu", &solverMode, ndWorld::ndSyclSolverGpu);
+			ImGui::RadioButton("gauss seidel", &solverMode, ndWorld::ndGaussSeidelSolver);
+			ImGui::RadioButton("avx512", &solverMode, ndWorld::ndSimdAvx512Solver);
 
 			m_solverMode = ndWorld::ndSolverModes(solverMode);
 			ImGui::Separator();
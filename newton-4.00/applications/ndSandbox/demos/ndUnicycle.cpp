@@ -395,7 +395,7 @@ namespace ndUnicycle
 			ndBodyKinematic::ndContactMap::Iterator it(body->GetContactMap());
 			for (it.Begin(); it; it++)
 			{
-				ndContact* const contact = it.GetNode()->GetInfo();
+				ndContact* const contact = *it;
 				if (contact->IsActive())
 				{
 					return true;
@@ -0,0 +1,508 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+// newton_bench runs the scenes in ndBenchScenes.cpp headless and prints one json 
+// document with the time per step, the time of the update stages and the 
+// contact and solver counters, for each scene and thread count.
+// every run uses the same scenes, timestep and step count, so two json files 
+// made on the same machine can be compared to find performance regressions.
+// the steps are timed with the frame stats off, the stages and counters come 
+// from a second run of the same steps with the stats on.
+// the default solver is the standard one, --solver best picks the fastest simd 
+// solver of the cpu. each run also times the same steps in deterministic mode, 
+// which sorts the new pairs and the bodies woken up and ignores the speculative 
+// contact budget, and prints its time per step and its overhead over the run.
+//
+// newton_bench [--scenes a,b,...] [--threads 1,2,4] [--steps n] [--warmup n]
+//              [--scale s] [--solver name] [--label text] [--output file] 
+//              [--list]
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "ndNewton.h"
+#include "ndBenchScenes.h"
+
+#define D_BENCH_TIMESTEP	(1.0f / 60.0f)
+
+class ndBenchOptions
+{
+	public:
+	ndBenchOptions()
+		:m_scenes()
+		,m_threads()
+		,m_label()
+		,m_output()
+		,m_solver(ndWorld::ndStandardSolver)
+		,m_scale(ndFloat32(1.0f))
+		,m_steps(300)
+		,m_warmup(60)
+		,m_list(false)
+	{
+	}
+
+	std::vector<std::string> m_scenes;
+	std::vector<ndInt32> m_threads;
+	std::string m_label;
+	std::string m_output;
+	ndWorld::ndSolverModes m_solver;
+	ndFloat32 m_scale;
+	ndInt32 m_steps;
+	ndInt32 m_warmup;
+	bool m_list;
+};
+
+class ndBenchStage
+{
+	public:
+	std::string m_name;
+	ndInt32 m_depth;
+	ndFloat64 m_time;
+};
+
+class ndBenchRun
+{
+	public:
+	ndInt32 m_threads;
+	ndInt32 m_bodies;
+	ndInt32 m_particles;
+	ndFloat64 m_mean;
+	ndFloat64 m_median;
+	ndFloat64 m_min;
+	ndFloat64 m_max;
+	ndFloat64 m_busy;
+	ndFloat64 m_deterministicMean;
+	ndFloat64 m_counters[ndFrameStats::m_counterCount];
+	std::vector<ndBenchStage> m_stages;
+	std::string m_solver;
+};
+
+static std::string JsonString(const std::string& text)
+{
+	std::string escaped;
+	for (size_t i = 0; i < text.size(); ++i)
+	{
+		const char ch = text[i];
+		if ((ch == '"') || (ch == '\\'))
+		{
+			escaped += '\\';
+			escaped += ch;
+		}
+		else if (ndUnsigned8(ch) < 0x20)
+		{
+			char code[8];
+			snprintf(code, sizeof(code), "\\u%04x", ch);
+			escaped += code;
+		}
+		else
+		{
+			escaped += ch;
+		}
+	}
+	return escaped;
+}
+
+static std::vector<std::string> SplitList(const char* const text)
+{
+	std::vector<std::string> list;
+	std::string item;
+	for (const char* ptr = text; ; ++ptr)
+	{
+		if (!*ptr || (*ptr == ','))
+		{
+			if (item.size())
+			{
+				list.push_back(item);
+			}
+			item.clear();
+			if (!*ptr)
+			{
+				break;
+			}
+		}
+		else
+		{
+			item += *ptr;
+		}
+	}
+	return list;
+}
+
+static bool ParseSolver(const char* const name, ndWorld::ndSolverModes& solver)
+{
+	static const struct { const char* m_name; ndWorld::ndSolverModes m_mode; } solvers[] =
+	{
+		{ "standard", ndWorld::ndStandardSolver },
+		{ "soa", ndWorld::ndSimdSoaSolver },
+		{ "avx2", ndWorld::ndSimdAvx2Solver },
+		{ "avx512", ndWorld::ndSimdAvx512Solver },
+		{ "gaussSeidel", ndWorld::ndGaussSeidelSolver },
+	};
+	if (!strcmp(name, "best"))
+	{
+		solver = ndWorld::GetBestSolver();
+		return true;
+	}
+	for (ndInt32 i = 0; i < ndInt32(sizeof(solvers) / sizeof(solvers[0])); ++i)
+	{
+		if (!strcmp(solvers[i].m_name, name))
+		{
+			solver = solvers[i].m_mode;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool ParseOptions(ndInt32 argc, char** const argv, ndBenchOptions& options)
+{
+	for (ndInt32 i = 1; i < argc; ++i)
+	{
+		const char* const arg = argv[i];
+		const char* const value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+		if (!strcmp(arg, "--list"))
+		{
+			options.m_list = true;
+			continue;
+		}
+		if (!value)
+		{
+			fprintf(stderr, "missing value for %s\n", arg);
+			return false;
+		}
+		i++;
+		if (!strcmp(arg, "--scenes"))
+		{
+			options.m_scenes = SplitList(value);
+		}
+		else if (!strcmp(arg, "--threads"))
+		{
+			const std::vector<std::string> list(SplitList(value));
+			for (size_t j = 0; j < list.size(); ++j)
+			{
+				options.m_threads.push_back(ndMax(atoi(list[j].c_str()), 1));
+			}
+		}
+		else if (!strcmp(arg, "--steps"))
+		{
+			options.m_steps = ndMax(atoi(value), 1);
+		}
+		else if (!strcmp(arg, "--warmup"))
+		{
+			options.m_warmup = ndMax(atoi(value), 0);
+		}
+		else if (!strcmp(arg, "--scale"))
+		{
+			options.m_scale = ndClamp(ndFloat32(atof(value)), ndFloat32(0.001f), ndFloat32(100.0f));
+		}
+		else if (!strcmp(arg, "--solver"))
+		{
+			if (!ParseSolver(value, options.m_solver))
+			{
+				fprintf(stderr, "unknown solver %s\n", value);
+				return false;
+			}
+		}
+		else if (!strcmp(arg, "--label"))
+		{
+			options.m_label = value;
+		}
+		else if (!strcmp(arg, "--output"))
+		{
+			options.m_output = value;
+		}
+		else
+		{
+			fprintf(stderr, "unknown option %s\n", arg);
+			return false;
+		}
+	}
+
+	if (!options.m_threads.size())
+	{
+		// powers of two up to the pool size
+		const ndInt32 maxThreads = ndThreadPool::GetMaxThreads();
+		for (ndInt32 count = 1; count < maxThreads; count *= 2)
+		{
+			options.m_threads.push_back(count);
+		}
+		options.m_threads.push_back(maxThreads);
+	}
+	return true;
+}
+
+static void AddStages(std::vector<ndBenchStage>& stages, const ndFrameStats& stats)
+{
+	// the zones under the update root, at most two levels deep
+	for (ndInt32 i = 0; i < stats.m_zones.GetCount(); ++i)
+	{
+		const ndFrameStats::ndZone& zone = stats.m_zones[i];
+		if ((zone.m_depth < 1) || (zone.m_depth > 2))
+		{
+			continue;
+		}
+		std::string name(zone.m_name);
+		if (zone.m_depth == 2)
+		{
+			name = std::string(stats.m_zones[zone.m_parent].m_name) + "/" + name;
+		}
+
+		size_t index = 0;
+		for (; (index < stages.size()) && (stages[index].m_name != name); ++index);
+		if (index == stages.size())
+		{
+			ndBenchStage stage;
+			stage.m_name = name;
+			stage.m_depth = zone.m_depth;
+			stage.m_time = 0.0;
+			stages.push_back(stage);
+		}
+		stages[index].m_time += zone.m_time;
+	}
+}
+
+static void BuildWorld(ndWorld& world, const ndBenchScene& scene, const ndBenchOptions& options, ndInt32 threads, bool deterministic)
+{
+	ndSetRandSeed(0x5eed);
+	world.SetThreadCount(threads);
+	world.SelectSolver(options.m_solver);
+	world.SetDeterministicMode(deterministic);
+	scene.m_build(world, options.m_scale);
+	for (ndInt32 i = 0; i < options.m_warmup; ++i)
+	{
+		world.Update(D_BENCH_TIMESTEP);
+		world.Sync();
+	}
+}
+
+static void TimeSteps(std::vector<ndFloat64>& times, const ndBenchScene& scene, const ndBenchOptions& options, ndInt32 threads, bool deterministic)
+{
+	ndWorld world;
+	BuildWorld(world, scene, options, threads, deterministic);
+	for (ndInt32 i = 0; i < options.m_steps; ++i)
+	{
+		const ndUnsigned64 startTime = ndGetTimeInMicroseconds();
+		world.Update(D_BENCH_TIMESTEP);
+		world.Sync();
+		times.push_back(ndFloat64(ndGetTimeInMicroseconds() - startTime) * 1.0e-3);
+	}
+}
+
+static ndBenchRun RunScene(const ndBenchScene& scene, const ndBenchOptions& options, ndInt32 threads)
+{
+	// collecting the stats costs time, so the timed runs 
+	// and the stats run are separate worlds.
+	std::vector<ndFloat64> times;
+	std::vector<ndFloat64> deterministicTimes;
+	TimeSteps(times, scene, options, threads, false);
+	TimeSteps(deterministicTimes, scene, options, threads, true);
+
+	ndWorld world;
+	BuildWorld(world, scene, options, threads, false);
+
+	ndBenchRun run;
+	run.m_threads = world.GetThreadCount();
+	run.m_bodies = world.GetBodyList().GetCount();
+	run.m_particles = 0;
+	const ndBodyList& particleList = world.GetParticleList();
+	for (ndBodyList::ndNode* node = particleList.GetFirst(); node; node = node->GetNext())
+	{
+		run.m_particles += ndInt32(node->GetInfo()->GetAsBodyParticleSet()->GetPositions().GetCount());
+	}
+	run.m_solver = world.GetSolverString();
+
+	world.EnableFrameStats(true);
+	run.m_busy = 0.0;
+	memset(run.m_counters, 0, sizeof(run.m_counters));
+	for (ndInt32 i = 0; i < options.m_steps; ++i)
+	{
+		world.Update(D_BENCH_TIMESTEP);
+		world.Sync();
+
+		const ndFrameStats& stats = world.GetFrameStats();
+		AddStages(run.m_stages, stats);
+		for (ndInt32 j = 0; j < ndFrameStats::m_counterCount; ++j)
+		{
+			run.m_counters[j] += ndFloat64(stats.m_counters[j]);
+		}
+		ndFloat64 busy = 0.0;
+		for (ndInt32 j = 0; j < stats.m_threads.GetCount(); ++j)
+		{
+			busy += stats.m_threads[j].m_busy;
+		}
+		run.m_busy += (stats.m_frameTime > 0.0) ? busy / (stats.m_frameTime * ndFloat64(stats.m_threads.GetCount())) : 0.0;
+	}
+	world.EnableFrameStats(false);
+
+	const ndFloat64 steps = ndFloat64(options.m_steps);
+	ndFloat64 total = 0.0;
+	for (size_t i = 0; i < times.size(); ++i)
+	{
+		total += times[i];
+	}
+	ndFloat64 deterministicTotal = 0.0;
+	for (size_t i = 0; i < deterministicTimes.size(); ++i)
+	{
+		deterministicTotal += deterministicTimes[i];
+	}
+	std::sort(times.begin(), times.end());
+	run.m_mean = total / steps;
+	run.m_deterministicMean = deterministicTotal / steps;
+	run.m_median = times[times.size() / 2];
+	run.m_min = times[0];
+	run.m_max = times[times.size() - 1];
+	run.m_busy /= steps;
+	for (ndInt32 j = 0; j < ndFrameStats::m_counterCount; ++j)
+	{
+		run.m_counters[j] /= steps;
+	}
+	for (size_t i = 0; i < run.m_stages.size(); ++i)
+	{
+		run.m_stages[i].m_time = run.m_stages[i].m_time * 1.0e-3 / steps;
+	}
+	return run;
+}
+
+static void PrintRun(FILE* const file, const ndBenchRun& run, const ndBenchRun& baseline, bool last)
+{
+	fprintf(file, "\t\t\t\t{\n");
+	fprintf(file, "\t\t\t\t\t\"threads\": %d,\n", run.m_threads);
+	fprintf(file, "\t\t\t\t\t\"msPerStep\": %.4f,\n", run.m_mean);
+	fprintf(file, "\t\t\t\t\t\"medianMs\": %.4f,\n", run.m_median);
+	fprintf(file, "\t\t\t\t\t\"minMs\": %.4f,\n", run.m_min);
+	fprintf(file, "\t\t\t\t\t\"maxMs\": %.4f,\n", run.m_max);
+	fprintf(file, "\t\t\t\t\t\"speedup\": %.3f,\n", (run.m_mean > 0.0) ? baseline.m_mean / run.m_mean : 0.0);
+	fprintf(file, "\t\t\t\t\t\"deterministicMsPerStep\": %.4f,\n", run.m_deterministicMean);
+	fprintf(file, "\t\t\t\t\t\"deterministicOverhead\": %.3f,\n", (run.m_mean > 0.0) ? run.m_deterministicMean / run.m_mean - 1.0 : 0.0);
+	fprintf(file, "\t\t\t\t\t\"threadBusy\": %.3f,\n", run.m_busy);
+	fprintf(file, "\t\t\t\t\t\"solver\": \"%s\",\n", run.m_solver.c_str());
+
+	fprintf(file, "\t\t\t\t\t\"counters\": {");
+	for (ndInt32 i = 0; i < ndFrameStats::m_counterCount; ++i)
+	{
+		fprintf(file, "%s \"%s\": %.1f", i ? "," : "", ndFrameStats::GetCounterName(ndFrameStats::ndCounter(i)), run.m_counters[i]);
+	}
+	fprintf(file, " },\n");
+
+	fprintf(file, "\t\t\t\t\t\"stagesMs\": {");
+	for (size_t i = 0; i < run.m_stages.size(); ++i)
+	{
+		fprintf(file, "%s\n\t\t\t\t\t\t\"%s\": %.4f", i ? "," : "", run.m_stages[i].m_name.c_str(), run.m_stages[i].m_time);
+	}
+	fprintf(file, "\n\t\t\t\t\t}\n");
+	fprintf(file, "\t\t\t\t}%s\n", last ? "" : ",");
+}
+
+int main(int argc, char** argv)
+{
+	ndBenchOptions options;
+	if (!ParseOptions(argc, argv, options))
+	{
+		return 1;
+	}
+
+	const ndBenchScene* const scenes = ndBenchGetScenes();
+	if (options.m_list)
+	{
+		for (ndInt32 i = 0; scenes[i].m_name; ++i)
+		{
+			printf("%-20s %s\n", scenes[i].m_name, scenes[i].m_description);
+		}
+		return 0;
+	}
+
+	std::vector<const ndBenchScene*> selected;
+	for (ndInt32 i = 0; scenes[i].m_name; ++i)
+	{
+		bool found = !options.m_scenes.size();
+		for (size_t j = 0; j < options.m_scenes.size(); ++j)
+		{
+			found = found || (options.m_scenes[j] == scenes[i].m_name);
+		}
+		if (found)
+		{
+			selected.push_back(&scenes[i]);
+		}
+	}
+	for (size_t j = 0; j < options.m_scenes.size(); ++j)
+	{
+		bool found = false;
+		for (size_t i = 0; i < selected.size(); ++i)
+		{
+			found = found || (options.m_scenes[j] == selected[i]->m_name);
+		}
+		if (!found)
+		{
+			fprintf(stderr, "unknown scene %s\n", options.m_scenes[j].c_str());
+			return 1;
+		}
+	}
+
+	FILE* const file = options.m_output.size() ? fopen(options.m_output.c_str(), "wb") : stdout;
+	if (!file)
+	{
+		fprintf(stderr, "can't open %s\n", options.m_output.c_str());
+		return 1;
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"label\": \"%s\",\n", JsonString(options.m_label).c_str());
+	fprintf(file, "\t\"engineVersion\": %d,\n", ndWorld().GetEngineVersion());
+	fprintf(file, "\t\"vectorInstructionSet\": \"%s\",\n", ndCpuFeatures::GetVectorInstructionSet());
+	fprintf(file, "\t\"precision\": \"%s\",\n", (sizeof(ndFloat32) == sizeof(ndFloat64)) ? "double" : "float");
+	fprintf(file, "\t\"maxThreads\": %d,\n", ndThreadPool::GetMaxThreads());
+	fprintf(file, "\t\"timestep\": %f,\n", D_BENCH_TIMESTEP);
+	fprintf(file, "\t\"steps\": %d,\n", options.m_steps);
+	fprintf(file, "\t\"warmup\": %d,\n", options.m_warmup);
+	fprintf(file, "\t\"scale\": %f,\n", options.m_scale);
+	fprintf(file, "\t\"scenes\": [\n");
+	for (size_t i = 0; i < selected.size(); ++i)
+	{
+		const ndBenchScene& scene = *selected[i];
+		fprintf(file, "\t\t{\n");
+		fprintf(file, "\t\t\t\"name\": \"%s\",\n", scene.m_name);
+		fprintf(file, "\t\t\t\"description\": \"%s\",\n", scene.m_description);
+
+		std::vector<ndBenchRun> runs;
+		for (size_t j = 0; j < options.m_threads.size(); ++j)
+		{
+			fprintf(stderr, "%s, %d threads\n", scene.m_name, options.m_threads[j]);
+			const ndBenchRun run(RunScene(scene, options, options.m_threads[j]));
+			bool duplicate = false;
+			for (size_t k = 0; k < runs.size(); ++k)
+			{
+				duplicate = duplicate || (runs[k].m_threads == run.m_threads);
+			}
+			if (!duplicate)
+			{
+				runs.push_back(run);
+			}
+		}
+
+		fprintf(file, "\t\t\t\"bodies\": %d,\n", runs[0].m_bodies);
+		fprintf(file, "\t\t\t\"particles\": %d,\n", runs[0].m_particles);
+		fprintf(file, "\t\t\t\"runs\": [\n");
+		for (size_t j = 0; j < runs.size(); ++j)
+		{
+			PrintRun(file, runs[j], runs[0], j == (runs.size() - 1));
+		}
+		fprintf(file, "\t\t\t]\n");
+		fprintf(file, "\t\t}%s\n", (i == (selected.size() - 1)) ? "" : ",");
+	}
+	fprintf(file, "\t]\n");
+	fprintf(file, "}\n");
+
+	if (file != stdout)
+	{
+		fclose(file);
+	}
+	return 0;
+}
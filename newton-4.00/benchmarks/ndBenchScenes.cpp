@@ -0,0 +1,364 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include "ndBenchScenes.h"
+
+#define D_BENCH_GRAVITY	ndFloat32(-10.0f)
+
+static ndInt32 ScaleCount(ndInt32 count, ndFloat32 scale)
+{
+	return ndMax(ndInt32(ndFloat32(count) * scale + ndFloat32(0.5f)), 1);
+}
+
+static ndInt32 ScaleSide(ndInt32 side, ndFloat32 scale)
+{
+	return ndMax(ndInt32(ndFloat32(side) * ndSqrt(scale) + ndFloat32(0.5f)), 1);
+}
+
+static ndBodyKinematic* AddStaticBody(ndWorld& world, const ndShapeInstance& shape, const ndMatrix& matrix)
+{
+	ndBodyKinematic* const body = new ndBodyKinematic();
+	body->SetCollisionShape(shape);
+	body->SetMatrix(matrix);
+	ndSharedPtr<ndBody> bodyPtr(body);
+	world.AddBody(bodyPtr);
+	return body;
+}
+
+static ndBodyDynamic* AddDynamicBody(ndWorld& world, const ndShapeInstance& shape, const ndMatrix& matrix, ndFloat32 mass)
+{
+	ndBodyDynamic* const body = new ndBodyDynamic();
+	body->SetNotifyCallback(new ndBodyNotify(ndVector(ndFloat32(0.0f), D_BENCH_GRAVITY, ndFloat32(0.0f), ndFloat32(0.0f))));
+	body->SetCollisionShape(shape);
+	body->SetMatrix(matrix);
+	body->SetMassMatrix(mass, shape);
+	ndSharedPtr<ndBody> bodyPtr(body);
+	world.AddBody(bodyPtr);
+	return body;
+}
+
+static void AddJoint(ndWorld& world, ndJointBilateralConstraint* const joint)
+{
+	ndSharedPtr<ndJointBilateralConstraint> jointPtr(joint);
+	world.AddJoint(jointPtr);
+}
+
+static void AddFloor(ndWorld& world, ndFloat32 size)
+{
+	ndShapeInstance shape(new ndShapeBox(size, ndFloat32(1.0f), size));
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit.m_y = ndFloat32(-0.5f);
+	AddStaticBody(world, shape, matrix);
+}
+
+static ndMatrix Location(ndFloat32 x, ndFloat32 y, ndFloat32 z)
+{
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit = ndVector(x, y, z, ndFloat32(1.0f));
+	return matrix;
+}
+
+// 64 stacks of 12 boxes
+static void BuildBoxStacks(ndWorld& world, ndFloat32 scale)
+{
+	AddFloor(world, ndFloat32(200.0f));
+
+	ndShapeInstance box(new ndShapeBox(ndFloat32(1.0f), ndFloat32(0.5f), ndFloat32(1.0f)));
+	const ndInt32 side = ScaleSide(8, scale);
+	const ndInt32 high = 12;
+	for (ndInt32 i = 0; i < side; ++i)
+	{
+		for (ndInt32 j = 0; j < side; ++j)
+		{
+			for (ndInt32 k = 0; k < high; ++k)
+			{
+				const ndFloat32 x = ndFloat32(i) * ndFloat32(3.0f);
+				const ndFloat32 z = ndFloat32(j) * ndFloat32(3.0f);
+				AddDynamicBody(world, box, Location(x, ndFloat32(0.25f) + ndFloat32(k) * ndFloat32(0.5f), z), ndFloat32(1.0f));
+			}
+		}
+	}
+}
+
+// 8 pyramid walls of bricks with a base of 24
+static void BuildPyramidWalls(ndWorld& world, ndFloat32 scale)
+{
+	AddFloor(world, ndFloat32(200.0f));
+
+	const ndFloat32 width = ndFloat32(1.0f);
+	const ndFloat32 high = ndFloat32(0.5f);
+	ndShapeInstance brick(new ndShapeBox(width, high, ndFloat32(0.5f)));
+	const ndInt32 walls = ScaleCount(8, scale);
+	const ndInt32 base = 24;
+	for (ndInt32 w = 0; w < walls; ++w)
+	{
+		const ndFloat32 z = ndFloat32(w) * ndFloat32(4.0f);
+		for (ndInt32 row = 0; row < base; ++row)
+		{
+			const ndInt32 count = base - row;
+			const ndFloat32 x0 = -ndFloat32(count - 1) * width * ndFloat32(0.5f);
+			const ndFloat32 y = high * ndFloat32(0.5f) + ndFloat32(row) * high;
+			for (ndInt32 i = 0; i < count; ++i)
+			{
+				AddDynamicBody(world, brick, Location(x0 + ndFloat32(i) * width, y, z), ndFloat32(1.0f));
+			}
+		}
+	}
+}
+
+// 64 ragdolls of ten capsules linked by ball and hinge joints, dropped in a crowd
+static void BuildRagdollCrowd(ndWorld& world, ndFloat32 scale)
+{
+	AddFloor(world, ndFloat32(200.0f));
+
+	ndShapeInstance torsoShape(new ndShapeCapsule(ndFloat32(0.15f), ndFloat32(0.15f), ndFloat32(0.5f)));
+	ndShapeInstance headShape(new ndShapeSphere(ndFloat32(0.12f)));
+	ndShapeInstance armShape(new ndShapeCapsule(ndFloat32(0.06f), ndFloat32(0.06f), ndFloat32(0.25f)));
+	ndShapeInstance legShape(new ndShapeCapsule(ndFloat32(0.08f), ndFloat32(0.08f), ndFloat32(0.3f)));
+	const ndMatrix vertical(ndRollMatrix(ndFloat32(90.0f) * ndDegreeToRad));
+
+	const ndInt32 side = ScaleSide(8, scale);
+	for (ndInt32 i = 0; i < side; ++i)
+	{
+		for (ndInt32 j = 0; j < side; ++j)
+		{
+			const ndVector origin(ndFloat32(i) * ndFloat32(1.2f), ndFloat32(0.5f) + ndFloat32((i + j) % 3) * ndFloat32(0.5f), ndFloat32(j) * ndFloat32(1.2f), ndFloat32(0.0f));
+			const ndMatrix frame(ndYawMatrix(ndFloat32((i * 7 + j * 3) % 12) * ndFloat32(30.0f) * ndDegreeToRad));
+			auto Place = [&origin, &frame](const ndMatrix& matrix)
+			{
+				ndMatrix placed(matrix * frame);
+				placed.m_posit += origin;
+				return placed;
+			};
+			auto At = [](const ndMatrix& matrix, ndFloat32 x, ndFloat32 y)
+			{
+				ndMatrix placed(matrix);
+				placed.m_posit = ndVector(x, y, ndFloat32(0.0f), ndFloat32(1.0f));
+				return placed;
+			};
+
+			ndBodyDynamic* const torso = AddDynamicBody(world, torsoShape, Place(At(vertical, ndFloat32(0.0f), ndFloat32(1.2f))), ndFloat32(10.0f));
+			ndBodyDynamic* const head = AddDynamicBody(world, headShape, Place(At(ndGetIdentityMatrix(), ndFloat32(0.0f), ndFloat32(1.65f))), ndFloat32(2.0f));
+			AddJoint(world, new ndJointSpherical(Place(At(vertical, ndFloat32(0.0f), ndFloat32(1.52f))), head, torso));
+
+			for (ndInt32 k = -1; k <= 1; k += 2)
+			{
+				const ndFloat32 s = ndFloat32(k);
+				ndBodyDynamic* const upperArm = AddDynamicBody(world, armShape, Place(At(ndGetIdentityMatrix(), s * ndFloat32(0.37f), ndFloat32(1.4f))), ndFloat32(1.5f));
+				ndBodyDynamic* const lowerArm = AddDynamicBody(world, armShape, Place(At(ndGetIdentityMatrix(), s * ndFloat32(0.76f), ndFloat32(1.4f))), ndFloat32(1.0f));
+				AddJoint(world, new ndJointSpherical(Place(At(ndGetIdentityMatrix(), s * ndFloat32(0.18f), ndFloat32(1.4f))), upperArm, torso));
+				AddJoint(world, new ndJointHinge(Place(At(ndYawMatrix(ndFloat32(90.0f) * ndDegreeToRad), s * ndFloat32(0.565f), ndFloat32(1.4f))), lowerArm, upperArm));
+
+				ndBodyDynamic* const thigh = AddDynamicBody(world, legShape, Place(At(vertical, s * ndFloat32(0.1f), ndFloat32(0.72f))), ndFloat32(3.0f));
+				ndBodyDynamic* const shin = AddDynamicBody(world, legShape, Place(At(vertical, s * ndFloat32(0.1f), ndFloat32(0.26f))), ndFloat32(2.0f));
+				AddJoint(world, new ndJointSpherical(Place(At(vertical, s * ndFloat32(0.1f), ndFloat32(0.95f))), thigh, torso));
+				AddJoint(world, new ndJointHinge(Place(At(ndGetIdentityMatrix(), s * ndFloat32(0.1f), ndFloat32(0.49f))), shin, thigh));
+			}
+		}
+	}
+}
+
+// 64 cars, a box chassis on four sprung wheels, driving over a field of bumps
+static void BuildVehicleFleet(ndWorld& world, ndFloat32 scale)
+{
+	AddFloor(world, ndFloat32(400.0f));
+
+	ndShapeInstance bump(new ndShapeCapsule(ndFloat32(0.15f), ndFloat32(0.15f), ndFloat32(20.0f)));
+	const ndMatrix across(ndYawMatrix(ndFloat32(90.0f) * ndDegreeToRad));
+	for (ndInt32 i = 0; i < 16; ++i)
+	{
+		ndMatrix matrix(across);
+		matrix.m_posit = ndVector(ndFloat32(0.0f), ndFloat32(0.0f), ndFloat32(12.0f) + ndFloat32(i) * ndFloat32(6.0f), ndFloat32(1.0f));
+		for (ndInt32 j = 0; j < 6; ++j)
+		{
+			matrix.m_posit.m_x = ndFloat32(j) * ndFloat32(20.0f);
+			AddStaticBody(world, bump, matrix);
+		}
+	}
+
+	ndShapeInstance chassisShape(new ndShapeBox(ndFloat32(1.8f), ndFloat32(0.5f), ndFloat32(4.0f)));
+	ndShapeInstance wheelShape(new ndShapeChamferCylinder(ndFloat32(0.5f), ndFloat32(1.0f)));
+	wheelShape.SetScale(ndVector(ndFloat32(0.3f), ndFloat32(0.7f), ndFloat32(0.7f), ndFloat32(0.0f)));
+
+	ndWheelDescriptor desc;
+	desc.m_radios = ndFloat32(0.35f);
+	desc.m_springK = ndFloat32(1000.0f);
+	desc.m_damperC = ndFloat32(30.0f);
+	desc.m_upperStop = ndFloat32(-0.05f);
+	desc.m_lowerStop = ndFloat32(0.2f);
+	desc.m_regularizer = ndFloat32(0.1f);
+
+	const ndInt32 side = ScaleSide(8, scale);
+	const ndVector veloc(ndFloat32(0.0f), ndFloat32(0.0f), ndFloat32(8.0f), ndFloat32(0.0f));
+	for (ndInt32 i = 0; i < side; ++i)
+	{
+		for (ndInt32 j = 0; j < side; ++j)
+		{
+			const ndFloat32 x = ndFloat32(i) * ndFloat32(4.0f) - ndFloat32(side) * ndFloat32(2.0f) + ndFloat32(50.0f);
+			const ndFloat32 z = ndFloat32(j) * ndFloat32(7.0f) - ndFloat32(side) * ndFloat32(7.0f);
+			ndBodyDynamic* const chassis = AddDynamicBody(world, chassisShape, Location(x, ndFloat32(0.9f), z), ndFloat32(100.0f));
+			chassis->SetVelocity(veloc);
+			for (ndInt32 k = 0; k < 4; ++k)
+			{
+				const ndFloat32 wx = x + ((k & 1) ? ndFloat32(1.05f) : ndFloat32(-1.05f));
+				const ndFloat32 wz = z + ((k & 2) ? ndFloat32(1.4f) : ndFloat32(-1.4f));
+				const ndMatrix wheelMatrix(Location(wx, ndFloat32(0.4f), wz));
+				ndBodyDynamic* const wheel = AddDynamicBody(world, wheelShape, wheelMatrix, ndFloat32(10.0f));
+				wheel->SetVelocity(veloc);
+				wheel->SetOmega(ndVector(veloc.m_z / desc.m_radios, ndFloat32(0.0f), ndFloat32(0.0f), ndFloat32(0.0f)));
+				AddJoint(world, new ndJointWheel(wheelMatrix, wheel, chassis, desc));
+			}
+		}
+	}
+}
+
+// a rolling heightfield and 10000 pieces of debris falling on it
+static void BuildHeightfieldDebris(ndWorld& world, ndFloat32 scale)
+{
+	const ndInt32 size = 128;
+	const ndFloat32 cellSize = ndFloat32(1.0f);
+	ndShapeInstance terrain(new ndShapeHeightfield(size, size, ndShapeHeightfield::m_normalDiagonals, cellSize, cellSize));
+	ndShapeHeightfield* const heightfield = terrain.GetShape()->GetAsShapeHeightfield();
+	ndArray<ndReal>& elevation = heightfield->GetElevationMap();
+	for (ndInt32 z = 0; z < size; ++z)
+	{
+		for (ndInt32 x = 0; x < size; ++x)
+		{
+			const ndFloat32 h = ndFloat32(1.5f) * ndSin(ndFloat32(x) * ndFloat32(0.15f)) * ndCos(ndFloat32(z) * ndFloat32(0.11f));
+			elevation[z * size + x] = ndReal(h);
+		}
+	}
+	heightfield->UpdateElevationMapAabb();
+	ndMatrix terrainMatrix(ndGetIdentityMatrix());
+	terrainMatrix.m_posit = ndVector(-ndFloat32(size) * cellSize * ndFloat32(0.5f), ndFloat32(0.0f), -ndFloat32(size) * cellSize * ndFloat32(0.5f), ndFloat32(1.0f));
+	terrain.SetLocalMatrix(terrainMatrix);
+	AddStaticBody(world, terrain, ndGetIdentityMatrix());
+
+	ndShapeInstance box(new ndShapeBox(ndFloat32(0.4f), ndFloat32(0.3f), ndFloat32(0.5f)));
+	ndShapeInstance sphere(new ndShapeSphere(ndFloat32(0.2f)));
+	ndShapeInstance capsule(new ndShapeCapsule(ndFloat32(0.12f), ndFloat32(0.12f), ndFloat32(0.4f)));
+	ndShapeInstance cylinder(new ndShapeCylinder(ndFloat32(0.2f), ndFloat32(0.2f), ndFloat32(0.3f)));
+	const ndShapeInstance* const shapes[] = { &box, &sphere, &capsule, &cylinder };
+
+	const ndInt32 count = ScaleCount(10000, scale);
+	const ndInt32 side = 50;
+	const ndFloat32 spacing = ndFloat32(1.2f);
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		const ndInt32 layer = i / (side * side);
+		const ndInt32 x = i % side;
+		const ndInt32 z = (i / side) % side;
+		ndMatrix matrix(ndPitchMatrix(ndRand() * ndFloat32(2.0f) * ndPi) * ndYawMatrix(ndRand() * ndFloat32(2.0f) * ndPi));
+		matrix.m_posit = ndVector((ndFloat32(x) - ndFloat32(side) * ndFloat32(0.5f)) * spacing, ndFloat32(3.0f) + ndFloat32(layer) * spacing, (ndFloat32(z) - ndFloat32(side) * ndFloat32(0.5f)) * spacing, ndFloat32(1.0f));
+		AddDynamicBody(world, *shapes[i & 3], matrix, ndFloat32(1.0f));
+	}
+}
+
+// 256 compound bodies, open bins and crosses, piled in a pit
+static void BuildCompoundPile(ndWorld& world, ndFloat32 scale)
+{
+	AddFloor(world, ndFloat32(200.0f));
+
+	ndShapeInstance wall(new ndShapeBox(ndFloat32(8.0f), ndFloat32(3.0f), ndFloat32(0.5f)));
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		ndMatrix matrix(ndYawMatrix(ndFloat32(i) * ndFloat32(90.0f) * ndDegreeToRad));
+		matrix.m_posit = matrix.m_right.Scale(ndFloat32(4.25f));
+		matrix.m_posit.m_y = ndFloat32(1.5f);
+		matrix.m_posit.m_w = ndFloat32(1.0f);
+		AddStaticBody(world, wall, matrix);
+	}
+
+	auto AddChild = [](ndShapeInstance& compound, ndShape* const shape, const ndMatrix& localMatrix)
+	{
+		ndShapeInstance child(shape);
+		child.SetLocalMatrix(localMatrix);
+		compound.GetShape()->GetAsShapeCompound()->AddCollision(&child);
+	};
+
+	ndShapeInstance bin(new ndShapeCompound());
+	bin.GetShape()->GetAsShapeCompound()->BeginAddRemove();
+	AddChild(bin, new ndShapeBox(ndFloat32(1.0f), ndFloat32(0.1f), ndFloat32(1.0f)), Location(ndFloat32(0.0f), ndFloat32(-0.45f), ndFloat32(0.0f)));
+	AddChild(bin, new ndShapeBox(ndFloat32(1.0f), ndFloat32(1.0f), ndFloat32(0.1f)), Location(ndFloat32(0.0f), ndFloat32(0.0f), ndFloat32(0.45f)));
+	AddChild(bin, new ndShapeBox(ndFloat32(1.0f), ndFloat32(1.0f), ndFloat32(0.1f)), Location(ndFloat32(0.0f), ndFloat32(0.0f), ndFloat32(-0.45f)));
+	AddChild(bin, new ndShapeBox(ndFloat32(0.1f), ndFloat32(1.0f), ndFloat32(1.0f)), Location(ndFloat32(0.45f), ndFloat32(0.0f), ndFloat32(0.0f)));
+	AddChild(bin, new ndShapeBox(ndFloat32(0.1f), ndFloat32(1.0f), ndFloat32(1.0f)), Location(ndFloat32(-0.45f), ndFloat32(0.0f), ndFloat32(0.0f)));
+	bin.GetShape()->GetAsShapeCompound()->EndAddRemove();
+
+	ndShapeInstance cross(new ndShapeCompound());
+	cross.GetShape()->GetAsShapeCompound()->BeginAddRemove();
+	AddChild(cross, new ndShapeCapsule(ndFloat32(0.12f), ndFloat32(0.12f), ndFloat32(1.2f)), ndGetIdentityMatrix());
+	AddChild(cross, new ndShapeCapsule(ndFloat32(0.12f), ndFloat32(0.12f), ndFloat32(1.2f)), ndYawMatrix(ndFloat32(90.0f) * ndDegreeToRad));
+	AddChild(cross, new ndShapeCapsule(ndFloat32(0.12f), ndFloat32(0.12f), ndFloat32(1.2f)), ndRollMatrix(ndFloat32(90.0f) * ndDegreeToRad));
+	cross.GetShape()->GetAsShapeCompound()->EndAddRemove();
+
+	const ndInt32 count = ScaleCount(256, scale);
+	const ndInt32 side = 5;
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		const ndInt32 layer = i / (side * side);
+		const ndInt32 x = i % side;
+		const ndInt32 z = (i / side) % side;
+		ndMatrix matrix(ndPitchMatrix(ndRand() * ndPi) * ndYawMatrix(ndRand() * ndPi));
+		matrix.m_posit = ndVector((ndFloat32(x) - ndFloat32(2.0f)) * ndFloat32(1.5f), ndFloat32(1.0f) + ndFloat32(layer) * ndFloat32(1.5f), (ndFloat32(z) - ndFloat32(2.0f)) * ndFloat32(1.5f), ndFloat32(1.0f));
+		AddDynamicBody(world, (i & 1) ? cross : bin, matrix, ndFloat32(5.0f));
+	}
+}
+
+// a block of 16384 sph particles collapsing
+static void BuildSphFluid(ndWorld& world, ndFloat32 scale)
+{
+	const ndFloat32 radius = ndFloat32(0.125f);
+	ndBodySphFluid* const fluid = new ndBodySphFluid();
+	fluid->SetParticleRadius(radius);
+	fluid->SetGravity(ndVector(ndFloat32(0.0f), D_BENCH_GRAVITY, ndFloat32(0.0f), ndFloat32(0.0f)));
+	fluid->SetMatrix(ndGetIdentityMatrix());
+
+	// run the fluid in the update so its time is part of the step
+	fluid->SetAsynUpdate(false);
+
+	ndArray<ndVector>& posit = fluid->GetPositions();
+	ndArray<ndVector>& veloc = fluid->GetVelocity();
+	const ndInt32 side = ndMax(ndInt32(ndFloat32(32.0f) * ndPow(scale, ndFloat32(1.0f / 3.0f)) + ndFloat32(0.5f)), 2);
+	const ndFloat32 spacing = radius * ndFloat32(2.0f) * ndFloat32(0.9f);
+	for (ndInt32 y = 0; y < side / 2; ++y)
+	{
+		for (ndInt32 z = 0; z < side; ++z)
+		{
+			for (ndInt32 x = 0; x < side; ++x)
+			{
+				posit.PushBack(ndVector(ndFloat32(x) * spacing, ndFloat32(1.0f) + ndFloat32(y) * spacing, ndFloat32(z) * spacing, ndFloat32(1.0f)));
+				veloc.PushBack(ndVector::m_zero);
+			}
+		}
+	}
+
+	ndSharedPtr<ndBody> bodyPtr(fluid);
+	world.AddBody(bodyPtr);
+}
+
+static const ndBenchScene g_scenes[] =
+{
+	{ "boxStacks", "64 stacks of 12 boxes", BuildBoxStacks },
+	{ "pyramidWalls", "8 pyramid walls of 300 bricks", BuildPyramidWalls },
+	{ "ragdollCrowd", "64 ragdolls of 10 bodies and 9 joints", BuildRagdollCrowd },
+	{ "vehicleFleet", "64 four wheel cars over bumps", BuildVehicleFleet },
+	{ "heightfieldDebris", "10000 convex debris on a 128 x 128 heightfield", BuildHeightfieldDebris },
+	{ "compoundPile", "256 compound bins and crosses in a pit", BuildCompoundPile },
+	{ "sphFluid", "16384 sph particles", BuildSphFluid },
+	{ nullptr, nullptr, nullptr },
+};
+
+const ndBenchScene* ndBenchGetScenes()
+{
+	return g_scenes;
+}
@@ -0,0 +1,32 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#ifndef __ND_BENCH_SCENES_H__
+#define __ND_BENCH_SCENES_H__
+
+#include "ndNewton.h"
+
+// builds a scene in an empty world, scale multiplies the number of 
+// objects so the same scene can run on small machines and ci runners.
+typedef void (*ndBenchBuildScene)(ndWorld& world, ndFloat32 scale);
+
+class ndBenchScene
+{
+	public:
+	const char* m_name;
+	const char* m_description;
+	ndBenchBuildScene m_build;
+};
+
+// all the scenes, the list ends with an entry with a null name
+const ndBenchScene* ndBenchGetScenes();
+
+#endif
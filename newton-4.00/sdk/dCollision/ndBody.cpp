@@ -50,6 +50,7 @@ ndBody::ndBody()
 	,m_isConstrained(0)
 	,m_sceneForceUpdate(1)
 	,m_sceneEquilibrium(0)
+	,m_isFrozen(0)
 {
 	m_uniqueIdCount++;
 	m_transformIsDirty = 1;
@@ -97,6 +98,7 @@ void ndBody::SetOmegaNoSleep(const ndVector& omega)
 void ndBody::SetOmega(const ndVector& omega)
 {
 	m_equilibrium = 0;
+	Unfreeze();
 	SetOmegaNoSleep(omega);
 }
 
@@ -108,6 +110,7 @@ void ndBody::SetVelocityNoSleep(const ndVector& veloc)
 void ndBody::SetVelocity(const ndVector& veloc)
 {
 	m_equilibrium = 0;
+	Unfreeze();
 	SetVelocityNoSleep(veloc);
 }
 
@@ -132,6 +135,7 @@ void ndBody::SetMatrixAndCentreOfMass(const ndQuaternion& rotation, const ndVect
 void ndBody::SetMatrix(const ndMatrix& matrix)
 {
 	m_equilibrium = 0;
+	Unfreeze();
 	m_transformIsDirty = 1;
 	m_sceneForceUpdate = 1;
 	SetMatrixNoSleep(matrix);
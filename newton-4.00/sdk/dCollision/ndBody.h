@@ -90,6 +90,7 @@ class ndBody : public ndContainersFreeListAlloc<ndBody>
 	virtual void AttachContact(ndContact* const) {}
 	virtual void DetachContact(ndContact* const) {}
 	virtual ndContact* FindContact(const ndBody* const) const { return nullptr; }
+	virtual void Unfreeze() {}
 
 	ndMatrix m_matrix;
 	ndVector m_veloc;
@@ -127,6 +128,7 @@ class ndBody : public ndContainersFreeListAlloc<ndBody>
 	ndUnsigned8 m_isConstrained;
 	ndUnsigned8 m_sceneForceUpdate;
 	ndUnsigned8 m_sceneEquilibrium;
+	ndUnsigned8 m_isFrozen;
 	
 	D_COLLISION_API static ndUnsigned32 m_uniqueIdCount;
 
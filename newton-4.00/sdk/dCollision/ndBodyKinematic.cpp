@@ -34,60 +34,60 @@
 
 ndVector ndBodyKinematic::m_velocTol(ndVector(ndFloat32(1.0e-8f)) & ndVector::m_triplexMask);
 
-ndBodyKinematic::ndContactkey::ndContactkey(ndUnsigned32 tag0, ndUnsigned32 tag1)
-	:m_tagLow(ndMin(tag0, tag1))
-	,m_tagHigh(ndMax(tag0, tag1))
-{
-	ndAssert(m_tagLow < m_tagHigh);
-}
-
-bool ndBodyKinematic::ndContactkey::operator== (const ndContactkey& key) const
-{
-	return m_tag == key.m_tag;
-}
-
-bool ndBodyKinematic::ndContactkey::operator< (const ndContactkey& key) const
+ndBodyKinematic::ndContactMap::ndContactMap()
+	:ndArray<ndContact*>()
 {
-	return m_tag < key.m_tag;
 }
 
-bool ndBodyKinematic::ndContactkey::operator> (const ndContactkey& key) const
+ndBodyKinematic::ndContactMap::~ndContactMap()
 {
-	return m_tag > key.m_tag;
 }
 
-ndBodyKinematic::ndContactMap::ndContactMap()
-	:ndTree<ndContact*, ndContactkey, ndContainersFreeListAlloc<ndContact*>>()
+ndInt32& ndBodyKinematic::ndContactMap::GetSlot(ndContact* const contact) const
 {
+	ndAssert((&contact->GetBody0()->m_contactList == this) || (&contact->GetBody1()->m_contactList == this));
+	return (&contact->GetBody0()->m_contactList == this) ? contact->m_contactMapSlot0 : contact->m_contactMapSlot1;
 }
 
-ndBodyKinematic::ndContactMap::~ndContactMap()
+ndContact* ndBodyKinematic::ndContactMap::FindContact(const ndBody* const body0, const ndBody* const body1) const
 {
+	for (ndInt32 i = 0; i < GetCount(); ++i)
+	{
+		ndContact* const contact = m_array[i];
+		if (((contact->GetBody0() == body0) && (contact->GetBody1() == body1)) || ((contact->GetBody0() == body1) && (contact->GetBody1() == body0)))
+		{
+			return contact;
+		}
+	}
+	return nullptr;
 }
 
-ndContact* ndBodyKinematic::ndContactMap::FindContact(const ndBody* const body0, const ndBody* const body1) const
+bool ndBodyKinematic::ndContactMap::SanityCheck() const
 {
-	ndContactkey key(body0->GetId(), body1->GetId());
-	ndNode* const node = Find(key);
-	return node ? node->GetInfo() : nullptr;
+	for (ndInt32 i = 0; i < GetCount(); ++i)
+	{
+		if (GetSlot(m_array[i]) != i)
+		{
+			return false;
+		}
+	}
+	return true;
 }
 
 void ndBodyKinematic::ndContactMap::AttachContact(ndContact* const contact)
 {
-	ndBody* const body0 = contact->GetBody0();
-	ndBody* const body1 = contact->GetBody1();
-	ndContactkey key(body0->GetId(), body1->GetId());
-	ndAssert(!Find(key));
-	Insert(contact, key);
+	GetSlot(contact) = GetCount();
+	PushBack(contact);
 }
 
 void ndBodyKinematic::ndContactMap::DetachContact(ndContact* const contact)
 {
-	ndBody* const body0 = contact->GetBody0();
-	ndBody* const body1 = contact->GetBody1();
-	ndContactkey key(body0->GetId(), body1->GetId());
-	ndAssert(Find(key));
-	Remove(key);
+	const ndInt32 slot = GetSlot(contact);
+	ndAssert(m_array[slot] == contact);
+	ndContact* const last = m_array[GetCount() - 1];
+	m_array[slot] = last;
+	GetSlot(last) = slot;
+	SetCount(GetCount() - 1);
 }
 
 ndBodyKinematic::ndBodyKinematic()
@@ -121,6 +121,10 @@ ndBodyKinematic::ndBodyKinematic()
 	,m_sceneNodeIndex(-1)
 	,m_buildBodyNodeIndex(-1)
 	,m_buildSceneNodeIndex(-1)
+	,m_freezeMark(0)
+	,m_unfreezeQueued(0)
+	,m_hasFrozenContacts(0)
+	,m_speculativeContacts(0)
 {
 	m_invWorldInertiaMatrix[3][3] = ndFloat32(1.0f);
 	m_shapeInstance.m_ownerBody = this;
@@ -137,6 +141,10 @@ ndBodyKinematic::~ndBodyKinematic()
 void ndBodyKinematic::SetSleepState(bool state)
 {
 	m_equilibrium = ndUnsigned8 (state ? 1 : 0);
+	if (!state)
+	{
+		Unfreeze();
+	}
 	if ((m_invMass.m_w > ndFloat32(0.0f)) && (m_veloc.DotProduct(m_veloc).GetScalar() < ndFloat32(1.0e-10f)) && (m_omega.DotProduct(m_omega).GetScalar() < ndFloat32(1.0e-10f))) 
 	{
 		ndVector invalidateVeloc(ndFloat32(10.0f));
@@ -161,6 +169,11 @@ void ndBodyKinematic::SetCollisionShape(const ndShapeInstance& shapeInstance)
 
 ndContact* ndBodyKinematic::FindContact(const ndBody* const otherBody) const
 {
+	// bodies in a scene are found in the scene pair map, not in the contact list
+	if (m_scene)
+	{
+		return m_scene->m_contactPairMap.Find(this, otherBody);
+	}
 	ndScopeSpinLock lock(m_lock);
 	return m_contactList.FindContact(this, otherBody);
 }
@@ -169,6 +182,8 @@ void ndBodyKinematic::AttachContact(ndContact* const contact)
 {
 	ndScopeSpinLock lock(m_lock);
 	ndAssert((this == contact->GetBody0()) || (this == contact->GetBody1()));
+	// the scene inserts the pair before the contact is attached, so it is never attached twice
+	ndAssert(!m_scene || (m_scene->m_contactPairMap.Find(contact->GetBody0(), contact->GetBody1()) == contact));
 	if (m_invMass.m_w > ndFloat32(0.0f))
 	{
 		m_equilibrium = 0;
@@ -186,12 +201,26 @@ void ndBodyKinematic::DetachContact(ndContact* const contact)
 	{
 		m_equilibrium = 0;
 	}
+	if (m_isFrozen)
+	{
+		// a frozen island losing a contact must be simulated again
+		Unfreeze();
+	}
 	m_contactList.DetachContact(contact);
 }
 
+void ndBodyKinematic::Unfreeze()
+{
+	if (m_scene && (m_isFrozen | m_hasFrozenContacts))
+	{
+		m_scene->UnfreezeBody(this);
+	}
+}
+
 ndBodyKinematic::ndJointList::ndNode* ndBodyKinematic::AttachJoint(ndJointBilateralConstraint* const joint)
 {
 	m_equilibrium = 0;
+	Unfreeze();
 	#ifdef _DEBUG
 	ndBody* const body0 = joint->GetBody0();
 	ndBody* const body1 = joint->GetBody1();
@@ -218,6 +247,7 @@ ndBodyKinematic::ndJointList::ndNode* ndBodyKinematic::AttachJoint(ndJointBilate
 void ndBodyKinematic::DetachJoint(ndJointList::ndNode* const node)
 {
 	m_equilibrium = 0;
+	Unfreeze();
 #ifdef _DEBUG
 	bool found = false;
 	for (ndJointList::ndNode* nodeptr = m_jointList.GetFirst(); nodeptr; nodeptr = nodeptr->GetNext())
@@ -575,7 +605,7 @@ ndJacobian ndBodyKinematic::CalculateNetForce() const
 	ndBodyKinematic::ndContactMap::Iterator it(contactMap);
 	for (it.Begin(); it; it++)
 	{
-		ndContact* const fronterContact = it.GetNode()->GetInfo();
+		ndContact* const fronterContact = *it;
 		if (fronterContact->IsActive())
 		{
 			if (fronterContact->GetBody0() == this)
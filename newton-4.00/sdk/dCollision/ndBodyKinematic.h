@@ -39,27 +39,6 @@ class ndJointBilateralConstraint;
 D_MSV_NEWTON_ALIGN_32
 class ndBodyKinematic : public ndBody
 {
-	class ndContactkey
-	{
-		public:
-		ndContactkey(ndUnsigned32 tag0, ndUnsigned32 tag1);
-
-		bool operator> (const ndContactkey& key) const;
-		bool operator< (const ndContactkey& key) const;
-		bool operator== (const ndContactkey& key) const;
-		private:
-		union
-		{
-			ndUnsigned64 m_tag;
-			class
-			{
-				public:
-				ndUnsigned32 m_tagLow;
-				ndUnsigned32 m_tagHigh;
-			};
-		};
-	};
-
 	public:
 	class ndJointList : public ndList<ndJointBilateralConstraint*, ndContainersFreeListAlloc<ndJointBilateralConstraint*>>
 	{
@@ -70,16 +49,37 @@ class ndBodyKinematic : public ndBody
 		}
 	};
 
-	class ndContactMap: public ndTree<ndContact*, ndContactkey, ndContainersFreeListAlloc<ndContact*>>
+	// the contacts of a body, in no particular order. each contact knows its 
+	// slot in the map of both bodies, so removing one is a swap with the last.
+	// the scene finds the contact of a pair in its ndContactPairMap.
+	class ndContactMap: public ndArray<ndContact*>
 	{
 		public:
+		class Iterator
+		{
+			public:
+			Iterator(const ndContactMap& map);
+
+			void Begin();
+			operator bool() const;
+			void operator++ (ndInt32);
+			void operator++ ();
+			ndContact* operator* () const;
+
+			private:
+			const ndContactMap& m_map;
+			ndInt32 m_index;
+		};
+
 		D_COLLISION_API ndContact* FindContact(const ndBody* const body0, const ndBody* const body1) const;
+		D_COLLISION_API bool SanityCheck() const;
 
 		private:
 		ndContactMap();
 		~ndContactMap();
 		void AttachContact(ndContact* const contact);
 		void DetachContact(ndContact* const contact);
+		ndInt32& GetSlot(ndContact* const contact) const;
 		friend class ndBodyKinematic;
 	};
 
@@ -104,6 +104,11 @@ class ndBodyKinematic : public ndBody
 
 	bool GetAutoSleep() const;
 	void SetAutoSleep(bool state);
+
+	// fast moving bodies can opt in to speculative contacts, the narrow phase 
+	// then also reports the shapes the body can reach in the next step.
+	bool GetSpeculativeContacts() const;
+	void SetSpeculativeContacts(bool state);
 	ndFloat32 GetMaxLinearStep() const;
 	ndFloat32 GetMaxAngularStep() const;
 	void SetDebugMaxLinearAndAngularIntegrationStep(ndFloat32 angleInRadian, ndFloat32 stepInUnitPerSeconds);
@@ -168,6 +173,7 @@ class ndBodyKinematic : public ndBody
 	protected:
 	D_COLLISION_API virtual void AttachContact(ndContact* const contact);
 	D_COLLISION_API virtual void DetachContact(ndContact* const contact);
+	D_COLLISION_API virtual void Unfreeze();
 
 	D_COLLISION_API virtual void DetachJoint(ndJointList::ndNode* const node);
 	D_COLLISION_API virtual ndJointList::ndNode* AttachJoint(ndJointBilateralConstraint* const joint);
@@ -220,6 +226,10 @@ class ndBodyKinematic : public ndBody
 	ndInt32 m_sceneNodeIndex;
 	ndInt32 m_buildBodyNodeIndex;
 	ndInt32 m_buildSceneNodeIndex;
+	ndUnsigned32 m_freezeMark;
+	ndUnsigned8 m_unfreezeQueued;
+	ndUnsigned8 m_hasFrozenContacts;
+	ndUnsigned8 m_speculativeContacts;
 
 	D_COLLISION_API static ndVector m_velocTol;
 
@@ -231,11 +241,14 @@ class ndBodyKinematic : public ndBody
 	friend class ndDynamicsUpdate;
 	friend class ndWorldSceneSycl;
 	friend class ndWorldSceneCuda;
+	friend class ndBvhFlatTree;
 	friend class ndBvhSceneManager;
 	friend class ndSkeletonContainer;
 	friend class ndModelArticulation;
 	friend class ndDynamicsUpdateSoa;
+	friend class ndDynamicsUpdateGaussSeidel;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 	friend class ndDynamicsUpdateSycl;
 	friend class ndDynamicsUpdateCuda;
 	friend class ndJointBilateralConstraint;
@@ -391,6 +404,37 @@ inline void ndBodyKinematic::PrepareStep(ndInt32 index)
 	m_equilibrium0 = m_equilibrium;
 }
 
+inline ndBodyKinematic::ndContactMap::Iterator::Iterator(const ndContactMap& map)
+	:m_map(map)
+	,m_index(0)
+{
+}
+
+inline void ndBodyKinematic::ndContactMap::Iterator::Begin()
+{
+	m_index = 0;
+}
+
+inline ndBodyKinematic::ndContactMap::Iterator::operator bool() const
+{
+	return m_index < m_map.GetCount();
+}
+
+inline void ndBodyKinematic::ndContactMap::Iterator::operator++ (ndInt32)
+{
+	m_index++;
+}
+
+inline void ndBodyKinematic::ndContactMap::Iterator::operator++ ()
+{
+	m_index++;
+}
+
+inline ndContact* ndBodyKinematic::ndContactMap::Iterator::operator* () const
+{
+	return m_map[m_index];
+}
+
 inline ndBodyKinematic::ndContactMap& ndBodyKinematic::GetContactMap()
 {
 	return m_contactList;
@@ -437,6 +481,16 @@ inline void ndBodyKinematic::SetAutoSleep(bool state)
 	SetSleepState(false);
 }
 
+inline bool ndBodyKinematic::GetSpeculativeContacts() const
+{
+	return m_speculativeContacts ? true : false;
+}
+
+inline void ndBodyKinematic::SetSpeculativeContacts(bool state)
+{
+	m_speculativeContacts = ndUnsigned8(state ? 1 : 0);
+}
+
 inline ndSkeletonContainer* ndBodyKinematic::GetSkeleton() const
 { 
 	return m_skeletonContainer;
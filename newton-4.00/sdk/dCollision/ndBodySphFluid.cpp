@@ -170,14 +170,24 @@ class ndBodySphFluid::ndWorkingBuffers
 		,m_hashGridSize(ndFloat32(0.0f))
 		,m_hashInvGridSize(ndFloat32(0.0f))
 	{
-		for (ndInt32 i = 0; i < D_MAX_THREADS_COUNT; ++i)
+	}
+
+	~ndWorkingBuffers()
+	{
+		for (ndInt32 i = 0; i < m_partialsGridScans.GetCount(); ++i)
 		{
-			m_partialsGridScans[i].Resize(D_SPH_BUFFER_GRANULARITY);
+			delete m_partialsGridScans[i];
 		}
 	}
 
-	~ndWorkingBuffers()
+	void SetThreadCount(ndInt32 threadCount)
 	{
+		// one partial scan per thread of the pool running the update
+		while (m_partialsGridScans.GetCount() < threadCount)
+		{
+			ndArray<ndInt32>* const partialScan = new ndArray<ndInt32>(D_SPH_BUFFER_GRANULARITY);
+			m_partialsGridScans.PushBack(partialScan);
+		}
 	}
 
 	void SetWorldToGridMapping(ndFloat32 gridSize, const ndVector& maxP, const ndVector& minP)
@@ -214,7 +224,7 @@ class ndBodySphFluid::ndWorkingBuffers
 	ndArray<ndGridHash> m_hashGridMap;
 	ndArray<ndGridHash> m_hashGridMapScratchBuffer;
 	ndArray<ndParticleKernelDistance> m_kernelDistance;
-	ndArray<ndInt32> m_partialsGridScans[D_MAX_THREADS_COUNT];
+	ndArray<ndArray<ndInt32>*> m_partialsGridScans;
 	ndFloat32 m_worlToGridOrigin;
 	ndFloat32 m_worlToGridScale;
 	ndFloat32 m_hashGridSize;
@@ -456,7 +466,7 @@ void ndBodySphFluid::CalculateScans(ndThreadPool* const threadPool)
 
 		const ndInt32 start = scans[threadIndex];
 		const ndInt32 end = scans[threadIndex + 1];
-		ndArray<ndInt32>& gridScans = data.m_partialsGridScans[threadIndex];
+		ndArray<ndInt32>& gridScans = *data.m_partialsGridScans[threadIndex];
 		ndUnsigned64 gridHash0 = hashGridMap[start].m_gridHash;
 
 		ndInt32 count = 0;
@@ -479,7 +489,7 @@ void ndBodySphFluid::CalculateScans(ndThreadPool* const threadPool)
 	{
 		D_TRACKTIME_NAMED(CalculateScans);
 		ndArray<ndInt32>& gridScans = data.m_gridScans;
-		const ndArray<ndInt32>& partialScan = data.m_partialsGridScans[threadIndex];
+		const ndArray<ndInt32>& partialScan = *data.m_partialsGridScans[threadIndex];
 		const ndInt32 base = sums[threadIndex];
 		ndInt32 sum = scans[threadIndex];
 		for (ndInt32 i = 0; i < partialScan.GetCount(); ++i)
@@ -491,6 +501,7 @@ void ndBodySphFluid::CalculateScans(ndThreadPool* const threadPool)
 
 	memset(scans, 0, sizeof(scans));
 	const ndInt32 threadCount = threadPool->GetThreadCount();
+	data.SetThreadCount(threadCount);
 	
 	ndInt32 particleCount = data.m_hashGridMap.GetCount();
 
@@ -514,7 +525,7 @@ void ndBodySphFluid::CalculateScans(ndThreadPool* const threadPool)
 	for (ndInt32 i = 0; i < threadCount; ++i)
 	{
 		sums[i] = scansCount;
-		scansCount += data.m_partialsGridScans[i].GetCount();
+		scansCount += data.m_partialsGridScans[i]->GetCount();
 	}
 	sums[threadCount] = scansCount;
 
@@ -1335,14 +1346,24 @@ class ndBodySphFluid::ndWorkingBuffers
 		, m_hashInvGridSize(ndFloat32(0.0f))
 		, m_particleDiameter(ndFloat32(0.0f))
 	{
-		for (ndInt32 i = 0; i < D_MAX_THREADS_COUNT; ++i)
+	}
+
+	~ndWorkingBuffers()
+	{
+		for (ndInt32 i = 0; i < m_partialsGridScans.GetCount(); ++i)
 		{
-			m_partialsGridScans[i].Resize(D_SPH_BUFFER_GRANULARITY);
+			delete m_partialsGridScans[i];
 		}
 	}
 
-	~ndWorkingBuffers()
+	void SetThreadCount(ndInt32 threadCount)
 	{
+		// one partial scan per thread of the pool running the update
+		while (m_partialsGridScans.GetCount() < threadCount)
+		{
+			ndArray<ndInt32>* const partialScan = new ndArray<ndInt32>(D_SPH_BUFFER_GRANULARITY);
+			m_partialsGridScans.PushBack(partialScan);
+		}
 	}
 
 	void SetWorldToGridMapping(ndFloat32 gridSize, const ndVector& maxP, const ndVector& minP)
@@ -1379,7 +1400,7 @@ class ndBodySphFluid::ndWorkingBuffers
 	ndArray<ndGridHash> m_hashGridMap;
 	ndArray<ndGridHash> m_hashGridMapScratchBuffer;
 	ndArray<ndParticleKernelDistance> m_kernelDistance;
-	ndArray<ndInt32> m_partialsGridScans[D_MAX_THREADS_COUNT];
+	ndArray<ndArray<ndInt32>*> m_partialsGridScans;
 	ndFloat32 m_worlToGridOrigin;
 	ndFloat32 m_worlToGridScale;
 	ndFloat32 m_hashGridSize;
@@ -1621,7 +1642,7 @@ void ndBodySphFluid::CalculateScans(ndThreadPool* const threadPool)
 
 		const ndInt32 start = scans[threadIndex];
 		const ndInt32 end = scans[threadIndex + 1];
-		ndArray<ndInt32>& gridScans = data.m_partialsGridScans[threadIndex];
+		ndArray<ndInt32>& gridScans = *data.m_partialsGridScans[threadIndex];
 		ndUnsigned64 gridHash0 = hashGridMap[start].m_gridHash;
 
 		ndInt32 count = 0;
@@ -1644,7 +1665,7 @@ void ndBodySphFluid::CalculateScans(ndThreadPool* const threadPool)
 	{
 		D_TRACKTIME_NAMED(CalculateScans);
 		ndArray<ndInt32>& gridScans = data.m_gridScans;
-		const ndArray<ndInt32>& partialScan = data.m_partialsGridScans[threadIndex];
+		const ndArray<ndInt32>& partialScan = *data.m_partialsGridScans[threadIndex];
 		const ndInt32 base = sums[threadIndex];
 		ndInt32 sum = scans[threadIndex];
 		for (ndInt32 i = 0; i < partialScan.GetCount(); ++i)
@@ -1656,6 +1677,7 @@ void ndBodySphFluid::CalculateScans(ndThreadPool* const threadPool)
 
 	memset(scans, 0, sizeof(scans));
 	const ndInt32 threadCount = threadPool->GetThreadCount();
+	data.SetThreadCount(threadCount);
 
 	ndInt32 particleCount = data.m_hashGridMap.GetCount();
 
@@ -1679,7 +1701,7 @@ void ndBodySphFluid::CalculateScans(ndThreadPool* const threadPool)
 	for (ndInt32 i = 0; i < threadCount; ++i)
 	{
 		sums[i] = scansCount;
-		scansCount += data.m_partialsGridScans[i].GetCount();
+		scansCount += data.m_partialsGridScans[i]->GetCount();
 	}
 	sums[threadCount] = scansCount;
 
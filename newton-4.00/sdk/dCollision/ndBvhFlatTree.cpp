@@ -0,0 +1,286 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndCollisionStdafx.h"
+#include "ndBvhNode.h"
+#include "ndBvhFlatTree.h"
+#include "ndBodyKinematic.h"
+
+#define D_BVH_FLAT_BUILD_STACK	1024
+
+ndBvhFlatRay::ndBvhFlatRay(const ndFastRay& ray)
+{
+	for (ndInt32 i = 0; i < 3; ++i)
+	{
+		m_minOrigin[i] = ndVector(ray.m_p0[i]);
+		m_maxOrigin[i] = m_minOrigin[i];
+		m_invDir[i] = ndVector(ray.m_dpInv[i]);
+		m_isParallel[i] = (ray.m_isParallel.GetSignMask() >> i) & 1;
+	}
+}
+
+ndBvhFlatRay::ndBvhFlatRay(const ndFastRay& ray, const ndVector& boxP0, const ndVector& boxP1)
+{
+	// clipping the ray against a box expanded by the swept box is the
+	// same as clipping it from an origin moved by each side of the swept box.
+	for (ndInt32 i = 0; i < 3; ++i)
+	{
+		m_minOrigin[i] = ndVector(ray.m_p0[i] + boxP1[i]);
+		m_maxOrigin[i] = ndVector(ray.m_p0[i] + boxP0[i]);
+		m_invDir[i] = ndVector(ray.m_dpInv[i]);
+		m_isParallel[i] = (ray.m_isParallel.GetSignMask() >> i) & 1;
+	}
+}
+
+ndBvhFlatTree::ndBvhFlatTree()
+	:m_nodes(256)
+	,m_bodies(256)
+	,m_sources(256)
+	,m_leafOrder(256)
+	,m_leafBase(0)
+	,m_isValid(false)
+{
+}
+
+ndBvhFlatTree::~ndBvhFlatTree()
+{
+}
+
+void ndBvhFlatTree::CleanUp()
+{
+	m_isValid = false;
+	m_nodes.Resize(256);
+	m_bodies.Resize(256);
+	m_sources.Resize(256);
+	m_leafOrder.Resize(256);
+	m_nodes.SetCount(0);
+	m_bodies.SetCount(0);
+	m_sources.SetCount(0);
+	m_leafOrder.SetCount(0);
+}
+
+ndInt32 ndBvhFlatTree::GetLeafOrder(const ndBodyKinematic* const body) const
+{
+	const ndInt32 order = m_leafOrder[body->m_bodyNodeIndex - m_leafBase];
+	ndAssert(m_bodies[order] == body);
+	return order;
+}
+
+void ndBvhFlatTree::Build(const ndBvhNode* const root, ndInt32 leafBase, ndInt32 leafCount)
+{
+	D_TRACKTIME();
+	class ndStackEntry
+	{
+		public:
+		const ndBvhNode* m_node;
+		ndInt32 m_parent;
+		ndInt32 m_slot;
+	};
+
+	auto AddNode = [this]()
+	{
+		ndBvhFlatNode node;
+		for (ndInt32 i = 0; i < 3; ++i)
+		{
+			node.m_minBox[i] = ndVector(ndFloat32(1.0e15f));
+			node.m_maxBox[i] = ndVector(ndFloat32(-1.0e15f));
+		}
+		for (ndInt32 i = 0; i < 4; ++i)
+		{
+			node.m_children[i] = 0;
+			node.m_lastLeaf[i] = -1;
+			m_sources.PushBack(nullptr);
+		}
+		node.m_frozenMask = 0;
+		m_nodes.PushBack(node);
+		return m_nodes.GetCount() - 1;
+	};
+
+	auto CalculateArea = [](const ndBvhNode* const node)
+	{
+		const ndVector size(node->m_maxBox - node->m_minBox);
+		return size.DotProduct(size.ShiftTripleRight()).GetScalar();
+	};
+
+	m_nodes.SetCount(0);
+	m_bodies.SetCount(0);
+	m_sources.SetCount(0);
+	m_leafOrder.SetCount(leafCount);
+	m_leafBase = leafBase;
+	m_isValid = false;
+	if (!root)
+	{
+		return;
+	}
+
+	ndStackEntry stackPool[D_BVH_FLAT_BUILD_STACK];
+	ndInt32 stack = 0;
+	if (root->GetAsSceneBodyNode())
+	{
+		// a lone body still needs a node to hold its box
+		const ndInt32 index = AddNode();
+		m_sources[index * 4] = root;
+		stackPool[0].m_node = root;
+		stackPool[0].m_parent = index;
+		stackPool[0].m_slot = 0;
+		stack = 1;
+	}
+	else
+	{
+		stackPool[0].m_node = root;
+		stackPool[0].m_parent = -1;
+		stackPool[0].m_slot = 0;
+		stack = 1;
+	}
+
+	// depth first, so that leaves under each child are consecutive
+	while (stack)
+	{
+		stack--;
+		const ndStackEntry entry(stackPool[stack]);
+		const ndBvhNode* const node = entry.m_node;
+		if (node->GetAsSceneBodyNode())
+		{
+			ndBodyKinematic* const body = node->GetBody();
+			const ndInt32 order = m_bodies.GetCount();
+			m_bodies.PushBack(body);
+			m_leafOrder[body->m_bodyNodeIndex - leafBase] = order;
+			m_nodes[entry.m_parent].m_children[entry.m_slot] = -(order + 1);
+		}
+		else
+		{
+			const ndInt32 index = AddNode();
+			if (entry.m_parent >= 0)
+			{
+				m_nodes[entry.m_parent].m_children[entry.m_slot] = index;
+			}
+
+			// collapse the two levels below the node, opening the largest child first
+			ndInt32 count = 2;
+			const ndBvhNode* slots[4];
+			slots[0] = node->GetLeft();
+			slots[1] = node->GetRight();
+			while (count < 4)
+			{
+				ndInt32 best = -1;
+				ndFloat32 bestArea = ndFloat32(-1.0f);
+				for (ndInt32 i = 0; i < count; ++i)
+				{
+					if (slots[i]->GetAsSceneTreeNode())
+					{
+						const ndFloat32 area = CalculateArea(slots[i]);
+						if (area > bestArea)
+						{
+							best = i;
+							bestArea = area;
+						}
+					}
+				}
+				if (best < 0)
+				{
+					break;
+				}
+
+				const ndBvhNode* const child = slots[best];
+				for (ndInt32 i = count; i > best + 1; --i)
+				{
+					slots[i] = slots[i - 1];
+				}
+				slots[best] = child->GetLeft();
+				slots[best + 1] = child->GetRight();
+				count++;
+			}
+
+			for (ndInt32 i = count - 1; i >= 0; --i)
+			{
+				m_sources[index * 4 + i] = slots[i];
+				stackPool[stack].m_node = slots[i];
+				stackPool[stack].m_parent = index;
+				stackPool[stack].m_slot = i;
+				stack++;
+				ndAssert(stack < D_BVH_FLAT_BUILD_STACK);
+			}
+		}
+	}
+
+	// nodes are allocated before their children, so a
+	// reverse sweep sees each node after all its children.
+	for (ndInt32 i = m_nodes.GetCount() - 1; i >= 0; --i)
+	{
+		ndBvhFlatNode& node = m_nodes[i];
+		for (ndInt32 j = 0; j < 4; ++j)
+		{
+			const ndBvhNode* const source = m_sources[i * 4 + j];
+			if (source)
+			{
+				const ndInt32 child = node.m_children[j];
+				if (child < 0)
+				{
+					node.m_lastLeaf[j] = -child - 1;
+				}
+				else
+				{
+					const ndBvhFlatNode& childNode = m_nodes[child];
+					node.m_lastLeaf[j] = ndMax(ndMax(childNode.m_lastLeaf[0], childNode.m_lastLeaf[1]), ndMax(childNode.m_lastLeaf[2], childNode.m_lastLeaf[3]));
+				}
+			}
+		}
+	}
+	m_isValid = true;
+}
+
+void ndBvhFlatTree::Update(ndThreadPool& threadPool)
+{
+	D_TRACKTIME();
+	auto CopyBoxes = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CopyBoxes);
+		const ndVector emptyMinBox(ndFloat32(1.0e15f));
+		const ndVector emptyMaxBox(ndFloat32(-1.0e15f));
+		const ndStartEnd startEnd(m_nodes.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndVector minBox[4];
+			ndVector maxBox[4];
+			ndInt32 frozenMask = 0;
+			const ndBvhNode** const sources = &m_sources[i * 4];
+			for (ndInt32 j = 0; j < 4; ++j)
+			{
+				minBox[j] = sources[j] ? sources[j]->m_minBox : emptyMinBox;
+				maxBox[j] = sources[j] ? sources[j]->m_maxBox : emptyMaxBox;
+				if (sources[j])
+				{
+					const ndBvhInternalNode* const internalNode = sources[j]->GetAsSceneTreeNode();
+					const bool frozen = internalNode ? (internalNode->m_frozenLeaves != 0) : (sources[j]->GetBody()->m_isFrozen != 0);
+					frozenMask |= frozen ? (1 << j) : 0;
+				}
+			}
+
+			ndVector unused;
+			ndBvhFlatNode& node = m_nodes[i];
+			node.m_frozenMask = frozenMask;
+			ndVector::Transpose4x4(node.m_minBox[0], node.m_minBox[1], node.m_minBox[2], unused, minBox[0], minBox[1], minBox[2], minBox[3]);
+			ndVector::Transpose4x4(node.m_maxBox[0], node.m_maxBox[1], node.m_maxBox[2], unused, maxBox[0], maxBox[1], maxBox[2], maxBox[3]);
+		}
+	});
+	threadPool.ParallelExecute(CopyBoxes);
+}
@@ -0,0 +1,137 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __ND_BVH_FLAT_TREE_H__
+#define __ND_BVH_FLAT_TREE_H__
+
+#include "ndCollisionStdafx.h"
+
+class ndBvhNode;
+class ndBodyKinematic;
+
+// a ray, or a box swept along a ray, with its data splat in all lanes
+// so that it can be clipped against the four boxes of a flat node at once.
+D_MSV_NEWTON_ALIGN_32
+class ndBvhFlatRay
+{
+	public:
+	ndBvhFlatRay(const ndFastRay& ray);
+	ndBvhFlatRay(const ndFastRay& ray, const ndVector& boxP0, const ndVector& boxP1);
+
+	ndVector m_minOrigin[3];
+	ndVector m_maxOrigin[3];
+	ndVector m_invDir[3];
+	ndInt32 m_isParallel[3];
+} D_GCC_NEWTON_ALIGN_32;
+
+// four children boxes in structure of arrays form.
+// children >= 0 are flat nodes, children < 0 are leaves -(order + 1).
+// unused slots have inverted boxes, so they fail all tests.
+D_MSV_NEWTON_ALIGN_32
+class ndBvhFlatNode
+{
+	public:
+	// bit i is set if child i overlaps the box, given with all components splat
+	ndInt32 OverlapTest(const ndVector* const minBox, const ndVector* const maxBox) const;
+
+	// entry distance of the ray into each child box, 1.2 for the ones it misses
+	ndVector RayDistance(const ndBvhFlatRay& ray) const;
+
+	ndVector m_minBox[3];
+	ndVector m_maxBox[3];
+	ndInt32 m_children[4];
+	// the last leaf, in depth first order, under each child
+	ndInt32 m_lastLeaf[4];
+	// bit i is set if child i has leaves with a frozen body
+	ndInt32 m_frozenMask;
+} D_GCC_NEWTON_ALIGN_32;
+
+// a four wide, index based copy of the scene bvh, for the queries.
+// the topology is rebuilt when the scene tree changes, the boxes 
+// and the frozen masks are copied from the scene tree every step.
+class ndBvhFlatTree
+{
+	public:
+	ndBvhFlatTree();
+	~ndBvhFlatTree();
+
+	void CleanUp();
+	void Invalidate();
+	bool IsValid() const;
+
+	void Build(const ndBvhNode* const root, ndInt32 leafBase, ndInt32 leafCount);
+	void Update(ndThreadPool& threadPool);
+
+	ndInt32 GetLeafOrder(const ndBodyKinematic* const body) const;
+
+	ndArray<ndBvhFlatNode> m_nodes;
+	ndArray<ndBodyKinematic*> m_bodies;
+
+	private:
+	ndArray<const ndBvhNode*> m_sources;
+	ndArray<ndInt32> m_leafOrder;
+	ndInt32 m_leafBase;
+	bool m_isValid;
+};
+
+inline ndInt32 ndBvhFlatNode::OverlapTest(const ndVector* const minBox, const ndVector* const maxBox) const
+{
+	const ndVector test(
+		(m_minBox[0] < maxBox[0]) & (m_maxBox[0] > minBox[0]) &
+		(m_minBox[1] < maxBox[1]) & (m_maxBox[1] > minBox[1]) &
+		(m_minBox[2] < maxBox[2]) & (m_maxBox[2] > minBox[2]));
+	return test.GetSignMask();
+}
+
+inline ndVector ndBvhFlatNode::RayDistance(const ndBvhFlatRay& ray) const
+{
+	ndVector t0(ndVector::m_zero);
+	ndVector t1(ndVector::m_one);
+	ndVector miss(m_minBox[0] > m_maxBox[0]);
+	for (ndInt32 i = 0; i < 3; ++i)
+	{
+		if (ray.m_isParallel[i])
+		{
+			miss = miss | (ray.m_minOrigin[i] <= m_minBox[i]) | (ray.m_maxOrigin[i] >= m_maxBox[i]);
+		}
+		else
+		{
+			const ndVector tt0((m_minBox[i] - ray.m_minOrigin[i]) * ray.m_invDir[i]);
+			const ndVector tt1((m_maxBox[i] - ray.m_maxOrigin[i]) * ray.m_invDir[i]);
+			t0 = t0.GetMax(tt0.GetMin(tt1));
+			t1 = t1.GetMin(tt0.GetMax(tt1));
+		}
+	}
+	const ndVector hit((t0 < t1).AndNot(miss));
+	return ndVector(ndFloat32(1.2f)).Select(t0, hit);
+}
+
+inline bool ndBvhFlatTree::IsValid() const
+{
+	return m_isValid;
+}
+
+inline void ndBvhFlatTree::Invalidate()
+{
+	m_isValid = false;
+}
+
+#endif
@@ -27,6 +27,17 @@
 #define D_AABB_QUANTIZATION		ndFloat32 (4.0f)
 #define D_AABB_INV_QUANTIZATION	(ndFloat32 (1.0f) / D_AABB_QUANTIZATION)
 
+// leaf boxes are padded, bodies that move less than the padding 
+// stay inside their node and are not queried for new pairs.
+#define D_AABB_FAT_SCALE			ndFloat32 (0.125f)
+#define D_AABB_FAT_MAX_PADDING		ndFloat32 (0.25f)
+#define D_AABB_FAT_VELOCITY_STEPS	ndFloat32 (2.0f)
+
+// morton codes use ten bits per axis, trees deeper than 
+// this fall back to the grid build, to keep the query stacks bounded.
+#define D_MORTON_AXIS_CELLS			1024
+#define D_MORTON_MAX_DEPTH			128
+
 ndVector ndBvhNode::m_aabbQuantization(D_AABB_QUANTIZATION, D_AABB_QUANTIZATION, D_AABB_QUANTIZATION, ndFloat32 (0.0f));
 ndVector ndBvhNode::m_aabbInvQuantization(D_AABB_INV_QUANTIZATION, D_AABB_INV_QUANTIZATION, D_AABB_INV_QUANTIZATION, ndFloat32(0.0f));
 
@@ -57,6 +68,24 @@ ndBvhLeafNode::~ndBvhLeafNode()
 {
 }
 
+void ndBvhLeafNode::SetFatAabb(const ndVector& minBox, const ndVector& maxBox, const ndVector& step)
+{
+	const ndVector sizePadding((maxBox - minBox).Scale(D_AABB_FAT_SCALE).GetMin(ndVector(D_AABB_FAT_MAX_PADDING)));
+	const ndVector padding((sizePadding + step.Abs().Scale(D_AABB_FAT_VELOCITY_STEPS)) & ndVector::m_triplexMask);
+	SetAabb(minBox - padding, maxBox + padding);
+}
+
+void ndBvhLeafNode::ShrinkFatAabb(const ndVector& minBox, const ndVector& maxBox)
+{
+	// the node box can only shrink, a box that grows without 
+	// a pair search would miss the pairs of its new overlaps.
+	const ndVector oldMinBox(m_minBox);
+	const ndVector oldMaxBox(m_maxBox);
+	SetFatAabb(minBox, maxBox, ndVector::m_zero);
+	m_minBox = m_minBox.GetMax(oldMinBox);
+	m_maxBox = m_maxBox.GetMin(oldMaxBox);
+}
+
 ndBvhNode* ndBvhLeafNode::Clone() const
 {
 	ndBvhNode* const node = new ndBvhLeafNode(*this);
@@ -67,6 +96,8 @@ ndBvhInternalNode::ndBvhInternalNode()
 	:ndBvhNode(nullptr)
 	,m_left(nullptr)
 	,m_right(nullptr)
+	,m_frozenLeaves(0)
+	,m_awakeLeaves(0)
 {
 #ifdef _DEBUG
 	static ndInt32 nodeId = 1000000;
@@ -79,6 +110,8 @@ ndBvhInternalNode::ndBvhInternalNode(const ndBvhInternalNode& src)
 	:ndBvhNode(src)
 	,m_left(nullptr)
 	,m_right(nullptr)
+	,m_frozenLeaves(src.m_frozenLeaves)
+	,m_awakeLeaves(src.m_awakeLeaves)
 {
 #ifdef _DEBUG
 	m_nodeId = src.m_nodeId;
@@ -188,6 +221,14 @@ ndBvhSceneManager::ndBvhSceneManager()
 	,m_buildArray()
 #endif
 	,m_bvhBuildState()
+	,m_flatTree()
+	,m_cost(ndFloat32(0.0f))
+	,m_buildCost(ndFloat32(0.0f))
+	,m_frozenArea(ndFloat32(0.0f))
+	,m_buildCount(0)
+	,m_rotationCount(0)
+	,m_buildMethod(m_gridCells)
+	,m_flatTreeDirty(true)
 {
 }
 
@@ -197,6 +238,14 @@ ndBvhSceneManager::ndBvhSceneManager(const ndBvhSceneManager& src)
 	,m_buildArray(src.m_buildArray)
 #endif
 	,m_bvhBuildState(src.m_bvhBuildState)
+	,m_flatTree()
+	,m_cost(src.m_cost)
+	,m_buildCost(src.m_buildCost)
+	,m_frozenArea(src.m_frozenArea)
+	,m_buildCount(src.m_buildCount)
+	,m_rotationCount(src.m_rotationCount)
+	,m_buildMethod(src.m_buildMethod)
+	,m_flatTreeDirty(true)
 {
 }
 
@@ -207,6 +256,7 @@ ndBvhSceneManager::~ndBvhSceneManager()
 
 ndBvhNode* ndBvhSceneManager::AddBody(ndBodyKinematic* const body, ndBvhNode* root)
 {
+	m_flatTree.Invalidate();
 	m_workingArray.m_isDirty = 1;
 	ndBvhLeafNode* const bodyNode = new ndBvhLeafNode(body);
 	ndBvhInternalNode* sceneNode = new ndBvhInternalNode();
@@ -312,6 +362,7 @@ void ndBvhSceneManager::RemoveBody(ndBodyKinematic* const body)
 	m_buildArray.m_isDirty = 1;
 	#endif
 
+	m_flatTree.Invalidate();
 	m_workingArray.m_isDirty = 1;
 	ndBvhLeafNode* const bodyNode = (ndBvhLeafNode*)m_workingArray[body->m_bodyNodeIndex];
 	ndBvhInternalNode* const sceneNode = (ndBvhInternalNode*)m_workingArray[body->m_sceneNodeIndex];
@@ -330,6 +381,8 @@ ndBvhLeafNode* ndBvhSceneManager::GetLeafNode(ndBodyKinematic* const body) const
 
 void ndBvhSceneManager::CleanUp()
 {
+	m_flatTree.CleanUp();
+	m_flatTreeDirty = true;
 	m_workingArray.CleanUp();
 #ifdef D_NEW_SCENE	
 	m_buildArray.CleanUp();
@@ -425,6 +478,8 @@ ndBuildBvhTreeBuildState::ndBuildBvhTreeBuildState()
 	,m_cellBuffer1(1024)
 	,m_cellCounts0(1024)
 	,m_cellCounts1(1024)
+	,m_mortonBuffer0(1024)
+	,m_mortonBuffer1(1024)
 	,m_tempNodeBuffer(1024)
 	,m_root(nullptr)
 	,m_srcArray(nullptr)
@@ -463,6 +518,11 @@ void ndBvhSceneManager::UpdateScene(ndThreadPool& threadPool)
 		{
 			ndBvhInternalNode* const node = nodes[i];
 			ndAssert(node && node->GetAsSceneNode());
+			if (!node->m_awakeLeaves)
+			{
+				// frozen leaves do not move
+				continue;
+			}
 
 			const ndVector minBox(node->m_left->m_minBox.GetMin(node->m_right->m_minBox));
 			const ndVector maxBox(node->m_left->m_maxBox.GetMax(node->m_right->m_maxBox));
@@ -483,6 +543,255 @@ void ndBvhSceneManager::UpdateScene(ndThreadPool& threadPool)
 	}
 }
 
+ndInt32 ndBvhSceneManager::RotateScene(ndThreadPool& threadPool)
+{
+	D_TRACKTIME();
+	ndInt32 start = 0;
+	ndInt32 count = 0;
+	ndAtomic<ndInt32> rotations(0);
+	auto RotateSceneBvh = ndMakeObject::ndFunction([this, &start, &count, &rotations](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(RotateSceneBvh);
+		auto CalculateArea = [](const ndBvhNode* const node0, const ndBvhNode* const node1)
+		{
+			const ndVector size(node0->m_maxBox.GetMax(node1->m_maxBox) - node0->m_minBox.GetMin(node1->m_minBox));
+			return size.DotProduct(size.ShiftTripleRight()).GetScalar();
+		};
+
+		ndBvhInternalNode** const nodes = (ndBvhInternalNode**)&m_workingArray[start];
+		const ndStartEnd startEnd(count, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndBvhInternalNode* const node = nodes[i];
+			ndAssert(node && node->GetAsSceneTreeNode());
+			if (!node->m_awakeLeaves)
+			{
+				continue;
+			}
+
+			// swapping a child with a child of its sibling does not change the node box,
+			// only the sibling box, take the swap that shrinks it the most.
+			// nodes in one layer have disjoint sub trees, so they rotate concurrently.
+			ndInt32 bestSide = -1;
+			ndInt32 bestGrandChild = -1;
+			ndFloat32 bestGain = ndFloat32(0.0f);
+			for (ndInt32 side = 0; side < 2; ++side)
+			{
+				const ndBvhNode* const child = side ? node->m_right : node->m_left;
+				const ndBvhInternalNode* const sibling = (side ? node->m_left : node->m_right)->GetAsSceneTreeNode();
+				if (sibling && (child->m_depthLevel < sibling->m_depthLevel))
+				{
+					const ndFloat32 area = CalculateArea(sibling->m_left, sibling->m_right);
+					const ndFloat32 gain0 = area - CalculateArea(child, sibling->m_right);
+					const ndFloat32 gain1 = area - CalculateArea(sibling->m_left, child);
+					if (gain0 > bestGain)
+					{
+						bestSide = side;
+						bestGrandChild = 0;
+						bestGain = gain0;
+					}
+					if (gain1 > bestGain)
+					{
+						bestSide = side;
+						bestGrandChild = 1;
+						bestGain = gain1;
+					}
+				}
+			}
+
+			if (bestSide >= 0)
+			{
+				ndBvhNode*& childLink = bestSide ? node->m_right : node->m_left;
+				ndBvhInternalNode* const sibling = (bestSide ? node->m_left : node->m_right)->GetAsSceneTreeNode();
+				ndBvhNode*& grandChildLink = bestGrandChild ? sibling->m_right : sibling->m_left;
+
+				ndBvhNode* const child = childLink;
+				ndBvhNode* const grandChild = grandChildLink;
+				childLink = grandChild;
+				grandChildLink = child;
+				grandChild->m_parent = node;
+				child->m_parent = sibling;
+
+				sibling->m_minBox = sibling->m_left->m_minBox.GetMin(sibling->m_right->m_minBox);
+				sibling->m_maxBox = sibling->m_left->m_maxBox.GetMax(sibling->m_right->m_maxBox);
+				sibling->m_depthLevel = ndMax(sibling->m_left->m_depthLevel, sibling->m_right->m_depthLevel) + 1;
+				node->m_depthLevel = ndMax(node->m_left->m_depthLevel, node->m_right->m_depthLevel) + 1;
+				rotations.fetch_add(1);
+			}
+
+			node->m_minBox = node->m_left->m_minBox.GetMin(node->m_right->m_minBox);
+			node->m_maxBox = node->m_left->m_maxBox.GetMax(node->m_right->m_maxBox);
+		}
+	});
+
+	// layers are sorted from the leaves up, so that the children 
+	// of a node are refitted and rotated before the node is.
+	const ndBvhNodeArray& array = m_workingArray;
+	for (ndInt32 i = 0; i < ndInt32(array.m_scansCount); ++i)
+	{
+		start = ndInt32(array.m_scans[i]);
+		count = ndInt32(array.m_scans[i + 1] - start);
+		threadPool.ParallelExecute(RotateSceneBvh);
+	}
+
+	const ndInt32 rotationCount = rotations.load();
+	if (rotationCount)
+	{
+		// rotated nodes may now sit in a lower layer, sort the layers again
+		// so that the next refit still sees children before their parents.
+		ndAssert(m_bvhBuildState.m_tempNodeBuffer.GetCount() >= m_workingArray.GetCount() / 2);
+		BuildBvhTreeSetNodesDepth(threadPool);
+		CountFrozenLeaves(threadPool);
+		m_rotationCount += ndUnsigned32(rotationCount);
+		m_flatTreeDirty = true;
+	}
+	return rotationCount;
+}
+
+void ndBvhSceneManager::UpdateFlatTree(ndThreadPool& threadPool, const ndBvhNode* const root)
+{
+	D_TRACKTIME();
+	if (m_flatTreeDirty || !m_flatTree.IsValid())
+	{
+		const ndInt32 leafCount = m_workingArray.GetCount() / 2;
+		m_flatTree.Build(root, leafCount, leafCount);
+		m_flatTreeDirty = false;
+	}
+	m_flatTree.Update(threadPool);
+}
+
+ndFloat32 ndBvhSceneManager::CalculateCost(ndThreadPool& threadPool, const ndBvhNode* const root)
+{
+	D_TRACKTIME();
+	m_cost = ndFloat32(0.0f);
+	if (root && root->GetAsSceneTreeNode())
+	{
+		ndAssert(!m_workingArray.m_isDirty);
+		ndFloat32 areas[D_MAX_THREADS_COUNT];
+		auto CalculateNodesArea = ndMakeObject::ndFunction([this, root, &areas](ndInt32 threadIndex, ndInt32 threadCount)
+		{
+			D_TRACKTIME_NAMED(CalculateNodesArea);
+			ndFloat32 area = ndFloat32(0.0f);
+			const ndBvhNodeArray& nodeArray = m_workingArray;
+			const ndStartEnd startEnd(nodeArray.GetCount() / 2, threadIndex, threadCount);
+			for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+			{
+				// one internal node is always spare, it has no parent. 
+				// the nodes with only frozen leaves are in m_frozenArea.
+				const ndBvhInternalNode* const node = nodeArray[i]->GetAsSceneTreeNode();
+				ndAssert(node);
+				if ((node->m_parent || (node == root)) && node->m_awakeLeaves)
+				{
+					const ndVector size(node->m_maxBox - node->m_minBox);
+					area += size.DotProduct(size.ShiftTripleRight()).GetScalar();
+				}
+			}
+			areas[threadIndex] = area;
+		});
+		threadPool.ParallelExecute(CalculateNodesArea);
+
+		ndFloat32 area = m_frozenArea;
+		for (ndInt32 i = threadPool.GetThreadCount() - 1; i >= 0; --i)
+		{
+			area += areas[i];
+		}
+		const ndVector size(root->m_maxBox - root->m_minBox);
+		const ndFloat32 rootArea = size.DotProduct(size.ShiftTripleRight()).GetScalar();
+		m_cost = area / ndMax(rootArea, ndFloat32(1.0e-6f));
+	}
+	return m_cost;
+}
+
+void ndBvhSceneManager::CountFrozenLeaves(ndThreadPool& threadPool)
+{
+	D_TRACKTIME();
+	ndInt32 start = 0;
+	ndInt32 count = 0;
+	ndFloat32 areas[D_MAX_THREADS_COUNT];
+	for (ndInt32 i = 0; i < D_MAX_THREADS_COUNT; ++i)
+	{
+		areas[i] = ndFloat32(0.0f);
+	}
+
+	auto CountLeaves = ndMakeObject::ndFunction([this, &start, &count, &areas](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CountFrozenLeaves);
+		ndFloat32 area = ndFloat32(0.0f);
+		ndBvhInternalNode** const nodes = (ndBvhInternalNode**)&m_workingArray[start];
+		const ndStartEnd startEnd(count, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndBvhInternalNode* const node = nodes[i];
+			ndAssert(node && node->GetAsSceneTreeNode());
+			node->m_frozenLeaves = 0;
+			node->m_awakeLeaves = 0;
+			const ndBvhNode* const children[] = { node->m_left, node->m_right };
+			for (ndInt32 j = 0; j < 2; ++j)
+			{
+				const ndBvhInternalNode* const child = children[j]->GetAsSceneTreeNode();
+				if (child)
+				{
+					node->m_frozenLeaves += child->m_frozenLeaves;
+					node->m_awakeLeaves += child->m_awakeLeaves;
+				}
+				else
+				{
+					const ndInt32 frozen = children[j]->GetBody()->m_isFrozen ? 1 : 0;
+					node->m_frozenLeaves += frozen;
+					node->m_awakeLeaves += 1 - frozen;
+				}
+			}
+			if (!node->m_awakeLeaves)
+			{
+				const ndVector size(node->m_maxBox - node->m_minBox);
+				area += size.DotProduct(size.ShiftTripleRight()).GetScalar();
+			}
+		}
+		areas[threadIndex] += area;
+	});
+
+	// layers are sorted from the leaves up
+	const ndBvhNodeArray& array = m_workingArray;
+	for (ndInt32 i = 0; i < ndInt32(array.m_scansCount); ++i)
+	{
+		start = ndInt32(array.m_scans[i]);
+		count = ndInt32(array.m_scans[i + 1] - start);
+		threadPool.ParallelExecute(CountLeaves);
+	}
+
+	m_frozenArea = ndFloat32(0.0f);
+	for (ndInt32 i = threadPool.GetThreadCount() - 1; i >= 0; --i)
+	{
+		m_frozenArea += areas[i];
+	}
+}
+
+void ndBvhSceneManager::SetFrozen(ndBodyKinematic* const body, bool frozen)
+{
+	if (m_workingArray.m_isDirty)
+	{
+		// the tree is built again before the next update, and counts the leaves
+		return;
+	}
+
+	const ndInt32 delta = frozen ? 1 : -1;
+	const ndBvhNode* const leafNode = GetLeafNode(body);
+	for (ndBvhInternalNode* node = (ndBvhInternalNode*)leafNode->m_parent; node; node = (ndBvhInternalNode*)node->m_parent)
+	{
+		ndAssert(node->GetAsSceneTreeNode());
+		const bool wasFrozen = !node->m_awakeLeaves;
+		node->m_frozenLeaves += delta;
+		node->m_awakeLeaves -= delta;
+		ndAssert((node->m_frozenLeaves >= 0) && (node->m_awakeLeaves >= 0));
+		if (wasFrozen != !node->m_awakeLeaves)
+		{
+			const ndVector size(node->m_maxBox - node->m_minBox);
+			const ndFloat32 area = size.DotProduct(size.ShiftTripleRight()).GetScalar();
+			m_frozenArea += frozen ? area : -area;
+		}
+	}
+}
+
 bool ndBvhSceneManager::BuildBvhTreeInitNodes(ndThreadPool& threadPool)
 {
 	D_TRACKTIME();
@@ -511,7 +820,14 @@ bool ndBvhSceneManager::BuildBvhTreeInitNodes(ndThreadPool& threadPool)
 			node->m_bhvLinked = 0;
 			node->m_depthLevel = 0;
 			node->m_parent = nullptr;
-			node->SetAabb(body->m_minAabb, body->m_maxAabb);
+			if (ndBoxInclusionTest(body->m_minAabb, body->m_maxAabb, node->m_minBox, node->m_maxBox))
+			{
+				node->ShrinkFatAabb(body->m_minAabb, body->m_maxAabb);
+			}
+			else
+			{
+				node->SetAabb(body->m_minAabb, body->m_maxAabb);
+			}
 			srcArray[i] = node;
 		}
 	});
@@ -1565,6 +1881,209 @@ ndBvhNode* ndBvhSceneManager::BuildIncrementalBvhTree(ndThreadPool& threadPool)
 	return root;
 }
 
+bool ndBvhSceneManager::BuildMortonBvhTree(ndThreadPool& threadPool)
+{
+	D_TRACKTIME();
+	class ndMortonDigitKey
+	{
+		public:
+		ndMortonDigitKey(const void* const context)
+			:m_shift(*((ndUnsigned32*)context))
+		{
+		}
+
+		ndInt32 GetKey(const ndMortonCell& cell) const
+		{
+			return ndInt32((cell.m_code >> m_shift) & 0xff);
+		}
+
+		ndUnsigned32 m_shift;
+	};
+
+	// length of the common prefix of two keys, equal codes 
+	// are told apart by their position in the sorted array
+	auto CommonPrefix = [](const ndMortonCell* const cells, ndInt32 count, ndInt32 i, ndInt32 j)
+	{
+		if ((j < 0) || (j >= count))
+		{
+			return ndInt32(-1);
+		}
+		const ndUnsigned64 key0 = (ndUnsigned64(cells[i].m_code) << 32) | ndUnsigned64(i);
+		const ndUnsigned64 key1 = (ndUnsigned64(cells[j].m_code) << 32) | ndUnsigned64(j);
+		ndUnsigned64 bits = key0 ^ key1;
+		ndAssert(bits);
+		ndInt32 zeros = 0;
+		for (ndInt32 shift = 32; shift; shift >>= 1)
+		{
+			if (!(bits >> (64 - shift)))
+			{
+				zeros += shift;
+				bits = bits << shift;
+			}
+		}
+		return zeros;
+	};
+
+	const ndInt32 leafCount = m_bvhBuildState.m_leafNodesCount;
+	if (leafCount < 2)
+	{
+		return false;
+	}
+
+	ndVector boxes[D_MAX_THREADS_COUNT][2];
+	auto CalculateCentroidBox = ndMakeObject::ndFunction([this, &boxes](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CalculateCentroidBox);
+		ndVector minP(ndFloat32(1.0e15f));
+		ndVector maxP(ndFloat32(-1.0e15f));
+		ndBvhNode** const srcArray = m_bvhBuildState.m_srcArray;
+		const ndStartEnd startEnd(m_bvhBuildState.m_leafNodesCount, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			const ndBvhNode* const node = srcArray[i];
+			const ndVector p(ndVector::m_half * (node->m_minBox + node->m_maxBox));
+			minP = minP.GetMin(p);
+			maxP = maxP.GetMax(p);
+		}
+		boxes[threadIndex][0] = minP;
+		boxes[threadIndex][1] = maxP;
+	});
+	threadPool.ParallelExecute(CalculateCentroidBox);
+
+	ndVector minP(ndFloat32(1.0e15f));
+	ndVector maxP(ndFloat32(-1.0e15f));
+	for (ndInt32 i = threadPool.GetThreadCount() - 1; i >= 0; --i)
+	{
+		minP = minP.GetMin(boxes[i][0]);
+		maxP = maxP.GetMax(boxes[i][1]);
+	}
+	const ndVector size(maxP - minP);
+	const ndFloat32 cells = ndFloat32(D_MORTON_AXIS_CELLS - 1);
+	const ndVector scale(
+		cells / ndMax(size.m_x, ndFloat32(1.0e-3f)),
+		cells / ndMax(size.m_y, ndFloat32(1.0e-3f)),
+		cells / ndMax(size.m_z, ndFloat32(1.0e-3f)), ndFloat32(0.0f));
+
+	m_bvhBuildState.m_mortonBuffer0.SetCount(leafCount);
+	m_bvhBuildState.m_mortonBuffer1.SetCount(leafCount);
+	auto CalculateMortonCodes = ndMakeObject::ndFunction([this, &minP, &scale](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CalculateMortonCodes);
+		auto SpreadBits = [](ndUnsigned32 x)
+		{
+			x = (x | (x << 16)) & 0x030000ff;
+			x = (x | (x << 8)) & 0x0300f00f;
+			x = (x | (x << 4)) & 0x030c30c3;
+			x = (x | (x << 2)) & 0x09249249;
+			return x;
+		};
+
+		const ndVector maxCell(ndFloat32(D_MORTON_AXIS_CELLS - 1));
+		ndBvhNode** const srcArray = m_bvhBuildState.m_srcArray;
+		ndMortonCell* const cells = &m_bvhBuildState.m_mortonBuffer0[0];
+		const ndStartEnd startEnd(m_bvhBuildState.m_leafNodesCount, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndBvhNode* const node = srcArray[i];
+			const ndVector p(ndVector::m_half * (node->m_minBox + node->m_maxBox));
+			const ndVector cell((scale * (p - minP)).GetMax(ndVector::m_zero).GetMin(maxCell).GetInt());
+			cells[i].m_node = node;
+			cells[i].m_code = (SpreadBits(ndUnsigned32(cell.m_ix)) << 2) | (SpreadBits(ndUnsigned32(cell.m_iy)) << 1) | SpreadBits(ndUnsigned32(cell.m_iz));
+		}
+	});
+	threadPool.ParallelExecute(CalculateMortonCodes);
+
+	for (ndUnsigned32 shift = 0; shift < 32; shift += 8)
+	{
+		ndCountingSortInPlace<ndMortonCell, ndMortonDigitKey, 8>(threadPool, &m_bvhBuildState.m_mortonBuffer0[0], &m_bvhBuildState.m_mortonBuffer1[0], leafCount, nullptr, &shift);
+	}
+
+	// Karras, each internal node finds its key range and split independently
+	auto BuildRadixTree = ndMakeObject::ndFunction([this, &CommonPrefix](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(BuildRadixTree);
+		const ndInt32 count = m_bvhBuildState.m_leafNodesCount;
+		const ndMortonCell* const cells = &m_bvhBuildState.m_mortonBuffer0[0];
+		ndBvhNode** const parentsArray = m_bvhBuildState.m_parentsArray;
+
+		const ndStartEnd startEnd(count - 1, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			const ndInt32 direction = (CommonPrefix(cells, count, i, i + 1) > CommonPrefix(cells, count, i, i - 1)) ? 1 : -1;
+			const ndInt32 minPrefix = CommonPrefix(cells, count, i, i - direction);
+
+			ndInt32 maxLength = 2;
+			while (CommonPrefix(cells, count, i, i + maxLength * direction) > minPrefix)
+			{
+				maxLength *= 2;
+			}
+
+			ndInt32 length = 0;
+			for (ndInt32 step = maxLength / 2; step; step /= 2)
+			{
+				if (CommonPrefix(cells, count, i, i + (length + step) * direction) > minPrefix)
+				{
+					length += step;
+				}
+			}
+			const ndInt32 j = i + length * direction;
+			const ndInt32 nodePrefix = CommonPrefix(cells, count, i, j);
+
+			ndInt32 split = 0;
+			ndInt32 step = length;
+			do
+			{
+				step = (step + 1) >> 1;
+				if (CommonPrefix(cells, count, i, i + (split + step) * direction) > nodePrefix)
+				{
+					split += step;
+				}
+			} while (step > 1);
+			const ndInt32 gamma = i + split * direction + ndMin(direction, 0);
+
+			ndBvhInternalNode* const node = parentsArray[i]->GetAsSceneTreeNode();
+			ndAssert(node);
+			node->m_left = (ndMin(i, j) == gamma) ? cells[gamma].m_node : parentsArray[gamma];
+			node->m_right = (ndMax(i, j) == (gamma + 1)) ? cells[gamma + 1].m_node : parentsArray[gamma + 1];
+			node->m_left->m_parent = node;
+			node->m_right->m_parent = node;
+			node->m_bhvLinked = 0;
+		}
+	});
+	threadPool.ParallelExecute(BuildRadixTree);
+
+	// the second child to reach a node fits its box and sets its depth
+	auto CalculateNodesBoxes = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CalculateNodesBoxes);
+		ndBvhNode** const srcArray = m_bvhBuildState.m_srcArray;
+		const ndStartEnd startEnd(m_bvhBuildState.m_leafNodesCount, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			for (ndBvhInternalNode* node = (ndBvhInternalNode*)srcArray[i]->m_parent; node; node = (ndBvhInternalNode*)node->m_parent)
+			{
+				ndAssert(node->GetAsSceneTreeNode());
+				{
+					ndScopeSpinLock lock(node->m_lock);
+					node->m_bhvLinked++;
+					if (node->m_bhvLinked == 1)
+					{
+						break;
+					}
+				}
+				node->m_minBox = node->m_left->m_minBox.GetMin(node->m_right->m_minBox);
+				node->m_maxBox = node->m_left->m_maxBox.GetMax(node->m_right->m_maxBox);
+				node->m_depthLevel = ndMax(node->m_left->m_depthLevel, node->m_right->m_depthLevel) + 1;
+			}
+		}
+	});
+	threadPool.ParallelExecute(CalculateNodesBoxes);
+
+	m_bvhBuildState.m_root = m_bvhBuildState.m_parentsArray[0];
+	ndAssert(!m_bvhBuildState.m_root->m_parent);
+	return m_bvhBuildState.m_root->m_depthLevel < D_MORTON_MAX_DEPTH;
+}
+
 //void ndBvhSceneManager::BuildBvhTreeSwapBuffers(ndThreadPool& threadPool)
 void ndBvhSceneManager::BuildBvhTreeSwapBuffers(ndThreadPool& )
 {
@@ -1607,18 +2126,35 @@ ndBvhNode* ndBvhSceneManager::BuildBvhTree(ndThreadPool& threadPool)
 		return nullptr;
 	}
 
-	BuildBvhTreeCalculateLeafBoxes(threadPool);
-	while (m_bvhBuildState.m_leafNodesCount > 1)
+	bool mortonTree = false;
+	if (m_buildMethod == m_mortonCodes)
 	{
-		m_bvhBuildState.m_size = m_bvhBuildState.m_size * ndVector::m_two;
-		BuildBvhGenerateLayerGrids(threadPool);
+		mortonTree = BuildMortonBvhTree(threadPool);
+		if (!mortonTree)
+		{
+			// too few leaves or a degenerated tree, start over with the grid build
+			BuildBvhTreeInitNodes(threadPool);
+		}
 	}
 
-	m_bvhBuildState.m_root = m_bvhBuildState.m_srcArray[0];
+	if (!mortonTree)
+	{
+		BuildBvhTreeCalculateLeafBoxes(threadPool);
+		while (m_bvhBuildState.m_leafNodesCount > 1)
+		{
+			m_bvhBuildState.m_size = m_bvhBuildState.m_size * ndVector::m_two;
+			BuildBvhGenerateLayerGrids(threadPool);
+		}
+		m_bvhBuildState.m_root = m_bvhBuildState.m_srcArray[0];
+	}
 
 	BuildBvhTreeSetNodesDepth(threadPool);
 	ndAssert(m_bvhBuildState.m_root->SanityCheck(0));
 
 	BuildBvhTreeSwapBuffers(threadPool);
+	CountFrozenLeaves(threadPool);
+	m_buildCount++;
+	m_flatTreeDirty = true;
+	m_buildCost = CalculateCost(threadPool, m_bvhBuildState.m_root);
 	return m_bvhBuildState.m_root;
 }
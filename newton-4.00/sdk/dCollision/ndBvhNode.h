@@ -23,6 +23,7 @@
 #define __ND_SCENE_NODE_H__
 
 #include "ndCollisionStdafx.h"
+#include "ndBvhFlatTree.h"
 
 //#define D_NEW_SCENE
 
@@ -87,6 +88,10 @@ class ndBvhInternalNode: public ndBvhNode
 
 	ndBvhNode* m_left;
 	ndBvhNode* m_right;
+	// leaves under the node with a frozen body and with an awake one, 
+	// the boxes of the nodes without awake leaves do not change.
+	ndInt32 m_frozenLeaves;
+	ndInt32 m_awakeLeaves;
 } D_GCC_NEWTON_ALIGN_32;
 
 class ndBvhLeafNode : public ndBvhNode
@@ -100,6 +105,9 @@ class ndBvhLeafNode : public ndBvhNode
 	virtual ndBodyKinematic* GetBody() const;
 	virtual ndBvhLeafNode* GetAsSceneBodyNode() const;
 
+	void SetFatAabb(const ndVector& minBox, const ndVector& maxBox, const ndVector& step);
+	void ShrinkFatAabb(const ndVector& minBox, const ndVector& maxBox);
+
 	ndBodyKinematic* m_body;
 };
 
@@ -112,6 +120,13 @@ class ndBottomUpCell
 	ndBvhNode* m_node;
 };
 
+class ndMortonCell
+{
+	public:
+	ndUnsigned32 m_code;
+	ndBvhNode* m_node;
+};
+
 class ndCellScanPrefix
 {
 	public:
@@ -141,6 +156,8 @@ class ndBuildBvhTreeBuildState
 	ndArray<ndBottomUpCell> m_cellBuffer1;
 	ndArray<ndCellScanPrefix> m_cellCounts0;
 	ndArray<ndCellScanPrefix> m_cellCounts1;
+	ndArray<ndMortonCell> m_mortonBuffer0;
+	ndArray<ndMortonCell> m_mortonBuffer1;
 	ndArray<ndBvhNode*> m_tempNodeBuffer;
 
 	ndBvhNode* m_root;
@@ -171,6 +188,14 @@ class ndBvhNodeArray : public ndArray<ndBvhNode*>
 class ndBvhSceneManager
 {
 	public:
+	enum ndBuildMethod
+	{
+		// bottom up clustering of leaves that share cells of a growing grid
+		m_gridCells,
+		// linear bvh, a radix tree over the sorted morton codes of the leaves
+		m_mortonCodes,
+	};
+
 	ndBvhSceneManager();
 	ndBvhSceneManager(const ndBvhSceneManager& src);
 	~ndBvhSceneManager();
@@ -180,8 +205,29 @@ class ndBvhSceneManager
 	void RemoveBody(ndBodyKinematic* const body);
 
 	void UpdateScene(ndThreadPool& threadPool);
+	ndInt32 RotateScene(ndThreadPool& threadPool);
 	ndBvhNode* BuildBvhTree(ndThreadPool& threadPool);
 
+	// surface area heuristic cost of the tree, the sum of the areas 
+	// of all internal nodes divided by the area of the root.
+	ndFloat32 CalculateCost(ndThreadPool& threadPool, const ndBvhNode* const root);
+	ndFloat32 GetCost() const;
+	ndFloat32 GetBuildCost() const;
+
+	// updates the frozen leaf counts of the nodes above the body, 
+	// the scene calls it when it freezes or wakes the body up.
+	void SetFrozen(ndBodyKinematic* const body, bool frozen);
+
+	// number of tree builds and of node rotations since the manager was created
+	ndUnsigned32 GetBuildCount() const;
+	ndUnsigned32 GetRotationCount() const;
+
+	ndBuildMethod GetBuildMethod() const;
+	void SetBuildMethod(ndBuildMethod method);
+
+	const ndBvhFlatTree& GetFlatTree() const;
+	void UpdateFlatTree(ndThreadPool& threadPool, const ndBvhNode* const root);
+
 	ndBvhNodeArray& GetNodeArray();
 	ndBvhLeafNode* GetLeafNode(ndBodyKinematic* const body) const;
 
@@ -194,8 +240,10 @@ class ndBvhSceneManager
 	
 	ndBvhNode* BuildIncrementalBvhTree(ndThreadPool& threadPool);
 	ndInt32 BuildSmallBvhTree(ndThreadPool& threadPool, ndBvhNode** const parentsArray, ndInt32 bashCount);
+	bool BuildMortonBvhTree(ndThreadPool& threadPool);
 
 	void BuildBvhTreeSwapBuffers(ndThreadPool& threadPool);
+	void CountFrozenLeaves(ndThreadPool& threadPool);
 
 	ndBvhNodeArray m_workingArray;
 #ifdef D_NEW_SCENE
@@ -203,6 +251,14 @@ class ndBvhSceneManager
 #endif
 
 	ndBuildBvhTreeBuildState m_bvhBuildState;
+	ndBvhFlatTree m_flatTree;
+	ndFloat32 m_cost;
+	ndFloat32 m_buildCost;
+	ndFloat32 m_frozenArea;
+	ndUnsigned32 m_buildCount;
+	ndUnsigned32 m_rotationCount;
+	ndBuildMethod m_buildMethod;
+	bool m_flatTreeDirty;
 };
 
 
@@ -351,4 +407,39 @@ inline ndBvhNodeArray& ndBvhSceneManager::GetNodeArray()
 	return m_workingArray;
 }
 
+inline ndFloat32 ndBvhSceneManager::GetCost() const
+{
+	return m_cost;
+}
+
+inline ndFloat32 ndBvhSceneManager::GetBuildCost() const
+{
+	return m_buildCost;
+}
+
+inline ndUnsigned32 ndBvhSceneManager::GetBuildCount() const
+{
+	return m_buildCount;
+}
+
+inline ndUnsigned32 ndBvhSceneManager::GetRotationCount() const
+{
+	return m_rotationCount;
+}
+
+inline ndBvhSceneManager::ndBuildMethod ndBvhSceneManager::GetBuildMethod() const
+{
+	return m_buildMethod;
+}
+
+inline void ndBvhSceneManager::SetBuildMethod(ndBuildMethod method)
+{
+	m_buildMethod = method;
+}
+
+inline const ndBvhFlatTree& ndBvhSceneManager::GetFlatTree() const
+{
+	return m_flatTree;
+}
+
 #endif
@@ -34,6 +34,7 @@
 #include <ndScene.h>
 #include <ndShape.h>
 #include <ndBvhNode.h>
+#include <ndBvhFlatTree.h>
 #include <ndContact.h>
 #include <ndShapeBox.h>
 #include <ndShapeNull.h>
@@ -46,6 +47,7 @@
 #include <ndShapeConvex.h>
 #include <ndBodyListView.h>
 #include <ndContactArray.h>
+#include <ndContactPairMap.h>
 #include <ndBodySphFluid.h>
 #include "ndBodySphFluid_New.h"
 #include <ndShapeCapsule.h>
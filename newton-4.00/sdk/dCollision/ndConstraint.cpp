@@ -80,6 +80,7 @@ ndConstraint::ndConstraint()
 	,m_fence1(0)
 	,m_resting(0)
 	,m_isInSkeletonLoop(0)
+	,m_isInDirectIsland(0)
 {
 }
 
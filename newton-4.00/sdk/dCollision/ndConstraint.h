@@ -246,13 +246,16 @@ class ndConstraint: public ndContainersFreeListAlloc<ndConstraint>
 	ndUnsigned8 m_fence1;
 	ndUnsigned8 m_resting;   // this should be identical to m_fence0, should be removed. 
 	ndUnsigned8 m_isInSkeletonLoop;
+	ndUnsigned8 m_isInDirectIsland;
 
 	friend class ndIkSolver;
 	friend class ndBodyKinematic;
 	friend class ndDynamicsUpdate;
 	friend class ndSkeletonContainer;
 	friend class ndDynamicsUpdateSoa;
+	friend class ndDynamicsUpdateGaussSeidel;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 } D_GCC_NEWTON_ALIGN_32 ;
 
 inline ndConstraint::~ndConstraint()
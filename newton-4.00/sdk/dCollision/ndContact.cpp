@@ -33,6 +33,58 @@ ndVector ndContact::m_initialSeparatingVector(ndFloat32(0.0f), ndFloat32(1.0f),
 #define D_MAX_PENETRATION_STIFFNESS		ndFloat32 (50.0f)
 #define D_DIAGONAL_REGULARIZER			ndFloat32 (1.0e-3f)
 
+ndContactPointList::ndContactPointList()
+	:ndClassAlloc()
+	,m_nodes(nullptr)
+	,m_count(0)
+	,m_capacity(0)
+{
+}
+
+ndContactPointList::~ndContactPointList()
+{
+	if (m_nodes)
+	{
+		ndMemory::Free(m_nodes);
+	}
+}
+
+void ndContactPointList::SetCount(ndInt32 count)
+{
+	ndAssert(count >= 0);
+	ndAssert(count <= D_MAX_CONTACT_POINTS);
+	if (count > m_capacity)
+	{
+		// most pairs have four or fewer points
+		const ndInt32 capacity = ndMin(ndMax(count, ndMax(m_capacity * 2, 4)), ndInt32(D_MAX_CONTACT_POINTS));
+		ndNode* const nodes = (ndNode*)ndMemory::Malloc(size_t(sizeof(ndNode) * capacity));
+		for (ndInt32 i = 0; i < m_count; ++i)
+		{
+			nodes[i].m_info = m_nodes[i].m_info;
+		}
+		if (m_nodes)
+		{
+			ndMemory::Free(m_nodes);
+		}
+		m_nodes = nodes;
+		m_capacity = capacity;
+	}
+
+	for (ndInt32 i = m_count; i < count; ++i)
+	{
+		m_nodes[i].m_info = ndContactMaterial();
+	}
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		m_nodes[i].m_next = &m_nodes[i + 1];
+	}
+	if (count)
+	{
+		m_nodes[count - 1].m_next = nullptr;
+	}
+	m_count = count;
+}
+
 ndContact::ndContact()
 	:ndConstraint()
 	,m_positAcc(ndFloat32(10.0f))
@@ -43,12 +95,15 @@ ndContact::ndContact()
 	,m_timeOfImpact(ndFloat32(1.0e10f))
 	,m_separationDistance(ndFloat32(0.0f))
 	,m_sceneLru(0)
+	,m_contactMapSlot0(-1)
+	,m_contactMapSlot1(-1)
 	,m_isDead(0)
 	,m_inTrigger(0)
 	,m_isAttached(0)
 	,m_isIntersetionTestOnly(0)
 	//,m_skeletonIntraCollision(1)
 	,m_skeletonSelftCollision(1)
+	,m_isFrozen(0)
 {
 	m_active = 0;
 }
@@ -89,13 +144,12 @@ void ndContact::JacobianDerivative(ndConstraintDescritor& desc)
 	ndInt32 frictionIndex = 0;
 	if (m_maxDof) 
 	{
-		ndInt32 i = 0;
-		frictionIndex = m_contacPointsList.GetCount();
-		for (ndContactPointList::ndNode* node = m_contacPointsList.GetFirst(); node; node = node->GetNext())
+		const ndInt32 count = m_contacPointsList.GetCount();
+		frictionIndex = count;
+		for (ndInt32 i = 0; i < count; ++i)
 		{
-			const ndContactMaterial& contact = node->GetInfo();
+			const ndContactMaterial& contact = m_contacPointsList[i];
 			JacobianContactDerivative(desc, contact, i, frictionIndex);
-			i++;
 		}
 	}
 	desc.m_rowsCount = frictionIndex;
@@ -148,17 +202,31 @@ void ndContact::JacobianContactDerivative(ndConstraintDescritor& desc, const ndC
 	desc.m_forceBounds[normalIndex].m_normalIndex = D_INDEPENDENT_ROW;
 	desc.m_forceBounds[normalIndex].m_jointForce = (ndForceImpactPair*)&contact.m_normal_Force;
 
-	const ndFloat32 restitutionVelocity = (relSpeed > D_REST_RELATIVE_VELOCITY) ? relSpeed * restitutionCoefficient : ndFloat32(0.0f);
-	const ndFloat32 penetrationStiffness = D_MAX_PENETRATION_STIFFNESS * contact.m_material.m_softness;
-	const ndFloat32 penetrationVeloc = penetration * penetrationStiffness;
-	ndAssert(ndAbs(penetrationVeloc - D_MAX_PENETRATION_STIFFNESS * contact.m_material.m_softness * penetration) < ndFloat32(1.0e-6f));
-	desc.m_penetrationStiffness[normalIndex] = penetrationStiffness;
-	relSpeed += ndMax(restitutionVelocity, penetrationVeloc);
-
 	const bool isHardContact = !(contact.m_material.m_flags & m_isSoftContact);
 	desc.m_diagonalRegularizer[normalIndex] = isHardContact ? D_DIAGONAL_REGULARIZER : ndMax(D_DIAGONAL_REGULARIZER, contact.m_material.m_skinMargin);
 	const ndFloat32 relGyro = (normalJacobian0.m_angular * gyroAlpha0 + normalJacobian1.m_angular * gyroAlpha1).AddHorizontal().GetScalar();
 
+	if (contact.m_penetration < D_SPECULATIVE_CONTACT_GAP)
+	{
+		// speculative contact, the shapes are still apart so the row only removes 
+		// the approach speed that closes the gap in this step, no bounce and no 
+		// penetration recovery. the negative penetration is the gap speed. 
+		const ndFloat32 gapSpeed = -contact.m_penetration * desc.m_invTimestep;
+		desc.m_penetration[normalIndex] = -gapSpeed;
+		desc.m_restitution[normalIndex] = ndFloat32(0.0f);
+		desc.m_penetrationStiffness[normalIndex] = ndFloat32(0.0f);
+		relSpeed -= gapSpeed;
+	}
+	else
+	{
+		const ndFloat32 restitutionVelocity = (relSpeed > D_REST_RELATIVE_VELOCITY) ? relSpeed * restitutionCoefficient : ndFloat32(0.0f);
+		const ndFloat32 penetrationStiffness = D_MAX_PENETRATION_STIFFNESS * contact.m_material.m_softness;
+		const ndFloat32 penetrationVeloc = penetration * penetrationStiffness;
+		ndAssert(ndAbs(penetrationVeloc - D_MAX_PENETRATION_STIFFNESS * contact.m_material.m_softness * penetration) < ndFloat32(1.0e-6f));
+		desc.m_penetrationStiffness[normalIndex] = penetrationStiffness;
+		relSpeed += ndMax(restitutionVelocity, penetrationVeloc);
+	}
+
 	desc.m_jointAccel[normalIndex] = relGyro + relSpeed * desc.m_timestep;
 	if (contact.m_material.m_flags & m_overrideNormalAccel)
 	{
@@ -299,7 +367,13 @@ void ndContact::JointAccelerations(ndJointAccelerationDecriptor* const desc)
 		
 				ndFloat32 penetrationVeloc = ndFloat32(0.0f);
 				ndFloat32 restitution = (vRel <= ndFloat32(0.0f)) ? (ndFloat32(1.0f) + rhs->m_restitution) : ndFloat32(1.0f);
-				if (rhs->m_penetration > D_RESTING_CONTACT_PENETRATION * ndFloat32(0.125f)) 
+				if (rhs->m_penetration < ndFloat32(0.0f))
+				{
+					// speculative contact, only the approach faster than the gap speed is removed
+					restitution = ndFloat32(1.0f);
+					penetrationVeloc = -rhs->m_penetration;
+				}
+				else if (rhs->m_penetration > D_RESTING_CONTACT_PENETRATION * ndFloat32(0.125f)) 
 				{
 					if (vRel > ndFloat32(0.0f)) 
 					{
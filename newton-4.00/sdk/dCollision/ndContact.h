@@ -32,8 +32,12 @@ class ndShapeInstance;
 
 #define D_MAX_CONTATCS					128
 #define D_CONSTRAINT_MAX_ROWS			(3 * 16)
+#define D_MAX_CONTACT_POINTS			(D_CONSTRAINT_MAX_ROWS / 3)
 #define D_RESTING_CONTACT_PENETRATION	(D_PENETRATION_TOL + ndFloat32 (1.0f / 1024.0f))
 
+// contact points with a penetration below this are speculative, the shapes are still apart
+#define D_SPECULATIVE_CONTACT_GAP		(ndFloat32 (-1.0e-5f))
+
 D_MSV_NEWTON_ALIGN_32
 class ndContactPoint
 {
@@ -83,13 +87,45 @@ class ndContactMaterial: public ndContactPoint
 	ndMaterial m_material;
 } D_GCC_NEWTON_ALIGN_32;
 
-class ndContactPointList : public ndList<ndContactMaterial, ndContainersFreeListAlloc<ndContactMaterial>>
+// the contact points of a pair are stored in one contiguous buffer that 
+// grows up to D_MAX_CONTACT_POINTS entries and is kept for the life of the contact, 
+// the nodes are linked in array order, so it is iterated like a list.
+class ndContactPointList : public ndClassAlloc
 {
 	public:
-	ndContactPointList()
-		:ndList<ndContactMaterial, ndContainersFreeListAlloc<ndContactMaterial>>()
+	D_MSV_NEWTON_ALIGN_32
+	class ndNode
 	{
-	}
+		public:
+		ndContactMaterial& GetInfo();
+		const ndContactMaterial& GetInfo() const;
+		ndNode* GetNext() const;
+
+		private:
+		ndContactMaterial m_info;
+		ndNode* m_next;
+		friend class ndContactPointList;
+	} D_GCC_NEWTON_ALIGN_32;
+
+	D_COLLISION_API ndContactPointList();
+	D_COLLISION_API ~ndContactPointList();
+
+	ndInt32 GetCount() const;
+	ndNode* GetFirst() const;
+	ndContactMaterial& operator[] (ndInt32 i);
+	const ndContactMaterial& operator[] (ndInt32 i) const;
+
+	// keeps the first entries, new entries are default constructed
+	D_COLLISION_API void SetCount(ndInt32 count);
+	void RemoveAll();
+
+	private:
+	ndContactPointList(const ndContactPointList&);
+	ndContactPointList& operator= (const ndContactPointList&);
+
+	ndNode* m_nodes;
+	ndInt32 m_count;
+	ndInt32 m_capacity;
 };
 
 D_MSV_NEWTON_ALIGN_32 
@@ -130,12 +166,15 @@ class ndContact: public ndConstraint
 	ndFloat32 m_separationDistance;
 	//ndUnsigned32 m_maxDOF;
 	ndUnsigned32 m_sceneLru;
+	ndInt32 m_contactMapSlot0;
+	ndInt32 m_contactMapSlot1;
 	ndUnsigned32 m_isDead : 1;
 	ndUnsigned32 m_inTrigger : 1;
 	ndUnsigned32 m_isAttached : 1;
 	ndUnsigned32 m_isIntersetionTestOnly : 1;
 	//ndUnsigned32 m_skeletonIntraCollision : 1;
 	ndUnsigned32 m_skeletonSelftCollision : 1;
+	ndUnsigned32 m_isFrozen : 1;
 	static ndVector m_initialSeparatingVector;
 
 	friend class ndScene;
@@ -148,6 +187,50 @@ class ndContact: public ndConstraint
 	friend class ndBodyPlayerCapsuleContactSolver;
 } D_GCC_NEWTON_ALIGN_32 ;
 
+inline ndContactMaterial& ndContactPointList::ndNode::GetInfo()
+{
+	return m_info;
+}
+
+inline const ndContactMaterial& ndContactPointList::ndNode::GetInfo() const
+{
+	return m_info;
+}
+
+inline ndContactPointList::ndNode* ndContactPointList::ndNode::GetNext() const
+{
+	return m_next;
+}
+
+inline ndInt32 ndContactPointList::GetCount() const
+{
+	return m_count;
+}
+
+inline ndContactPointList::ndNode* ndContactPointList::GetFirst() const
+{
+	return m_count ? m_nodes : nullptr;
+}
+
+inline ndContactMaterial& ndContactPointList::operator[] (ndInt32 i)
+{
+	ndAssert(i >= 0);
+	ndAssert(i < m_count);
+	return m_nodes[i].m_info;
+}
+
+inline const ndContactMaterial& ndContactPointList::operator[] (ndInt32 i) const
+{
+	ndAssert(i >= 0);
+	ndAssert(i < m_count);
+	return m_nodes[i].m_info;
+}
+
+inline void ndContactPointList::RemoveAll()
+{
+	m_count = 0;
+}
+
 inline ndContact* ndContact::GetAsContact()
 {
 	return this;
@@ -0,0 +1,235 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include "ndCoreStdafx.h"
+#include "ndCollisionStdafx.h"
+#include "ndContact.h"
+#include "ndBodyKinematic.h"
+#include "ndContactPairMap.h"
+
+#define D_CONTACT_PAIR_EMPTY		ndUnsigned64(0)
+#define D_CONTACT_PAIR_TOMBSTONE	ndUnsigned64(-1)
+#define D_CONTACT_PAIR_MIN_CAPACITY	256
+
+ndContactPairMap::ndContactPairMap()
+	:ndClassAlloc()
+	,m_slots(nullptr)
+	,m_capacity(0)
+	,m_count(0)
+	,m_tombstones(0)
+{
+}
+
+ndContactPairMap::ndContactPairMap(const ndContactPairMap& src)
+	:ndClassAlloc()
+	,m_slots(nullptr)
+	,m_capacity(0)
+	,m_count(0)
+	,m_tombstones(0)
+{
+	ndContactPairMap& steal = (ndContactPairMap&)src;
+	ndSwap(m_slots, steal.m_slots);
+	ndSwap(m_capacity, steal.m_capacity);
+	m_count.store(steal.m_count.load());
+	m_tombstones.store(steal.m_tombstones.load());
+	steal.m_count.store(0);
+	steal.m_tombstones.store(0);
+}
+
+ndContactPairMap::~ndContactPairMap()
+{
+	if (m_slots)
+	{
+		ndMemory::Free(m_slots);
+	}
+}
+
+ndUnsigned64 ndContactPairMap::GetKey(const ndBody* const body0, const ndBody* const body1)
+{
+	const ndUnsigned32 id0 = body0->GetId();
+	const ndUnsigned32 id1 = body1->GetId();
+	ndAssert(id0 != id1);
+	// the high id is never zero, so a key is never empty or a tombstone
+	return (ndUnsigned64(ndMax(id0, id1)) << 32) + ndMin(id0, id1);
+}
+
+ndUnsigned64 ndContactPairMap::GetHash(ndUnsigned64 key)
+{
+	// murmur3 finalizer, ids are sequential and need to be scattered.
+	key ^= key >> 33;
+	key *= ndUnsigned64(0xff51afd7ed558ccdULL);
+	key ^= key >> 33;
+	key *= ndUnsigned64(0xc4ceb9fe1a85ec53ULL);
+	key ^= key >> 33;
+	return key;
+}
+
+ndContact* ndContactPairMap::Find(const ndBody* const body0, const ndBody* const body1) const
+{
+	if (!m_slots)
+	{
+		return nullptr;
+	}
+
+	const ndUnsigned64 key = GetKey(body0, body1);
+	const ndUnsigned64 mask = ndUnsigned64(m_capacity - 1);
+	for (ndUnsigned64 i = GetHash(key) & mask; ; i = (i + 1) & mask)
+	{
+		const ndUnsigned64 slotKey = m_slots[i].m_key.load();
+		if (slotKey == key)
+		{
+			// a pair being inserted reads as missing until its contact is stored
+			return m_slots[i].m_contact.load();
+		}
+		if (slotKey == D_CONTACT_PAIR_EMPTY)
+		{
+			return nullptr;
+		}
+	}
+}
+
+void ndContactPairMap::Reserve(ndInt32 insertCount)
+{
+	// keep the table at most half full, tombstones included
+	const ndInt32 used = m_count.load() + m_tombstones.load() + insertCount;
+	if ((2 * used) > m_capacity)
+	{
+		ndInt32 capacity = D_CONTACT_PAIR_MIN_CAPACITY;
+		while (capacity < 2 * (m_count.load() + insertCount))
+		{
+			capacity *= 2;
+		}
+		Rehash(ndMax(capacity, m_capacity));
+	}
+}
+
+void ndContactPairMap::Rehash(ndInt32 capacity)
+{
+	ndAssert(!(capacity & (capacity - 1)));
+	ndSlot* const slots = (ndSlot*)ndMemory::Malloc(size_t(sizeof(ndSlot) * capacity));
+	for (ndInt32 i = 0; i < capacity; ++i)
+	{
+		new (&slots[i]) ndSlot();
+	}
+
+	const ndUnsigned64 mask = ndUnsigned64(capacity - 1);
+	for (ndInt32 i = 0; i < m_capacity; ++i)
+	{
+		const ndUnsigned64 key = m_slots[i].m_key.load();
+		if ((key != D_CONTACT_PAIR_EMPTY) && (key != D_CONTACT_PAIR_TOMBSTONE))
+		{
+			ndUnsigned64 j = GetHash(key) & mask;
+			while (slots[j].m_key.load() != D_CONTACT_PAIR_EMPTY)
+			{
+				j = (j + 1) & mask;
+			}
+			slots[j].m_key.store(key);
+			slots[j].m_contact.store(m_slots[i].m_contact.load());
+		}
+	}
+
+	if (m_slots)
+	{
+		ndMemory::Free(m_slots);
+	}
+	m_slots = slots;
+	m_capacity = capacity;
+	m_tombstones.store(0);
+}
+
+bool ndContactPairMap::Insert(ndContact* const contact)
+{
+	ndAssert(m_slots);
+	ndAssert(2 * (m_count.load() + m_tombstones.load()) < m_capacity);
+
+	const ndUnsigned64 key = GetKey(contact->GetBody0(), contact->GetBody1());
+	const ndUnsigned64 mask = ndUnsigned64(m_capacity - 1);
+	ndUnsigned64 i = GetHash(key) & mask;
+	for (;;)
+	{
+		ndSlot& slot = m_slots[i];
+		ndUnsigned64 slotKey = slot.m_key.load();
+		if (slotKey == D_CONTACT_PAIR_EMPTY)
+		{
+			ndUnsigned64 expected = D_CONTACT_PAIR_EMPTY;
+			if (slot.m_key.compare_exchange_weak(expected, key))
+			{
+				slot.m_contact.store(contact);
+				m_count.fetch_add(1);
+				return true;
+			}
+			// lost the slot, or a spurious failure, look at it again
+			slotKey = slot.m_key.load();
+			if (slotKey == D_CONTACT_PAIR_EMPTY)
+			{
+				continue;
+			}
+		}
+		if (slotKey == key)
+		{
+			return false;
+		}
+		i = (i + 1) & mask;
+	}
+}
+
+void ndContactPairMap::Remove(ndContact* const contact)
+{
+	if (!m_slots)
+	{
+		return;
+	}
+
+	const ndUnsigned64 key = GetKey(contact->GetBody0(), contact->GetBody1());
+	const ndUnsigned64 mask = ndUnsigned64(m_capacity - 1);
+	for (ndUnsigned64 i = GetHash(key) & mask; ; i = (i + 1) & mask)
+	{
+		ndSlot& slot = m_slots[i];
+		const ndUnsigned64 slotKey = slot.m_key.load();
+		if (slotKey == key)
+		{
+			if (slot.m_contact.load() == contact)
+			{
+				slot.m_contact.store(nullptr);
+				slot.m_key.store(D_CONTACT_PAIR_TOMBSTONE);
+				m_count.fetch_sub(1);
+				m_tombstones.fetch_add(1);
+			}
+			return;
+		}
+		if (slotKey == D_CONTACT_PAIR_EMPTY)
+		{
+			return;
+		}
+	}
+}
+
+void ndContactPairMap::RemoveAll()
+{
+	for (ndInt32 i = 0; i < m_capacity; ++i)
+	{
+		m_slots[i].m_key.store(D_CONTACT_PAIR_EMPTY);
+		m_slots[i].m_contact.store(nullptr);
+	}
+	m_count.store(0);
+	m_tombstones.store(0);
+}
@@ -0,0 +1,73 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef __ND_CONTACT_PAIR_MAP_H__
+#define __ND_CONTACT_PAIR_MAP_H__
+
+#include "ndCollisionStdafx.h"
+
+class ndBody;
+class ndContact;
+
+// open addressing hash of the scene contacts, keyed by the sorted pair of 
+// body ids. lookups and inserts are lock free and can run concurrently, 
+// but the table does not grow while inserting, so Reserve must be called 
+// before a batch of inserts. removed keys leave a tombstone until the next rehash.
+class ndContactPairMap: public ndClassAlloc
+{
+	class ndSlot
+	{
+		public:
+		ndAtomic<ndUnsigned64> m_key;
+		ndAtomic<ndContact*> m_contact;
+	};
+
+	public:
+	ndContactPairMap();
+	ndContactPairMap(const ndContactPairMap& src);
+	~ndContactPairMap();
+
+	ndInt32 GetCount() const;
+	ndContact* Find(const ndBody* const body0, const ndBody* const body1) const;
+
+	void Reserve(ndInt32 insertCount);
+	bool Insert(ndContact* const contact);
+	void Remove(ndContact* const contact);
+	void RemoveAll();
+
+	private:
+	void Rehash(ndInt32 capacity);
+	static ndUnsigned64 GetKey(const ndBody* const body0, const ndBody* const body1);
+	static ndUnsigned64 GetHash(ndUnsigned64 key);
+
+	ndSlot* m_slots;
+	ndInt32 m_capacity;
+	ndAtomic<ndInt32> m_count;
+	ndAtomic<ndInt32> m_tombstones;
+};
+
+inline ndInt32 ndContactPairMap::GetCount() const
+{
+	return m_count.load();
+}
+
+#endif
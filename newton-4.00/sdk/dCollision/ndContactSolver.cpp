@@ -24,7 +24,10 @@
 #include "ndScene.h"
 #include "ndShape.h"
 #include "ndContact.h"
+#include "ndShapeBox.h"
 #include "ndShapePoint.h"
+#include "ndShapeSphere.h"
+#include "ndShapeCapsule.h"
 #include "ndShapeConvex.h"
 #include "ndShapeCompound.h"
 #include "ndBodyKinematic.h"
@@ -350,6 +353,7 @@ ndContactSolver::ndContactSolver()
 	,m_vertexIndex(0)
 	,m_pruneContacts(1)
 	,m_intersectionTestOnly(0)
+	,m_speculativeContacts(0)
 {
 }
 
@@ -371,6 +375,7 @@ ndContactSolver::ndContactSolver(ndShapeInstance* const instance, ndContactNotif
 	,m_vertexIndex(0)
 	,m_pruneContacts(1)
 	,m_intersectionTestOnly(0)
+	,m_speculativeContacts(0)
 {
 }
 
@@ -394,6 +399,7 @@ ndContactSolver::ndContactSolver(ndContact* const contact, ndContactNotify* cons
 	,m_vertexIndex(0)
 	,m_pruneContacts(1)
 	,m_intersectionTestOnly(0)
+	,m_speculativeContacts(0)
 {
 }
 
@@ -417,6 +423,7 @@ ndContactSolver::ndContactSolver(const ndContactSolver& src, const ndShapeInstan
 	,m_vertexIndex(0)
 	,m_pruneContacts(src.m_pruneContacts)
 	,m_intersectionTestOnly(src.m_intersectionTestOnly)
+	,m_speculativeContacts(src.m_speculativeContacts)
 {
 }
 
@@ -679,6 +686,7 @@ ndInt32 ndContactSolver::CalculateClosestSimplex()
 		if (dist < ndFloat32 (1.0e-9f)) 
 		{
 			// very deep penetration, resolve with generic Minkowski solver
+			D_FRAME_STATS_COUNT(m_gjkIterations, iter + 1);
 			return -index; 
 		}
 	
@@ -690,6 +698,7 @@ ndInt32 ndContactSolver::CalculateClosestSimplex()
 		cycling ++;
 		if (cycling > 4) 
 		{
+			D_FRAME_STATS_COUNT(m_gjkIterations, iter + 1);
 			return -index;
 		}
 	
@@ -704,6 +713,7 @@ ndInt32 ndContactSolver::CalculateClosestSimplex()
 		if (dist1 < ndFloat64 (1.0e-3f)) 
 		{
 			m_separatingVector = dir;
+			D_FRAME_STATS_COUNT(m_gjkIterations, iter + 1);
 			return index;
 		}
 	
@@ -738,6 +748,7 @@ ndInt32 ndContactSolver::CalculateClosestSimplex()
 		iter ++;
 	} while (iter < D_CONNICS_CONTATS_ITERATIONS); 
 
+	D_FRAME_STATS_COUNT(m_gjkIterations, iter);
 	m_separatingVector = bestNormal;
 	return (index < 4) ? index : -4;
 }
@@ -2533,6 +2544,529 @@ ndInt32 ndContactSolver::ConvexContactsDiscrete()
 	return count;
 }
 
+class ndContactSolver::ndPrimitiveContact
+{
+	public:
+	// closest points and one contact for two spheres, also used by the capsule pairs
+	void SetSpheres(const ndVector& center0, ndFloat32 radius0, const ndVector& center1, ndFloat32 radius1)
+	{
+		const ndVector dist((center1 - center0) & ndVector::m_triplexMask);
+		const ndFloat32 mag2 = dist.DotProduct(dist).GetScalar();
+		m_normal = (mag2 > ndFloat32(1.0e-12f)) ? dist.Scale(ndRsqrt(mag2)) : ndVector(ndFloat32(0.0f), ndFloat32(1.0f), ndFloat32(0.0f), ndFloat32(0.0f));
+		m_point0 = center0 + m_normal.Scale(radius0);
+		m_point1 = center1 - m_normal.Scale(radius1);
+		m_points[0] = ndVector::m_half * (m_point0 + m_point1);
+		m_count = 1;
+	}
+
+	void Swap()
+	{
+		ndSwap(m_point0, m_point1);
+		m_normal = m_normal * ndVector::m_negOne;
+	}
+
+	ndVector m_point0;
+	ndVector m_point1;
+	// from shape 0 to shape 1, same as the separating vector
+	ndVector m_normal;
+	ndVector m_points[2];
+	ndInt32 m_count;
+};
+
+class ndContactSolver::ndPrimitiveDispatch
+{
+	public:
+	ndPrimitiveDispatch()
+	{
+		memset(m_kernel, 0, sizeof(m_kernel));
+		memset(m_swap, 0, sizeof(m_swap));
+		Add(m_sphere, m_sphere, SphereToSphereContacts);
+		Add(m_sphere, m_capsule, SphereToCapsuleContacts);
+		Add(m_sphere, m_box, SphereToBoxContacts);
+		Add(m_capsule, m_capsule, CapsuleToCapsuleContacts);
+		Add(m_capsule, m_box, CapsuleToBoxContacts);
+	}
+
+	void Add(ndShapeID id0, ndShapeID id1, ndPrimitiveContactKernel kernel)
+	{
+		m_kernel[id0][id1] = kernel;
+		m_kernel[id1][id0] = kernel;
+		m_swap[id1][id0] = (id0 != id1);
+	}
+
+	ndPrimitiveContactKernel m_kernel[m_convexHull + 1][m_convexHull + 1];
+	bool m_swap[m_convexHull + 1][m_convexHull + 1];
+};
+
+ndContactSolver::ndPrimitiveDispatch ndContactSolver::m_primitiveDispatch;
+
+// the kernels only take shapes with unit or uniform scale
+static inline bool ndPrimitiveHasUniformScale(const ndShapeInstance& instance)
+{
+	return (instance.GetScaleType() == ndShapeInstance::m_unit) || (instance.GetScaleType() == ndShapeInstance::m_uniform);
+}
+
+// closest points parameters of segments p0 + d0 * s and p1 + d1 * t, with s and t in [0, 1]
+static inline void ndPrimitiveSegmentsClosestParam(const ndVector& p0, const ndVector& d0, const ndVector& p1, const ndVector& d1, ndFloat32& s, ndFloat32& t)
+{
+	const ndVector r((p0 - p1) & ndVector::m_triplexMask);
+	const ndFloat32 a = d0.DotProduct(d0).GetScalar();
+	const ndFloat32 b = d0.DotProduct(d1).GetScalar();
+	const ndFloat32 c = d0.DotProduct(r).GetScalar();
+	const ndFloat32 e = d1.DotProduct(d1).GetScalar();
+	const ndFloat32 f = d1.DotProduct(r).GetScalar();
+	const ndFloat32 den = a * e - b * b;
+
+	s = (den > ndFloat32(1.0e-6f) * a * e) ? ndClamp((b * f - c * e) / den, ndFloat32(0.0f), ndFloat32(1.0f)) : ndFloat32(0.0f);
+	t = (b * s + f) / e;
+	if (t < ndFloat32(0.0f))
+	{
+		t = ndFloat32(0.0f);
+		s = ndClamp(-c / a, ndFloat32(0.0f), ndFloat32(1.0f));
+	}
+	else if (t > ndFloat32(1.0f))
+	{
+		t = ndFloat32(1.0f);
+		s = ndClamp((b - c) / a, ndFloat32(0.0f), ndFloat32(1.0f));
+	}
+}
+
+bool ndContactSolver::SphereToSphereContacts(const ndShapeInstance& sphere0, const ndShapeInstance& sphere1, ndPrimitiveContact& contact)
+{
+	const ndFloat32 radius0 = ((const ndShapeSphere*)sphere0.GetShape())->m_radius * sphere0.GetScale().m_x;
+	const ndFloat32 radius1 = ((const ndShapeSphere*)sphere1.GetShape())->m_radius * sphere1.GetScale().m_x;
+	contact.SetSpheres(sphere0.m_globalMatrix.m_posit, radius0, sphere1.m_globalMatrix.m_posit, radius1);
+	return true;
+}
+
+bool ndContactSolver::SphereToCapsuleContacts(const ndShapeInstance& sphere, const ndShapeInstance& capsule, ndPrimitiveContact& contact)
+{
+	const ndShapeCapsule* const capsuleShape = (const ndShapeCapsule*)capsule.GetShape();
+	if (capsuleShape->m_radius0 != capsuleShape->m_radius1)
+	{
+		return false;
+	}
+
+	const ndFloat32 scale = capsule.GetScale().m_x;
+	const ndMatrix& matrix = capsule.m_globalMatrix;
+	const ndVector axis(matrix.m_front.Scale(capsuleShape->m_height * scale));
+	const ndVector p0(matrix.m_posit - axis);
+	const ndVector diff(axis.Scale(ndFloat32(2.0f)));
+
+	const ndVector center(sphere.m_globalMatrix.m_posit);
+	const ndFloat32 t = ndClamp(diff.DotProduct(center - p0).GetScalar() / diff.DotProduct(diff).GetScalar(), ndFloat32(0.0f), ndFloat32(1.0f));
+	const ndFloat32 radius = ((const ndShapeSphere*)sphere.GetShape())->m_radius * sphere.GetScale().m_x;
+	contact.SetSpheres(center, radius, p0 + diff.Scale(t), capsuleShape->m_radius0 * scale);
+	return true;
+}
+
+bool ndContactSolver::SphereToBoxContacts(const ndShapeInstance& sphere, const ndShapeInstance& box, ndPrimitiveContact& contact)
+{
+	const ndMatrix& matrix = box.m_globalMatrix;
+	const ndVector size(((const ndShapeBox*)box.GetShape())->m_size[0].Scale(box.GetScale().m_x));
+	const ndVector center(sphere.m_globalMatrix.m_posit);
+	const ndFloat32 radius = ((const ndShapeSphere*)sphere.GetShape())->m_radius * sphere.GetScale().m_x;
+
+	const ndVector localCenter(matrix.UntransformVector(center) & ndVector::m_triplexMask);
+	ndVector closestPoint(localCenter.GetMax(size * ndVector::m_negOne).GetMin(size));
+	const ndVector diff(closestPoint - localCenter);
+	const ndFloat32 dist2 = diff.DotProduct(diff).GetScalar();
+	if (dist2 > ndFloat32(1.0e-12f))
+	{
+		contact.m_normal = matrix.RotateVector(diff.Scale(ndRsqrt(dist2)));
+	}
+	else
+	{
+		// the center is inside the box, push it out of the closest face
+		const ndVector depth(size - localCenter.Abs());
+		const ndInt32 index = ((depth.m_x < depth.m_y) && (depth.m_x < depth.m_z)) ? 0 : ((depth.m_y < depth.m_z) ? 1 : 2);
+		const ndFloat32 side = (localCenter[index] < ndFloat32(0.0f)) ? ndFloat32(-1.0f) : ndFloat32(1.0f);
+		closestPoint[index] = size[index] * side;
+		contact.m_normal = matrix[index].Scale(-side);
+	}
+
+	contact.m_point0 = center + contact.m_normal.Scale(radius);
+	contact.m_point1 = matrix.TransformVector(closestPoint | ndVector::m_wOne);
+	contact.m_points[0] = ndVector::m_half * (contact.m_point0 + contact.m_point1);
+	contact.m_count = 1;
+	return true;
+}
+
+bool ndContactSolver::CapsuleToCapsuleContacts(const ndShapeInstance& capsule0, const ndShapeInstance& capsule1, ndPrimitiveContact& contact)
+{
+	const ndShapeCapsule* const capsuleShape0 = (const ndShapeCapsule*)capsule0.GetShape();
+	const ndShapeCapsule* const capsuleShape1 = (const ndShapeCapsule*)capsule1.GetShape();
+	if ((capsuleShape0->m_radius0 != capsuleShape0->m_radius1) || (capsuleShape1->m_radius0 != capsuleShape1->m_radius1))
+	{
+		return false;
+	}
+
+	const ndFloat32 scale0 = capsule0.GetScale().m_x;
+	const ndFloat32 scale1 = capsule1.GetScale().m_x;
+	const ndFloat32 radius0 = capsuleShape0->m_radius0 * scale0;
+	const ndFloat32 radius1 = capsuleShape1->m_radius0 * scale1;
+	const ndVector axis0(capsule0.m_globalMatrix.m_front.Scale(capsuleShape0->m_height * scale0));
+	const ndVector axis1(capsule1.m_globalMatrix.m_front.Scale(capsuleShape1->m_height * scale1));
+	const ndVector p0(capsule0.m_globalMatrix.m_posit - axis0);
+	const ndVector p1(capsule1.m_globalMatrix.m_posit - axis1);
+	const ndVector d0(axis0.Scale(ndFloat32(2.0f)));
+	const ndVector d1(axis1.Scale(ndFloat32(2.0f)));
+
+	ndFloat32 s;
+	ndFloat32 t;
+	ndPrimitiveSegmentsClosestParam(p0, d0, p1, d1, s, t);
+	contact.SetSpheres(p0 + d0.Scale(s), radius0, p1 + d1.Scale(t), radius1);
+
+	// parallel capsules touch along the overlap of the two segments
+	const ndFloat32 a = d0.DotProduct(d0).GetScalar();
+	const ndFloat32 b = d0.DotProduct(d1).GetScalar();
+	const ndFloat32 e = d1.DotProduct(d1).GetScalar();
+	if ((b * b) > (ndFloat32(0.996f) * a * e))
+	{
+		const ndFloat32 t0 = d0.DotProduct(p1 - p0).GetScalar() / a;
+		const ndFloat32 t1 = d0.DotProduct(p1 + d1 - p0).GetScalar() / a;
+		const ndFloat32 low = ndMax(ndMin(t0, t1), ndFloat32(0.0f));
+		const ndFloat32 high = ndMin(ndMax(t0, t1), ndFloat32(1.0f));
+		if ((high - low) * ndSqrt(a) > D_PENETRATION_TOL)
+		{
+			const ndFloat32 gap = contact.m_normal.DotProduct(contact.m_point1 - contact.m_point0).GetScalar();
+			const ndVector offset(contact.m_normal.Scale(radius0 + gap * ndFloat32(0.5f)));
+			contact.m_points[0] = p0 + d0.Scale(low) + offset;
+			contact.m_points[1] = p0 + d0.Scale(high) + offset;
+			contact.m_count = 2;
+		}
+	}
+	return true;
+}
+
+bool ndContactSolver::CapsuleToBoxContacts(const ndShapeInstance& capsule, const ndShapeInstance& box, ndPrimitiveContact& contact)
+{
+	const ndShapeCapsule* const capsuleShape = (const ndShapeCapsule*)capsule.GetShape();
+	if (capsuleShape->m_radius0 != capsuleShape->m_radius1)
+	{
+		return false;
+	}
+
+	// everything in the space of the box
+	const ndMatrix& matrix = box.m_globalMatrix;
+	const ndVector size(((const ndShapeBox*)box.GetShape())->m_size[0].Scale(box.GetScale().m_x));
+	const ndFloat32 capsuleScale = capsule.GetScale().m_x;
+	const ndFloat32 radius = capsuleShape->m_radius0 * capsuleScale;
+	const ndVector axis(matrix.UnrotateVector(capsule.m_globalMatrix.m_front.Scale(capsuleShape->m_height * capsuleScale)));
+	const ndVector p0((matrix.UntransformVector(capsule.m_globalMatrix.m_posit) & ndVector::m_triplexMask) - axis);
+	const ndVector diff(axis.Scale(ndFloat32(2.0f)));
+	const ndVector minSize(size * ndVector::m_negOne);
+
+	// the distance from the segment to the box is convex, a golden section search finds the closest point
+	ndFloat32 t0 = ndFloat32(0.0f);
+	ndFloat32 t1 = ndFloat32(1.0f);
+	const ndFloat32 golden = ndFloat32(0.618034f);
+	ndFloat32 ta = t1 - golden;
+	ndFloat32 tb = t0 + golden;
+	ndVector pa(p0 + diff.Scale(ta));
+	ndVector pb(p0 + diff.Scale(tb));
+	ndVector da(pa - pa.GetMax(minSize).GetMin(size));
+	ndVector db(pb - pb.GetMax(minSize).GetMin(size));
+	ndFloat32 fa = da.DotProduct(da).GetScalar();
+	ndFloat32 fb = db.DotProduct(db).GetScalar();
+	for (ndInt32 i = 0; i < 24; ++i)
+	{
+		if (fa < fb)
+		{
+			t1 = tb;
+			tb = ta;
+			fb = fa;
+			ta = t1 - golden * (t1 - t0);
+			pa = p0 + diff.Scale(ta);
+			da = pa - pa.GetMax(minSize).GetMin(size);
+			fa = da.DotProduct(da).GetScalar();
+		}
+		else
+		{
+			t0 = ta;
+			ta = tb;
+			fa = fb;
+			tb = t0 + golden * (t1 - t0);
+			pb = p0 + diff.Scale(tb);
+			db = pb - pb.GetMax(minSize).GetMin(size);
+			fb = db.DotProduct(db).GetScalar();
+		}
+	}
+
+	const ndFloat32 t = ndFloat32(0.5f) * (t0 + t1);
+	const ndVector segmentPoint(p0 + diff.Scale(t));
+	const ndVector boxPoint(segmentPoint.GetMax(minSize).GetMin(size));
+	const ndVector dist(segmentPoint - boxPoint);
+	const ndFloat32 dist2 = dist.DotProduct(dist).GetScalar();
+	if (dist2 < ndFloat32(1.0e-8f))
+	{
+		// the segment cuts the box, leave the deep penetration to gjk
+		return false;
+	}
+
+	const ndFloat32 distance = ndSqrt(dist2);
+	const ndVector localNormal(dist.Scale(ndFloat32(1.0f) / distance));
+	contact.m_normal = matrix.RotateVector(localNormal * ndVector::m_negOne);
+	contact.m_point0 = matrix.TransformVector((segmentPoint - localNormal.Scale(radius)) | ndVector::m_wOne);
+	contact.m_point1 = matrix.TransformVector(boxPoint | ndVector::m_wOne);
+	contact.m_count = 0;
+
+	// when the closest feature is a face, clip the segment to the face and 
+	// keep the ends that are as close to the face as the closest point
+	const ndVector absNormal(localNormal.Abs());
+	const ndInt32 index = ((absNormal.m_x > absNormal.m_y) && (absNormal.m_x > absNormal.m_z)) ? 0 : ((absNormal.m_y > absNormal.m_z) ? 1 : 2);
+	if (absNormal[index] > ndFloat32(0.9999f))
+	{
+		ndFloat32 low = ndFloat32(0.0f);
+		ndFloat32 high = ndFloat32(1.0f);
+		for (ndInt32 i = 0; i < 3; ++i)
+		{
+			if ((i != index) && (ndAbs(diff[i]) > ndFloat32(1.0e-6f)))
+			{
+				const ndFloat32 invDiff = ndFloat32(1.0f) / diff[i];
+				const ndFloat32 clip0 = (-size[i] - p0[i]) * invDiff;
+				const ndFloat32 clip1 = (size[i] - p0[i]) * invDiff;
+				low = ndMax(low, ndMin(clip0, clip1));
+				high = ndMin(high, ndMax(clip0, clip1));
+			}
+		}
+
+		const ndFloat32 side = (localNormal[index] < ndFloat32(0.0f)) ? ndFloat32(-1.0f) : ndFloat32(1.0f);
+		const ndFloat32 clipParam[] = { low, high };
+		const ndInt32 clipCount = (low > high) ? 0 : (((high - low) * ndSqrt(diff.DotProduct(diff).GetScalar()) > D_PENETRATION_TOL) ? 2 : 1);
+		for (ndInt32 i = 2 - clipCount; i < 2; ++i)
+		{
+			ndVector point(p0 + diff.Scale(clipParam[i]));
+			const ndFloat32 height = point[index] * side - size[index];
+			if ((height - distance) < D_PENETRATION_TOL)
+			{
+				point[index] = side * (size[index] + (height - radius) * ndFloat32(0.5f));
+				contact.m_points[contact.m_count] = matrix.TransformVector(point | ndVector::m_wOne);
+				contact.m_count++;
+			}
+		}
+	}
+
+	if (!contact.m_count)
+	{
+		contact.m_points[0] = ndVector::m_half * (contact.m_point0 + contact.m_point1);
+		contact.m_count = 1;
+	}
+	return true;
+}
+
+ndInt32 ndContactSolver::CalculatePrimitiveContacts()
+{
+	const ndShapeID id0 = m_instance0.GetShape()->GetCollisionId();
+	const ndShapeID id1 = m_instance1.GetShape()->GetCollisionId();
+	if ((id0 > m_convexHull) || (id1 > m_convexHull))
+	{
+		return -1;
+	}
+	const ndPrimitiveContactKernel kernel = m_primitiveDispatch.m_kernel[id0][id1];
+	if (!(kernel && ndPrimitiveHasUniformScale(m_instance0) && ndPrimitiveHasUniformScale(m_instance1)))
+	{
+		return -1;
+	}
+
+	ndPrimitiveContact contact;
+	if (m_primitiveDispatch.m_swap[id0][id1])
+	{
+		if (!kernel(m_instance1, m_instance0, contact))
+		{
+			return -1;
+		}
+		contact.Swap();
+	}
+	else if (!kernel(m_instance0, m_instance1, contact))
+	{
+		return -1;
+	}
+
+	m_closestPoint0 = contact.m_point0;
+	m_closestPoint1 = contact.m_point1;
+	m_separatingVector = contact.m_normal;
+	for (ndInt32 i = 0; i < contact.m_count; ++i)
+	{
+		m_buffer[i] = contact.m_points[i];
+	}
+	return contact.m_count;
+}
+
+ndInt32 ndContactSolver::GetContactBatchType(const ndShapeInstance& instance0, const ndShapeInstance& instance1, bool& swapped)
+{
+	if (!(instance0.GetCollisionMode() && instance1.GetCollisionMode() && ndPrimitiveHasUniformScale(instance0) && ndPrimitiveHasUniformScale(instance1)))
+	{
+		return -1;
+	}
+
+	swapped = instance0.GetShape()->GetCollisionId() != m_sphere;
+	const ndShapeInstance& sphere = swapped ? instance1 : instance0;
+	const ndShapeInstance& other = swapped ? instance0 : instance1;
+	if (sphere.GetShape()->GetCollisionId() != m_sphere)
+	{
+		return -1;
+	}
+
+	switch (other.GetShape()->GetCollisionId())
+	{
+		case m_sphere:
+			return m_sphereToSphereBatch;
+		case m_box:
+			return m_sphereToBoxBatch;
+		default:
+			return -1;
+	}
+}
+
+void ndContactSolver::SphereToSphereContactsSoa(ndContactBatch& batch)
+{
+	ndVector center0[D_CONTACT_BATCH_SIZE];
+	ndVector center1[D_CONTACT_BATCH_SIZE];
+	ndVector radius0;
+	ndVector radius1;
+	for (ndInt32 i = 0; i < D_CONTACT_BATCH_SIZE; ++i)
+	{
+		const ndShapeInstance& sphere0 = batch.m_contacts[i]->GetBody0()->GetCollisionShape();
+		const ndShapeInstance& sphere1 = batch.m_contacts[i]->GetBody1()->GetCollisionShape();
+		center0[i] = sphere0.m_globalMatrix.m_posit;
+		center1[i] = sphere1.m_globalMatrix.m_posit;
+		radius0[i] = ((const ndShapeSphere*)sphere0.GetShape())->m_radius * sphere0.GetScale().m_x;
+		radius1[i] = ((const ndShapeSphere*)sphere1.GetShape())->m_radius * sphere1.GetScale().m_x;
+	}
+
+	ndVector x0, y0, z0, w0;
+	ndVector x1, y1, z1, w1;
+	ndVector::Transpose4x4(x0, y0, z0, w0, center0[0], center0[1], center0[2], center0[3]);
+	ndVector::Transpose4x4(x1, y1, z1, w1, center1[0], center1[1], center1[2], center1[3]);
+
+	const ndVector dx(x1 - x0);
+	const ndVector dy(y1 - y0);
+	const ndVector dz(z1 - z0);
+	const ndVector mag2(dx * dx + dy * dy + dz * dz);
+	const ndVector valid(mag2 > ndVector(ndFloat32(1.0e-12f)));
+	const ndVector invMag(mag2.GetMax(ndVector::m_epsilon).InvSqrt());
+
+	// coincident centers separate along the y axis
+	const ndVector nx((dx * invMag) & valid);
+	const ndVector ny(ndVector::m_one.Select(dy * invMag, valid));
+	const ndVector nz((dz * invMag) & valid);
+
+	const ndVector offset(ndVector::m_half * (radius0 - radius1));
+	batch.m_normal[0] = nx;
+	batch.m_normal[1] = ny;
+	batch.m_normal[2] = nz;
+	batch.m_point[0] = ndVector::m_half * (x0 + x1) + nx * offset;
+	batch.m_point[1] = ndVector::m_half * (y0 + y1) + ny * offset;
+	batch.m_point[2] = ndVector::m_half * (z0 + z1) + nz * offset;
+	batch.m_separation = nx * dx + ny * dy + nz * dz - radius0 - radius1 - ndVector(D_PENETRATION_TOL);
+}
+
+void ndContactSolver::SphereToBoxContactsSoa(ndContactBatch& batch)
+{
+	ndVector center[D_CONTACT_BATCH_SIZE];
+	ndVector size[D_CONTACT_BATCH_SIZE];
+	ndMatrix matrix[D_CONTACT_BATCH_SIZE];
+	ndVector radius;
+	ndVector flip;
+	for (ndInt32 i = 0; i < D_CONTACT_BATCH_SIZE; ++i)
+	{
+		const ndContact* const contact = batch.m_contacts[i];
+		const bool swapped = batch.m_swapped[i];
+		const ndShapeInstance& sphere = (swapped ? contact->GetBody1() : contact->GetBody0())->GetCollisionShape();
+		const ndShapeInstance& box = (swapped ? contact->GetBody0() : contact->GetBody1())->GetCollisionShape();
+		flip[i] = swapped ? ndFloat32(-1.0f) : ndFloat32(1.0f);
+		center[i] = sphere.m_globalMatrix.m_posit;
+		radius[i] = ((const ndShapeSphere*)sphere.GetShape())->m_radius * sphere.GetScale().m_x;
+		size[i] = ((const ndShapeBox*)box.GetShape())->m_size[0].Scale(box.GetScale().m_x);
+		matrix[i] = box.m_globalMatrix;
+	}
+
+	ndVector cx, cy, cz, cw;
+	ndVector hx, hy, hz, hw;
+	ndVector fx, fy, fz, fw;
+	ndVector ux, uy, uz, uw;
+	ndVector rx, ry, rz, rw;
+	ndVector px, py, pz, pw;
+	ndVector::Transpose4x4(cx, cy, cz, cw, center[0], center[1], center[2], center[3]);
+	ndVector::Transpose4x4(hx, hy, hz, hw, size[0], size[1], size[2], size[3]);
+	ndVector::Transpose4x4(fx, fy, fz, fw, matrix[0].m_front, matrix[1].m_front, matrix[2].m_front, matrix[3].m_front);
+	ndVector::Transpose4x4(ux, uy, uz, uw, matrix[0].m_up, matrix[1].m_up, matrix[2].m_up, matrix[3].m_up);
+	ndVector::Transpose4x4(rx, ry, rz, rw, matrix[0].m_right, matrix[1].m_right, matrix[2].m_right, matrix[3].m_right);
+	ndVector::Transpose4x4(px, py, pz, pw, matrix[0].m_posit, matrix[1].m_posit, matrix[2].m_posit, matrix[3].m_posit);
+
+	// sphere center in the space of the box, and the closest point in the box
+	const ndVector dx(cx - px);
+	const ndVector dy(cy - py);
+	const ndVector dz(cz - pz);
+	const ndVector lx(dx * fx + dy * fy + dz * fz);
+	const ndVector ly(dx * ux + dy * uy + dz * uz);
+	const ndVector lz(dx * rx + dy * ry + dz * rz);
+	ndVector qx(lx.GetMax(hx * ndVector::m_negOne).GetMin(hx));
+	ndVector qy(ly.GetMax(hy * ndVector::m_negOne).GetMin(hy));
+	ndVector qz(lz.GetMax(hz * ndVector::m_negOne).GetMin(hz));
+
+	const ndVector diffx(qx - lx);
+	const ndVector diffy(qy - ly);
+	const ndVector diffz(qz - lz);
+	const ndVector dist2(diffx * diffx + diffy * diffy + diffz * diffz);
+	const ndVector outside(dist2 > ndVector(ndFloat32(1.0e-12f)));
+	const ndVector invDist(dist2.GetMax(ndVector::m_epsilon).InvSqrt());
+
+	// a center inside the box is pushed out of the closest face
+	const ndVector depthx(hx - lx.Abs());
+	const ndVector depthy(hy - ly.Abs());
+	const ndVector depthz(hz - lz.Abs());
+	const ndVector maskx((depthx < depthy) & (depthx < depthz));
+	const ndVector masky((depthy < depthz).AndNot(maskx));
+	const ndVector maskz(ndVector::m_xyzwMask.AndNot(maskx | masky));
+	const ndVector sidex(ndVector::m_one.Select(ndVector::m_negOne, lx < ndVector::m_zero));
+	const ndVector sidey(ndVector::m_one.Select(ndVector::m_negOne, ly < ndVector::m_zero));
+	const ndVector sidez(ndVector::m_one.Select(ndVector::m_negOne, lz < ndVector::m_zero));
+
+	const ndVector lnx(((sidex * ndVector::m_negOne) & maskx).Select(diffx * invDist, outside));
+	const ndVector lny(((sidey * ndVector::m_negOne) & masky).Select(diffy * invDist, outside));
+	const ndVector lnz(((sidez * ndVector::m_negOne) & maskz).Select(diffz * invDist, outside));
+	qx = qx.Select(sidex * hx, maskx.AndNot(outside));
+	qy = qy.Select(sidey * hy, masky.AndNot(outside));
+	qz = qz.Select(sidez * hz, maskz.AndNot(outside));
+
+	const ndVector nx(fx * lnx + ux * lny + rx * lnz);
+	const ndVector ny(fy * lnx + uy * lny + ry * lnz);
+	const ndVector nz(fz * lnx + uz * lny + rz * lnz);
+	const ndVector boxx(px + fx * qx + ux * qy + rx * qz);
+	const ndVector boxy(py + fy * qx + uy * qy + ry * qz);
+	const ndVector boxz(pz + fz * qx + uz * qy + rz * qz);
+	const ndVector spherex(cx + nx * radius);
+	const ndVector spherey(cy + ny * radius);
+	const ndVector spherez(cz + nz * radius);
+
+	// the normal goes from the first body to the second
+	batch.m_normal[0] = nx * flip;
+	batch.m_normal[1] = ny * flip;
+	batch.m_normal[2] = nz * flip;
+	batch.m_point[0] = ndVector::m_half * (boxx + spherex);
+	batch.m_point[1] = ndVector::m_half * (boxy + spherey);
+	batch.m_point[2] = ndVector::m_half * (boxz + spherez);
+	batch.m_separation = nx * (boxx - spherex) + ny * (boxy - spherey) + nz * (boxz - spherez) - ndVector(D_PENETRATION_TOL);
+}
+
+ndFloat32 ndContactSolver::CalculateSpeculativeDistance() const
+{
+	// the distance the two bodies can close along the separating 
+	// vector in one step, assuming they keep their velocities.
+	const ndBodyKinematic* const body0 = m_contact->GetBody0();
+	const ndBodyKinematic* const body1 = m_contact->GetBody1();
+	const ndVector veloc(body0->GetVelocity() - body1->GetVelocity());
+	const ndVector omega0(body0->GetOmega());
+	const ndVector omega1(body1->GetOmega());
+
+	const ndFloat32 closingSpeed = ndMax(m_separatingVector.DotProduct(veloc & ndVector::m_triplexMask).GetScalar(), ndFloat32(0.0f));
+	const ndFloat32 angularSpeed0 = ndSqrt(omega0.DotProduct(omega0 & ndVector::m_triplexMask).GetScalar()) * body0->GetCollisionShape().GetBoxMaxRadius();
+	const ndFloat32 angularSpeed1 = ndSqrt(omega1.DotProduct(omega1 & ndVector::m_triplexMask).GetScalar()) * body1->GetCollisionShape().GetBoxMaxRadius();
+	return (closingSpeed + angularSpeed0 + angularSpeed1) * m_timestep;
+}
+
 ndInt32 ndContactSolver::ConvexToConvexContactsDiscrete()
 {
 	ndAssert(m_instance0.GetConvexVertexCount() && m_instance1.GetConvexVertexCount());
@@ -2542,7 +3076,8 @@ ndInt32 ndContactSolver::ConvexToConvexContactsDiscrete()
 	ndAssert(!m_instance1.GetShape()->GetAsShapeNull());
 
 	ndInt32 count = 0;
-	bool colliding = CalculateClosestPoints();
+	const ndInt32 primitiveCount = CalculatePrimitiveContacts();
+	bool colliding = (primitiveCount >= 0) || CalculateClosestPoints();
 	ndFloat32 penetration = m_separatingVector.DotProduct(m_closestPoint1 - m_closestPoint0).GetScalar() - m_skinMargin - D_PENETRATION_TOL;
 	m_separationDistance = penetration;
 	if (m_intersectionTestOnly)
@@ -2551,11 +3086,12 @@ ndInt32 ndContactSolver::ConvexToConvexContactsDiscrete()
 	}
 	else if (colliding)
 	{
-		if (penetration <= ndFloat32(1.0e-5f))
+		const ndFloat32 contactDistance = m_speculativeContacts ? ndMax(CalculateSpeculativeDistance(), ndFloat32(1.0e-5f)) : ndFloat32(1.0e-5f);
+		if (penetration <= contactDistance)
 		{
 			if (ndInt8 (m_instance0.GetCollisionMode()) & ndInt8(m_instance1.GetCollisionMode()))
 			{
-				count = CalculateContacts(m_closestPoint0, m_closestPoint1, m_separatingVector * ndVector::m_negOne);
+				count = (primitiveCount >= 0) ? primitiveCount : CalculateContacts(m_closestPoint0, m_closestPoint1, m_separatingVector * ndVector::m_negOne);
 				// skip convex shape polygon because they could have a skirt
 				ndShapeConvexPolygon* const convexPolygon = m_instance1.GetShape()->GetAsShapeAsConvexPolygon();
 				if (!(count || convexPolygon))
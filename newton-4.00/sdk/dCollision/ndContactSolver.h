@@ -51,6 +51,7 @@ class ndMinkFace
 #define D_PENETRATION_TOL				ndFloat32 (1.0f / 1024.0f)
 #define D_MINK_VERTEX_ERR				ndFloat32 (1.0e-3f)
 #define D_MINK_VERTEX_ERR2				(D_MINK_VERTEX_ERR * D_MINK_VERTEX_ERR)
+#define D_CONTACT_BATCH_SIZE			4
 
 class ndContact;
 class dCollisionParamProxy;
@@ -91,6 +92,44 @@ class ndContactSolver: public ndDownHeap<ndMinkFace *, ndFloat32>
 	ndInt32 CalculatePolySoupToHullContactsDescrete(ndPolygonMeshDesc& data); // done
 	ndInt32 ConvexToSaticStaticBvhContactsNodeDescrete(const ndAabbPolygonSoup::ndNode* const node); // done
 
+	// closed form contacts for the sphere, capsule and box pairs, the other pairs use gjk
+	class ndPrimitiveContact;
+	class ndPrimitiveDispatch;
+	typedef bool (*ndPrimitiveContactKernel)(const ndShapeInstance& instance0, const ndShapeInstance& instance1, ndPrimitiveContact& contact);
+
+	ndInt32 CalculatePrimitiveContacts();
+	static bool SphereToSphereContacts(const ndShapeInstance& sphere0, const ndShapeInstance& sphere1, ndPrimitiveContact& contact);
+	static bool SphereToCapsuleContacts(const ndShapeInstance& sphere, const ndShapeInstance& capsule, ndPrimitiveContact& contact);
+	static bool SphereToBoxContacts(const ndShapeInstance& sphere, const ndShapeInstance& box, ndPrimitiveContact& contact);
+	static bool CapsuleToCapsuleContacts(const ndShapeInstance& capsule0, const ndShapeInstance& capsule1, ndPrimitiveContact& contact);
+	static bool CapsuleToBoxContacts(const ndShapeInstance& capsule, const ndShapeInstance& box, ndPrimitiveContact& contact);
+
+	// the scene gathers the sphere pairs of each type and solves them in groups 
+	// of D_CONTACT_BATCH_SIZE, each pair in one lane of the simd registers. 
+	// a swapped pair has the sphere as the second body.
+	enum ndContactBatchType
+	{
+		m_sphereToSphereBatch,
+		m_sphereToBoxBatch,
+		m_contactBatchCount,
+	};
+
+	D_MSV_NEWTON_ALIGN_32
+	class ndContactBatch
+	{
+		public:
+		// soa results, one vector per coordinate
+		ndVector m_point[3];
+		ndVector m_normal[3];
+		ndVector m_separation;
+		ndContact* m_contacts[D_CONTACT_BATCH_SIZE];
+		bool m_swapped[D_CONTACT_BATCH_SIZE];
+	} D_GCC_NEWTON_ALIGN_32;
+
+	static ndInt32 GetContactBatchType(const ndShapeInstance& instance0, const ndShapeInstance& instance1, bool& swapped);
+	static void SphereToSphereContactsSoa(ndContactBatch& batch);
+	static void SphereToBoxContactsSoa(ndContactBatch& batch);
+
 	ndInt32 ConvexContactsContinue(); // done
 	ndInt32 CompoundContactsContinue(); // done
 	ndInt32 ConvexToConvexContactsContinue(); // done
@@ -135,6 +174,7 @@ class ndContactSolver: public ndDownHeap<ndMinkFace *, ndFloat32>
 	void SupportVertex(const ndVector& dir, ndInt32 vertexIndex);
 
 	void TranslateSimplex(const ndVector& step);
+	ndFloat32 CalculateSpeculativeDistance() const;
 	void CalculateContactFromFeacture(ndInt32 featureType);
 
 	ndShapeInstance m_instance0;
@@ -166,6 +206,7 @@ class ndContactSolver: public ndDownHeap<ndMinkFace *, ndFloat32>
 	ndInt32 m_vertexIndex;
 	ndUnsigned32 m_pruneContacts		: 1;
 	ndUnsigned32 m_intersectionTestOnly	: 1;
+	ndUnsigned32 m_speculativeContacts	: 1;
 	
 	ndMinkFace* m_faceStack[D_CONVEX_MINK_STACK_SIZE];
 	ndMinkFace* m_coneFaceList[D_CONVEX_MINK_STACK_SIZE];
@@ -177,6 +218,7 @@ class ndContactSolver: public ndDownHeap<ndMinkFace *, ndFloat32>
 	static ndVector m_pruneSupportX;
 
 	static ndVector m_hullDirs[14]; 
+	static ndPrimitiveDispatch m_primitiveDispatch;
 	static ndInt32 m_rayCastSimplex[4][4];
 
 	friend class ndScene;
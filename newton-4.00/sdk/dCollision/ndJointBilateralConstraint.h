@@ -150,7 +150,9 @@ class ndJointBilateralConstraint : public ndConstraint
 	friend class ndModelArticulation;
 	friend class ndSkeletonContainer;
 	friend class ndDynamicsUpdateSoa;
+	friend class ndDynamicsUpdateGaussSeidel;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 	friend class ndDynamicsUpdateSycl;
 	friend class ndDynamicsUpdateCuda;
 };
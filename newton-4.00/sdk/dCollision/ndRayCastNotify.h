@@ -79,5 +79,16 @@ class ndRayCastClosestHitCallback: public ndRayCastNotify
 	}
 } D_GCC_NEWTON_ALIGN_32 ;
 
+// closest hit of one ray of a batch, m_body is nullptr and m_param is 1.2 if the ray missed
+D_MSV_NEWTON_ALIGN_32
+class ndRayCastHit
+{
+	public:
+	ndVector m_point;
+	ndVector m_normal;
+	const ndBodyKinematic* m_body;
+	ndInt64 m_shapeId;
+	ndFloat32 m_param;
+} D_GCC_NEWTON_ALIGN_32;
 
 #endif
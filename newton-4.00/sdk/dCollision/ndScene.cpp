@@ -40,6 +40,25 @@
 #define D_NARROW_PHASE_DIST			ndFloat32 (0.2f)
 #define D_CONTACT_TRANSLATION_ERROR	ndFloat32 (1.0e-3f)
 #define D_CONTACT_ANGULAR_ERROR		(ndFloat32 (0.25f * ndDegreeToRad))
+#define D_SCENE_PAIRS_GRAIN			16
+#define D_SCENE_CONTACTS_GRAIN		8
+#define D_SCENE_SPECULATIVE_GROUP	8
+#define D_SCENE_RAY_PACKET_SIZE		4
+#define D_SCENE_RAY_PACKET_GRAIN	4
+#define D_SCENE_RAY_MORTON_CELLS	512
+
+// growth of the bvh cost, relative to the cost right after 
+// the last build, that triggers a rotation pass or a rebuild
+#define D_BVH_ROTATE_COST_RATIO		ndFloat32 (1.1f)
+#define D_BVH_REBUILD_COST_RATIO	ndFloat32 (1.5f)
+
+// rotation passes allowed between two builds, and the most frames 
+// a tree is kept, refitted boxes never shrink until the next build.
+#define D_BVH_ROTATE_PASSES			8
+#define D_BVH_MAX_REBUILD_FRAMES	256
+
+// the cost sweeps all the awake nodes, so it is only sampled every few frames
+#define D_BVH_COST_SAMPLE_FRAMES	8
 
 ndVector ndScene::m_velocTol(ndFloat32(1.0e-16f));
 ndVector ndScene::m_angularContactError2(D_CONTACT_ANGULAR_ERROR * D_CONTACT_ANGULAR_ERROR);
@@ -50,30 +69,37 @@ ndScene::ndScene()
 	,m_bodyList()
 	,m_particleSetList()
 	,m_contactArray()
+	,m_contactPairMap()
 	,m_bvhSceneManager()
-	,m_scratchBuffer(1024 * sizeof (void*))
 	,m_sceneBodyArray(1024)
+	,m_activeBodyArray(1024)
+	,m_unfreezeQueue(256)
+	,m_freezeStack(256)
 	,m_activeConstraintArray(1024)
 	,m_specialUpdateList()
 	,m_backgroundThread()
 	,m_newPairs(1024)
+	,m_threadData()
 	,m_lock()
 	,m_rootNode(nullptr)
 	,m_sentinelBody(nullptr)
 	,m_contactNotifyCallback(new ndContactNotify(nullptr))
+	,m_frameContactArray(nullptr)
 	,m_timestep(ndFloat32 (0.0f))
 	,m_lru(D_CONTACT_DELAY_FRAMES)
 	,m_frameNumber(0)
 	,m_subStepNumber(0)
 	,m_forceBalanceSceneCounter(0)
+	,m_rotateScenePasses(0)
+	,m_freezeMark(0)
+	,m_frozenBodyCount(0)
+	,m_speculativeBudget(0)
+	,m_deterministic(false)
 {
 	m_sentinelBody = new ndBodySentinel;
 	m_contactNotifyCallback->m_scene = this;
 
-	for (ndInt32 i = 0; i < D_MAX_THREADS_COUNT; ++i)
-	{
-		m_partialNewPairs[i].Resize(256);
-	}
+	ResizeThreadData();
 }
 
 ndScene::ndScene(const ndScene& src)
@@ -81,31 +107,42 @@ ndScene::ndScene(const ndScene& src)
 	,m_bodyList(src.m_bodyList)
 	,m_particleSetList()
 	,m_contactArray(src.m_contactArray)
+	,m_contactPairMap(src.m_contactPairMap)
 	,m_bvhSceneManager(src.m_bvhSceneManager)
-	,m_scratchBuffer()
 	,m_sceneBodyArray()
+	,m_activeBodyArray()
+	,m_unfreezeQueue()
+	,m_freezeStack(256)
 	,m_activeConstraintArray()
 	,m_specialUpdateList()
 	,m_backgroundThread()
 	,m_newPairs(1024)
+	,m_threadData()
 	,m_lock()
 	,m_rootNode(nullptr)
 	,m_sentinelBody(nullptr)
 	,m_contactNotifyCallback(nullptr)
+	,m_frameContactArray(nullptr)
 	,m_timestep(ndFloat32(0.0f))
 	,m_lru(src.m_lru)
 	,m_frameNumber(src.m_frameNumber)
 	,m_subStepNumber(src.m_subStepNumber)
 	,m_forceBalanceSceneCounter(0)
+	,m_rotateScenePasses(0)
+	,m_freezeMark(src.m_freezeMark)
+	,m_frozenBodyCount(src.m_frozenBodyCount)
+	,m_speculativeBudget(src.m_speculativeBudget)
+	,m_deterministic(src.m_deterministic)
 {
 	ndScene* const stealData = (ndScene*)&src;
 
 	SetThreadCount(src.GetThreadCount());
 	m_backgroundThread.SetThreadCount(m_backgroundThread.GetThreadCount());
 
-	m_scratchBuffer.Swap(stealData->m_scratchBuffer);
 	m_sceneBodyArray.Swap(stealData->m_sceneBodyArray);
+	m_unfreezeQueue.Swap(stealData->m_unfreezeQueue);
 	m_activeConstraintArray.Swap(stealData->m_activeConstraintArray);
+	stealData->m_frozenBodyCount = 0;
 
 	ndSwap(m_rootNode, stealData->m_rootNode);
 	ndSwap(m_sentinelBody, stealData->m_sentinelBody);
@@ -141,10 +178,7 @@ ndScene::ndScene(const ndScene& src)
 		ndAssert (body->GetContactMap().SanityCheck());
 	}
 
-	for (ndInt32 i = 0; i < D_MAX_THREADS_COUNT; ++i)
-	{
-		m_partialNewPairs[i].Resize(256);
-	}
+	ResizeThreadData();
 }
 
 ndScene::~ndScene()
@@ -155,9 +189,42 @@ ndScene::~ndScene()
 	{
 		delete m_contactNotifyCallback;
 	}
+	for (ndInt32 i = 0; i < m_threadData.GetCount(); ++i)
+	{
+		delete m_threadData[i];
+	}
 	ndFreeListAlloc::Flush();
 }
 
+void ndScene::SetThreadCount(ndInt32 count)
+{
+	ndThreadPool::SetThreadCount(count);
+	ResizeThreadData();
+}
+
+void ndScene::ResizeThreadData()
+{
+	const ndInt32 threadCount = GetThreadCount();
+	for (ndInt32 i = m_threadData.GetCount() - 1; i >= threadCount; --i)
+	{
+		delete m_threadData[i];
+	}
+	for (ndInt32 i = m_threadData.GetCount(); i < threadCount; ++i)
+	{
+		m_threadData.PushBack(new ndThreadData);
+	}
+	m_threadData.SetCount(threadCount);
+}
+
+void ndScene::ResetFrameArenas()
+{
+	for (ndInt32 i = m_threadData.GetCount() - 1; i >= 0; --i)
+	{
+		m_threadData[i]->m_frameArena.Reset();
+	}
+	m_frameContactArray = nullptr;
+}
+
 void ndScene::Sync()
 {
 	ndThreadPool::Sync();
@@ -196,6 +263,15 @@ ndContactNotify* ndScene::GetContactNotify() const
 	return m_contactNotifyCallback;
 }
 
+void ndScene::SetBvhBuildMethod(ndBvhSceneManager::ndBuildMethod method)
+{
+	if (method != m_bvhSceneManager.GetBuildMethod())
+	{
+		m_bvhSceneManager.SetBuildMethod(method);
+		m_forceBalanceSceneCounter = 0;
+	}
+}
+
 void ndScene::SetContactNotify(ndContactNotify* const notify)
 {
 	ndAssert(m_contactNotifyCallback);
@@ -277,10 +353,39 @@ bool ndScene::RemoveBody(const ndSharedPtr<ndBody>& body)
 		m_forceBalanceSceneCounter = 0;
 		m_bvhSceneManager.RemoveBody(kinematicBody);
 
+		if (kinematicBody->m_isFrozen)
+		{
+			m_frozenBodyCount--;
+			kinematicBody->m_isFrozen = 0;
+		}
+		if (kinematicBody->m_unfreezeQueued)
+		{
+			ndScopeSpinLock lock(m_lock);
+			for (ndInt32 i = m_unfreezeQueue.GetCount() - 1; i >= 0; --i)
+			{
+				if (m_unfreezeQueue[i] == kinematicBody)
+				{
+					m_unfreezeQueue[i] = m_unfreezeQueue[m_unfreezeQueue.GetCount() - 1];
+					m_unfreezeQueue.SetCount(m_unfreezeQueue.GetCount() - 1);
+					break;
+				}
+			}
+			kinematicBody->m_unfreezeQueued = 0;
+		}
+		kinematicBody->m_hasFrozenContacts = 0;
+
 		ndBodyKinematic::ndContactMap& contactMap = kinematicBody->GetContactMap();
-		while (contactMap.GetRoot())
+		while (contactMap.GetCount())
 		{
-			ndContact* const contact = contactMap.GetRoot()->GetInfo();
+			ndContact* const contact = contactMap[contactMap.GetCount() - 1];
+			m_contactPairMap.Remove(contact);
+			if (contact->m_isFrozen)
+			{
+				// frozen contacts are only owned by the bodies, hand them back 
+				// to the contact array so they get deleted with the dead ones.
+				contact->m_isFrozen = 0;
+				m_contactArray.PushBack(contact);
+			}
 			m_contactArray.DetachContact(contact);
 		}
 
@@ -314,12 +419,42 @@ void ndScene::BalanceScene()
 	UpdateBodyList();
 	if (m_bvhSceneManager.GetNodeArray().GetCount() > 2)
 	{
+		if (m_forceBalanceSceneCounter)
+		{
+			// refitting keeps the topology, as bodies move around the tree 
+			// degrades, rotations fix local damage, a rebuild fixes the rest.
+			m_forceBalanceSceneCounter++;
+			if (m_forceBalanceSceneCounter > D_BVH_MAX_REBUILD_FRAMES)
+			{
+				m_forceBalanceSceneCounter = 0;
+			}
+			else if (!(m_forceBalanceSceneCounter % D_BVH_COST_SAMPLE_FRAMES))
+			{
+				const ndFloat32 cost = m_bvhSceneManager.CalculateCost(*this, m_rootNode);
+				const ndFloat32 buildCost = m_bvhSceneManager.GetBuildCost();
+				if (cost > buildCost * D_BVH_REBUILD_COST_RATIO)
+				{
+					m_forceBalanceSceneCounter = 0;
+				}
+				else if (m_rotateScenePasses && (cost > buildCost * D_BVH_ROTATE_COST_RATIO))
+				{
+					// once a pass finds nothing to rotate, the tree 
+					// is only refitted until the next rebuild.
+					m_rotateScenePasses--;
+					if (!m_bvhSceneManager.RotateScene(*this))
+					{
+						m_rotateScenePasses = 0;
+					}
+				}
+			}
+		}
+
 		if (!m_forceBalanceSceneCounter)
 		{
 			m_rootNode = m_bvhSceneManager.BuildBvhTree(*this);
+			m_forceBalanceSceneCounter = 1;
+			m_rotateScenePasses = D_BVH_ROTATE_PASSES;
 		}
-		const ndInt32 sceneUpdatePeriod = 64;
-		m_forceBalanceSceneCounter = (m_forceBalanceSceneCounter < sceneUpdatePeriod) ? m_forceBalanceSceneCounter + 1 : 0;
 		ndAssert(!m_rootNode || !m_rootNode->m_parent);
 	}
 
@@ -375,7 +510,7 @@ bool ndScene::ValidateContactCache(ndContact* const contact, const ndVector& tim
 	return false;
 }
 
-void ndScene::CalculateJointContacts(ndInt32 threadIndex, ndContact* const contact)
+void ndScene::CalculateJointContacts(ndInt32 threadIndex, ndContact* const contact, bool speculativeContacts)
 {
 	ndBodyKinematic* const body0 = contact->GetBody0();
 	ndBodyKinematic* const body1 = contact->GetBody1();
@@ -398,7 +533,17 @@ void ndScene::CalculateJointContacts(ndInt32 threadIndex, ndContact* const conta
 		contactSolver.m_contactBuffer = contactBuffer;
 		contactSolver.m_intersectionTestOnly = body0->m_contactTestOnly | body1->m_contactTestOnly;
 
+		// speculative pairs run the discrete narrow phase with a wider contact distance
+		const bool speculative = speculativeContacts && (body0->m_speculativeContacts | body1->m_speculativeContacts) && !contactSolver.m_intersectionTestOnly;
+		contactSolver.m_speculativeContacts = speculative ? 1 : 0;
+
 		ndInt32 count = contactSolver.CalculateContactsDiscrete ();
+		if (speculative)
+		{
+			D_FRAME_STATS_COUNT(m_speculativePairs, 1);
+		}
+		D_FRAME_STATS_COUNT(m_pairsTested, 1);
+		D_FRAME_STATS_COUNT(m_contactsGenerated, count);
 		if (count)
 		{
 			contact->SetActive(true);
@@ -422,7 +567,7 @@ void ndScene::CalculateJointContacts(ndInt32 threadIndex, ndContact* const conta
 			else
 			{
 				ndAssert(count <= (D_CONSTRAINT_MAX_ROWS / 3));
-				ProcessContacts(threadIndex, count, &contactSolver);
+				ProcessContacts(threadIndex, count, contact, contactBuffer);
 				ndAssert(contact->m_maxDof);
 				contact->m_isIntersetionTestOnly = 0;
 			}
@@ -452,9 +597,8 @@ void ndScene::CalculateJointContacts(ndInt32 threadIndex, ndContact* const conta
 	}
 }
 
-void ndScene::ProcessContacts(ndInt32, ndInt32 contactCount, ndContactSolver* const contactSolver)
+void ndScene::ProcessContacts(ndInt32, ndInt32 contactCount, ndContact* const contact, const ndContactPoint* const contactArray)
 {
-	ndContact* const contact = contactSolver->m_contact;
 	contact->m_positAcc = ndVector::m_zero;
 	contact->m_rotationAcc = ndQuaternion();
 
@@ -465,18 +609,76 @@ void ndScene::ProcessContacts(ndInt32, ndInt32 contactCount, ndContactSolver* co
 	ndAssert(body0 != body1);
 
 	contact->m_material = m_contactNotifyCallback->GetMaterial(contact, body0->GetCollisionShape(), body1->GetCollisionShape());
-	const ndContactPoint* const contactArray = contactSolver->m_contactBuffer;
 	
-	ndInt32 count = 0;
-	ndVector cachePosition[D_MAX_CONTATCS];
-	ndContactPointList::ndNode* nodes[D_MAX_CONTATCS];
+	// only the forces of the previous points are reused, to warm start the solver
 	ndContactPointList& contactPointList = contact->m_contacPointsList;
-	for (ndContactPointList::ndNode* contactNode = contactPointList.GetFirst(); contactNode; contactNode = contactNode->GetNext()) 
+	const ndInt32 cacheCount = contactPointList.GetCount();
+	ndInt32 slots[D_MAX_CONTACT_POINTS];
+	ndVector cachePosition[D_MAX_CONTACT_POINTS];
+	ndForceImpactPair cacheForce[D_MAX_CONTACT_POINTS][3];
+	for (ndInt32 i = 0; i < cacheCount; ++i)
+	{
+		const ndContactMaterial& contactPoint = contactPointList[i];
+		slots[i] = i;
+		cachePosition[i] = contactPoint.m_point;
+		cacheForce[i][0] = contactPoint.m_normal_Force;
+		cacheForce[i][1] = contactPoint.m_dir0_Force;
+		cacheForce[i][2] = contactPoint.m_dir1_Force;
+	}
+
+	// match each new point with the closest previous one
+	ndInt32 count = cacheCount;
+	ndInt32 matchSlot[D_MAX_CONTACT_POINTS];
+	ndAssert(contactCount <= D_MAX_CONTACT_POINTS);
+	for (ndInt32 i = 0; i < contactCount; ++i)
+	{
+		ndInt32 index = -1;
+		ndFloat32 min = ndFloat32(1.0e20f);
+		for (ndInt32 j = 0; j < count; ++j)
+		{
+			ndVector v(ndVector::m_triplexMask & (cachePosition[j] - contactArray[i].m_point));
+			ndAssert(v.m_w == ndFloat32(0.0f));
+			const ndFloat32 dist = v.DotProduct(v).GetScalar();
+			if (dist < min)
+			{
+				index = j;
+				min = dist;
+			}
+		}
+
+		matchSlot[i] = -1;
+		if (index != -1)
+		{
+			count--;
+			matchSlot[i] = slots[index];
+			slots[index] = slots[count];
+			cachePosition[index] = cachePosition[count];
+		}
+	}
+
+	// matched points keep the order of their previous rows, new points go last, 
+	// so the solver sees the rows in the same order from frame to frame.
+	ndInt32 slotRow[D_MAX_CONTACT_POINTS];
+	for (ndInt32 i = 0; i < cacheCount; ++i)
+	{
+		slotRow[i] = -1;
+	}
+	for (ndInt32 i = 0; i < contactCount; ++i)
+	{
+		if (matchSlot[i] != -1)
+		{
+			slotRow[matchSlot[i]] = 0;
+		}
+	}
+	ndInt32 rowCount = 0;
+	for (ndInt32 i = 0; i < cacheCount; ++i)
 	{
-		nodes[count] = contactNode;
-		cachePosition[count] = contactNode->GetInfo().m_point;
-		count++;
+		if (slotRow[i] != -1)
+		{
+			slotRow[i] = rowCount++;
+		}
 	}
+	contactPointList.SetCount(contactCount);
 	
 	const ndVector& v0 = body0->m_veloc;
 	const ndVector& w0 = body0->m_omega;
@@ -520,35 +722,21 @@ void ndScene::ProcessContacts(ndInt32, ndInt32 contactCount, ndContactSolver* co
 	ndFloat32 maxImpulse = ndFloat32(-1.0f);
 	for (ndInt32 i = 0; i < contactCount; ++i) 
 	{
-		ndInt32 index = -1;
-		ndFloat32 min = ndFloat32(1.0e20f);
-		ndContactPointList::ndNode* contactNode = nullptr;
-		for (ndInt32 j = 0; j < count; ++j) 
-		{
-			ndVector v(ndVector::m_triplexMask & (cachePosition[j] - contactArray[i].m_point));
-			ndAssert(v.m_w == ndFloat32(0.0f));
-			diff = v.DotProduct(v).GetScalar();
-			if (diff < min) 
-			{
-				index = j;
-				min = diff;
-				contactNode = nodes[j];
-			}
-		}
-	
-		if (contactNode) 
+		const ndInt32 slot = matchSlot[i];
+		const ndInt32 row = (slot != -1) ? slotRow[slot] : rowCount++;
+		ndContactMaterial* const contactPoint = &contactPointList[row];
+		if (slot != -1) 
 		{
-			count--;
-			ndAssert(index != -1);
-			nodes[index] = nodes[count];
-			cachePosition[index] = cachePosition[count];
+			contactPoint->m_normal_Force = cacheForce[slot][0];
+			contactPoint->m_dir0_Force = cacheForce[slot][1];
+			contactPoint->m_dir1_Force = cacheForce[slot][2];
 		}
 		else 
 		{
-			contactNode = contactPointList.Append();
+			contactPoint->m_normal_Force.Clear();
+			contactPoint->m_dir0_Force.Clear();
+			contactPoint->m_dir1_Force.Clear();
 		}
-
-		ndContactMaterial* const contactPoint = &contactNode->GetInfo();
 	
 		ndAssert(ndCheckFloat(contactArray[i].m_point.m_x));
 		ndAssert(ndCheckFloat(contactArray[i].m_point.m_y));
@@ -639,68 +827,78 @@ void ndScene::ProcessContacts(ndInt32, ndInt32 contactCount, ndContactSolver* co
 		ndAssert(contactPoint->m_normal.m_w == ndFloat32(0.0f));
 	}
 	
-	for (ndInt32 i = 0; i < count; ++i) 
-	{
-		contactPointList.Remove(nodes[i]);
-	}
-	
 	//contact->m_maxDof = ndUnsigned32(3 * contactPointList.GetCount());
 	contact->m_maxDof = ndUnsigned8(3 * contactPointList.GetCount());
 	m_contactNotifyCallback->OnContactCallback(contact, m_timestep);
 }
 
-void ndScene::SubmitPairs(ndBvhLeafNode* const leafNode, ndBvhNode* const node, bool forward, ndInt32 threadId)
+void ndScene::SubmitPairs(ndBodyKinematic* const body0, bool sceneBody, ndInt32 threadId)
 {
-	ndBvhNode* pool[D_SCENE_MAX_STACK_DEPTH];
+	// leaves are numbered in depth first order, a body pairs with the leaves after it.
+	// when only the bodies that left their leaf box are queried, they also pair with 
+	// the leaves before them that did not, and the children ending before the
+	// body can not be skipped.
+	const ndBvhFlatTree& tree = m_bvhSceneManager.GetFlatTree();
+	const ndBvhLeafNode* const leafNode = m_bvhSceneManager.GetLeafNode(body0);
+	const ndInt32 order0 = tree.GetLeafOrder(body0);
+	const ndUnsigned8 test0 = ndUnsigned8(!body0->m_equilibrium);
 
-	ndBodyKinematic* const body0 = leafNode->GetBody() ? leafNode->GetBody() : nullptr;
-	ndAssert(body0);
+	// frozen bodies are not in the active array and never submit pairs, so a 
+	// moving body also enters the children before it that have frozen leaves.
+	const ndInt32 frozenMask = test0 ? -1 : 0;
 
-	const ndVector boxP0(leafNode->m_minBox);
-	const ndVector boxP1(leafNode->m_maxBox);
-	//const bool test0 = (body0->m_invMass.m_w != ndFloat32(0.0f)) & body0->GetCollisionShape().GetCollisionMode();
-	const ndUnsigned8 test0 = ndUnsigned8(!body0->m_equilibrium);
+	ndVector minBox[3];
+	ndVector maxBox[3];
+	for (ndInt32 i = 0; i < 3; ++i)
+	{
+		minBox[i] = ndVector(leafNode->m_minBox[i]);
+		maxBox[i] = ndVector(leafNode->m_maxBox[i]);
+	}
 
-	pool[0] = node;
+	ndInt32 pool[D_SCENE_MAX_STACK_DEPTH];
+	pool[0] = 0;
 	ndInt32 stack = 1;
 	while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 16)))
 	{
 		stack--;
-		ndBvhNode* const rootNode = pool[stack];
-		if (ndOverlapTest(rootNode->m_minBox, rootNode->m_maxBox, boxP0, boxP1)) 
+		const ndBvhFlatNode& node = tree.m_nodes[pool[stack]];
+		const ndInt32 mask = node.OverlapTest(minBox, maxBox);
+		for (ndInt32 i = 0; i < 4; ++i)
 		{
-			if (rootNode->GetAsSceneBodyNode()) 
+			if ((mask & (1 << i)) && (sceneBody || (node.m_lastLeaf[i] > order0) || (node.m_frozenMask & frozenMask & (1 << i))))
 			{
-				ndAssert(!rootNode->GetRight());
-				ndAssert(!rootNode->GetLeft());
-				
-				ndBodyKinematic* const body1 = rootNode->GetBody();
-				ndAssert(body1);
-				if (body1->m_sceneEquilibrium || forward)
+				const ndInt32 child = node.m_children[i];
+				if (child >= 0)
+				{
+					pool[stack] = child;
+					stack++;
+					ndAssert(stack < ndInt32(sizeof(pool) / sizeof(pool[0])));
+				}
+				else
 				{
-					//const bool test1 = (body1->m_invMass.m_w != ndFloat32(0.0f)) & body1->GetCollisionShape().GetCollisionMode();
-					const ndUnsigned8 test1 = ndUnsigned8(!body1->m_equilibrium);
-					const ndUnsigned8 test = ndUnsigned8(test0 | test1);
-					if (test)
+					const ndInt32 order1 = -child - 1;
+					ndBodyKinematic* const body1 = tree.m_bodies[order1];
+					ndAssert(body1);
+					if ((order1 > order0) || ((order1 < order0) && ((sceneBody && body1->m_sceneEquilibrium) || body1->m_isFrozen)))
 					{
-						AddPair(body0, body1, threadId);
+						const ndUnsigned8 test1 = ndUnsigned8(!body1->m_equilibrium);
+						const ndUnsigned8 test = ndUnsigned8(test0 | test1);
+						if (test)
+						{
+							if (body1->m_isFrozen)
+							{
+								// the island is woken up at the start of the next 
+								// step, the pair will be found again then.
+								UnfreezeBody(body1);
+							}
+							else
+							{
+								AddPair(body0, body1, threadId);
+							}
+						}
 					}
 				}
 			}
-			else 
-			{
-				ndBvhInternalNode* const tmpNode = rootNode->GetAsSceneTreeNode();
-				ndAssert(tmpNode->m_left);
-				ndAssert(tmpNode->m_right);
-		
-				pool[stack] = tmpNode->m_left;
-				stack++;
-				ndAssert(stack < ndInt32(sizeof(pool) / sizeof(pool[0])));
-		
-				pool[stack] = tmpNode->m_right;
-				stack++;
-				ndAssert(stack < ndInt32(sizeof(pool) / sizeof(pool[0])));
-			}
 		}
 	}
 
@@ -737,54 +935,6 @@ ndJointBilateralConstraint* ndScene::FindBilateralJoint(ndBodyKinematic* const b
 	return nullptr;
 }
 
-void ndScene::FindCollidingPairs(ndBodyKinematic* const body, ndInt32 threadId)
-{
-	ndBvhLeafNode* const bodyNode = m_bvhSceneManager.GetLeafNode(body);
-	ndAssert(bodyNode->GetAsSceneBodyNode());
-	for (ndBvhNode* ptr = bodyNode; ptr->m_parent; ptr = ptr->m_parent)
-	{
-		ndBvhInternalNode* const parent = ptr->m_parent->GetAsSceneTreeNode();
-		ndAssert(!parent->GetAsSceneBodyNode());
-		ndBvhNode* const sibling = parent->m_right;
-		if (sibling != ptr)
-		{
-			SubmitPairs(bodyNode, sibling, true, threadId);
-		}
-	}
-}
-
-void ndScene::FindCollidingPairsForward(ndBodyKinematic* const body, ndInt32 threadId)
-{
-	ndBvhLeafNode* const bodyNode = m_bvhSceneManager.GetLeafNode(body);
-	ndAssert(bodyNode->GetAsSceneBodyNode());
-	for (ndBvhNode* ptr = bodyNode; ptr->m_parent; ptr = ptr->m_parent)
-	{
-		ndBvhInternalNode* const parent = ptr->m_parent->GetAsSceneTreeNode();
-		ndAssert(!parent->GetAsSceneBodyNode());
-		ndBvhNode* const sibling = parent->m_right;
-		if (sibling != ptr)
-		{
-			SubmitPairs(bodyNode, sibling, true, threadId);
-		}
-	}
-}
-
-void ndScene::FindCollidingPairsBackward(ndBodyKinematic* const body, ndInt32 threadId)
-{
-	ndBvhLeafNode* const bodyNode = m_bvhSceneManager.GetLeafNode(body);
-	ndAssert(bodyNode->GetAsSceneBodyNode());
-	for (ndBvhNode* ptr = bodyNode; ptr->m_parent; ptr = ptr->m_parent)
-	{
-		ndBvhInternalNode* const parent = ptr->m_parent->GetAsSceneTreeNode();
-		ndAssert(!parent->GetAsSceneBodyNode());
-		ndBvhNode* const sibling = parent->m_left;
-		if (sibling != ptr)
-		{
-			SubmitPairs(bodyNode, sibling, false, threadId);
-		}
-	}
-}
-
 void ndScene::UpdateTransform()
 {
 	D_TRACKTIME();
@@ -823,9 +973,9 @@ void ndScene::CalculateContacts(ndInt32 threadIndex, ndContact* const contact)
 	ndBodyKinematic* const body1 = contact->GetBody1();
 
 	ndAssert(!contact->m_isDead);
+	const bool active = contact->IsActive();
 	if (!(body0->m_equilibrium & body1->m_equilibrium))
 	{
-		bool active = contact->IsActive();
 		if (ValidateContactCache(contact, deltaTime))
 		{
 			contact->m_sceneLru = m_lru;
@@ -858,7 +1008,12 @@ void ndScene::CalculateContacts(ndInt32 threadIndex, ndContact* const contact)
 			}
 			if (distance < D_NARROW_PHASE_DIST)
 			{
-				CalculateJointContacts(threadIndex, contact);
+				if (AddBatchedContact(threadIndex, contact, active) || AddSpeculativeContact(threadIndex, contact, active))
+				{
+					// CalculateBatchedContacts or CalculateSpeculativeContacts finishes this contact
+					return;
+				}
+				CalculateJointContacts(threadIndex, contact, true);
 				//if (contact->m_maxDOF || contact->m_isIntersetionTestOnly)
 				if (contact->m_maxDof || contact->m_isIntersetionTestOnly)
 				{
@@ -883,21 +1038,27 @@ void ndScene::CalculateContacts(ndInt32 threadIndex, ndContact* const contact)
 				}
 			}
 		}
-
-		if (active ^ contact->IsActive())
-		{
-			ndAssert(body0->GetInvMass() > ndFloat32(0.0f));
-			body0->m_equilibrium = 0;
-			if (body1->GetInvMass() > ndFloat32(0.0f))
-			{
-				body1->m_equilibrium = 0;
-			}
-		}
 	}
 	else
 	{
 		contact->m_sceneLru = m_lru;
 	}
+	UpdateContactState(contact, active);
+}
+
+void ndScene::UpdateContactState(ndContact* const contact, bool active)
+{
+	ndBodyKinematic* const body0 = contact->GetBody0();
+	ndBodyKinematic* const body1 = contact->GetBody1();
+	if (active ^ contact->IsActive())
+	{
+		ndAssert(body0->GetInvMass() > ndFloat32(0.0f));
+		body0->m_equilibrium = 0;
+		if (body1->GetInvMass() > ndFloat32(0.0f))
+		{
+			body1->m_equilibrium = 0;
+		}
+	}
 
 	if (!contact->m_isDead && (body0->m_equilibrium & body1->m_equilibrium & !contact->IsActive()))
 	{
@@ -912,126 +1073,336 @@ void ndScene::CalculateContacts(ndInt32 threadIndex, ndContact* const contact)
 	}
 }
 
-void ndScene::UpdateSpecial()
+bool ndScene::AddBatchedContact(ndInt32 threadIndex, ndContact* const contact, bool active)
 {
-	for (ndSpecialList<ndBodyKinematic>::ndNode* node = m_specialUpdateList.GetFirst(); node; node = node->GetNext())
+	const ndBodyKinematic* const body0 = contact->GetBody0();
+	const ndBodyKinematic* const body1 = contact->GetBody1();
+	if (body0->m_contactTestOnly | body1->m_contactTestOnly | body0->m_speculativeContacts | body1->m_speculativeContacts)
 	{
-		ndBodyKinematic* const body = node->GetInfo();
-		body->SpecialUpdate(m_timestep);
+		return false;
 	}
+
+	bool swapped = false;
+	const ndInt32 type = ndContactSolver::GetContactBatchType(body0->GetCollisionShape(), body1->GetCollisionShape(), swapped);
+	if (type < 0)
+	{
+		return false;
+	}
+
+	ndBatchedContact entry;
+	entry.m_contact = contact;
+	entry.m_active = active;
+	entry.m_swapped = swapped;
+	m_threadData[threadIndex]->m_contactBatches[type].PushBack(entry);
+	return true;
 }
 
-bool ndScene::ConvexCast(ndConvexCastNotify& callback, const ndBvhNode** stackPool, ndFloat32* const stackDistance, ndInt32 stack, const ndFastRay& ray, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const
+void ndScene::ProcessBatchedContact(ndInt32 threadIndex, const ndContactSolver::ndContactBatch& batch, ndInt32 lane, bool active)
 {
-	ndVector boxP0;
-	ndVector boxP1;
+	// same as CalculateJointContacts followed by the end of CalculateContacts, 
+	// for a pair that makes at most one contact point
+	ndContact* const contact = batch.m_contacts[lane];
+	ndAssert(contact->m_material);
+	if (m_contactNotifyCallback->OnAabbOverlap(contact, m_timestep))
+	{
+		const ndVector separatingVector(batch.m_normal[0][lane], batch.m_normal[1][lane], batch.m_normal[2][lane], ndFloat32(0.0f));
+		const ndFloat32 separation = batch.m_separation[lane];
+		contact->m_timeOfImpact = m_timestep;
+		contact->m_separatingVector = separatingVector;
+		contact->m_separationDistance = separation;
+
+		const ndInt32 count = (separation <= ndFloat32(1.0e-5f)) ? 1 : 0;
+		D_FRAME_STATS_COUNT(m_pairsTested, 1);
+		D_FRAME_STATS_COUNT(m_contactsGenerated, count);
+		if (count)
+		{
+			ndBodyKinematic* const body0 = contact->GetBody0();
+			ndBodyKinematic* const body1 = contact->GetBody1();
+
+			ndContactPoint contactPoint;
+			contactPoint.m_point = ndVector(batch.m_point[0][lane], batch.m_point[1][lane], batch.m_point[2][lane], ndFloat32(1.0f));
+			contactPoint.m_normal = separatingVector * ndVector::m_negOne;
+			contactPoint.m_body0 = body0;
+			contactPoint.m_body1 = body1;
+			contactPoint.m_shapeInstance0 = &body0->GetCollisionShape();
+			contactPoint.m_shapeInstance1 = &body1->GetCollisionShape();
+			contactPoint.m_shapeId0 = 0;
+			contactPoint.m_shapeId1 = 0;
+			contactPoint.m_penetration = -separation;
 
-	ndAssert(globalOrigin.TestOrthogonal());
-	convexShape.CalculateAabb(globalOrigin, boxP0, boxP1);
-	
-	callback.m_contacts.SetCount(0);
-	callback.m_param = ndFloat32(1.2f);
-	callback.m_cachedScene = (ndScene*)this;
-	while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 4)))
+			contact->SetActive(true);
+			ProcessContacts(threadIndex, count, contact, &contactPoint);
+			ndAssert(contact->m_maxDof);
+			contact->m_isIntersetionTestOnly = 0;
+		}
+		else
+		{
+			contact->m_maxDof = 0;
+		}
+	}
+
+	if (contact->m_maxDof || contact->m_isIntersetionTestOnly)
 	{
-		stack--;
-		ndFloat32 dist = stackDistance[stack];
-		
-		if (dist > callback.m_param)
+		contact->SetActive(true);
+		contact->m_timeOfImpact = ndFloat32(1.0e10f);
+	}
+	contact->m_sceneLru = m_lru;
+	UpdateContactState(contact, active);
+}
+
+void ndScene::CalculateBatchedContacts()
+{
+	D_TRACKTIME();
+	for (ndInt32 type = 0; type < ndContactSolver::m_contactBatchCount; ++type)
+	{
+		ndInt32 count = 0;
+		for (ndInt32 i = 0; i < m_threadData.GetCount(); ++i)
 		{
-			break;
+			count += m_threadData[i]->m_contactBatches[type].GetCount();
 		}
-		else 
+		if (!count)
 		{
-			const ndBvhNode* const me = stackPool[stack];
-		
-			ndBody* const body = me->GetBody();
-			if (body) 
+			continue;
+		}
+
+		ndInt32 base = 0;
+		ndBatchedContact* const entries = GetFrameArena().Alloc<ndBatchedContact>(count);
+		for (ndInt32 i = 0; i < m_threadData.GetCount(); ++i)
+		{
+			const ndArray<ndBatchedContact>& batch = m_threadData[i]->m_contactBatches[type];
+			for (ndInt32 j = 0; j < batch.GetCount(); ++j)
 			{
-				if (callback.OnRayPrecastAction (body, &convexShape)) 
-				{
-					// save contacts and try new set
-					ndConvexCastNotify savedNotification(callback);
-					ndBodyKinematic* const kinBody = body->GetAsBodyKinematic();
-					callback.m_contacts.SetCount(0);
-					if (callback.CastShape(convexShape, globalOrigin, globalDest, kinBody))
-					{
-						// found new contacts, see how the are managed
-						if (ndAbs(savedNotification.m_param - callback.m_param) < ndFloat32(-1.0e-3f))
-						{
-							// merge contact
-							for (ndInt32 i = 0; i < savedNotification.m_contacts.GetCount(); ++i)
-							{
-								const ndContactPoint& contact = savedNotification.m_contacts[i];
-								bool newPoint = true;
-								for (ndInt32 j = callback.m_contacts.GetCount() - 1; j >= 0; ++j)
-								{
-									const ndVector diff(callback.m_contacts[j].m_point - contact.m_point);
-									ndFloat32 mag2 = diff.DotProduct(diff & ndVector::m_triplexMask).GetScalar();
-									newPoint = newPoint & (mag2 > ndFloat32(1.0e-5f));
-								}
-								if (newPoint && (callback.m_contacts.GetCount() < callback.m_contacts.GetCapacity()))
-								{
-									callback.m_contacts.PushBack(contact);
-								}
-							}
-						}
-						else if (callback.m_param > savedNotification.m_param)
-						{
-							// restore contacts
-							callback.m_normal = savedNotification.m_normal;
-							callback.m_closestPoint0 = savedNotification.m_closestPoint0;
-							callback.m_closestPoint1 = savedNotification.m_closestPoint1;
-							callback.m_param = savedNotification.m_param;
-							for (ndInt32 i = 0; i < savedNotification.m_contacts.GetCount(); ++i)
-							{
-								callback.m_contacts[i] = savedNotification.m_contacts[i];
-							}
-						}
-					}
-					else
-					{
-						// no new contacts restore old ones,
-						// in theory it should no copy, by the notification may change
-						// the previous found contacts
-						callback.m_normal = savedNotification.m_normal;
-						callback.m_closestPoint0 = savedNotification.m_closestPoint0;
-						callback.m_closestPoint1 = savedNotification.m_closestPoint1;
-						callback.m_param = savedNotification.m_param;
-						for (ndInt32 i = 0; i < savedNotification.m_contacts.GetCount(); ++i)
-						{
-							callback.m_contacts[i] = savedNotification.m_contacts[i];
-						}
-					}
+				entries[base + j] = batch[j];
+			}
+			base += batch.GetCount();
+		}
 
-					if (callback.m_param < ndFloat32 (1.0e-8f)) 
-					{
-						break;
-					}
-				}
+		auto CalculateBatch = [this, entries, count, type](ndInt32 threadIndex, ndInt32 group)
+		{
+			// the unused lanes of the last group repeat the first pair
+			const ndInt32 start = group * D_CONTACT_BATCH_SIZE;
+			const ndInt32 lanes = ndMin(count - start, D_CONTACT_BATCH_SIZE);
+			ndContactSolver::ndContactBatch batch;
+			for (ndInt32 i = 0; i < D_CONTACT_BATCH_SIZE; ++i)
+			{
+				const ndBatchedContact& entry = entries[start + ((i < lanes) ? i : 0)];
+				batch.m_contacts[i] = entry.m_contact;
+				batch.m_swapped[i] = entry.m_swapped;
 			}
-			else 
+
+			if (type == ndContactSolver::m_sphereToSphereBatch)
 			{
-				{
-					const ndBvhNode* const left = me->GetLeft();
-					ndAssert(left);
-					const ndVector minBox(left->m_minBox - boxP1);
-					const ndVector maxBox(left->m_maxBox - boxP0);
-					ndFloat32 dist1 = ray.BoxIntersect(minBox, maxBox);
-					if (dist1 < callback.m_param)
-					{
-						ndInt32 j = stack;
-						for (; j && (dist1 > stackDistance[j - 1]); j--)
-						{
-							stackPool[j] = stackPool[j - 1];
-							stackDistance[j] = stackDistance[j - 1];
-						}
-						stackPool[j] = left;
-						stackDistance[j] = dist1;
-						stack++;
-						ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
-					}
-				}
+				ndContactSolver::SphereToSphereContactsSoa(batch);
+			}
+			else
+			{
+				ndAssert(type == ndContactSolver::m_sphereToBoxBatch);
+				ndContactSolver::SphereToBoxContactsSoa(batch);
+			}
+
+			for (ndInt32 i = 0; i < lanes; ++i)
+			{
+				ProcessBatchedContact(threadIndex, batch, i, entries[start + i].m_active);
+			}
+		};
+		ParallelFor(0, (count + D_CONTACT_BATCH_SIZE - 1) / D_CONTACT_BATCH_SIZE, D_SCENE_CONTACTS_GRAIN / D_CONTACT_BATCH_SIZE, CalculateBatch);
+	}
+}
+
+bool ndScene::AddSpeculativeContact(ndInt32 threadIndex, ndContact* const contact, bool active)
+{
+	// without a budget, or in deterministic mode, the speculative pairs are not deferred
+	const ndBodyKinematic* const body0 = contact->GetBody0();
+	const ndBodyKinematic* const body1 = contact->GetBody1();
+	if (m_deterministic || !m_speculativeBudget || !(body0->m_speculativeContacts | body1->m_speculativeContacts) || (body0->m_contactTestOnly | body1->m_contactTestOnly))
+	{
+		return false;
+	}
+
+	ndBatchedContact entry;
+	entry.m_contact = contact;
+	entry.m_active = active;
+	entry.m_swapped = false;
+	m_threadData[threadIndex]->m_speculativeContacts.PushBack(entry);
+	return true;
+}
+
+void ndScene::CalculateSpeculativeContacts()
+{
+	D_TRACKTIME();
+	ndInt32 count = 0;
+	for (ndInt32 i = 0; i < m_threadData.GetCount(); ++i)
+	{
+		count += m_threadData[i]->m_speculativeContacts.GetCount();
+	}
+	if (!count)
+	{
+		return;
+	}
+
+	ndInt32 base = 0;
+	ndBatchedContact* const entries = GetFrameArena().Alloc<ndBatchedContact>(count);
+	for (ndInt32 i = 0; i < m_threadData.GetCount(); ++i)
+	{
+		ndArray<ndBatchedContact>& pairs = m_threadData[i]->m_speculativeContacts;
+		for (ndInt32 j = 0; j < pairs.GetCount(); ++j)
+		{
+			entries[base + j] = pairs[j];
+		}
+		base += pairs.GetCount();
+		pairs.SetCount(0);
+	}
+
+	// the budget is the time of the whole pass, the clock is read once per group of pairs. 
+	// once it runs out the remaining pairs of this step get plain discrete contacts.
+	const ndUnsigned64 startTicks = ndFrameStatsCollector::GetTicks();
+	const ndUnsigned64 budgetTicks = m_speculativeBudget * 1000;
+	auto CalculateGroup = [this, entries, count, startTicks, budgetTicks](ndInt32 threadIndex, ndInt32 group)
+	{
+		const bool speculative = (ndFrameStatsCollector::GetTicks() - startTicks) < budgetTicks;
+		const ndInt32 start = group * D_SCENE_SPECULATIVE_GROUP;
+		const ndInt32 end = ndMin(count, start + D_SCENE_SPECULATIVE_GROUP);
+		for (ndInt32 i = start; i < end; ++i)
+		{
+			// same as the end of CalculateContacts
+			ndContact* const contact = entries[i].m_contact;
+			CalculateJointContacts(threadIndex, contact, speculative);
+			if (contact->m_maxDof || contact->m_isIntersetionTestOnly)
+			{
+				contact->SetActive(true);
+				contact->m_timeOfImpact = ndFloat32(1.0e10f);
+			}
+			contact->m_sceneLru = m_lru;
+			UpdateContactState(contact, entries[i].m_active);
+		}
+	};
+	ParallelFor(0, (count + D_SCENE_SPECULATIVE_GROUP - 1) / D_SCENE_SPECULATIVE_GROUP, 1, CalculateGroup);
+}
+
+void ndScene::UpdateSpecial()
+{
+	for (ndSpecialList<ndBodyKinematic>::ndNode* node = m_specialUpdateList.GetFirst(); node; node = node->GetNext())
+	{
+		ndBodyKinematic* const body = node->GetInfo();
+		body->SpecialUpdate(m_timestep);
+	}
+}
+
+void ndScene::ConvexCastBody(ndConvexCastNotify& callback, ndBody* const body, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const
+{
+	if (callback.OnRayPrecastAction (body, &convexShape)) 
+	{
+		// save contacts and try new set
+		ndConvexCastNotify savedNotification(callback);
+		ndBodyKinematic* const kinBody = body->GetAsBodyKinematic();
+		callback.m_contacts.SetCount(0);
+		if (callback.CastShape(convexShape, globalOrigin, globalDest, kinBody))
+		{
+			// found new contacts, see how the are managed
+			if (ndAbs(savedNotification.m_param - callback.m_param) < ndFloat32(-1.0e-3f))
+			{
+				// merge contact
+				for (ndInt32 i = 0; i < savedNotification.m_contacts.GetCount(); ++i)
+				{
+					const ndContactPoint& contact = savedNotification.m_contacts[i];
+					bool newPoint = true;
+					for (ndInt32 j = callback.m_contacts.GetCount() - 1; j >= 0; ++j)
+					{
+						const ndVector diff(callback.m_contacts[j].m_point - contact.m_point);
+						ndFloat32 mag2 = diff.DotProduct(diff & ndVector::m_triplexMask).GetScalar();
+						newPoint = newPoint & (mag2 > ndFloat32(1.0e-5f));
+					}
+					if (newPoint && (callback.m_contacts.GetCount() < callback.m_contacts.GetCapacity()))
+					{
+						callback.m_contacts.PushBack(contact);
+					}
+				}
+			}
+			else if (callback.m_param > savedNotification.m_param)
+			{
+				// restore contacts
+				callback.m_normal = savedNotification.m_normal;
+				callback.m_closestPoint0 = savedNotification.m_closestPoint0;
+				callback.m_closestPoint1 = savedNotification.m_closestPoint1;
+				callback.m_param = savedNotification.m_param;
+				for (ndInt32 i = 0; i < savedNotification.m_contacts.GetCount(); ++i)
+				{
+					callback.m_contacts[i] = savedNotification.m_contacts[i];
+				}
+			}
+		}
+		else
+		{
+			// no new contacts restore old ones,
+			// in theory it should no copy, by the notification may change
+			// the previous found contacts
+			callback.m_normal = savedNotification.m_normal;
+			callback.m_closestPoint0 = savedNotification.m_closestPoint0;
+			callback.m_closestPoint1 = savedNotification.m_closestPoint1;
+			callback.m_param = savedNotification.m_param;
+			for (ndInt32 i = 0; i < savedNotification.m_contacts.GetCount(); ++i)
+			{
+				callback.m_contacts[i] = savedNotification.m_contacts[i];
+			}
+		}
+	}
+}
+
+bool ndScene::ConvexCast(ndConvexCastNotify& callback, const ndBvhNode** stackPool, ndFloat32* const stackDistance, ndInt32 stack, const ndFastRay& ray, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const
+{
+	ndVector boxP0;
+	ndVector boxP1;
+
+	ndAssert(globalOrigin.TestOrthogonal());
+	convexShape.CalculateAabb(globalOrigin, boxP0, boxP1);
+	
+	callback.m_contacts.SetCount(0);
+	callback.m_param = ndFloat32(1.2f);
+	callback.m_cachedScene = (ndScene*)this;
+	while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 4)))
+	{
+		stack--;
+		ndFloat32 dist = stackDistance[stack];
+		
+		if (dist > callback.m_param)
+		{
+			break;
+		}
+		else 
+		{
+			const ndBvhNode* const me = stackPool[stack];
+		
+			ndBody* const body = me->GetBody();
+			if (body) 
+			{
+				ConvexCastBody(callback, body, convexShape, globalOrigin, globalDest);
+				if (callback.m_param < ndFloat32 (1.0e-8f)) 
+				{
+					break;
+				}
+			}
+			else 
+			{
+				{
+					const ndBvhNode* const left = me->GetLeft();
+					ndAssert(left);
+					const ndVector minBox(left->m_minBox - boxP1);
+					const ndVector maxBox(left->m_maxBox - boxP0);
+					ndFloat32 dist1 = ray.BoxIntersect(minBox, maxBox);
+					if (dist1 < callback.m_param)
+					{
+						ndInt32 j = stack;
+						for (; j && (dist1 > stackDistance[j - 1]); j--)
+						{
+							stackPool[j] = stackPool[j - 1];
+							stackDistance[j] = stackDistance[j - 1];
+						}
+						stackPool[j] = left;
+						stackDistance[j] = dist1;
+						stack++;
+						ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
+					}
+				}
 		
 				{
 					const ndBvhNode* const right = me->GetRight();
@@ -1061,81 +1432,501 @@ bool ndScene::ConvexCast(ndConvexCastNotify& callback, const ndBvhNode** stackPo
 	return callback.m_contacts.GetCount() > 0;
 }
 
-bool ndScene::RayCast(ndRayCastNotify& callback, const ndBvhNode** stackPool, ndFloat32* const stackDistance, ndInt32 stack, const ndFastRay& ray) const
+bool ndScene::RayCast(ndRayCastNotify& callback, const ndBvhNode** stackPool, ndFloat32* const stackDistance, ndInt32 stack, const ndFastRay& ray) const
+{
+	bool state = false;
+	while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 4)))
+	{
+		stack--;
+		ndFloat32 dist = stackDistance[stack];
+		if (dist > callback.m_param)
+		{
+			break;
+		}
+		else
+		{
+			const ndBvhNode* const me = stackPool[stack];
+			ndAssert(me);
+			ndBodyKinematic* const body = me->GetBody();
+			if (body)
+			{
+				ndAssert(!me->GetLeft());
+				ndAssert(!me->GetRight());
+
+				if (body->RayCast(callback, ray, callback.m_param))
+				{
+					state = true;
+					if (callback.m_param < ndFloat32(1.0e-8f))
+					{
+						break;
+					}
+				}
+			}
+			else
+			{
+				const ndBvhNode* const left = me->GetLeft();
+				ndAssert(left);
+				ndFloat32 dist1 = ray.BoxIntersect(left->m_minBox, left->m_maxBox);
+				if (dist1 < callback.m_param)
+				{
+					ndInt32 j = stack;
+					for (; j && (dist1 > stackDistance[j - 1]); j--)
+					{
+						stackPool[j] = stackPool[j - 1];
+						stackDistance[j] = stackDistance[j - 1];
+					}
+					stackPool[j] = left;
+					stackDistance[j] = dist1;
+					stack++;
+					ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
+				}
+	
+				const ndBvhNode* const right = me->GetRight();
+				ndAssert(right);
+				dist1 = ray.BoxIntersect(right->m_minBox, right->m_maxBox);
+				if (dist1 < callback.m_param)
+				{
+					ndInt32 j = stack;
+					for (; j && (dist1 > stackDistance[j - 1]); j--)
+					{
+						stackPool[j] = stackPool[j - 1];
+						stackDistance[j] = stackDistance[j - 1];
+					}
+					stackPool[j] = right;
+					stackDistance[j] = dist1;
+					stack++;
+					ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
+				}
+			}
+		}
+	}
+	return state;
+}
+
+bool ndScene::RayCast(ndRayCastNotify& callback, const ndFastRay& ray) const
+{
+	const ndBvhFlatTree& tree = m_bvhSceneManager.GetFlatTree();
+	const ndBvhFlatRay flatRay(ray);
+
+	ndInt32 stackPool[D_SCENE_MAX_STACK_DEPTH];
+	ndFloat32 stackDistance[D_SCENE_MAX_STACK_DEPTH];
+
+	bool state = false;
+	stackPool[0] = 0;
+	stackDistance[0] = ndFloat32(0.0f);
+	ndInt32 stack = 1;
+	while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 4)))
+	{
+		stack--;
+		if (stackDistance[stack] > callback.m_param)
+		{
+			break;
+		}
+
+		const ndInt32 entry = stackPool[stack];
+		if (entry < 0)
+		{
+			ndBodyKinematic* const body = tree.m_bodies[-entry - 1];
+			if (body->RayCast(callback, ray, callback.m_param))
+			{
+				state = true;
+				if (callback.m_param < ndFloat32(1.0e-8f))
+				{
+					break;
+				}
+			}
+		}
+		else
+		{
+			const ndBvhFlatNode& node = tree.m_nodes[entry];
+			const ndVector distance(node.RayDistance(flatRay));
+			for (ndInt32 i = 0; i < 4; ++i)
+			{
+				const ndFloat32 dist1 = distance[i];
+				if (dist1 < callback.m_param)
+				{
+					ndInt32 j = stack;
+					for (; j && (dist1 > stackDistance[j - 1]); j--)
+					{
+						stackPool[j] = stackPool[j - 1];
+						stackDistance[j] = stackDistance[j - 1];
+					}
+					stackPool[j] = node.m_children[i];
+					stackDistance[j] = dist1;
+					stack++;
+					ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
+				}
+			}
+		}
+	}
+	return state;
+}
+
+bool ndScene::ConvexCast(ndConvexCastNotify& callback, const ndFastRay& ray, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const
+{
+	ndVector boxP0;
+	ndVector boxP1;
+	ndAssert(globalOrigin.TestOrthogonal());
+	convexShape.CalculateAabb(globalOrigin, boxP0, boxP1);
+
+	const ndBvhFlatTree& tree = m_bvhSceneManager.GetFlatTree();
+	const ndBvhFlatRay flatRay(ray, boxP0, boxP1);
+
+	ndInt32 stackPool[D_SCENE_MAX_STACK_DEPTH];
+	ndFloat32 stackDistance[D_SCENE_MAX_STACK_DEPTH];
+
+	callback.m_contacts.SetCount(0);
+	callback.m_param = ndFloat32(1.2f);
+	callback.m_cachedScene = (ndScene*)this;
+
+	stackPool[0] = 0;
+	stackDistance[0] = ndFloat32(0.0f);
+	ndInt32 stack = 1;
+	while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 4)))
+	{
+		stack--;
+		if (stackDistance[stack] > callback.m_param)
+		{
+			break;
+		}
+
+		const ndInt32 entry = stackPool[stack];
+		if (entry < 0)
+		{
+			ndBodyKinematic* const body = tree.m_bodies[-entry - 1];
+			ConvexCastBody(callback, body, convexShape, globalOrigin, globalDest);
+			if (callback.m_param < ndFloat32(1.0e-8f))
+			{
+				break;
+			}
+		}
+		else
+		{
+			const ndBvhFlatNode& node = tree.m_nodes[entry];
+			const ndVector distance(node.RayDistance(flatRay));
+			for (ndInt32 i = 0; i < 4; ++i)
+			{
+				const ndFloat32 dist1 = distance[i];
+				if (dist1 < callback.m_param)
+				{
+					ndInt32 j = stack;
+					for (; j && (dist1 > stackDistance[j - 1]); j--)
+					{
+						stackPool[j] = stackPool[j - 1];
+						stackDistance[j] = stackDistance[j - 1];
+					}
+					stackPool[j] = node.m_children[i];
+					stackDistance[j] = dist1;
+					stack++;
+					ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
+				}
+			}
+		}
+	}
+
+	callback.m_cachedScene = nullptr;
+	return callback.m_contacts.GetCount() > 0;
+}
+
+// closest hit of a ray of a batch, it does not filter any body
+class ndRayCastBatchNotify : public ndRayCastNotify
+{
+	public:
+	ndRayCastBatchNotify()
+		:ndRayCastNotify()
+	{
+		m_param = ndFloat32(1.2f);
+	}
+
+	ndFloat32 OnRayCastAction(const ndContactPoint& contact, ndFloat32 intersetParam)
+	{
+		if (intersetParam < m_param)
+		{
+			m_contact = contact;
+			m_param = intersetParam;
+		}
+		return intersetParam;
+	}
+
+	void GetResult(ndRayCastHit& result) const
+	{
+		if (m_param < ndFloat32(1.0f))
+		{
+			result.m_point = m_contact.m_point;
+			result.m_normal = m_contact.m_normal;
+			result.m_body = m_contact.m_body0;
+			result.m_shapeId = m_contact.m_shapeId0;
+			result.m_param = m_param;
+		}
+		else
+		{
+			result.m_point = ndVector::m_wOne;
+			result.m_normal = ndVector::m_zero;
+			result.m_body = nullptr;
+			result.m_shapeId = 0;
+			result.m_param = ndFloat32(1.2f);
+		}
+	}
+};
+
+void ndScene::RayCastPacket(const ndFastRay** const rays, ndRayCastHit** const results, ndInt32 count) const
+{
+	ndAssert(count && (count <= D_SCENE_RAY_PACKET_SIZE));
+	const ndBvhFlatTree& tree = m_bvhSceneManager.GetFlatTree();
+
+	// unused lanes repeat the last ray, with a negative 
+	// param so that they never hit anything.
+	const ndBvhFlatRay flatRays[D_SCENE_RAY_PACKET_SIZE] = 
+	{
+		ndBvhFlatRay(*rays[0]),
+		ndBvhFlatRay(*rays[ndMin(1, count - 1)]),
+		ndBvhFlatRay(*rays[ndMin(2, count - 1)]),
+		ndBvhFlatRay(*rays[ndMin(3, count - 1)]),
+	};
+	ndRayCastBatchNotify callbacks[D_SCENE_RAY_PACKET_SIZE];
+	ndVector param(ndFloat32(-1.0f));
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		param[i] = callbacks[i].m_param;
+	}
+
+	// each stack entry keeps the entry distance of all the rays of the packet,
+	// the entries are sorted so that the nearest child is visited first.
+	ndInt32 stackPool[D_SCENE_MAX_STACK_DEPTH];
+	ndVector stackDistance[D_SCENE_MAX_STACK_DEPTH];
+	stackPool[0] = 0;
+	stackDistance[0] = ndVector::m_zero;
+	ndInt32 stack = 1;
+	while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 4)))
+	{
+		stack--;
+		const ndInt32 rayMask = (stackDistance[stack] < param).GetSignMask();
+		if (!rayMask)
+		{
+			continue;
+		}
+
+		const ndInt32 entry = stackPool[stack];
+		if (entry < 0)
+		{
+			ndBodyKinematic* const body = tree.m_bodies[-entry - 1];
+			for (ndInt32 i = 0; i < count; ++i)
+			{
+				if (rayMask & (1 << i))
+				{
+					ndRayCastBatchNotify& callback = callbacks[i];
+					if (body->RayCast(callback, *rays[i], callback.m_param))
+					{
+						param[i] = callback.m_param;
+					}
+				}
+			}
+		}
+		else
+		{
+			const ndBvhFlatNode& node = tree.m_nodes[entry];
+			ndVector distance[4];
+			ndVector::Transpose4x4(distance[0], distance[1], distance[2], distance[3],
+				node.RayDistance(flatRays[0]), node.RayDistance(flatRays[1]), 
+				node.RayDistance(flatRays[2]), node.RayDistance(flatRays[3]));
+
+			ndInt32 childCount = 0;
+			ndInt32 children[4];
+			ndFloat32 nearest[4];
+			for (ndInt32 i = 0; i < 4; ++i)
+			{
+				const ndVector hit(distance[i] < param);
+				if (hit.GetSignMask())
+				{
+					const ndVector dist(ndVector(ndFloat32(1.2f)).Select(distance[i], hit));
+					const ndFloat32 dist1 = ndMin(ndMin(dist.m_x, dist.m_y), ndMin(dist.m_z, dist.m_w));
+					ndInt32 j = childCount;
+					for (; j && (dist1 > nearest[j - 1]); j--)
+					{
+						children[j] = children[j - 1];
+						nearest[j] = nearest[j - 1];
+					}
+					children[j] = i;
+					nearest[j] = dist1;
+					childCount++;
+				}
+			}
+
+			for (ndInt32 i = 0; i < childCount; ++i)
+			{
+				stackPool[stack] = node.m_children[children[i]];
+				stackDistance[stack] = distance[children[i]];
+				stack++;
+				ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
+			}
+		}
+	}
+
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		callbacks[i].GetResult(*results[i]);
+	}
+}
+
+void ndScene::RayCastBatch(const ndFastRay* const rays, ndInt32 count, ndRayCastHit* const results)
+{
+	D_TRACKTIME();
+	class ndRayKey
+	{
+		public:
+		ndUnsigned32 m_code;
+		ndInt32 m_index;
+	};
+
+	class ndRayKeyDigit
+	{
+		public:
+		ndRayKeyDigit(const void* const context)
+			:m_shift(*((ndUnsigned32*)context))
+		{
+		}
+
+		ndInt32 GetKey(const ndRayKey& key) const
+		{
+			return ndInt32((key.m_code >> m_shift) & 0xff);
+		}
+
+		ndUnsigned32 m_shift;
+	};
+
+	if (count <= 0)
+	{
+		return;
+	}
+
+	// called from outside the update the workers must be started for the jobs, 
+	// only the pool is started, this is not a scene frame.
+	ndThreadPool::Begin();
+	if (!m_rootNode || !m_bvhSceneManager.GetFlatTree().IsValid() || (GetCallerThreadIndex() >= 0))
+	{
+		// no snapshot, or called from a job of the pool, where the packet 
+		// sort can not run, one ray at the time through the node graph
+		auto CastRay = [this, rays, results](ndInt32, ndInt32 i)
+		{
+			ndRayCastBatchNotify callback;
+			RayCast(callback, rays[i].m_p0, rays[i].m_p1);
+			callback.GetResult(results[i]);
+		};
+		ParallelFor(0, count, D_SCENE_RAY_PACKET_SIZE * D_SCENE_RAY_PACKET_GRAIN, CastRay);
+		ndThreadPool::End();
+		return;
+	}
+
+	// sort the rays by direction octant first and origin morton code 
+	// second, so that the rays of a packet visit the same nodes.
+	ndArray<ndRayKey> keys;
+	ndArray<ndRayKey> scratch;
+	keys.SetCount(count);
+	scratch.SetCount(count);
+
+	const ndFloat32 cells = ndFloat32(D_SCENE_RAY_MORTON_CELLS - 1);
+	const ndVector origin(m_rootNode->m_minBox);
+	const ndVector size(m_rootNode->m_maxBox - m_rootNode->m_minBox);
+	const ndVector scale(
+		cells / ndMax(size.m_x, ndFloat32(1.0e-3f)),
+		cells / ndMax(size.m_y, ndFloat32(1.0e-3f)),
+		cells / ndMax(size.m_z, ndFloat32(1.0e-3f)), ndFloat32(0.0f));
+	auto CalculateKeys = ndMakeObject::ndFunction([rays, count, &keys, &origin, &scale](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CalculateKeys);
+		auto SpreadBits = [](ndUnsigned32 x)
+		{
+			x = (x | (x << 16)) & 0x030000ff;
+			x = (x | (x << 8)) & 0x0300f00f;
+			x = (x | (x << 4)) & 0x030c30c3;
+			x = (x | (x << 2)) & 0x09249249;
+			return x;
+		};
+
+		const ndVector maxCell(ndFloat32(D_SCENE_RAY_MORTON_CELLS - 1));
+		const ndStartEnd startEnd(count, threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			const ndFastRay& ray = rays[i];
+			const ndVector cell((scale * (ray.m_p0 - origin)).GetMax(ndVector::m_zero).GetMin(maxCell).GetInt());
+			const ndUnsigned32 octant = ndUnsigned32((ray.m_diff < ndVector::m_zero).GetSignMask() & 7);
+			keys[i].m_index = i;
+			keys[i].m_code = (octant << 27) | (SpreadBits(ndUnsigned32(cell.m_ix)) << 2) | (SpreadBits(ndUnsigned32(cell.m_iy)) << 1) | SpreadBits(ndUnsigned32(cell.m_iz));
+		}
+	});
+	ParallelExecute(CalculateKeys);
+
+	ndUnsigned32 scans[(1 << 8) + 1];
+	for (ndUnsigned32 shift = 0; shift < 32; shift += 8)
+	{
+		ndCountingSortInPlace<ndRayKey, ndRayKeyDigit, 8>(*this, &keys[0], &scratch[0], count, scans, &shift);
+	}
+
+	auto CastPackets = [this, rays, results, count, &keys](ndInt32, ndInt32 packet)
+	{
+		const ndFastRay* packetRays[D_SCENE_RAY_PACKET_SIZE];
+		ndRayCastHit* packetResults[D_SCENE_RAY_PACKET_SIZE];
+		const ndInt32 start = packet * D_SCENE_RAY_PACKET_SIZE;
+		const ndInt32 packetCount = ndMin(count - start, ndInt32(D_SCENE_RAY_PACKET_SIZE));
+		for (ndInt32 i = 0; i < packetCount; ++i)
+		{
+			const ndInt32 index = keys[start + i].m_index;
+			packetRays[i] = &rays[index];
+			packetResults[i] = &results[index];
+		}
+		RayCastPacket(packetRays, packetResults, packetCount);
+	};
+	const ndInt32 packetCount = (count + D_SCENE_RAY_PACKET_SIZE - 1) / D_SCENE_RAY_PACKET_SIZE;
+	ParallelFor(0, packetCount, D_SCENE_RAY_PACKET_GRAIN, CastPackets);
+	ndThreadPool::End();
+}
+
+void ndScene::BodiesInAabb(ndBodiesInAabbNotify& callback, const ndVector& minBox, const ndVector& maxBox) const
 {
-	bool state = false;
-	while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 4)))
+	callback.Reset();
+	if (m_rootNode && m_bvhSceneManager.GetFlatTree().IsValid())
 	{
-		stack--;
-		ndFloat32 dist = stackDistance[stack];
-		if (dist > callback.m_param)
+		const ndBvhFlatTree& tree = m_bvhSceneManager.GetFlatTree();
+		ndVector boxP0[3];
+		ndVector boxP1[3];
+		for (ndInt32 i = 0; i < 3; ++i)
 		{
-			break;
+			boxP0[i] = ndVector(minBox[i]);
+			boxP1[i] = ndVector(maxBox[i]);
 		}
-		else
-		{
-			const ndBvhNode* const me = stackPool[stack];
-			ndAssert(me);
-			ndBodyKinematic* const body = me->GetBody();
-			if (body)
-			{
-				ndAssert(!me->GetLeft());
-				ndAssert(!me->GetRight());
 
-				if (body->RayCast(callback, ray, callback.m_param))
-				{
-					state = true;
-					if (callback.m_param < ndFloat32(1.0e-8f))
-					{
-						break;
-					}
-				}
-			}
-			else
+		ndInt32 stackPool[D_SCENE_MAX_STACK_DEPTH];
+		stackPool[0] = 0;
+		ndInt32 stack = 1;
+		while (stack && (stack < (D_SCENE_MAX_STACK_DEPTH - 4)))
+		{
+			stack--;
+			const ndBvhFlatNode& node = tree.m_nodes[stackPool[stack]];
+			const ndInt32 mask = node.OverlapTest(boxP0, boxP1);
+			for (ndInt32 i = 0; i < 4; ++i)
 			{
-				const ndBvhNode* const left = me->GetLeft();
-				ndAssert(left);
-				ndFloat32 dist1 = ray.BoxIntersect(left->m_minBox, left->m_maxBox);
-				if (dist1 < callback.m_param)
+				if (mask & (1 << i))
 				{
-					ndInt32 j = stack;
-					for (; j && (dist1 > stackDistance[j - 1]); j--)
+					const ndInt32 child = node.m_children[i];
+					if (child < 0)
 					{
-						stackPool[j] = stackPool[j - 1];
-						stackDistance[j] = stackDistance[j - 1];
+						ndBodyKinematic* const body = tree.m_bodies[-child - 1];
+						if (ndOverlapTest(body->m_minAabb, body->m_maxAabb, minBox, maxBox))
+						{
+							callback.OnOverlap(body);
+						}
 					}
-					stackPool[j] = left;
-					stackDistance[j] = dist1;
-					stack++;
-					ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
-				}
-	
-				const ndBvhNode* const right = me->GetRight();
-				ndAssert(right);
-				dist1 = ray.BoxIntersect(right->m_minBox, right->m_maxBox);
-				if (dist1 < callback.m_param)
-				{
-					ndInt32 j = stack;
-					for (; j && (dist1 > stackDistance[j - 1]); j--)
+					else
 					{
-						stackPool[j] = stackPool[j - 1];
-						stackDistance[j] = stackDistance[j - 1];
+						stackPool[stack] = child;
+						stack++;
+						ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
 					}
-					stackPool[j] = right;
-					stackDistance[j] = dist1;
-					stack++;
-					ndAssert(stack < D_SCENE_MAX_STACK_DEPTH);
 				}
 			}
 		}
 	}
-	return state;
-}
-
-void ndScene::BodiesInAabb(ndBodiesInAabbNotify& callback, const ndVector& minBox, const ndVector& maxBox) const
-{
-	callback.Reset();
-	if (m_rootNode)
+	else if (m_rootNode)
 	{
 		const ndBvhNode* stackPool[D_SCENE_MAX_STACK_DEPTH];
 		stackPool[0] = m_rootNode;
@@ -1192,18 +1983,20 @@ void ndScene::Cleanup()
 		m_sentinelBody = nullptr;
 	}
 
+	UnfreezeAllBodies();
 	m_bvhSceneManager.CleanUp();
 	m_contactArray.DeleteAllContacts();
+	m_contactPairMap.RemoveAll();
 
 	ndFreeListAlloc::Flush();
 	m_contactArray.Resize(1024);
 	m_sceneBodyArray.Resize(1024);
+	m_activeBodyArray.Resize(1024);
 	m_activeConstraintArray.Resize(1024);
-	m_scratchBuffer.Resize(1024 * sizeof(void*));
 
 	m_contactArray.SetCount(0);
-	m_scratchBuffer.SetCount(0);
 	m_sceneBodyArray.SetCount(0);
+	m_activeBodyArray.SetCount(0);
 	m_activeConstraintArray.SetCount(0);
 }
 
@@ -1224,10 +2017,16 @@ bool ndScene::RayCast(ndRayCastNotify& callback, const ndVector& globalOrigin, c
 			const ndBvhNode* stackPool[D_SCENE_MAX_STACK_DEPTH];
 
 			ndFastRay ray(p0, p1);
-
-			stackPool[0] = m_rootNode;
-			distance[0] = ray.BoxIntersect(m_rootNode->m_minBox, m_rootNode->m_maxBox);
-			state = RayCast(callback, stackPool, distance, 1, ray);
+			if (m_bvhSceneManager.GetFlatTree().IsValid())
+			{
+				state = RayCast(callback, ray);
+			}
+			else
+			{
+				stackPool[0] = m_rootNode;
+				distance[0] = ray.BoxIntersect(m_rootNode->m_minBox, m_rootNode->m_maxBox);
+				state = RayCast(callback, stackPool, distance, 1, ray);
+			}
 		}
 	}
 	return state;
@@ -1237,7 +2036,13 @@ bool ndScene::ConvexCast(ndConvexCastNotify& callback, const ndShapeInstance& co
 {
 	bool state = false;
 	callback.m_param = ndFloat32(1.2f);
-	if (m_rootNode)
+	if (m_rootNode && m_bvhSceneManager.GetFlatTree().IsValid())
+	{
+		const ndVector velocA((globalDest - globalOrigin.m_posit) & ndVector::m_triplexMask);
+		const ndFastRay ray(ndVector::m_zero, velocA);
+		state = ConvexCast(callback, ray, convexShape, globalOrigin, globalDest);
+	}
+	else if (m_rootNode)
 	{
 		ndVector boxP0;
 		ndVector boxP1;
@@ -1267,17 +2072,14 @@ void ndScene::SendBackgroundTask(ndBackgroundTask* const job)
 
 void ndScene::AddPair(ndBodyKinematic* const body0, ndBodyKinematic* const body1, ndInt32 threadId)
 {
-	const ndBodyKinematic::ndContactMap& contactMap0 = body0->GetContactMap();
-	const ndBodyKinematic::ndContactMap& contactMap1 = body1->GetContactMap();
-
-	ndContact* const contact = (contactMap0.GetCount() <= contactMap1.GetCount()) ? contactMap0.FindContact(body0, body1) : contactMap1.FindContact(body1, body0);
+	ndContact* const contact = m_contactPairMap.Find(body0, body1);
 	if (!contact)
 	{
 		const ndJointBilateralConstraint* const bilateral = FindBilateralJoint(body0, body1);
 		const bool isCollidable = bilateral ? bilateral->IsCollidable() : true;
 		if (isCollidable)
 		{
-			ndArray<ndContactPairs>& particalPairs = m_partialNewPairs[threadId];
+			ndArray<ndContactPairs>& particalPairs = m_threadData[threadId]->m_partialNewPairs;
 			ndContactPairs pair(ndUnsigned32(body0->m_index), ndUnsigned32(body1->m_index));
 			particalPairs.PushBack(pair);
 		}
@@ -1287,45 +2089,21 @@ void ndScene::AddPair(ndBodyKinematic* const body0, ndBodyKinematic* const body1
 void ndScene::FindCollidingPairs()
 {
 	D_TRACKTIME();
-	auto FindPairs = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
-	{
-		D_TRACKTIME_NAMED(FindPairs);
-		const ndArray<ndBodyKinematic*>& bodyArray = GetActiveBodyArray();
-		const ndStartEnd startEnd(bodyArray.GetCount() - 1, threadIndex, threadCount);
-		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
-		{
-			ndBodyKinematic* const body = bodyArray[i];
-			FindCollidingPairs(body, threadIndex);
-		}
-	});
-
-	auto FindPairsForward = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
+	auto FindPairs = [this](ndInt32 threadIndex, ndInt32 i)
 	{
-		D_TRACKTIME_NAMED(FindPairsForward);
-		const ndArray<ndBodyKinematic*>& bodyArray = m_sceneBodyArray;
-		const ndStartEnd startEnd(m_sceneBodyArray.GetCount(), threadIndex, threadCount);
-		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
-		{
-			ndBodyKinematic* const body = bodyArray[i];
-			FindCollidingPairsForward(body, threadIndex);
-		}
-	});
+		ndBodyKinematic* const body = GetActiveBodyArray()[i];
+		SubmitPairs(body, false, threadIndex);
+	};
 
-	auto FindPairsBackward = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32 threadCount)
+	auto FindSceneBodyPairs = [this](ndInt32 threadIndex, ndInt32 i)
 	{
-		D_TRACKTIME_NAMED(FindPairsBackward);
-		const ndArray<ndBodyKinematic*>& bodyArray = m_sceneBodyArray;
-		const ndStartEnd startEnd(m_sceneBodyArray.GetCount(), threadIndex, threadCount);
-		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
-		{
-			ndBodyKinematic* const body = bodyArray[i];
-			FindCollidingPairsBackward(body, threadIndex);
-		}
-	});
+		ndBodyKinematic* const body = m_sceneBodyArray[i];
+		SubmitPairs(body, true, threadIndex);
+	};
 
 	for (ndInt32 i = GetThreadCount() - 1; i >= 0; --i)
 	{
-		m_partialNewPairs[i].SetCount(0);
+		m_threadData[i]->m_partialNewPairs.SetCount(0);
 	}
 
 	const ndInt32 threadCount = GetThreadCount();
@@ -1333,13 +2111,15 @@ void ndScene::FindCollidingPairs()
 	const bool fullScan = (2 * m_sceneBodyArray.GetCount()) > activeBodies.GetCount();
 	if (fullScan)
 	{
-		ParallelExecute(FindPairs);
+		D_TRACKTIME_NAMED(FindPairs);
+		D_FRAME_STATS_COUNT(m_pairQueries, activeBodies.GetCount() - 1);
+		ParallelFor(0, activeBodies.GetCount() - 1, D_SCENE_PAIRS_GRAIN, FindPairs);
 
 		ndUnsigned32 sum = 0;
 		ndUnsigned32 scanCounts[D_MAX_THREADS_COUNT + 1];
 		for (ndInt32 i = 0; i < threadCount; ++i)
 		{
-			const ndArray<ndContactPairs>& newPairs = m_partialNewPairs[i];
+			const ndArray<ndContactPairs>& newPairs = m_threadData[i]->m_partialNewPairs;
 			scanCounts[i] = sum;
 			sum += newPairs.GetCount();
 		}
@@ -1351,7 +2131,7 @@ void ndScene::FindCollidingPairs()
 			auto CopyPartialCounts = ndMakeObject::ndFunction([this, &scanCounts](ndInt32 threadIndex, ndInt32)
 			{
 				D_TRACKTIME_NAMED(CopyPartialCounts);
-				const ndArray<ndContactPairs>& newPairs = m_partialNewPairs[threadIndex];
+				const ndArray<ndContactPairs>& newPairs = m_threadData[threadIndex]->m_partialNewPairs;
 
 				const ndInt32 count = newPairs.GetCount();
 				const ndInt32 start = ndInt32(scanCounts[threadIndex]);
@@ -1366,20 +2146,21 @@ void ndScene::FindCollidingPairs()
 	}
 	else
 	{
-		ParallelExecute(FindPairsForward);
-		ParallelExecute(FindPairsBackward);
+		D_TRACKTIME_NAMED(FindSceneBodyPairs);
+		D_FRAME_STATS_COUNT(m_pairQueries, m_sceneBodyArray.GetCount());
+		ParallelFor(0, m_sceneBodyArray.GetCount(), D_SCENE_PAIRS_GRAIN, FindSceneBodyPairs);
 
 		ndUnsigned32 sum = 0;
 		for (ndInt32 i = 0; i < threadCount; ++i)
 		{
-			sum += m_partialNewPairs[i].GetCount();
+			sum += m_threadData[i]->m_partialNewPairs.GetCount();
 		}
 		m_newPairs.SetCount(ndInt32(sum));
 
 		sum = 0;
 		for (ndInt32 i = 0; i < threadCount; ++i)
 		{
-			const ndArray<ndContactPairs>& newPairs = m_partialNewPairs[i];
+			const ndArray<ndContactPairs>& newPairs = m_threadData[i]->m_partialNewPairs;
 			const ndInt32 count = newPairs.GetCount();
 			for (ndInt32 j = 0; j < count; ++j)
 			{
@@ -1388,13 +2169,41 @@ void ndScene::FindCollidingPairs()
 			sum += count;
 		}
 	}
+
+	if (m_deterministic)
+	{
+		SortNewPairs();
+	}
+}
+
+void ndScene::SortNewPairs()
+{
+	// the pairs come out in the order the work stealing loop visited the 
+	// bodies, sorting them makes the contact order, and with it the 
+	// order of the solver joints, independent of the threads.
+	D_TRACKTIME();
+	class ndComparePair
+	{
+		public:
+		ndInt32 Compare(const ndContactPairs& pairA, const ndContactPairs& pairB, void* const) const
+		{
+			const ndUnsigned64 keyA = (ndUnsigned64(pairA.m_body0) << 32) + pairA.m_body1;
+			const ndUnsigned64 keyB = (ndUnsigned64(pairB.m_body0) << 32) + pairB.m_body1;
+			return (keyA < keyB) ? -1 : ((keyA > keyB) ? 1 : 0);
+		}
+	};
+	if (m_newPairs.GetCount() > 1)
+	{
+		ndSort<ndContactPairs, ndComparePair>(&m_newPairs[0], m_newPairs.GetCount(), nullptr);
+	}
 }
 
 void ndScene::UpdateBodyList()
 {
+	ndArray<ndBodyKinematic*>& activeBodies = m_activeBodyArray;
 	if (m_bodyList.UpdateView())
 	{
-		ndArray<ndBodyKinematic*>& view = GetActiveBodyArray();
+		const ndArray<ndBodyKinematic*>& view = m_bodyList.GetView();
 		// allow for bodies with null shape to be part of the simulation.
 		//#ifdef _DEBUG
 		//for (ndInt32 i = 0; i < view.GetCount(); ++i)
@@ -1403,8 +2212,273 @@ void ndScene::UpdateBodyList()
 		//	ndAssert(!body->GetCollisionShape().GetShape()->GetAsShapeNull());
 		//}
 		//#endif
-		view.PushBack(m_sentinelBody);
+		activeBodies.SetCount(0);
+		for (ndInt32 i = 0; i < view.GetCount(); ++i)
+		{
+			ndBodyKinematic* const body = view[i];
+			if (!body->m_isFrozen)
+			{
+				activeBodies.PushBack(body);
+			}
+		}
+	}
+	else if (activeBodies.GetCount())
+	{
+		ndAssert(activeBodies[activeBodies.GetCount() - 1] == m_sentinelBody);
+		activeBodies.SetCount(activeBodies.GetCount() - 1);
 	}
+
+	UnfreezeIslands();
+	FreezeIslands();
+	activeBodies.PushBack(m_sentinelBody);
+}
+
+void ndScene::UnfreezeBody(ndBodyKinematic* const body)
+{
+	ndScopeSpinLock lock(m_lock);
+	if (!body->m_unfreezeQueued)
+	{
+		body->m_unfreezeQueued = 1;
+		m_unfreezeQueue.PushBack(body);
+	}
+}
+
+void ndScene::FreezeIslands()
+{
+	// an island of dynamics bodies is taken out of the simulation when all 
+	// its bodies are at rest and it is only touching resting static bodies.
+	// islands with joints, special bodies or moving kinematic bodies are left 
+	// to the solver sleep logic.
+	D_TRACKTIME();
+	if (IsHighPerformanceCompute())
+	{
+		return;
+	}
+
+	m_freezeMark++;
+	const ndUnsigned32 mark = m_freezeMark;
+	ndArray<ndBodyKinematic*>& activeBodies = m_activeBodyArray;
+	ndArray<ndBodyKinematic*>& stack = m_freezeStack;
+
+	ndInt32 frozenCount = 0;
+	for (ndInt32 i = 0; i < activeBodies.GetCount(); ++i)
+	{
+		ndBodyKinematic* const root = activeBodies[i];
+		if (!root->m_equilibrium || (root->m_freezeMark == mark) || (root->m_invMass.m_w == ndFloat32(0.0f)))
+		{
+			continue;
+		}
+
+		bool canFreeze = true;
+		ndInt32 islandStart = stack.GetCount();
+		root->m_freezeMark = mark;
+		stack.PushBack(root);
+		for (ndInt32 j = islandStart; j < stack.GetCount(); ++j)
+		{
+			ndBodyKinematic* const body = stack[j];
+			canFreeze = canFreeze && body->m_equilibrium && !body->m_jointList.GetCount() && !body->GetAsBodyKinematicSpecial();
+
+			ndBodyKinematic::ndContactMap::Iterator it(body->m_contactList);
+			for (it.Begin(); it; it++)
+			{
+				ndContact* const contact = *it;
+				ndBodyKinematic* const body1 = (contact->GetBody0() == body) ? contact->GetBody1() : contact->GetBody0();
+				if (body1->m_invMass.m_w == ndFloat32(0.0f))
+				{
+					const ndFloat32 speed2 = body1->m_veloc.DotProduct(body1->m_veloc).GetScalar() + body1->m_omega.DotProduct(body1->m_omega).GetScalar();
+					canFreeze = canFreeze && (speed2 == ndFloat32(0.0f)) && !body1->GetAsBodyKinematicSpecial();
+				}
+				else if (body1->m_freezeMark != mark)
+				{
+					body1->m_freezeMark = mark;
+					stack.PushBack(body1);
+				}
+			}
+		}
+
+		if (canFreeze)
+		{
+			for (ndInt32 j = islandStart; j < stack.GetCount(); ++j)
+			{
+				ndBodyKinematic* const body = stack[j];
+				body->m_isFrozen = 1;
+				body->m_sceneEquilibrium = 1;
+				m_bvhSceneManager.SetFrozen(body, true);
+				ndBodyKinematic::ndContactMap::Iterator it(body->m_contactList);
+				for (it.Begin(); it; it++)
+				{
+					ndContact* const contact = *it;
+					contact->m_isFrozen = 1;
+					ndBodyKinematic* const body1 = (contact->GetBody0() == body) ? contact->GetBody1() : contact->GetBody0();
+					if (body1->m_invMass.m_w == ndFloat32(0.0f))
+					{
+						body1->m_hasFrozenContacts = 1;
+					}
+				}
+			}
+			frozenCount += stack.GetCount() - islandStart;
+		}
+		else
+		{
+			stack.SetCount(islandStart);
+		}
+	}
+	stack.SetCount(0);
+
+	if (frozenCount)
+	{
+		m_frozenBodyCount += frozenCount;
+
+		ndInt32 bodyCount = 0;
+		for (ndInt32 i = 0; i < activeBodies.GetCount(); ++i)
+		{
+			ndBodyKinematic* const body = activeBodies[i];
+			activeBodies[bodyCount] = body;
+			bodyCount += body->m_isFrozen ? 0 : 1;
+		}
+		activeBodies.SetCount(bodyCount);
+
+		ndInt32 contactCount = 0;
+		for (ndInt32 i = 0; i < m_contactArray.GetCount(); ++i)
+		{
+			ndContact* const contact = m_contactArray[i];
+			m_contactArray[contactCount] = contact;
+			contactCount += contact->m_isFrozen ? 0 : 1;
+		}
+		m_contactArray.SetCount(contactCount);
+	}
+}
+
+void ndScene::UnfreezeIslands()
+{
+	if (!m_unfreezeQueue.GetCount())
+	{
+		return;
+	}
+
+	D_TRACKTIME();
+	class ndCompareKey
+	{
+		public:
+		ndInt32 Compare(const ndBodyKinematic* const bodyA, const ndBodyKinematic* const bodyB, void* const) const
+		{
+			const ndUnsigned32 idA = bodyA->GetId();
+			const ndUnsigned32 idB = bodyB->GetId();
+			return (idA < idB) ? -1 : ((idA > idB) ? 1 : 0);
+		}
+	};
+	// the queue is filled from many threads, sort it so that 
+	// the wake up order does not depend on the thread timing.
+	ndSort<ndBodyKinematic*, ndCompareKey>(&m_unfreezeQueue[0], m_unfreezeQueue.GetCount(), nullptr);
+
+	ndArray<ndBodyKinematic*>& stack = m_freezeStack;
+	ndArray<ndBodyKinematic*>& activeBodies = m_activeBodyArray;
+	const ndInt32 bodyStart = activeBodies.GetCount();
+	const ndInt32 contactStart = m_contactArray.GetCount();
+	for (ndInt32 i = 0; i < m_unfreezeQueue.GetCount(); ++i)
+	{
+		ndBodyKinematic* const root = m_unfreezeQueue[i];
+		root->m_unfreezeQueued = 0;
+		if (root->m_isFrozen)
+		{
+			stack.PushBack(root);
+		}
+		else if (root->m_hasFrozenContacts)
+		{
+			// a static body woken by the application, wake the islands resting on it.
+			root->m_hasFrozenContacts = 0;
+			ndBodyKinematic::ndContactMap::Iterator it(root->m_contactList);
+			for (it.Begin(); it; it++)
+			{
+				ndContact* const contact = *it;
+				ndBodyKinematic* const body1 = (contact->GetBody0() == root) ? contact->GetBody1() : contact->GetBody0();
+				if (body1->m_isFrozen)
+				{
+					stack.PushBack(body1);
+				}
+			}
+		}
+
+		while (stack.GetCount())
+		{
+			ndBodyKinematic* const body = stack[stack.GetCount() - 1];
+			stack.SetCount(stack.GetCount() - 1);
+			if (body->m_isFrozen)
+			{
+				body->m_isFrozen = 0;
+				body->m_equilibrium = 0;
+				body->m_sceneForceUpdate = 1;
+				m_bvhSceneManager.SetFrozen(body, false);
+				m_frozenBodyCount--;
+				activeBodies.PushBack(body);
+
+				ndBodyKinematic::ndContactMap::Iterator it(body->m_contactList);
+				for (it.Begin(); it; it++)
+				{
+					ndContact* const contact = *it;
+					if (contact->m_isFrozen)
+					{
+						contact->m_isFrozen = 0;
+						m_contactArray.PushBack(contact);
+					}
+					ndBodyKinematic* const body1 = (contact->GetBody0() == body) ? contact->GetBody1() : contact->GetBody0();
+					if (body1->m_isFrozen)
+					{
+						stack.PushBack(body1);
+					}
+				}
+			}
+		}
+	}
+	m_unfreezeQueue.SetCount(0);
+	ndAssert(m_frozenBodyCount >= 0);
+
+	if (m_deterministic)
+	{
+		// the contact maps of the bodies are filled in thread order, 
+		// sort what the walk added so the solver sees the same order.
+		class ndCompareContact
+		{
+			public:
+			ndInt32 Compare(const ndContact* const contactA, const ndContact* const contactB, void* const) const
+			{
+				const ndUnsigned64 keyA = (ndUnsigned64(contactA->GetBody0()->GetId()) << 32) + contactA->GetBody1()->GetId();
+				const ndUnsigned64 keyB = (ndUnsigned64(contactB->GetBody0()->GetId()) << 32) + contactB->GetBody1()->GetId();
+				return (keyA < keyB) ? -1 : ((keyA > keyB) ? 1 : 0);
+			}
+		};
+		if ((activeBodies.GetCount() - bodyStart) > 1)
+		{
+			ndSort<ndBodyKinematic*, ndCompareKey>(&activeBodies[bodyStart], activeBodies.GetCount() - bodyStart, nullptr);
+		}
+		if ((m_contactArray.GetCount() - contactStart) > 1)
+		{
+			ndSort<ndContact*, ndCompareContact>(&m_contactArray[contactStart], m_contactArray.GetCount() - contactStart, nullptr);
+		}
+	}
+}
+
+void ndScene::UnfreezeAllBodies()
+{
+	for (ndBodyListView::ndNode* node = m_bodyList.GetFirst(); node; node = node->GetNext())
+	{
+		ndBodyKinematic* const body = node->GetInfo()->GetAsBodyKinematic();
+		body->m_isFrozen = 0;
+		body->m_unfreezeQueued = 0;
+		body->m_hasFrozenContacts = 0;
+		ndBodyKinematic::ndContactMap::Iterator it(body->m_contactList);
+		for (it.Begin(); it; it++)
+		{
+			ndContact* const contact = *it;
+			if (contact->m_isFrozen)
+			{
+				contact->m_isFrozen = 0;
+				m_contactArray.PushBack(contact);
+			}
+		}
+	}
+	m_frozenBodyCount = 0;
+	m_unfreezeQueue.SetCount(0);
 }
 
 void ndScene::ApplyExtForce()
@@ -1452,10 +2526,20 @@ void ndScene::InitBodyArray()
 				ndAssert(!bodyNode->GetRight());
 
 				body->UpdateCollisionMatrix();
-				const ndInt32 test = ndBoxInclusionTest(body->m_minAabb, body->m_maxAabb, bodyNode->m_minBox, bodyNode->m_maxBox);
+				ndVector minBox(body->m_minAabb);
+				ndVector maxBox(body->m_maxAabb);
+				if (body->m_speculativeContacts)
+				{
+					// the leaf box of a speculative body covers the path of this step, 
+					// so that the pairs are found before the body gets to them.
+					const ndVector step(body->m_veloc.Scale(m_timestep) & ndVector::m_triplexMask);
+					minBox = minBox.GetMin(minBox + step);
+					maxBox = maxBox.GetMax(maxBox + step);
+				}
+				const ndInt32 test = ndBoxInclusionTest(minBox, maxBox, bodyNode->m_minBox, bodyNode->m_maxBox);
 				if (!test)
 				{
-					bodyNode->SetAabb(body->m_minAabb, body->m_maxAabb);
+					bodyNode->SetFatAabb(minBox, maxBox, body->m_veloc.Scale(m_timestep));
 				}
 				sceneEquilibrium = ndUnsigned8(!sceneForceUpdate & (test != 0));
 			}
@@ -1537,6 +2621,11 @@ void ndScene::InitBodyArray()
 			m_bvhSceneManager.UpdateScene(*this);
 		}
 	}
+
+	if (m_rootNode)
+	{
+		m_bvhSceneManager.UpdateFlatTree(*this, m_rootNode);
+	}
 	
 	ndBodyKinematic* const sentinelBody = m_sentinelBody;
 	sentinelBody->PrepareStep(GetActiveBodyArray().GetCount() - 1);
@@ -1556,10 +2645,12 @@ void ndScene::CreateNewContacts()
 {
 	D_TRACKTIME();
 	const ndInt32 contactCount = m_contactArray.GetCount();
-	m_scratchBuffer.SetCount(ndInt32((contactCount + m_newPairs.GetCount() + 16) * sizeof(ndContact*)));
+	m_frameContactArray = GetFrameArena().Alloc<ndContact*>(contactCount + m_newPairs.GetCount() + 16);
 
-	ndContact** const tmpJointsArray = (ndContact**)&m_scratchBuffer[0];
-	auto CreateNewContacts = ndMakeObject::ndFunction([this, tmpJointsArray](ndInt32 threadIndex, ndInt32 threadCount)
+	ndContact** const tmpJointsArray = m_frameContactArray;
+	m_contactPairMap.Reserve(m_newPairs.GetCount());
+	ndAtomic<ndInt32> duplicatedPairs(0);
+	auto CreateNewContacts = ndMakeObject::ndFunction([this, tmpJointsArray, &duplicatedPairs](ndInt32 threadIndex, ndInt32 threadCount)
 	{
 		D_TRACKTIME_NAMED(CreateNewContacts);
 		const ndArray<ndContactPairs>& newPairs = m_newPairs;
@@ -1576,8 +2667,16 @@ void ndScene::CreateNewContacts()
 
 			ndContact* const contact = new ndContact;
 			contact->SetBodies(body0, body1);
-			contact->AttachToBodies();
+			if (!m_contactPairMap.Insert(contact))
+			{
+				// the pair was submitted twice, the first contact owns it
+				delete contact;
+				tmpJointsArray[i] = nullptr;
+				duplicatedPairs.fetch_add(1);
+				continue;
+			}
 
+			contact->AttachToBodies();
 			ndAssert(contact->m_body0->GetInvMass() != ndFloat32(0.0f));
 			contact->m_material = m_contactNotifyCallback->GetMaterial(contact, body0->GetCollisionShape(), body1->GetCollisionShape());
 			tmpJointsArray[i] = contact;
@@ -1585,9 +2684,23 @@ void ndScene::CreateNewContacts()
 	});
 	ParallelExecute(CreateNewContacts);
 
+	if (duplicatedPairs.load())
+	{
+		ndInt32 count = 0;
+		for (ndInt32 i = 0; i < m_newPairs.GetCount(); ++i)
+		{
+			if (tmpJointsArray[i])
+			{
+				tmpJointsArray[count] = tmpJointsArray[i];
+				count++;
+			}
+		}
+		m_newPairs.SetCount(count);
+	}
+
 	if (contactCount)
 	{
-		D_TRACKTIME_NAMED(CopyContactArray)
+		D_TRACKTIME_NAMED(CopyContactArray);
 		const ndInt32 start = m_newPairs.GetCount();
 		ndContact** const contactArray = &m_contactArray[0];
 		for (ndInt32 i = 0; i < contactCount; ++i)
@@ -1604,28 +2717,31 @@ void ndScene::CalculateContacts()
 	m_activeConstraintArray.SetCount(0);
 	const ndInt32 contactCount = m_contactArray.GetCount() + m_newPairs.GetCount();
 	m_contactArray.SetCount(contactCount);
-	if (contactCount)
+	for (ndInt32 i = 0; i < m_threadData.GetCount(); ++i)
 	{
-		ndAtomic<ndInt32> count(0);
-		ndContact** const tmpJointsArray = (ndContact**)&m_scratchBuffer[0];
-		auto CalculateContactPoints = ndMakeObject::ndFunction([this, &count, tmpJointsArray](ndInt32 threadIndex, ndInt32 threadCount)
+		for (ndInt32 j = 0; j < ndContactSolver::m_contactBatchCount; ++j)
 		{
-			D_TRACKTIME_NAMED(CalculateContactPoints);
-			const ndInt32 jointCount = m_contactArray.GetCount();
+			m_threadData[i]->m_contactBatches[j].SetCount(0);
+		}
+	}
 
-			const ndStartEnd startEnd(jointCount, threadIndex, threadCount);
-			for (ndInt32 i = count.fetch_add(1); i < jointCount; i = count.fetch_add(1))
+	if (contactCount)
+	{
+		ndContact** const tmpJointsArray = m_frameContactArray;
+		auto CalculateContactPoints = [this, tmpJointsArray](ndInt32 threadIndex, ndInt32 i)
+		{
+			ndContact* const contact = tmpJointsArray[i];
+			ndAssert(contact);
+			if (!contact->m_isDead)
 			{
-				ndContact* const contact = tmpJointsArray[i];
-				ndAssert(contact);
-				if (!contact->m_isDead)
-				{
-					CalculateContacts(threadIndex, contact);
-				}
+				CalculateContacts(threadIndex, contact);
 			}
-		});
-		ParallelExecute(CalculateContactPoints);
+		};
+		D_TRACKTIME_NAMED(CalculateContactPoints);
+		ParallelFor(0, contactCount, D_SCENE_CONTACTS_GRAIN, CalculateContactPoints);
 	}
+	CalculateBatchedContacts();
+	CalculateSpeculativeContacts();
 }
 
 void ndScene::DeleteDeadContacts()
@@ -1662,7 +2778,7 @@ void ndScene::DeleteDeadContacts()
 	if (m_contactArray.GetCount())
 	{
 		D_TRACKTIME();
-		ndContact** const tmpJointsArray = (ndContact**)&m_scratchBuffer[0];
+		ndContact** const tmpJointsArray = m_frameContactArray;
 		ndCountingSort<ndContact*, ndJointActive, 2>(*this, tmpJointsArray, &m_contactArray[0], m_contactArray.GetCount(), prefixScan, nullptr);
 		if (prefixScan[m_dead + 1] != prefixScan[m_dead])
 		{
@@ -1680,6 +2796,7 @@ void ndScene::DeleteDeadContacts()
 					ndAssert(contact->m_isDead);
 					if (contact->m_isAttached)
 					{
+						m_contactPairMap.Remove(contact);
 						contact->DetachFromBodies();
 					}
 					delete contact;
@@ -26,6 +26,8 @@
 #include "ndBvhNode.h"
 #include "ndBodyListView.h"
 #include "ndContactArray.h"
+#include "ndContactPairMap.h"
+#include "ndContactSolver.h"
 #include "ndPolygonMeshDesc.h"
 
 #define D_SCENE_MAX_STACK_DEPTH		256
@@ -36,6 +38,7 @@ class ndContact;
 class ndRayCastNotify;
 class ndContactNotify;
 class ndConvexCastNotify;
+class ndRayCastHit;
 class ndBodiesInAabbNotify;
 class ndJointBilateralConstraint;
 
@@ -71,6 +74,36 @@ class ndScene : public ndThreadPool
 		ndUnsigned32 m_body1;
 	};
 
+	// a contact waiting for the batched narrow phase, and whether it was active before
+	class ndBatchedContact
+	{
+		public:
+		ndContact* m_contact;
+		bool m_active;
+		bool m_swapped;
+	};
+
+	// scratch state owned by one worker thread, the trailing 
+	// padding keeps neighbor slots off each other cache lines.
+	class ndThreadData: public ndClassAlloc
+	{
+		public:
+		ndThreadData()
+			:ndClassAlloc()
+			,m_partialNewPairs(256)
+			,m_frameArena()
+		{
+		}
+
+		ndArray<ndContactPairs> m_partialNewPairs;
+		ndArray<ndBatchedContact> m_contactBatches[ndContactSolver::m_contactBatchCount];
+		ndArray<ndBatchedContact> m_speculativeContacts;
+		ndFrameArena m_frameArena;
+		ndPolygonMeshDesc::ndStaticMeshFaceQuery m_staticMeshQuery;
+		ndPolygonMeshDesc::ndProceduralStaticMeshFaceQuery m_proceduralStaticMeshQuery;
+		char m_padding[D_WORKER_CACHE_LINE];
+	};
+
 	public:
 	D_COLLISION_API virtual ~ndScene();
 	D_COLLISION_API virtual bool AddBody(const ndSharedPtr<ndBody>& body);
@@ -95,10 +128,12 @@ class ndScene : public ndThreadPool
 	D_COLLISION_API virtual void BodiesInAabb(ndBodiesInAabbNotify& callback, const ndVector& minBox, const ndVector& maxBox) const;
 	D_COLLISION_API virtual bool RayCast(ndRayCastNotify& callback, const ndVector& globalOrigin, const ndVector& globalDest) const;
 	D_COLLISION_API virtual bool ConvexCast(ndConvexCastNotify& callback, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const;
+	D_COLLISION_API void RayCastBatch(const ndFastRay* const rays, ndInt32 count, ndRayCastHit* const results);
 
 	D_COLLISION_API void SendBackgroundTask(ndBackgroundTask* const job);
 
 	ndInt32 GetThreadCount() const;
+	D_COLLISION_API virtual void SetThreadCount(ndInt32 count);
 
 	virtual ndWorld* GetWorld() const;
 	const ndBodyListView& GetBodyList() const;
@@ -107,33 +142,61 @@ class ndScene : public ndThreadPool
 	ndArray<ndBodyKinematic*>& GetActiveBodyArray();
 	const ndArray<ndBodyKinematic*>& GetActiveBodyArray() const;
 
+	ndInt32 GetFrozenBodyCount() const;
+
 	ndArray<ndConstraint*>& GetActiveContactArray();
 	const ndArray<ndConstraint*>& GetActiveContactArray() const;
 
-	ndArray<ndUnsigned8>& GetScratchBuffer();
+	ndFrameArena& GetFrameArena(ndInt32 threadIndex);
+	// the arena of the calling thread, serial code outside a parallel 
+	// region gets the arena the caller uses inside parallel regions.
+	ndFrameArena& GetFrameArena();
+	D_COLLISION_API void ResetFrameArenas();
 
 	ndFloat32 GetTimestep() const;
 	void SetTimestep(ndFloat32 timestep);
+
+	// the bvh cost is sampled every few frames and after each build
+	ndFloat32 GetBvhCost() const;
+	ndUnsigned32 GetBvhBuildCount() const;
+	ndUnsigned32 GetBvhRotationCount() const;
+	ndBvhSceneManager::ndBuildMethod GetBvhBuildMethod() const;
+	D_COLLISION_API void SetBvhBuildMethod(ndBvhSceneManager::ndBuildMethod method);
 	ndBodyKinematic* GetSentinelBody() const;
 
 	protected:
 	D_COLLISION_API ndScene();
 	D_COLLISION_API ndScene(const ndScene& src);
 	bool ValidateContactCache(ndContact* const contact, const ndVector& timestep) const;
+	void ResizeThreadData();
+
+	void FreezeIslands();
+	void UnfreezeIslands();
+	void UnfreezeAllBodies();
+	void UnfreezeBody(ndBodyKinematic* const body);
+	void SortNewPairs();
 
 	const ndContactArray& GetContactArray() const;
-	void FindCollidingPairs(ndBodyKinematic* const body, ndInt32 threadId);
-	void FindCollidingPairsForward(ndBodyKinematic* const body, ndInt32 threadId);
-	void FindCollidingPairsBackward(ndBodyKinematic* const body, ndInt32 threadId);
 	void AddPair(ndBodyKinematic* const body0, ndBodyKinematic* const body1, ndInt32 threadId);
-	void SubmitPairs(ndBvhLeafNode* const bodyNode, ndBvhNode* const node, bool forward, ndInt32 threadId);
+	void SubmitPairs(ndBodyKinematic* const body, bool sceneBody, ndInt32 threadId);
+
+	void CalculateJointContacts(ndInt32 threadIndex, ndContact* const contact, bool speculative);
+	void ProcessContacts(ndInt32 threadIndex, ndInt32 contactCount, ndContact* const contact, const ndContactPoint* const contactArray);
+	void UpdateContactState(ndContact* const contact, bool active);
 
-	void CalculateJointContacts(ndInt32 threadIndex, ndContact* const contact);
-	void ProcessContacts(ndInt32 threadIndex, ndInt32 contactCount, ndContactSolver* const contactSolver);
+	bool AddBatchedContact(ndInt32 threadIndex, ndContact* const contact, bool active);
+	void ProcessBatchedContact(ndInt32 threadIndex, const ndContactSolver::ndContactBatch& batch, ndInt32 lane, bool active);
+	void CalculateBatchedContacts();
+	bool AddSpeculativeContact(ndInt32 threadIndex, ndContact* const contact, bool active);
+	void CalculateSpeculativeContacts();
 
 	ndJointBilateralConstraint* FindBilateralJoint(ndBodyKinematic* const body0, ndBodyKinematic* const body1) const;
+	bool RayCast(ndRayCastNotify& callback, const ndFastRay& ray) const;
+	void RayCastPacket(const ndFastRay** const rays, ndRayCastHit** const results, ndInt32 count) const;
 	bool RayCast(ndRayCastNotify& callback, const ndBvhNode** stackPool, ndFloat32* const distance, ndInt32 stack, const ndFastRay& ray) const;
+	bool ConvexCast(ndConvexCastNotify& callback, const ndFastRay& ray, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const;
 	bool ConvexCast(ndConvexCastNotify& callback, const ndBvhNode** stackPool, ndFloat32* const distance, ndInt32 stack, const ndFastRay& ray, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const;
+	void ConvexCastBody(ndConvexCastNotify& callback, ndBody* const body, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const;
 
 	// call from sub steps update
 	D_COLLISION_API virtual void ApplyExtForce();
@@ -157,27 +220,34 @@ class ndScene : public ndThreadPool
 	ndBodyListView m_bodyList;
 	ndBodyList m_particleSetList;
 	ndContactArray m_contactArray;
+	ndContactPairMap m_contactPairMap;
 	ndBvhSceneManager m_bvhSceneManager;
-	ndArray<ndUnsigned8> m_scratchBuffer;
 	ndArray<ndBodyKinematic*> m_sceneBodyArray;
+	ndArray<ndBodyKinematic*> m_activeBodyArray;
+	ndArray<ndBodyKinematic*> m_unfreezeQueue;
+	ndArray<ndBodyKinematic*> m_freezeStack;
 	ndArray<ndConstraint*> m_activeConstraintArray;
 	ndSpecialList<ndBodyKinematic> m_specialUpdateList;
 	ndThreadBackgroundWorker m_backgroundThread;
 	ndArray<ndContactPairs> m_newPairs;
-	ndArray<ndContactPairs> m_partialNewPairs[D_MAX_THREADS_COUNT];
-	ndPolygonMeshDesc::ndStaticMeshFaceQuery m_staticMeshQuery[D_MAX_THREADS_COUNT];
-	ndPolygonMeshDesc::ndProceduralStaticMeshFaceQuery m_proceduralStaticMeshQuery[D_MAX_THREADS_COUNT];
+	ndArray<ndThreadData*> m_threadData;
 
 	ndSpinLock m_lock;
 	ndBvhNode* m_rootNode;
 	ndBodyKinematic* m_sentinelBody;
 	ndContactNotify* m_contactNotifyCallback;
+	ndContact** m_frameContactArray;
 	
 	ndFloat32 m_timestep;
 	ndUnsigned32 m_lru;
 	ndUnsigned32 m_frameNumber;
 	ndUnsigned32 m_subStepNumber;
 	ndUnsigned32 m_forceBalanceSceneCounter;
+	ndUnsigned32 m_rotateScenePasses;
+	ndUnsigned32 m_freezeMark;
+	ndInt32 m_frozenBodyCount;
+	ndUnsigned64 m_speculativeBudget;
+	bool m_deterministic;
 
 	static ndVector m_velocTol;
 	static ndVector m_linearContactError2;
@@ -216,9 +286,15 @@ inline ndInt32 ndScene::GetThreadCount() const
 	return pool.GetThreadCount();
 }
 
-inline ndArray<ndUnsigned8>& ndScene::GetScratchBuffer()
+inline ndFrameArena& ndScene::GetFrameArena(ndInt32 threadIndex)
 {
-	return m_scratchBuffer;
+	return m_threadData[threadIndex]->m_frameArena;
+}
+
+inline ndFrameArena& ndScene::GetFrameArena()
+{
+	const ndInt32 threadIndex = GetCallerThreadIndex();
+	return GetFrameArena((threadIndex >= 0) ? threadIndex : GetThreadCount() - 1);
 }
 
 inline const ndBodyList& ndScene::GetParticleList() const
@@ -248,12 +324,17 @@ inline const ndArray<ndConstraint*>& ndScene::GetActiveContactArray() const
 
 inline ndArray<ndBodyKinematic*>& ndScene::GetActiveBodyArray()
 {
-	return m_bodyList.GetView();
+	return m_activeBodyArray;
 }
 
 inline const ndArray<ndBodyKinematic*>& ndScene::GetActiveBodyArray() const
 {
-	return m_bodyList.GetView();
+	return m_activeBodyArray;
+}
+
+inline ndInt32 ndScene::GetFrozenBodyCount() const
+{
+	return m_frozenBodyCount;
 }
 
 inline ndFloat32 ndScene::GetTimestep() const
@@ -266,6 +347,26 @@ inline void ndScene::SetTimestep(ndFloat32 timestep)
 	m_timestep = timestep;
 }
 
+inline ndFloat32 ndScene::GetBvhCost() const
+{
+	return m_bvhSceneManager.GetCost();
+}
+
+inline ndUnsigned32 ndScene::GetBvhBuildCount() const
+{
+	return m_bvhSceneManager.GetBuildCount();
+}
+
+inline ndUnsigned32 ndScene::GetBvhRotationCount() const
+{
+	return m_bvhSceneManager.GetRotationCount();
+}
+
+inline ndBvhSceneManager::ndBuildMethod ndScene::GetBvhBuildMethod() const
+{
+	return m_bvhSceneManager.GetBuildMethod();
+}
+
 inline ndBodyKinematic* ndScene::GetSentinelBody() const
 {
 	return m_sentinelBody;
@@ -242,6 +242,7 @@ class ndShape: public ndContainersFreeListAlloc<ndShape>
 
 	virtual ndInt32 GetConvexVertexCount() const;
 
+	ndShapeID GetCollisionId() const;
 	ndVector GetObbSize() const;
 	ndVector GetObbOrigin() const;
 	ndFloat32 GetUmbraClipSize() const;
@@ -319,6 +320,11 @@ inline ndMatrix ndShape::CalculateInertiaAndCenterOfMass(const ndMatrix&, const
 	return ndGetZeroMatrix();
 }
 
+inline ndShapeID ndShape::GetCollisionId() const
+{
+	return m_collisionId;
+}
+
 inline ndVector ndShape::GetObbOrigin() const
 {
 	return m_boxOrigin;
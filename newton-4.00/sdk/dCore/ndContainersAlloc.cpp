@@ -23,187 +23,362 @@
 #include "ndUtils.h"
 #include "ndMemory.h"
 #include "ndClassAlloc.h"
-#include "ndFixSizeArray.h"
 #include "ndContainersAlloc.h"
 
-#define D_FREELIST_DICTIONARY_SIZE 64
+// chunks are grouped in size classes multiple of the granularity,
+// larger requests go straight to the heap.
+#define D_FREELIST_GRANULARITY		32
+#define D_FREELIST_CLASS_COUNT		128
+#define D_FREELIST_MAX_SIZE			(D_FREELIST_GRANULARITY * D_FREELIST_CLASS_COUNT)
+
+// threads move chunks to and from the depot in batches of this size,
+// a thread keeps at most two batches of each class.
+#define D_FREELIST_BATCH_SIZE		32
+
+// lock free depot slots per class, the overflow goes to a locked list
+#define D_FREELIST_DEPOT_SLOTS		32
 
 class ndFreeListEntry
 {
 	public:
 	ndFreeListEntry* m_next;
+	// only valid in the first entry of a batch in the depot overflow list
+	ndFreeListEntry* m_nextBatch;
 };
 
-class ndFreeListHeader
+class ndFreeListClass
 {
 	public:
-	ndInt32 m_count;
-	ndInt32 m_schunkSize;
-	ndFreeListEntry* m_headPointer;
+	ndFreeListClass()
+		:m_heapChunks(0)
+		,m_depotChunks(0)
+		,m_refills(0)
+		,m_returns(0)
+		,m_overflow(nullptr)
+		,m_lock()
+	{
+		for (ndInt32 i = 0; i < D_FREELIST_DEPOT_SLOTS; ++i)
+		{
+			m_slots[i].store(nullptr);
+		}
+	}
+
+	ndAtomic<ndFreeListEntry*> m_slots[D_FREELIST_DEPOT_SLOTS];
+	ndAtomic<ndInt32> m_heapChunks;
+	ndAtomic<ndInt32> m_depotChunks;
+	ndAtomic<ndInt32> m_refills;
+	ndAtomic<ndInt32> m_returns;
+	// changed under the lock, but peeked at without it
+	ndAtomic<ndFreeListEntry*> m_overflow;
+	ndSpinLock m_lock;
 };
 
-class ndFreeListDictionary: public ndFixSizeArray<ndFreeListHeader, D_FREELIST_DICTIONARY_SIZE>
+// the global depot, threads only touch it to exchange whole batches. 
+// slots are claimed with an exchange and filled with a compare exchange 
+// from null, so no pointer is ever compared against a stale value.
+class ndFreeListDepot
 {
 	public:
-	ndFreeListDictionary()
-		:ndFixSizeArray<ndFreeListHeader, D_FREELIST_DICTIONARY_SIZE>()
-		,m_lock()
+	ndFreeListDepot()
 	{
 	}
 
-	~ndFreeListDictionary()
+	~ndFreeListDepot()
 	{
 		Flush();
 	}
 
-	static ndFreeListDictionary& GetHeader()
+	static ndFreeListDepot& GetDepot()
 	{
-		static ndFreeListDictionary dictionary;
-		return dictionary;
+		static ndFreeListDepot depot;
+		return depot;
 	}
 
-	void Flush(ndFreeListHeader* const header)
+	static ndInt32 GetClass(ndInt32 size)
 	{
-		ndFreeListEntry* next;
-		for (ndFreeListEntry* node = header->m_headPointer; node; node = next)
+		ndAssert(size > 0);
+		return (size + D_FREELIST_GRANULARITY - 1) / D_FREELIST_GRANULARITY - 1;
+	}
+
+	static ndInt32 GetChunkSize(ndInt32 sizeClass)
+	{
+		return (sizeClass + 1) * D_FREELIST_GRANULARITY;
+	}
+
+	void* AllocChunk(ndInt32 sizeClass)
+	{
+		m_classes[sizeClass].m_heapChunks.fetch_add(1);
+		return ndMemory::Malloc(size_t(GetChunkSize(sizeClass)));
+	}
+
+	void FreeChunk(ndInt32 sizeClass, void* const ptr)
+	{
+		m_classes[sizeClass].m_heapChunks.fetch_sub(1);
+		ndMemory::Free(ptr);
+	}
+
+	ndFreeListEntry* PopBatch(ndInt32 sizeClass, ndInt32 startSlot)
+	{
+		ndFreeListClass& freeList = m_classes[sizeClass];
+		for (ndInt32 i = 0; i < D_FREELIST_DEPOT_SLOTS; ++i)
 		{
-			next = node->m_next;
-			ndMemory::Free(node);
+			ndAtomic<ndFreeListEntry*>& slot = freeList.m_slots[(startSlot + i) & (D_FREELIST_DEPOT_SLOTS - 1)];
+			if (slot.load())
+			{
+				ndFreeListEntry* const batch = slot.exchange(nullptr);
+				if (batch)
+				{
+					freeList.m_refills.fetch_add(1);
+					freeList.m_depotChunks.fetch_sub(D_FREELIST_BATCH_SIZE);
+					return batch;
+				}
+			}
 		}
-		header->m_count = 0;
-		header->m_headPointer = nullptr;
+
+		ndFreeListEntry* batch = nullptr;
+		if (freeList.m_overflow.load())
+		{
+			ndScopeSpinLock lock(freeList.m_lock);
+			batch = freeList.m_overflow.load();
+			if (batch)
+			{
+				freeList.m_overflow.store(batch->m_nextBatch);
+				freeList.m_refills.fetch_add(1);
+				freeList.m_depotChunks.fetch_sub(D_FREELIST_BATCH_SIZE);
+			}
+		}
+		return batch;
 	}
 
-	void* Malloc(ndInt32 size)
+	void PushBatch(ndInt32 sizeClass, ndInt32 startSlot, ndFreeListEntry* const batch)
 	{
+		ndFreeListClass& freeList = m_classes[sizeClass];
+		freeList.m_returns.fetch_add(1);
+		freeList.m_depotChunks.fetch_add(D_FREELIST_BATCH_SIZE);
+		for (ndInt32 i = 0; i < D_FREELIST_DEPOT_SLOTS; ++i)
 		{
-			ndScopeSpinLock lock(m_lock);
-			ndFreeListHeader* const header = FindEntry(ndMemory::CalculateBufferSize(size_t(size)));
-			ndAssert(header->m_count >= 0);
-			if (header->m_count)
+			ndAtomic<ndFreeListEntry*>& slot = freeList.m_slots[(startSlot + i) & (D_FREELIST_DEPOT_SLOTS - 1)];
+			if (!slot.load())
 			{
-				header->m_count--;
-				ndFreeListEntry* const self = header->m_headPointer;
-				header->m_headPointer = self->m_next;
-				return self;
+				ndFreeListEntry* empty = nullptr;
+				if (slot.compare_exchange_weak(empty, batch))
+				{
+					return;
+				}
 			}
 		}
-		void* const ptr = ndMemory::Malloc(size_t(size));
-		ndAssert(ndMemory::GetSize(ptr) == ndMemory::CalculateBufferSize(size_t(size)));
-		return ptr;
+
+		ndScopeSpinLock lock(freeList.m_lock);
+		batch->m_nextBatch = freeList.m_overflow.load();
+		freeList.m_overflow.store(batch);
 	}
 
-	void Free(void* ptr)
+	void FreeBatch(ndInt32 sizeClass, ndFreeListEntry* const batch)
 	{
-		ndScopeSpinLock lock(m_lock);
-		ndFreeListHeader* const header = FindEntry(ndMemory::GetSize(ptr));
-		ndAssert(header);
-		ndFreeListEntry* const self = (ndFreeListEntry*)ptr;
-
-		self->m_next = header->m_headPointer;
-		header->m_count++;
-		header->m_headPointer = self;
+		ndFreeListEntry* next;
+		for (ndFreeListEntry* entry = batch; entry; entry = next)
+		{
+			next = entry->m_next;
+			FreeChunk(sizeClass, entry);
+		}
 	}
 
-	void Flush()
+	void Flush(ndInt32 sizeClass)
 	{
-		ndScopeSpinLock lock(m_lock);
-		ndFreeListDictionary& me = *this;
-		for (ndInt32 i = 0; i < GetCount(); ++i)
+		ndFreeListClass& freeList = m_classes[sizeClass];
+		for (ndInt32 i = 0; i < D_FREELIST_DEPOT_SLOTS; ++i)
 		{
-			ndFreeListHeader* const header = &me[i];
-			Flush(header);
+			ndFreeListEntry* const batch = freeList.m_slots[i].exchange(nullptr);
+			if (batch)
+			{
+				freeList.m_depotChunks.fetch_sub(D_FREELIST_BATCH_SIZE);
+				FreeBatch(sizeClass, batch);
+			}
 		}
-		SetCount(0);
+
+		ndScopeSpinLock lock(freeList.m_lock);
+		ndFreeListEntry* nextBatch;
+		for (ndFreeListEntry* batch = freeList.m_overflow.load(); batch; batch = nextBatch)
+		{
+			nextBatch = batch->m_nextBatch;
+			freeList.m_depotChunks.fetch_sub(D_FREELIST_BATCH_SIZE);
+			FreeBatch(sizeClass, batch);
+		}
+		freeList.m_overflow.store(nullptr);
 	}
 
-	void Flush(ndInt32 size)
+	void Flush()
 	{
-		ndScopeSpinLock lock(m_lock);
-		ndFreeListHeader* const header = FindEntry(ndMemory::CalculateBufferSize(size_t(size)));
-		Flush(header);
+		for (ndInt32 i = 0; i < D_FREELIST_CLASS_COUNT; ++i)
+		{
+			Flush(i);
+		}
 	}
 
-	private:
-	ndFreeListHeader* FindEntry(ndInt32 size)
+	ndInt32 GetStats(ndMemoryFreeListStats* const stats, ndInt32 maxCount) const
 	{
-		ndInt32 i0 = 0;
-		ndInt32 i1 = GetCount() - 1;
-		ndFreeListDictionary& me = *this;
-		while ((i1 - i0 > 4))
+		ndInt32 count = 0;
+		for (ndInt32 i = 0; (i < D_FREELIST_CLASS_COUNT) && (count < maxCount); ++i)
 		{
-			ndInt32 mid = (i1 + i0) / 2;
-			if (me[mid].m_schunkSize <= size)
+			const ndFreeListClass& freeList = m_classes[i];
+			if (freeList.m_heapChunks.load() || freeList.m_refills.load() || freeList.m_returns.load())
 			{
-				i0 = mid;
-			}
-			else
-			{
-				i1 = mid;
+				ndMemoryFreeListStats& entry = stats[count];
+				entry.m_chunkSize = GetChunkSize(i);
+				entry.m_heapChunks = freeList.m_heapChunks.load();
+				entry.m_depotChunks = freeList.m_depotChunks.load();
+				entry.m_refills = freeList.m_refills.load();
+				entry.m_returns = freeList.m_returns.load();
+				count++;
 			}
 		}
+		return count;
+	}
+
+	ndFreeListClass m_classes[D_FREELIST_CLASS_COUNT];
+};
+
+// each thread caches up to two batches per class, chunks 
+// are allocated and freed with no synchronization at all.
+class ndFreeListThreadCache
+{
+	public:
+	class ndCache
+	{
+		public:
+		ndFreeListEntry* m_head;
+		ndInt32 m_count;
+	};
+
+	ndFreeListThreadCache()
+		:m_depot(ndFreeListDepot::GetDepot())
+	{
+		// spread the threads over the depot slots
+		static ndAtomic<ndInt32> threadCount(0);
+		m_startSlot = threadCount.fetch_add(1) * 7;
+		for (ndInt32 i = 0; i < D_FREELIST_CLASS_COUNT; ++i)
+		{
+			m_caches[i].m_head = nullptr;
+			m_caches[i].m_count = 0;
+		}
+	}
+
+	~ndFreeListThreadCache()
+	{
+		Flush();
+	}
+
+	static ndFreeListThreadCache& GetCache()
+	{
+		static thread_local ndFreeListThreadCache cache;
+		return cache;
+	}
 
-		for (ndInt32 i = i0; i <= i1; ++i)
+	void* Malloc(ndInt32 sizeClass)
+	{
+		ndCache& cache = m_caches[sizeClass];
+		if (!cache.m_count)
 		{
-			if (me[i].m_schunkSize == size)
+			ndFreeListEntry* const batch = m_depot.PopBatch(sizeClass, m_startSlot);
+			if (!batch)
 			{
-				return &me[i];
+				return m_depot.AllocChunk(sizeClass);
 			}
+			cache.m_head = batch;
+			cache.m_count = D_FREELIST_BATCH_SIZE;
 		}
 
-		#ifdef _DEBUG
-			for (ndInt32 i = 0; i < GetCount(); ++i)
-			{
-				ndAssert(me[i].m_schunkSize != size);
-			}
-		#endif
-
-		ndFreeListHeader header;
-		header.m_count = 0;
-		header.m_schunkSize = size;
-		header.m_headPointer = nullptr;
-		PushBack(header);
-		ndInt32 index = GetCount() - 1;
-		for (ndInt32 i = GetCount() - 2; i >= 0; --i)
+		ndFreeListEntry* const self = cache.m_head;
+		cache.m_head = self->m_next;
+		cache.m_count--;
+		return self;
+	}
+
+	void Free(ndInt32 sizeClass, void* const ptr)
+	{
+		ndCache& cache = m_caches[sizeClass];
+		ndFreeListEntry* const self = (ndFreeListEntry*)ptr;
+		self->m_next = cache.m_head;
+		cache.m_head = self;
+		cache.m_count++;
+
+		if (cache.m_count == 2 * D_FREELIST_BATCH_SIZE)
 		{
-			if (size < me[i].m_schunkSize)
+			// the first batch goes to the depot, the entries 
+			// at the head are the hottest, so they stay.
+			ndFreeListEntry* tail = cache.m_head;
+			for (ndInt32 i = 1; i < D_FREELIST_BATCH_SIZE; ++i)
 			{
-				me[i + 1] = me[i];
-				me[i + 0] = header;
-				index = i;
-			}
-			else
-			{
-				break;
+				tail = tail->m_next;
 			}
+			ndFreeListEntry* const batch = tail->m_next;
+			tail->m_next = nullptr;
+			cache.m_count = D_FREELIST_BATCH_SIZE;
+			m_depot.PushBatch(sizeClass, m_startSlot, batch);
 		}
-		return &me[index];
 	}
 
-	ndSpinLock m_lock;
+	void Flush(ndInt32 sizeClass)
+	{
+		ndCache& cache = m_caches[sizeClass];
+		m_depot.FreeBatch(sizeClass, cache.m_head);
+		cache.m_head = nullptr;
+		cache.m_count = 0;
+	}
+
+	void Flush()
+	{
+		for (ndInt32 i = 0; i < D_FREELIST_CLASS_COUNT; ++i)
+		{
+			Flush(i);
+		}
+	}
+
+	ndFreeListDepot& m_depot;
+	ndCache m_caches[D_FREELIST_CLASS_COUNT];
+	ndInt32 m_startSlot;
 };
 
 void ndFreeListAlloc::Flush()
 {
-	ndFreeListDictionary& dictionary = ndFreeListDictionary::GetHeader();
-	dictionary.Flush();
+	ndFreeListThreadCache::GetCache().Flush();
+	ndFreeListDepot::GetDepot().Flush();
 }
 
-void* ndFreeListAlloc::operator new (size_t size)
+void ndFreeListAlloc::Flush(ndInt32 size)
 {
-	ndFreeListDictionary& dictionary = ndFreeListDictionary::GetHeader();
-	return dictionary.Malloc(ndInt32 (size));
+	const ndInt32 sizeClass = ndFreeListDepot::GetClass(size);
+	if (sizeClass < D_FREELIST_CLASS_COUNT)
+	{
+		ndFreeListThreadCache::GetCache().Flush(sizeClass);
+		ndFreeListDepot::GetDepot().Flush(sizeClass);
+	}
 }
 
-void ndFreeListAlloc::operator delete (void* ptr)
+ndInt32 ndFreeListAlloc::GetStats(ndMemoryFreeListStats* const stats, ndInt32 maxCount)
 {
-	ndFreeListDictionary& dictionary = ndFreeListDictionary::GetHeader();
-	dictionary.Free(ptr);
+	return ndFreeListDepot::GetDepot().GetStats(stats, maxCount);
 }
 
-void ndFreeListAlloc::Flush(ndInt32 size)
+void* ndFreeListAlloc::operator new (size_t size)
 {
-	ndFreeListDictionary& dictionary = ndFreeListDictionary::GetHeader();
-	dictionary.Flush(size);
+	const ndInt32 sizeClass = ndFreeListDepot::GetClass(ndInt32(size));
+	if (sizeClass >= D_FREELIST_CLASS_COUNT)
+	{
+		return ndMemory::Malloc(size);
+	}
+	return ndFreeListThreadCache::GetCache().Malloc(sizeClass);
 }
 
+void ndFreeListAlloc::operator delete (void* ptr)
+{
+	const ndInt32 sizeClass = ndFreeListDepot::GetClass(ndMemory::GetSize(ptr) - ndMemory::CalculateBufferSize(0));
+	if (sizeClass >= D_FREELIST_CLASS_COUNT)
+	{
+		ndMemory::Free(ptr);
+	}
+	else
+	{
+		ndFreeListThreadCache::GetCache().Free(sizeClass, ptr);
+	}
+}
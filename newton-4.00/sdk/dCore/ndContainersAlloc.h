@@ -24,6 +24,8 @@
 
 #include "ndCoreStdafx.h"
 
+class ndMemoryFreeListStats;
+
 template<class T>
 class ndContainersAlloc: public ndClassAlloc
 {
@@ -47,6 +49,7 @@ class ndFreeListAlloc
 	ndFreeListAlloc();
 	D_CORE_API static void Flush();
 	D_CORE_API static void Flush(ndInt32 size);
+	D_CORE_API static ndInt32 GetStats(ndMemoryFreeListStats* const stats, ndInt32 maxCount);
 	D_CORE_API void *operator new (size_t size);
 	D_CORE_API void operator delete (void* ptr);
 };
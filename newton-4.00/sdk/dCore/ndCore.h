@@ -48,7 +48,11 @@
 #include <ndSemaphore.h>
 #include <ndSharedPtr.h>
 #include <ndClassAlloc.h>
+#include <ndFrameArena.h>
+#include <ndFrameStats.h>
+#include <ndCpuFeatures.h>
 #include <ndThreadPool.h>
+#include <ndTaskGraph.h>
 #include <ndIsoSurface.h>
 #include <ndQuaternion.h>
 #include <ndProbability.h>
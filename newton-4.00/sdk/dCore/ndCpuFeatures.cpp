@@ -0,0 +1,118 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include "ndCoreStdafx.h"
+#include "ndCpuFeatures.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	#include <intrin.h>
+#endif
+
+static ndUnsigned32 ndCpuFeatureMask = 0xffffffff;
+
+static ndUnsigned32 ndDetectCpuFeatures()
+{
+	ndUnsigned32 features = 0;
+	#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		int info[4];
+		__cpuid(info, 0);
+		const int maxLeaf = info[0];
+
+		__cpuid(info, 1);
+		features |= (info[3] & (1 << 26)) ? ndCpuFeatures::m_sse2 : 0;
+		features |= (info[2] & (1 << 19)) ? ndCpuFeatures::m_sse41 : 0;
+
+		// avx needs the os to save the ymm registers
+		const int osxsaveAvx = (1 << 27) | (1 << 28);
+		if (((info[2] & osxsaveAvx) == osxsaveAvx) && ((_xgetbv(0) & 0x06) == 0x06))
+		{
+			features |= ndCpuFeatures::m_avx;
+			features |= (info[2] & (1 << 12)) ? ndCpuFeatures::m_fma : 0;
+			if (maxLeaf >= 7)
+			{
+				__cpuidex(info, 7, 0);
+				features |= (info[1] & (1 << 5)) ? ndCpuFeatures::m_avx2 : 0;
+
+				// and avx512 the opmask and the upper zmm registers
+				const int avx512 = (1 << 16) | (1 << 17) | (1 << 30) | (1 << 31);
+				if (((info[1] & avx512) == avx512) && ((_xgetbv(0) & 0xe6) == 0xe6))
+				{
+					features |= ndCpuFeatures::m_avx512;
+				}
+			}
+		}
+	#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+		// these already check that the os saves the registers
+		__builtin_cpu_init();
+		features |= __builtin_cpu_supports("sse2") ? ndCpuFeatures::m_sse2 : 0;
+		features |= __builtin_cpu_supports("sse4.1") ? ndCpuFeatures::m_sse41 : 0;
+		features |= __builtin_cpu_supports("avx") ? ndCpuFeatures::m_avx : 0;
+		features |= __builtin_cpu_supports("fma") ? ndCpuFeatures::m_fma : 0;
+		features |= __builtin_cpu_supports("avx2") ? ndCpuFeatures::m_avx2 : 0;
+		if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+			__builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl"))
+		{
+			features |= ndCpuFeatures::m_avx512;
+		}
+	#elif defined(__aarch64__) || defined(__ARM_NEON)
+		features |= ndCpuFeatures::m_neon;
+	#endif
+	return features;
+}
+
+ndUnsigned32 ndCpuFeatures::GetDetectedFeatures()
+{
+	static const ndUnsigned32 features = ndDetectCpuFeatures();
+	return features;
+}
+
+ndUnsigned32 ndCpuFeatures::GetFeatures()
+{
+	return GetDetectedFeatures() & ndCpuFeatureMask;
+}
+
+ndUnsigned32 ndCpuFeatures::GetFeatureMask()
+{
+	return ndCpuFeatureMask;
+}
+
+void ndCpuFeatures::SetFeatureMask(ndUnsigned32 mask)
+{
+	ndCpuFeatureMask = mask;
+}
+
+const char* ndCpuFeatures::GetVectorInstructionSet()
+{
+	#ifdef D_SCALAR_VECTOR_CLASS
+		return "scalar";
+	#elif (defined (__x86_64) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64))
+		#ifdef D_NEWTON_USE_AVX2_OPTION
+			return "avx2";
+		#else
+			return "sse";
+		#endif
+	#elif (defined(__arm__) || defined(__aarch64__) || defined(__ARM_ARCH_ISA_A64) || defined(__ARM_ARCH_7S__) || defined(__ARM_ARCH_7A__))
+		return "neon";
+	#else
+		return "scalar";
+	#endif
+}
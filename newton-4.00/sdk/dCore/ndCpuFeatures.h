@@ -0,0 +1,71 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef __ND_CPU_FEATURES_H_
+#define __ND_CPU_FEATURES_H_
+
+#include "ndCoreStdafx.h"
+#include "ndTypes.h"
+
+// instruction sets of the cpu running the process, read with cpuid the 
+// first time they are asked for. the rest of the engine is compiled for 
+// a fix instruction set, only code in separate libraries, like the 
+// avx2 and avx512 solvers, can be selected with these flags.
+class ndCpuFeatures
+{
+	public:
+	enum ndFeature
+	{
+		m_sse2 = 1 << 0,
+		m_sse41 = 1 << 1,
+		m_avx = 1 << 2,
+		m_fma = 1 << 3,
+		m_avx2 = 1 << 4,
+		// avx512 foundation, dq, bw and vl, with os support for the zmm registers
+		m_avx512 = 1 << 5,
+		m_neon = 1 << 6,
+	};
+
+	// the features of the cpu, masked by the feature mask
+	D_CORE_API static ndUnsigned32 GetFeatures();
+
+	// the features of the cpu, ignoring the feature mask
+	D_CORE_API static ndUnsigned32 GetDetectedFeatures();
+
+	// hides features from GetFeatures, so that the code paths of older 
+	// cpus can be tested. the default mask, 0xffffffff, hides nothing. 
+	// it only affects code that asks after the change, like new worlds.
+	D_CORE_API static void SetFeatureMask(ndUnsigned32 mask);
+	D_CORE_API static ndUnsigned32 GetFeatureMask();
+
+	// the instruction set ndVector and the code using it were compiled for
+	D_CORE_API static const char* GetVectorInstructionSet();
+
+	static bool HasFeatures(ndUnsigned32 features);
+};
+
+inline bool ndCpuFeatures::HasFeatures(ndUnsigned32 features)
+{
+	return (GetFeatures() & features) == features;
+}
+
+#endif
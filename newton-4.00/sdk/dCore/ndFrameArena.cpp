@@ -0,0 +1,94 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndUtils.h"
+#include "ndMemory.h"
+#include "ndFrameArena.h"
+
+// the block header takes one alignment slot, so that the data stays aligned
+#define D_FRAME_ARENA_HEADER_SIZE	D_FRAME_ARENA_ALIGNMENT
+
+ndFrameArena::ndFrameArena()
+	:ndClassAlloc()
+	,m_blocks(nullptr)
+	,m_base(nullptr)
+	,m_offset(0)
+	,m_capacity(0)
+	,m_usedSize(0)
+	,m_peakSize(0)
+{
+	AddBlock(D_FRAME_ARENA_DEFAULT_SIZE);
+}
+
+ndFrameArena::~ndFrameArena()
+{
+	FreeBlocks();
+}
+
+void ndFrameArena::FreeBlocks()
+{
+	ndBlock* next;
+	for (ndBlock* block = m_blocks; block; block = next)
+	{
+		next = block->m_next;
+		ndMemory::Free(block);
+	}
+	m_blocks = nullptr;
+	m_base = nullptr;
+	m_offset = 0;
+	m_capacity = 0;
+}
+
+void ndFrameArena::AddBlock(ndInt32 sizeInBytes)
+{
+	ndBlock* const block = (ndBlock*)ndMemory::Malloc(size_t(sizeInBytes + D_FRAME_ARENA_HEADER_SIZE));
+	ndAssert(sizeof(ndBlock) <= D_FRAME_ARENA_HEADER_SIZE);
+	block->m_next = m_blocks;
+	block->m_size = sizeInBytes;
+	m_blocks = block;
+	m_base = ((ndInt8*)block) + D_FRAME_ARENA_HEADER_SIZE;
+	m_offset = 0;
+	m_capacity = sizeInBytes;
+}
+
+void* ndFrameArena::AllocNewBlock(ndInt32 sizeInBytes)
+{
+	// the rest of the current block is wasted until the next reset
+	AddBlock(ndMax(sizeInBytes, 2 * m_capacity));
+	void* const ptr = m_base;
+	m_offset = sizeInBytes;
+	m_usedSize += sizeInBytes;
+	return ptr;
+}
+
+void ndFrameArena::Reset()
+{
+	m_peakSize = ndMax(m_peakSize, m_usedSize);
+	if (m_blocks->m_next)
+	{
+		const ndInt32 size = (m_peakSize + D_FRAME_ARENA_DEFAULT_SIZE - 1) & -D_FRAME_ARENA_DEFAULT_SIZE;
+		FreeBlocks();
+		AddBlock(size);
+	}
+	m_offset = 0;
+	m_usedSize = 0;
+}
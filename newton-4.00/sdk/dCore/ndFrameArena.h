@@ -0,0 +1,108 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __ND_FRAME_ARENA_H_
+#define __ND_FRAME_ARENA_H_
+
+#include "ndCoreStdafx.h"
+#include "ndTypes.h"
+#include "ndClassAlloc.h"
+
+#define D_FRAME_ARENA_ALIGNMENT		32
+#define D_FRAME_ARENA_DEFAULT_SIZE	(64 * 1024)
+
+// a bump allocator for scratch memory that lives until the end of the frame.
+// allocations are never freed one by one, Reset releases all of them at once.
+// it is not thread safe, each thread must allocate from its own arena.
+// when a frame overflows the current block, the next Reset replaces all 
+// blocks by a single one large enough for the peak, so that after a few 
+// frames allocation is a pointer increment with no calls to the heap.
+class ndFrameArena: public ndClassAlloc
+{
+	public:
+	D_CORE_API ndFrameArena();
+	D_CORE_API ~ndFrameArena();
+
+	// memory is aligned to D_FRAME_ARENA_ALIGNMENT, and it is not initialized.
+	void* Alloc(ndInt32 sizeInBytes);
+
+	template <class T>
+	T* Alloc(ndInt32 count);
+
+	D_CORE_API void Reset();
+
+	// bytes handed out since the last reset
+	ndInt32 GetUsedSize() const;
+
+	// the largest used size seen at any reset
+	ndInt32 GetPeakSize() const;
+
+	private:
+	class ndBlock
+	{
+		public:
+		ndBlock* m_next;
+		ndInt32 m_size;
+	};
+
+	D_CORE_API void* AllocNewBlock(ndInt32 sizeInBytes);
+	void AddBlock(ndInt32 sizeInBytes);
+	void FreeBlocks();
+
+	ndBlock* m_blocks;
+	ndInt8* m_base;
+	ndInt32 m_offset;
+	ndInt32 m_capacity;
+	ndInt32 m_usedSize;
+	ndInt32 m_peakSize;
+};
+
+inline void* ndFrameArena::Alloc(ndInt32 sizeInBytes)
+{
+	ndAssert(sizeInBytes >= 0);
+	const ndInt32 size = (sizeInBytes + D_FRAME_ARENA_ALIGNMENT - 1) & -D_FRAME_ARENA_ALIGNMENT;
+	if ((m_offset + size) <= m_capacity)
+	{
+		void* const ptr = &m_base[m_offset];
+		m_offset += size;
+		m_usedSize += size;
+		return ptr;
+	}
+	return AllocNewBlock(size);
+}
+
+template <class T>
+inline T* ndFrameArena::Alloc(ndInt32 count)
+{
+	return (T*)Alloc(count * ndInt32(sizeof(T)));
+}
+
+inline ndInt32 ndFrameArena::GetUsedSize() const
+{
+	return m_usedSize;
+}
+
+inline ndInt32 ndFrameArena::GetPeakSize() const
+{
+	return m_peakSize;
+}
+
+#endif
@@ -0,0 +1,477 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndUtils.h"
+#include "ndFrameStats.h"
+#include "ndFixSizeArray.h"
+
+#define D_FRAME_STATS_ROOT	ndUnsigned64(-1)
+
+class ndFrameStatsThread: public ndClassAlloc
+{
+	public:
+	class ndEntry
+	{
+		public:
+		const char* m_name;
+		ndUnsigned64 m_parent;
+		ndUnsigned64 m_ticks;
+		ndUnsigned32 m_calls;
+	};
+
+	ndFrameStatsThread(ndInt32 slot)
+		:ndClassAlloc()
+		,m_slot(slot)
+	{
+		Clear();
+	}
+
+	void Clear()
+	{
+		m_count = 0;
+		m_busy = 0;
+		m_wait = 0;
+		memset(m_hash, -1, sizeof(m_hash));
+		memset(m_counters, 0, sizeof(m_counters));
+	}
+
+	ndUnsigned64 GetContext(ndInt32 entry) const
+	{
+		return (ndUnsigned64(m_slot) << 32) | ndUnsigned64(entry);
+	}
+
+	// find the zone by the dispatching zone and the name, the 
+	// name pointer is the key, names are merged by text later.
+	ndInt32 Find(ndUnsigned64 parent, const char* const name)
+	{
+		ndUnsigned64 key = (parent * ndUnsigned64(0x9e3779b97f4a7c15)) ^ ndUnsigned64(name);
+		key ^= key >> 29;
+		for (ndInt32 i = ndInt32(key & (D_FRAME_STATS_HASH_SIZE - 1)); ; i = (i + 1) & (D_FRAME_STATS_HASH_SIZE - 1))
+		{
+			const ndInt32 index = m_hash[i];
+			if (index < 0)
+			{
+				if (m_count == D_FRAME_STATS_MAX_ZONES)
+				{
+					return -1;
+				}
+				ndEntry& entry = m_entries[m_count];
+				entry.m_name = name;
+				entry.m_parent = parent;
+				entry.m_ticks = 0;
+				entry.m_calls = 0;
+				m_hash[i] = m_count;
+				m_count++;
+				return m_hash[i];
+			}
+			const ndEntry& entry = m_entries[index];
+			if ((entry.m_name == name) && (entry.m_parent == parent))
+			{
+				return index;
+			}
+		}
+	}
+
+	ndEntry m_entries[D_FRAME_STATS_MAX_ZONES];
+	ndInt32 m_hash[D_FRAME_STATS_HASH_SIZE];
+	ndUnsigned64 m_counters[ndFrameStats::m_counterCount];
+	ndUnsigned64 m_busy;
+	ndUnsigned64 m_wait;
+	ndInt32 m_count;
+	ndInt32 m_slot;
+};
+
+static thread_local ndFrameStatsThread* g_statsThread = nullptr;
+static thread_local ndUnsigned64 g_statsContext = D_FRAME_STATS_ROOT;
+
+ndFrameStats::ndFrameStats()
+	:ndClassAlloc()
+	,m_zones(64)
+	,m_threads(8)
+{
+	Clear();
+}
+
+void ndFrameStats::Clear()
+{
+	m_zones.SetCount(0);
+	m_threads.SetCount(0);
+	memset(m_counters, 0, sizeof(m_counters));
+	m_frameTime = ndFloat64(0.0f);
+	m_frameNumber = 0;
+}
+
+const char* ndFrameStats::GetCounterName(ndCounter counter)
+{
+	static const char* names[] =
+	{
+		"pairQueries",
+		"pairsTested",
+		"contactsGenerated",
+		"gjkIterations",
+		"solverPasses",
+		"islands",
+		"bodiesAwake",
+		"speculativePairs",
+	};
+	ndAssert(ndInt32(sizeof(names) / sizeof(names[0])) == m_counterCount);
+	return names[counter];
+}
+
+void ndFrameStats::AddCount(ndCounter counter, ndUnsigned64 count)
+{
+	ndFrameStatsThread* const thread = g_statsThread;
+	if (thread)
+	{
+		thread->m_counters[counter] += count;
+	}
+}
+
+bool ndFrameStats::ExportCsv(const char* const fileName) const
+{
+	FILE* const file = fopen(fileName, "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	fprintf(file, "type,name,parent,depth,calls,value\n");
+	fprintf(file, "frame,frameTime,-1,0,%u,%f\n", m_frameNumber, m_frameTime);
+	for (ndInt32 i = 0; i < m_zones.GetCount(); ++i)
+	{
+		const ndZone& zone = m_zones[i];
+		fprintf(file, "zone,%s,%d,%d,%u,%f\n", zone.m_name, zone.m_parent, zone.m_depth, zone.m_calls, zone.m_time);
+	}
+	for (ndInt32 i = 0; i < m_counterCount; ++i)
+	{
+		fprintf(file, "counter,%s,-1,0,0,%llu\n", GetCounterName(ndCounter(i)), (unsigned long long)m_counters[i]);
+	}
+	for (ndInt32 i = 0; i < m_threads.GetCount(); ++i)
+	{
+		fprintf(file, "busy,thread_%d,-1,0,0,%f\n", i, m_threads[i].m_busy);
+		fprintf(file, "idle,thread_%d,-1,0,0,%f\n", i, m_threads[i].m_idle);
+	}
+	fclose(file);
+	return true;
+}
+
+bool ndFrameStats::ExportJson(const char* const fileName) const
+{
+	FILE* const file = fopen(fileName, "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"frame\": %u,\n", m_frameNumber);
+	fprintf(file, "\t\"frameTime\": %f,\n", m_frameTime);
+
+	fprintf(file, "\t\"zones\": [");
+	for (ndInt32 i = 0; i < m_zones.GetCount(); ++i)
+	{
+		const ndZone& zone = m_zones[i];
+		fprintf(file, "%s\n\t\t{\"name\": \"%s\", \"parent\": %d, \"depth\": %d, \"calls\": %u, \"time\": %f}", i ? "," : "", zone.m_name, zone.m_parent, zone.m_depth, zone.m_calls, zone.m_time);
+	}
+	fprintf(file, "\n\t],\n");
+
+	fprintf(file, "\t\"counters\": {");
+	for (ndInt32 i = 0; i < m_counterCount; ++i)
+	{
+		fprintf(file, "%s\n\t\t\"%s\": %llu", i ? "," : "", GetCounterName(ndCounter(i)), (unsigned long long)m_counters[i]);
+	}
+	fprintf(file, "\n\t},\n");
+
+	fprintf(file, "\t\"threads\": [");
+	for (ndInt32 i = 0; i < m_threads.GetCount(); ++i)
+	{
+		fprintf(file, "%s\n\t\t{\"busy\": %f, \"idle\": %f}", i ? "," : "", m_threads[i].m_busy, m_threads[i].m_idle);
+	}
+	fprintf(file, "\n\t]\n");
+	fprintf(file, "}\n");
+	fclose(file);
+	return true;
+}
+
+ndFrameStatsZone::ndFrameStatsZone(const char* const name)
+	:m_thread(g_statsThread)
+{
+	if (m_thread)
+	{
+		m_parent = g_statsContext;
+		m_entry = m_thread->Find(m_parent, name);
+		if (m_entry >= 0)
+		{
+			g_statsContext = m_thread->GetContext(m_entry);
+			m_start = ndFrameStatsCollector::GetTicks();
+		}
+	}
+}
+
+ndFrameStatsZone::~ndFrameStatsZone()
+{
+	if (m_thread && (m_entry >= 0))
+	{
+		ndFrameStatsThread::ndEntry& entry = m_thread->m_entries[m_entry];
+		entry.m_ticks += ndFrameStatsCollector::GetTicks() - m_start;
+		entry.m_calls++;
+		g_statsContext = m_parent;
+	}
+}
+
+ndFrameStatsCollector::ndFrameStatsCollector()
+	:ndClassAlloc()
+	,m_threads()
+	,m_dispatchContext(D_FRAME_STATS_ROOT)
+	,m_frameStart(0)
+	,m_threadCount(0)
+{
+}
+
+ndFrameStatsCollector::~ndFrameStatsCollector()
+{
+	for (ndInt32 i = 0; i < m_threads.GetCount(); ++i)
+	{
+		delete m_threads[i];
+	}
+}
+
+ndUnsigned64 ndFrameStatsCollector::GetTicks()
+{
+	static std::chrono::steady_clock::time_point timeStampBase = std::chrono::steady_clock::now();
+	const std::chrono::steady_clock::time_point currentTimeStamp = std::chrono::steady_clock::now();
+	return ndUnsigned64(std::chrono::duration_cast<std::chrono::nanoseconds>(currentTimeStamp - timeStampBase).count());
+}
+
+void ndFrameStatsCollector::Begin(ndInt32 threadCount)
+{
+	for (ndInt32 i = ndInt32(m_threads.GetCount()); i < threadCount; ++i)
+	{
+		m_threads.PushBack(new ndFrameStatsThread(i));
+	}
+	m_threadCount = threadCount;
+	for (ndInt32 i = 0; i < m_threadCount; ++i)
+	{
+		m_threads[i]->Clear();
+	}
+
+	g_statsThread = m_threads[0];
+	g_statsContext = D_FRAME_STATS_ROOT;
+	m_dispatchContext = D_FRAME_STATS_ROOT;
+	m_frameStart = GetTicks();
+}
+
+void ndFrameStatsCollector::BeginDispatch()
+{
+	m_dispatchContext = g_statsContext;
+}
+
+void ndFrameStatsCollector::EndDispatch(ndUnsigned64 waitStart)
+{
+	if (m_threadCount && (g_statsThread == m_threads[0]))
+	{
+		m_threads[0]->m_wait += GetTicks() - waitStart;
+	}
+}
+
+ndUnsigned64 ndFrameStatsCollector::BeginJob(ndInt32 slot)
+{
+	if (slot < m_threadCount)
+	{
+		g_statsThread = m_threads[slot];
+		g_statsContext = m_dispatchContext;
+	}
+	return GetTicks();
+}
+
+void ndFrameStatsCollector::EndJob(ndInt32 slot, ndUnsigned64 start)
+{
+	if (slot < m_threadCount)
+	{
+		m_threads[slot]->m_busy += GetTicks() - start;
+	}
+	g_statsThread = nullptr;
+	g_statsContext = D_FRAME_STATS_ROOT;
+}
+
+void ndFrameStatsCollector::End(ndFrameStats& stats)
+{
+	const ndUnsigned64 frameTicks = GetTicks() - m_frameStart;
+	g_statsThread = nullptr;
+	g_statsContext = D_FRAME_STATS_ROOT;
+
+	class ndMergedZone
+	{
+		public:
+		const char* m_name;
+		ndInt32 m_parent;
+		ndInt32 m_firstChild;
+		ndInt32 m_lastChild;
+		ndInt32 m_sibling;
+		ndUnsigned32 m_calls;
+		ndUnsigned64 m_ticks;
+	};
+
+	// merge the entries of all threads by call path, a thread entry 
+	// can have its parent in another thread so they are resolved lazily.
+	ndArray<ndMergedZone> merged;
+	ndArray<ndInt32> remap;
+	remap.SetCount(m_threadCount * D_FRAME_STATS_MAX_ZONES);
+	for (ndInt32 i = 0; i < remap.GetCount(); ++i)
+	{
+		remap[i] = -1;
+	}
+
+	ndInt32 firstRoot = -1;
+	ndInt32 lastRoot = -1;
+	ndFixSizeArray<ndInt32, 256> stack;
+	for (ndInt32 slot = 0; slot < m_threadCount; ++slot)
+	{
+		const ndFrameStatsThread* const thread = m_threads[slot];
+		for (ndInt32 i = 0; i < thread->m_count; ++i)
+		{
+			stack.SetCount(0);
+			for (ndUnsigned64 context = thread->GetContext(i); context != D_FRAME_STATS_ROOT; )
+			{
+				const ndInt32 contextSlot = ndInt32(context >> 32);
+				const ndInt32 contextEntry = ndInt32(context & 0xffffffff);
+				if ((remap[contextSlot * D_FRAME_STATS_MAX_ZONES + contextEntry] >= 0) || (stack.GetCount() == stack.GetCapacity()))
+				{
+					break;
+				}
+				stack.PushBack(contextSlot * D_FRAME_STATS_MAX_ZONES + contextEntry);
+				context = m_threads[contextSlot]->m_entries[contextEntry].m_parent;
+			}
+
+			while (stack.GetCount())
+			{
+				const ndInt32 key = stack[stack.GetCount() - 1];
+				stack.SetCount(stack.GetCount() - 1);
+				const ndFrameStatsThread::ndEntry& entry = m_threads[key / D_FRAME_STATS_MAX_ZONES]->m_entries[key % D_FRAME_STATS_MAX_ZONES];
+				ndInt32 parent = -1;
+				if (entry.m_parent != D_FRAME_STATS_ROOT)
+				{
+					parent = remap[ndInt32(entry.m_parent >> 32) * D_FRAME_STATS_MAX_ZONES + ndInt32(entry.m_parent & 0xffffffff)];
+				}
+
+				ndInt32 node = (parent >= 0) ? merged[parent].m_firstChild : firstRoot;
+				for (; (node >= 0) && strcmp(merged[node].m_name, entry.m_name); node = merged[node].m_sibling);
+				if (node < 0)
+				{
+					ndMergedZone zone;
+					zone.m_name = entry.m_name;
+					zone.m_parent = parent;
+					zone.m_firstChild = -1;
+					zone.m_lastChild = -1;
+					zone.m_sibling = -1;
+					zone.m_calls = 0;
+					zone.m_ticks = 0;
+					node = ndInt32(merged.GetCount());
+					merged.PushBack(zone);
+					ndInt32& last = (parent >= 0) ? merged[parent].m_lastChild : lastRoot;
+					ndInt32& first = (parent >= 0) ? merged[parent].m_firstChild : firstRoot;
+					if (last >= 0)
+					{
+						merged[last].m_sibling = node;
+					}
+					else
+					{
+						first = node;
+					}
+					last = node;
+				}
+				merged[node].m_calls += entry.m_calls;
+				merged[node].m_ticks += entry.m_ticks;
+				remap[key] = node;
+			}
+		}
+	}
+
+	stats.m_zones.SetCount(0);
+	stats.m_threads.SetCount(0);
+	memset(stats.m_counters, 0, sizeof(stats.m_counters));
+	stats.m_frameTime = ndFloat64(frameTicks) * ndFloat64(1.0e-3f);
+
+	// flatten the tree depth first
+	ndArray<ndInt32> zoneIndex;
+	zoneIndex.SetCount(merged.GetCount());
+	stack.SetCount(0);
+	for (ndInt32 node = lastRoot; node >= 0; )
+	{
+		// push the roots in reverse order
+		stack.PushBack(node);
+		ndInt32 prev = -1;
+		for (ndInt32 i = firstRoot; i != node; i = merged[i].m_sibling)
+		{
+			prev = i;
+		}
+		node = prev;
+	}
+	while (stack.GetCount())
+	{
+		const ndInt32 node = stack[stack.GetCount() - 1];
+		stack.SetCount(stack.GetCount() - 1);
+		const ndMergedZone& zone = merged[node];
+
+		ndFrameStats::ndZone outZone;
+		outZone.m_name = zone.m_name;
+		outZone.m_parent = (zone.m_parent >= 0) ? zoneIndex[zone.m_parent] : -1;
+		outZone.m_depth = (zone.m_parent >= 0) ? stats.m_zones[outZone.m_parent].m_depth + 1 : 0;
+		outZone.m_calls = zone.m_calls;
+		outZone.m_time = ndFloat64(zone.m_ticks) * ndFloat64(1.0e-3f);
+		zoneIndex[node] = ndInt32(stats.m_zones.GetCount());
+		stats.m_zones.PushBack(outZone);
+
+		ndInt32 childCount = 0;
+		for (ndInt32 child = zone.m_firstChild; child >= 0; child = merged[child].m_sibling)
+		{
+			childCount++;
+		}
+		ndInt32 base = stack.GetCount();
+		if ((base + childCount) > stack.GetCapacity())
+		{
+			// a tree this deep is a recursion, drop the children
+			continue;
+		}
+		stack.SetCount(base + childCount);
+		ndInt32 index = base + childCount - 1;
+		for (ndInt32 child = zone.m_firstChild; child >= 0; child = merged[child].m_sibling)
+		{
+			stack[index--] = child;
+		}
+	}
+
+	for (ndInt32 slot = 0; slot < m_threadCount; ++slot)
+	{
+		const ndFrameStatsThread* const thread = m_threads[slot];
+		for (ndInt32 i = 0; i < ndFrameStats::m_counterCount; ++i)
+		{
+			stats.m_counters[i] += thread->m_counters[i];
+		}
+
+		const ndUnsigned64 busy = slot ? thread->m_busy : frameTicks - ndMin(thread->m_wait, frameTicks);
+		ndFrameStats::ndThreadTime time;
+		time.m_busy = ndFloat64(busy) * ndFloat64(1.0e-3f);
+		time.m_idle = ndFloat64(frameTicks - ndMin(busy, frameTicks)) * ndFloat64(1.0e-3f);
+		stats.m_threads.PushBack(time);
+	}
+}
@@ -0,0 +1,132 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __ND_FRAME_STATS_H_
+#define __ND_FRAME_STATS_H_
+
+#include "ndCoreStdafx.h"
+#include "ndTypes.h"
+#include "ndArray.h"
+#include "ndClassAlloc.h"
+
+#define D_FRAME_STATS_MAX_ZONES		512
+#define D_FRAME_STATS_HASH_SIZE		(D_FRAME_STATS_MAX_ZONES * 2)
+
+class ndFrameStatsThread;
+
+// the timers, counters and thread usage of one frame. zones are the 
+// D_TRACKTIME scopes merged across all threads by their call path, 
+// they are sorted depth first so a parent always comes before its children.
+// times are in microseconds.
+class ndFrameStats: public ndClassAlloc
+{
+	public:
+	enum ndCounter
+	{
+		m_pairQueries,
+		m_pairsTested,
+		m_contactsGenerated,
+		m_gjkIterations,
+		m_solverPasses,
+		m_islands,
+		m_bodiesAwake,
+		m_speculativePairs,
+		m_counterCount,
+	};
+
+	class ndZone
+	{
+		public:
+		const char* m_name;
+		ndInt32 m_parent;
+		ndInt32 m_depth;
+		ndUnsigned32 m_calls;
+		ndFloat64 m_time;
+	};
+
+	class ndThreadTime
+	{
+		public:
+		ndFloat64 m_busy;
+		ndFloat64 m_idle;
+	};
+
+	D_CORE_API ndFrameStats();
+	D_CORE_API void Clear();
+
+	D_CORE_API bool ExportCsv(const char* const fileName) const;
+	D_CORE_API bool ExportJson(const char* const fileName) const;
+	D_CORE_API static const char* GetCounterName(ndCounter counter);
+
+	// adds to a counter of the frame the calling thread is collecting, if any.
+	D_CORE_API static void AddCount(ndCounter counter, ndUnsigned64 count);
+
+	ndArray<ndZone> m_zones;
+	ndArray<ndThreadTime> m_threads;
+	ndUnsigned64 m_counters[m_counterCount];
+	ndFloat64 m_frameTime;
+	ndUnsigned32 m_frameNumber;
+};
+
+// scoped timer behind the D_TRACKTIME macros, it only costs a 
+// thread local read when the thread is not collecting stats.
+class ndFrameStatsZone
+{
+	public:
+	D_CORE_API ndFrameStatsZone(const char* const name);
+	D_CORE_API ~ndFrameStatsZone();
+
+	private:
+	ndFrameStatsThread* m_thread;
+	ndUnsigned64 m_parent;
+	ndUnsigned64 m_start;
+	ndInt32 m_entry;
+};
+
+// collects the stats of a thread pool, slot zero is the thread that 
+// runs the frame and dispatches the jobs, slot i + 1 is worker i. 
+// jobs record their zones under the zone that dispatched them.
+class ndFrameStatsCollector: public ndClassAlloc
+{
+	public:
+	D_CORE_API ndFrameStatsCollector();
+	D_CORE_API ~ndFrameStatsCollector();
+
+	// called by the thread that runs the frame
+	D_CORE_API void Begin(ndInt32 threadCount);
+	D_CORE_API void End(ndFrameStats& stats);
+
+	// called by the thread pool
+	D_CORE_API void BeginDispatch();
+	D_CORE_API void EndDispatch(ndUnsigned64 waitStart);
+	D_CORE_API ndUnsigned64 BeginJob(ndInt32 slot);
+	D_CORE_API void EndJob(ndInt32 slot, ndUnsigned64 start);
+
+	D_CORE_API static ndUnsigned64 GetTicks();
+
+	private:
+	ndArray<ndFrameStatsThread*> m_threads;
+	ndUnsigned64 m_dispatchContext;
+	ndUnsigned64 m_frameStart;
+	ndInt32 m_threadCount;
+};
+
+#endif
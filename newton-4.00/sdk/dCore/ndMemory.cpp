@@ -22,6 +22,8 @@
 #include "ndCoreStdafx.h"
 #include "ndTypes.h"
 #include "ndMemory.h"
+#include "ndClassAlloc.h"
+#include "ndContainersAlloc.h"
 
 ndAtomic<ndUnsigned64> ndMemory::m_memoryUsed(0);
 
@@ -35,7 +37,7 @@ class ndMemoryHeader
 	ndInt32 m_size;
 };
 
-#define D_MEMORY_ALIGMNET 32
+#define D_MEMORY_ALIGMNET 64
 #define ndGetBufferSize ndInt32(D_MEMORY_ALIGMNET - 1 + sizeof (ndMemoryHeader))
 
 ndInt32 ndMemory::CalculateBufferSize(size_t size)
@@ -80,6 +82,11 @@ ndUnsigned64 ndMemory::GetMemoryUsed()
 	return m_memoryUsed.load();
 }
 
+ndInt32 ndMemory::GetFreeListStats(ndMemoryFreeListStats* const stats, ndInt32 maxCount)
+{
+	return ndFreeListAlloc::GetStats(stats, maxCount);
+}
+
 void ndMemory::SetMemoryAllocators(ndMemAllocCallback alloc, ndMemFreeCallback free)
 {
 	m_allocMemory = alloc;
@@ -28,6 +28,22 @@
 typedef void* (*ndMemAllocCallback) (size_t size);
 typedef void (*ndMemFreeCallback) (void* const ptr);
 
+/// Usage of one size class of the free list allocator.
+class ndMemoryFreeListStats
+{
+	public:
+	/// size in bytes of the chunks of the class.
+	ndInt32 m_chunkSize;
+	/// chunks of the class currently allocated from the heap, in use or cached.
+	ndInt32 m_heapChunks;
+	/// chunks cached in the global depot, chunks cached by threads are not counted.
+	ndInt32 m_depotChunks;
+	/// batches of chunks taken from the depot by threads.
+	ndInt32 m_refills;
+	/// batches of chunks returned to the depot by threads.
+	ndInt32 m_returns;
+};
+
 class ndMemory
 {
 	public:
@@ -48,6 +64,12 @@ class ndMemory
 	/// Return the total memory allocated by the newton engine and tools.
 	D_CORE_API static ndUnsigned64 GetMemoryUsed();
 
+	/// Get the statistics of the free list size classes that have been used.
+	/// \param stats: array to receive one entry per size class.
+	/// \param maxCount: capacity of the array.
+	/// \return the number of entries written.
+	D_CORE_API static ndInt32 GetFreeListStats(ndMemoryFreeListStats* const stats, ndInt32 maxCount);
+
 	/// Install low level system memory allocation functions.
 	/// \param ndMemAllocCallback alloc: is a function pointer callback to allocate a memory chunk.
 	/// \param ndMemFreeCallback free: is a function pointer callback to free a memory chunk.
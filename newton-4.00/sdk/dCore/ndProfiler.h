@@ -24,19 +24,24 @@
 
 #include "ndCoreStdafx.h"
 #include "ndTypes.h"
+#include "ndFrameStats.h"
 
 // to make a profile build use Use CMAKE to create a profile configuration
 // or make a configuration that define macro D_PROFILER
+// the frame stats timers are always there, they do nothing 
+// unless the thread is collecting the stats of a frame.
 
 #ifdef D_PROFILER
 	#include <dTracyProfiler.h>
-	#define D_TRACKTIME() dProfilerZoneScoped(__FUNCTION__)
-	#define D_TRACKTIME_NAMED(name) dProfilerZoneScoped(#name)
+	#define D_TRACKTIME() dProfilerZoneScoped(__FUNCTION__); ndFrameStatsZone _ndFrameStatsZone(__FUNCTION__)
+	#define D_TRACKTIME_NAMED(name) dProfilerZoneScoped(#name); ndFrameStatsZone _ndFrameStatsZone_##name(#name)
 	#define D_SET_TRACK_NAME(trackName) dProfilerSetTrackName(trackName)
 #else
-	#define D_TRACKTIME() 
-	#define D_TRACKTIME_NAMED(name)
+	#define D_TRACKTIME() ndFrameStatsZone _ndFrameStatsZone(__FUNCTION__)
+	#define D_TRACKTIME_NAMED(name) ndFrameStatsZone _ndFrameStatsZone_##name(#name)
 	#define D_SET_TRACK_NAME(trackName)
 #endif
 
+#define D_FRAME_STATS_COUNT(counter, count) ndFrameStats::AddCount(ndFrameStats::counter, ndUnsigned64(count))
+
 #endif
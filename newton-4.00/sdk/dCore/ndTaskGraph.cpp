@@ -0,0 +1,208 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndTypes.h"
+#include "ndUtils.h"
+#include "ndProfiler.h"
+#include "ndTaskGraph.h"
+
+ndTaskGraph::ndNode::ndNode(ndInt32 count, ndInt32 grain, bool isStage)
+	:ndClassAlloc()
+	,m_successors()
+	,m_pendingDependencies(0)
+	,m_nextItem(0)
+	,m_itemsDone(0)
+	,m_complete(false)
+	,m_dependencies(0)
+	,m_count(ndMax(count, 0))
+	,m_grain(ndMax(grain, 1))
+	,m_isStage(isStage)
+{
+}
+
+ndTaskGraph::ndNode::~ndNode()
+{
+}
+
+void ndTaskGraph::ndNode::Reset()
+{
+	m_pendingDependencies.store(m_dependencies);
+	m_nextItem.store(0);
+	m_itemsDone.store(0);
+	m_complete.store(false);
+}
+
+ndTaskGraph::ndTaskGraph(ndThreadPool* const threadPool)
+	:ndClassAlloc()
+	,m_threadPool(threadPool)
+	,m_nodes()
+	,m_bufferSize(0)
+{
+}
+
+ndTaskGraph::~ndTaskGraph()
+{
+	for (ndInt32 i = 0; i < m_nodes.GetCount(); ++i)
+	{
+		m_nodes[i]->~ndNode();
+	}
+}
+
+void* ndTaskGraph::AllocNode(size_t size)
+{
+	const ndUnsigned64 base = (ndUnsigned64(&m_buffer[0]) + D_TASK_GRAPH_NODE_ALIGN - 1) & ~ndUnsigned64(D_TASK_GRAPH_NODE_ALIGN - 1);
+	const ndInt32 alignedSize = ndInt32((size + D_TASK_GRAPH_NODE_ALIGN - 1) & ~size_t(D_TASK_GRAPH_NODE_ALIGN - 1));
+	ndAssert((m_bufferSize + alignedSize) <= D_TASK_GRAPH_BUFFER_SIZE);
+	void* const memory = (void*)(base + ndUnsigned64(m_bufferSize));
+	m_bufferSize += alignedSize;
+	return memory;
+}
+
+ndTaskGraph::ndNode* ndTaskGraph::AddNode(ndNode* const node)
+{
+	ndAssert(m_nodes.GetCount() < m_nodes.GetCapacity());
+	m_nodes.PushBack(node);
+	return node;
+}
+
+void ndTaskGraph::AddDependency(ndNode* const node, ndNode* const dependency)
+{
+	ndAssert(node != dependency);
+	ndAssert(dependency->m_successors.GetCount() < dependency->m_successors.GetCapacity());
+	dependency->m_successors.PushBack(node);
+	node->m_dependencies++;
+}
+
+bool ndTaskGraph::IsReady(const ndNode* const node) const
+{
+	return !node->m_complete.load() && !node->m_pendingDependencies.load();
+}
+
+void ndTaskGraph::Complete(ndNode* const node)
+{
+	for (ndInt32 i = 0; i < node->m_successors.GetCount(); ++i)
+	{
+		ndNode* const successor = node->m_successors[i];
+		if ((successor->m_pendingDependencies.fetch_sub(1) == 1) && !successor->m_isStage && !successor->m_count)
+		{
+			// an empty loop completes as soon as it is ready
+			Complete(successor);
+		}
+	}
+	// flag the node last, so that threads looking for work
+	// do not quit while its successors are still unlocking.
+	node->m_complete.store(true);
+}
+
+void ndTaskGraph::ExecuteConcurrentNodes(ndInt32 threadIndex)
+{
+	for (bool running = true; running; )
+	{
+		running = false;
+		bool executed = false;
+		for (ndInt32 i = 0; i < m_nodes.GetCount(); ++i)
+		{
+			ndNode* const node = m_nodes[i];
+			if (!node->m_isStage && IsReady(node))
+			{
+				running = true;
+				const ndInt32 start = node->m_nextItem.fetch_add(node->m_grain);
+				if (start < node->m_count)
+				{
+					const ndInt32 end = ndMin(start + node->m_grain, node->m_count);
+					for (ndInt32 j = start; j < end; ++j)
+					{
+						node->Execute(threadIndex, j);
+					}
+					executed = true;
+					const ndInt32 items = end - start;
+					if ((node->m_itemsDone.fetch_add(items) + items) == node->m_count)
+					{
+						Complete(node);
+					}
+				}
+			}
+		}
+		if (running && !executed)
+		{
+			// other threads are finishing the last batches of the ready nodes
+			ndThreadYield();
+		}
+	}
+}
+
+void ndTaskGraph::Execute()
+{
+	D_TRACKTIME();
+	for (ndInt32 i = 0; i < m_nodes.GetCount(); ++i)
+	{
+		m_nodes[i]->Reset();
+	}
+	for (ndInt32 i = 0; i < m_nodes.GetCount(); ++i)
+	{
+		ndNode* const node = m_nodes[i];
+		if (!node->m_isStage && !node->m_count && IsReady(node))
+		{
+			Complete(node);
+		}
+	}
+
+	auto ConcurrentNodes = ndMakeObject::ndFunction([this](ndInt32 threadIndex, ndInt32)
+	{
+		D_TRACKTIME_NAMED(ConcurrentNodes);
+		ExecuteConcurrentNodes(threadIndex);
+	});
+
+	for (bool pending = true; pending; )
+	{
+		pending = false;
+		bool concurrentNodes = false;
+		ndNode* stage = nullptr;
+		for (ndInt32 i = 0; i < m_nodes.GetCount(); ++i)
+		{
+			ndNode* const node = m_nodes[i];
+			pending = pending || !node->m_complete.load();
+			if (IsReady(node))
+			{
+				concurrentNodes = concurrentNodes || !node->m_isStage;
+				stage = (!stage && node->m_isStage) ? node : stage;
+			}
+		}
+
+		if (concurrentNodes)
+		{
+			// drain all loops and jobs, including the ones they unlock.
+			m_threadPool->ParallelExecute(ConcurrentNodes);
+		}
+		else if (stage)
+		{
+			stage->Execute(0, 0);
+			Complete(stage);
+		}
+		else
+		{
+			// a cycle, or a dependency on a node that is not part of the graph
+			ndAssert(!pending);
+			pending = false;
+		}
+	}
+}
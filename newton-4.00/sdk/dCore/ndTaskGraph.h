@@ -0,0 +1,187 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __ND_TASK_GRAPH_H_
+#define __ND_TASK_GRAPH_H_
+
+#include "ndCoreStdafx.h"
+#include "ndTypes.h"
+#include "ndClassAlloc.h"
+#include "ndFixSizeArray.h"
+#include "ndThreadPool.h"
+
+#define D_TASK_GRAPH_MAX_NODES		32
+#define D_TASK_GRAPH_MAX_EDGES		8
+#define D_TASK_GRAPH_NODE_ALIGN		16
+#define D_TASK_GRAPH_BUFFER_SIZE	(D_TASK_GRAPH_MAX_NODES * 256)
+
+// a directed acyclic graph of tasks executed by a thread pool.
+// stage nodes own the whole pool and run one at the time,
+// they are the existing fork/join passes (they can call ParallelExecute).
+// loop and job nodes run concurrently with all other ready loop and job nodes,
+// their functions must not depend on per thread scratch shared with other nodes.
+// a ParallelFor called by a loop or job node runs on the same thread, with the 
+// thread index of the node. loop and job nodes must not call ParallelExecute, 
+// its slices would run on one thread with the thread indices of the others, 
+// work that needs the pool is a stage.
+// the nodes are placed in a buffer of the graph, a graph built for each step 
+// does not touch the heap.
+class ndTaskGraph: public ndClassAlloc
+{
+	public:
+	class ndNode: public ndClassAlloc
+	{
+		public:
+		D_CORE_API ndNode(ndInt32 count, ndInt32 grain, bool isStage);
+		D_CORE_API virtual ~ndNode();
+
+		protected:
+		virtual void Execute(ndInt32 threadIndex, ndInt32 item) const = 0;
+
+		private:
+		void Reset();
+
+		ndFixSizeArray<ndNode*, D_TASK_GRAPH_MAX_EDGES> m_successors;
+		ndAtomic<ndInt32> m_pendingDependencies;
+		ndAtomic<ndInt32> m_nextItem;
+		ndAtomic<ndInt32> m_itemsDone;
+		ndAtomic<bool> m_complete;
+		ndInt32 m_dependencies;
+		ndInt32 m_count;
+		ndInt32 m_grain;
+		bool m_isStage;
+		friend class ndTaskGraph;
+	};
+
+	D_CORE_API ndTaskGraph(ndThreadPool* const threadPool);
+	D_CORE_API ~ndTaskGraph();
+
+	// function() is called once, with the full thread pool available.
+	template <typename Function>
+	ndNode* AddStage(const Function& function);
+
+	// function(threadIndex) is called once, by any thread.
+	template <typename Function>
+	ndNode* AddJob(const Function& function);
+
+	// function(threadIndex, i) is called for all i in [0, count),
+	// batches of grain items are distributed across threads.
+	template <typename Function>
+	ndNode* AddParallelFor(ndInt32 count, ndInt32 grain, const Function& function);
+
+	// node will not start before dependency completes.
+	D_CORE_API void AddDependency(ndNode* const node, ndNode* const dependency);
+
+	// run all nodes, the call returns when the graph completes.
+	D_CORE_API void Execute();
+
+	private:
+	void* AllocNode(size_t size);
+	ndNode* AddNode(ndNode* const node);
+	void Complete(ndNode* const node);
+	bool IsReady(const ndNode* const node) const;
+	void ExecuteConcurrentNodes(ndInt32 threadIndex);
+
+	ndThreadPool* m_threadPool;
+	ndFixSizeArray<ndNode*, D_TASK_GRAPH_MAX_NODES> m_nodes;
+	ndInt32 m_bufferSize;
+	char m_buffer[D_TASK_GRAPH_BUFFER_SIZE + D_TASK_GRAPH_NODE_ALIGN];
+};
+
+template <typename Function>
+class ndTaskGraphStage: public ndTaskGraph::ndNode
+{
+	public:
+	ndTaskGraphStage(const Function& function)
+		:ndTaskGraph::ndNode(1, 1, true)
+		,m_function(function)
+	{
+	}
+
+	private:
+	void Execute(ndInt32, ndInt32) const
+	{
+		m_function();
+	}
+
+	Function m_function;
+};
+
+template <typename Function>
+class ndTaskGraphJob: public ndTaskGraph::ndNode
+{
+	public:
+	ndTaskGraphJob(const Function& function)
+		:ndTaskGraph::ndNode(1, 1, false)
+		,m_function(function)
+	{
+	}
+
+	private:
+	void Execute(ndInt32 threadIndex, ndInt32) const
+	{
+		m_function(threadIndex);
+	}
+
+	Function m_function;
+};
+
+template <typename Function>
+class ndTaskGraphParallelFor: public ndTaskGraph::ndNode
+{
+	public:
+	ndTaskGraphParallelFor(ndInt32 count, ndInt32 grain, const Function& function)
+		:ndTaskGraph::ndNode(count, grain, false)
+		,m_function(function)
+	{
+	}
+
+	private:
+	void Execute(ndInt32 threadIndex, ndInt32 item) const
+	{
+		m_function(threadIndex, item);
+	}
+
+	Function m_function;
+};
+
+template <typename Function>
+ndTaskGraph::ndNode* ndTaskGraph::AddStage(const Function& function)
+{
+	void* const memory = AllocNode(sizeof(ndTaskGraphStage<Function>));
+	return AddNode(::new (memory) ndTaskGraphStage<Function>(function));
+}
+
+template <typename Function>
+ndTaskGraph::ndNode* ndTaskGraph::AddJob(const Function& function)
+{
+	void* const memory = AllocNode(sizeof(ndTaskGraphJob<Function>));
+	return AddNode(::new (memory) ndTaskGraphJob<Function>(function));
+}
+
+template <typename Function>
+ndTaskGraph::ndNode* ndTaskGraph::AddParallelFor(ndInt32 count, ndInt32 grain, const Function& function)
+{
+	void* const memory = AllocNode(sizeof(ndTaskGraphParallelFor<Function>));
+	return AddNode(::new (memory) ndTaskGraphParallelFor<Function>(count, grain, function));
+}
+
+#endif
@@ -25,6 +25,24 @@
 #include "ndProfiler.h"
 #include "ndThreadPool.h"
 
+// the pool and the thread index of the job running on each thread
+static thread_local const ndThreadPool* g_callerPool = nullptr;
+static thread_local ndInt32 g_callerThreadIndex = -1;
+
+ndThreadPool::ndCallerScope::ndCallerScope(const ndThreadPool* const pool, ndInt32 threadIndex)
+	:m_pool(g_callerPool)
+	,m_threadIndex(g_callerThreadIndex)
+{
+	g_callerPool = pool;
+	g_callerThreadIndex = threadIndex;
+}
+
+ndThreadPool::ndCallerScope::~ndCallerScope()
+{
+	g_callerPool = m_pool;
+	g_callerThreadIndex = m_threadIndex;
+}
+
 ndThreadPool::ndWorker::ndWorker()
 	:ndThread()
 	,m_owner(nullptr)
@@ -51,7 +69,18 @@ void ndThreadPool::ndWorker::ThreadFunction()
 		if (task)
 		{
 			//D_TRACKTIME();
-			task->Execute();
+			ndCallerScope scope(m_owner, m_threadIndex);
+			ndFrameStatsCollector* const frameStats = m_owner->m_frameStats;
+			if (frameStats)
+			{
+				const ndUnsigned64 start = frameStats->BeginJob(m_threadIndex + 1);
+				task->Execute();
+				frameStats->EndJob(m_threadIndex + 1, start);
+			}
+			else
+			{
+				task->Execute();
+			}
 			m_task.store(nullptr);
 		}
 		ndThreadYield();
@@ -64,7 +93,9 @@ ndThreadPool::ndThreadPool(const char* const baseName)
 	:ndSyncMutex()
 	,ndThread()
 	,m_workers(nullptr)
+	,m_frameStats(nullptr)
 	,m_count(0)
+	,m_beginDepth(0)
 {
 	char name[256];
 	strncpy(m_baseName, baseName, sizeof (m_baseName));
@@ -121,6 +152,12 @@ void ndThreadPool::SetThreadCount(ndInt32 count)
 void ndThreadPool::Begin()
 {
 	D_TRACKTIME();
+	m_beginDepth++;
+	if (m_beginDepth > 1)
+	{
+		return;
+	}
+
 	for (ndInt32 i = 0; i < m_count; ++i)
 	{
 		m_workers[i].Signal();
@@ -135,6 +172,13 @@ void ndThreadPool::Begin()
 
 void ndThreadPool::End()
 {
+	ndAssert(m_beginDepth > 0);
+	m_beginDepth--;
+	if (m_beginDepth)
+	{
+		return;
+	}
+
 	#ifndef	D_USE_THREAD_EMULATION
 	for (ndInt32 i = 0; i < m_count; ++i)
 	{
@@ -154,6 +198,16 @@ void ndThreadPool::End()
 	#endif
 }
 
+ndInt32 ndThreadPool::GetCallerThreadIndex() const
+{
+	return (g_callerPool == this) ? g_callerThreadIndex : -1;
+}
+
+void ndThreadPool::SetFrameStatsCollector(ndFrameStatsCollector* const collector)
+{
+	m_frameStats = collector;
+}
+
 void ndThreadPool::Release()
 {
 	ndSyncMutex::Release();
@@ -29,9 +29,12 @@
 #include "ndSyncMutex.h"
 #include "ndSemaphore.h"
 #include "ndClassAlloc.h"
+#include "ndFrameStats.h"
 
 //#define	D_MAX_THREADS_COUNT	16
-#define	D_MAX_THREADS_COUNT	32
+//#define	D_MAX_THREADS_COUNT	32
+#define	D_MAX_THREADS_COUNT	128
+#define	D_WORKER_CACHE_LINE	64
 
 class ndThreadPool;
 
@@ -52,6 +55,82 @@ class ndStartEnd
 	ndInt32 m_end;
 };
 
+// a range of indices owned by one worker. 
+// the owner pops small batches from the front, 
+// idle workers steal the back half of the remaining range.
+class ndWorkStealingRange
+{
+	public:
+	ndWorkStealingRange()
+		:m_range(0)
+	{
+	}
+
+	void Set(ndInt32 start, ndInt32 end)
+	{
+		m_range.store(Pack(start, end));
+	}
+
+	bool PopFront(ndInt32 grain, ndInt32& start, ndInt32& end)
+	{
+		for (ndUnsigned64 range = m_range.load(); ; range = m_range.load())
+		{
+			const ndInt32 rangeStart = GetStart(range);
+			const ndInt32 rangeEnd = GetEnd(range);
+			if (rangeStart >= rangeEnd)
+			{
+				return false;
+			}
+			const ndInt32 newStart = ndMin(rangeStart + grain, rangeEnd);
+			if (m_range.compare_exchange_weak(range, Pack(newStart, rangeEnd)))
+			{
+				start = rangeStart;
+				end = newStart;
+				return true;
+			}
+		}
+	}
+
+	bool StealBack(ndInt32& start, ndInt32& end)
+	{
+		for (ndUnsigned64 range = m_range.load(); ; range = m_range.load())
+		{
+			const ndInt32 rangeStart = GetStart(range);
+			const ndInt32 rangeEnd = GetEnd(range);
+			if (rangeStart >= rangeEnd)
+			{
+				return false;
+			}
+			const ndInt32 split = rangeStart + (rangeEnd - rangeStart) / 2;
+			if (m_range.compare_exchange_weak(range, Pack(rangeStart, split)))
+			{
+				start = split;
+				end = rangeEnd;
+				return true;
+			}
+		}
+	}
+
+	private:
+	static ndUnsigned64 Pack(ndInt32 start, ndInt32 end)
+	{
+		return (ndUnsigned64(ndUnsigned32(end)) << 32) | ndUnsigned64(ndUnsigned32(start));
+	}
+
+	static ndInt32 GetStart(ndUnsigned64 range)
+	{
+		return ndInt32(ndUnsigned32(range));
+	}
+
+	static ndInt32 GetEnd(ndUnsigned64 range)
+	{
+		return ndInt32(ndUnsigned32(range >> 32));
+	}
+
+	ndAtomic<ndUnsigned64> m_range;
+	char m_padding[D_WORKER_CACHE_LINE - sizeof(ndAtomic<ndUnsigned64>)];
+};
+
 class ndTask
 {
 	public:
@@ -85,20 +164,54 @@ class ndThreadPool: public ndSyncMutex, public ndThread
 
 	ndInt32 GetThreadCount() const;
 	D_CORE_API static ndInt32 GetMaxThreads();
-	D_CORE_API void SetThreadCount(ndInt32 count);
+	D_CORE_API virtual void SetThreadCount(ndInt32 count);
 
 	D_CORE_API void TickOne();
+
+	// the workers only pick up jobs between Begin and End. the calls nest, 
+	// only the outer pair starts and stops the workers.
 	D_CORE_API void Begin();
 	D_CORE_API void End();
 
+	// when set, the jobs record their zones and busy time into the collector
+	ndFrameStatsCollector* GetFrameStatsCollector() const;
+	D_CORE_API void SetFrameStatsCollector(ndFrameStatsCollector* const collector);
+
+	// the index of the pool thread running the caller, or -1 when 
+	// the caller is not inside a parallel region of this pool.
+	D_CORE_API ndInt32 GetCallerThreadIndex() const;
+
+	// function(threadIndex, threadCount) is called once per thread. it must not 
+	// be called from inside a job of the pool, the nested slices can not get the 
+	// index of the thread running them, use ParallelFor there.
 	template <typename Function>
 	void ParallelExecute(const Function& ndFunction);
 
+	// execute function(threadIndex, i) for all i in [begin, end), 
+	// batches of grain items are balanced across threads by work stealing.
+	// a nested call runs on the calling thread, with its own thread index.
+	template <typename Function>
+	void ParallelFor(ndInt32 begin, ndInt32 end, ndInt32 grain, const Function& function);
+
 	private:
+	// marks the calling thread as running a job of the pool, for its lifetime
+	class ndCallerScope
+	{
+		public:
+		D_CORE_API ndCallerScope(const ndThreadPool* const pool, ndInt32 threadIndex);
+		D_CORE_API ~ndCallerScope();
+
+		private:
+		const ndThreadPool* m_pool;
+		ndInt32 m_threadIndex;
+	};
+
 	D_CORE_API virtual void Release();
 
 	ndWorker* m_workers;
+	ndFrameStatsCollector* m_frameStats;
 	ndInt32 m_count;
+	ndInt32 m_beginDepth;
 	char m_baseName[32];
 };
 
@@ -107,6 +220,11 @@ inline ndInt32 ndThreadPool::GetThreadCount() const
 	return m_count + 1;
 }
 
+inline ndFrameStatsCollector* ndThreadPool::GetFrameStatsCollector() const
+{
+	return m_frameStats;
+}
+
 template <typename Type, typename ... Args>
 class ndFunction
 	:public ndFunction<decltype(&Type::operator())(Args...)>
@@ -181,24 +299,46 @@ void ndThreadPool::ParallelExecute(const Function& callback)
 		new (job) ndTaskImplement<Function>(i, this, callback);
 	}
 
-	if (m_count > 0)
+	if (GetCallerThreadIndex() >= 0)
+	{
+		// called from inside a parallel region, all the slices are executed by 
+		// the calling thread, with the thread indices of the busy threads, so 
+		// per thread scratch is shared. this is an error, see the declaration.
+		ndAssert(0);
+		for (ndInt32 i = 0; i < threadCount; ++i)
+		{
+			ndTaskImplement<Function>* const job = &jobsArray[i];
+			callback(job->m_threadIndex, job->m_threadCount);
+		}
+	}
+	else if (m_count > 0)
 	{
 		#ifdef	D_USE_THREAD_EMULATION
 		for (ndInt32 i = 0; i < threadCount; ++i)
 		{
+			ndCallerScope scope(this, i);
 			ndTaskImplement<Function>* const job = &jobsArray[i];
 			callback(job->m_threadIndex, job->m_threadCount);
 		}
 		#else
+		ndFrameStatsCollector* const frameStats = m_frameStats;
+		if (frameStats)
+		{
+			frameStats->BeginDispatch();
+		}
 		for (ndInt32 i = 0; i < m_count; ++i)
 		{
 			ndTaskImplement<Function>* const job = &jobsArray[i];
 			m_workers[i].m_task.store(job);
 		}
 	
-		ndTaskImplement<Function>* const job = &jobsArray[m_count];
-		callback(job->m_threadIndex, job->m_threadCount);
+		{
+			ndCallerScope scope(this, m_count);
+			ndTaskImplement<Function>* const job = &jobsArray[m_count];
+			callback(job->m_threadIndex, job->m_threadCount);
+		}
 
+		const ndUnsigned64 waitStart = frameStats ? ndFrameStatsCollector::GetTicks() : 0;
 		bool jobsInProgress = true;
 		do
 		{
@@ -210,13 +350,83 @@ void ndThreadPool::ParallelExecute(const Function& callback)
 			}
 			jobsInProgress = jobsInProgress & inProgess;
 		} while (jobsInProgress);
+		if (frameStats)
+		{
+			frameStats->EndDispatch(waitStart);
+		}
 		#endif
 	}
 	else
 	{
+		ndCallerScope scope(this, 0);
 		ndTaskImplement<Function>* const job = &jobsArray[0];
 		callback(job->m_threadIndex, job->m_threadCount);
 	}
 }
 
+template <typename Function>
+void ndThreadPool::ParallelFor(ndInt32 begin, ndInt32 end, ndInt32 grain, const Function& function)
+{
+	const ndInt32 count = end - begin;
+	if (count <= 0)
+	{
+		return;
+	}
+
+	grain = ndMax(grain, 1);
+	const ndInt32 threadCount = GetThreadCount();
+	const ndInt32 callerThreadIndex = GetCallerThreadIndex();
+	if ((threadCount == 1) || (count <= grain) || (callerThreadIndex >= 0))
+	{
+		// a nested loop, or one too small to split, runs on the calling thread.
+		const ndInt32 threadIndex = ndMax(callerThreadIndex, 0);
+		for (ndInt32 i = begin; i < end; ++i)
+		{
+			function(threadIndex, i);
+		}
+		return;
+	}
+
+	ndWorkStealingRange* const ranges = ndAlloca(ndWorkStealingRange, threadCount + 1);
+	ndWorkStealingRange* const queues = (ndWorkStealingRange*)((ndUnsigned64(ranges) + D_WORKER_CACHE_LINE - 1) & ~ndUnsigned64(D_WORKER_CACHE_LINE - 1));
+	for (ndInt32 i = 0; i < threadCount; ++i)
+	{
+		new (&queues[i]) ndWorkStealingRange();
+		const ndStartEnd startEnd(count, i, threadCount);
+		queues[i].Set(begin + startEnd.m_start, begin + startEnd.m_end);
+	}
+
+	auto WorkStealing = [queues, grain, &function](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		ndInt32 start;
+		ndInt32 end;
+		ndWorkStealingRange& queue = queues[threadIndex];
+		for (;;)
+		{
+			while (queue.PopFront(grain, start, end))
+			{
+				for (ndInt32 i = start; i < end; ++i)
+				{
+					function(threadIndex, i);
+				}
+			}
+
+			bool stolen = false;
+			for (ndInt32 i = 1; !stolen && (i < threadCount); ++i)
+			{
+				ndInt32 victim = threadIndex + i;
+				victim = (victim >= threadCount) ? victim - threadCount : victim;
+				stolen = queues[victim].StealBack(start, end);
+			}
+			if (!stolen)
+			{
+				break;
+			}
+			queue.Set(start, end);
+		}
+	};
+
+	ParallelExecute(WorkStealing);
+}
+
 #endif
@@ -2177,6 +2177,7 @@ void ndDynamicsUpdateAvx2::CalculateForces()
 		{
 			CalculateJointsAcceleration();
 			CalculateJointsForce();
+			m_updatePasses += m_solverPasses;
 			UpdateSkeletons();
 			IntegrateBodiesVelocity();
 		}
@@ -0,0 +1,837 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndDynamicsUpdateAvx512.h"
+
+#define D_AVX512_WORK_GROUP				16
+#define D_AVX512_GROUPS_GRAIN			4
+#define D_AVX512_DEFAULT_BUFFER_SIZE	1024
+#define D_AVX512_JACOBIAN_STRIDE		ndInt32 (sizeof (ndJacobian) / sizeof (ndFloat32))
+
+// this file is compiled for avx512, it can not have static objects
+// with constructors, they will run at load time on any cpu.
+
+typedef __mmask16 ndAvx512Mask;
+
+class ndAvx512Int
+{
+	public:
+	inline ndAvx512Int()
+	{
+	}
+
+	inline ndAvx512Int(const ndInt32 val)
+		:m_type(_mm512_set1_epi32(val))
+	{
+	}
+
+	inline ndAvx512Int(const __m512i type)
+		:m_type(type)
+	{
+	}
+
+	inline ndAvx512Int(const ndAvx512Int& copy)
+		:m_type(copy.m_type)
+	{
+	}
+
+	// lanes out of the mask get the value of src
+	inline ndAvx512Int(const ndInt32* const baseAddr, const ndAvx512Int& index, const ndAvx512Int& src, ndAvx512Mask mask)
+		:m_type(_mm512_mask_i32gather_epi32(src.m_type, mask, index.m_type, baseAddr, sizeof (ndInt32)))
+	{
+	}
+
+	inline ndInt32& operator[] (ndInt32 i)
+	{
+		ndAssert(i >= 0);
+		ndAssert(i < D_AVX512_WORK_GROUP);
+		ndInt32* const ptr = (ndInt32*)&m_type;
+		return ptr[i];
+	}
+
+	inline const ndInt32& operator[] (ndInt32 i) const
+	{
+		ndAssert(i >= 0);
+		ndAssert(i < D_AVX512_WORK_GROUP);
+		const ndInt32* const ptr = (ndInt32*)&m_type;
+		return ptr[i];
+	}
+
+	inline ndAvx512Int& operator= (const ndAvx512Int& A)
+	{
+		m_type = A.m_type;
+		return *this;
+	}
+
+	inline ndAvx512Int operator+ (const ndAvx512Int& A) const
+	{
+		return _mm512_add_epi32(m_type, A.m_type);
+	}
+
+	inline ndAvx512Int operator* (const ndAvx512Int& A) const
+	{
+		return _mm512_mullo_epi32(m_type, A.m_type);
+	}
+
+	inline ndAvx512Mask operator> (const ndAvx512Int& A) const
+	{
+		return _mm512_cmpgt_epi32_mask(m_type, A.m_type);
+	}
+
+	static inline ndAvx512Int Ordinals()
+	{
+		return _mm512_set_epi32(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	}
+
+	__m512i m_type;
+};
+
+#ifdef D_NEWTON_USE_DOUBLE
+	class ndAvx512Float
+	{
+		public:
+		inline ndAvx512Float()
+		{
+		}
+
+		inline ndAvx512Float(const ndFloat32 val)
+			:m_low(_mm512_set1_pd(val))
+			,m_high(_mm512_set1_pd(val))
+		{
+		}
+
+		inline ndAvx512Float(const __m512d low, const __m512d high)
+			:m_low(low)
+			,m_high(high)
+		{
+		}
+
+		inline ndAvx512Float(const ndAvx512Float& copy)
+			:m_low(copy.m_low)
+			,m_high(copy.m_high)
+		{
+		}
+
+		// index is in ndFloat32 units from baseAddr
+		inline ndAvx512Float(const ndFloat32* const baseAddr, const ndAvx512Int& index)
+			:m_low(_mm512_i32gather_pd(_mm512_castsi512_si256(index.m_type), baseAddr, sizeof (ndFloat32)))
+			,m_high(_mm512_i32gather_pd(_mm512_extracti64x4_epi64(index.m_type, 1), baseAddr, sizeof (ndFloat32)))
+		{
+		}
+
+		// lanes out of the mask are set to zero
+		inline ndAvx512Float(const ndFloat32* const baseAddr, const ndAvx512Int& index, ndAvx512Mask mask)
+			:m_low(_mm512_mask_i32gather_pd(_mm512_setzero_pd(), __mmask8(mask), _mm512_castsi512_si256(index.m_type), baseAddr, sizeof (ndFloat32)))
+			,m_high(_mm512_mask_i32gather_pd(_mm512_setzero_pd(), __mmask8(mask >> 8), _mm512_extracti64x4_epi64(index.m_type, 1), baseAddr, sizeof (ndFloat32)))
+		{
+		}
+
+		inline ndFloat32& operator[] (ndInt32 i)
+		{
+			ndAssert(i >= 0);
+			ndAssert(i < D_AVX512_WORK_GROUP);
+			ndFloat32* const ptr = (ndFloat32*)&m_low;
+			return ptr[i];
+		}
+
+		inline const ndFloat32& operator[] (ndInt32 i) const
+		{
+			ndAssert(i >= 0);
+			ndAssert(i < D_AVX512_WORK_GROUP);
+			const ndFloat32* const ptr = (ndFloat32*)&m_low;
+			return ptr[i];
+		}
+
+		inline ndAvx512Float& operator= (const ndAvx512Float& A)
+		{
+			m_low = A.m_low;
+			m_high = A.m_high;
+			return *this;
+		}
+
+		inline ndAvx512Float operator+ (const ndAvx512Float& A) const
+		{
+			return ndAvx512Float(_mm512_add_pd(m_low, A.m_low), _mm512_add_pd(m_high, A.m_high));
+		}
+
+		inline ndAvx512Float operator- (const ndAvx512Float& A) const
+		{
+			return ndAvx512Float(_mm512_sub_pd(m_low, A.m_low), _mm512_sub_pd(m_high, A.m_high));
+		}
+
+		inline ndAvx512Float operator* (const ndAvx512Float& A) const
+		{
+			return ndAvx512Float(_mm512_mul_pd(m_low, A.m_low), _mm512_mul_pd(m_high, A.m_high));
+		}
+
+		inline ndAvx512Float MulAdd(const ndAvx512Float& A, const ndAvx512Float& B) const
+		{
+			return ndAvx512Float(_mm512_fmadd_pd(A.m_low, B.m_low, m_low), _mm512_fmadd_pd(A.m_high, B.m_high, m_high));
+		}
+
+		// lanes out of the mask keep their value
+		inline ndAvx512Float MulAdd(const ndAvx512Float& A, const ndAvx512Float& B, ndAvx512Mask mask) const
+		{
+			return ndAvx512Float(_mm512_mask3_fmadd_pd(A.m_low, B.m_low, m_low, __mmask8(mask)), _mm512_mask3_fmadd_pd(A.m_high, B.m_high, m_high, __mmask8(mask >> 8)));
+		}
+
+		inline ndAvx512Float MulSub(const ndAvx512Float& A, const ndAvx512Float& B) const
+		{
+			return ndAvx512Float(_mm512_fnmadd_pd(A.m_low, B.m_low, m_low), _mm512_fnmadd_pd(A.m_high, B.m_high, m_high));
+		}
+
+		inline ndAvx512Mask operator> (const ndAvx512Float& A) const
+		{
+			const ndAvx512Mask low = _mm512_cmp_pd_mask(m_low, A.m_low, _CMP_GT_OQ);
+			const ndAvx512Mask high = _mm512_cmp_pd_mask(m_high, A.m_high, _CMP_GT_OQ);
+			return ndAvx512Mask(low | (high << 8));
+		}
+
+		inline ndAvx512Mask operator< (const ndAvx512Float& A) const
+		{
+			const ndAvx512Mask low = _mm512_cmp_pd_mask(m_low, A.m_low, _CMP_LT_OQ);
+			const ndAvx512Mask high = _mm512_cmp_pd_mask(m_high, A.m_high, _CMP_LT_OQ);
+			return ndAvx512Mask(low | (high << 8));
+		}
+
+		inline ndAvx512Float GetMin(const ndAvx512Float& A) const
+		{
+			return ndAvx512Float(_mm512_min_pd(m_low, A.m_low), _mm512_min_pd(m_high, A.m_high));
+		}
+
+		inline ndAvx512Float GetMax(const ndAvx512Float& A) const
+		{
+			return ndAvx512Float(_mm512_max_pd(m_low, A.m_low), _mm512_max_pd(m_high, A.m_high));
+		}
+
+		inline ndAvx512Float Abs() const
+		{
+			return ndAvx512Float(_mm512_abs_pd(m_low), _mm512_abs_pd(m_high));
+		}
+
+		// lanes in the mask take the value of data
+		inline ndAvx512Float Select(const ndAvx512Float& data, ndAvx512Mask mask) const
+		{
+			return ndAvx512Float(_mm512_mask_blend_pd(__mmask8(mask), m_low, data.m_low), _mm512_mask_blend_pd(__mmask8(mask >> 8), m_high, data.m_high));
+		}
+
+		inline ndFloat32 GetMax() const
+		{
+			return _mm512_reduce_max_pd(_mm512_max_pd(m_low, m_high));
+		}
+
+		inline void Scatter(ndFloat32* const baseAddr, const ndAvx512Int& index, ndAvx512Mask mask) const
+		{
+			_mm512_mask_i32scatter_pd(baseAddr, __mmask8(mask), _mm512_castsi512_si256(index.m_type), m_low, sizeof (ndFloat32));
+			_mm512_mask_i32scatter_pd(baseAddr, __mmask8(mask >> 8), _mm512_extracti64x4_epi64(index.m_type, 1), m_high, sizeof (ndFloat32));
+		}
+
+		__m512d m_low;
+		__m512d m_high;
+	};
+#else
+	class ndAvx512Float
+	{
+		public:
+		inline ndAvx512Float()
+		{
+		}
+
+		inline ndAvx512Float(const ndFloat32 val)
+			:m_type(_mm512_set1_ps(val))
+		{
+		}
+
+		inline ndAvx512Float(const __m512 type)
+			:m_type(type)
+		{
+		}
+
+		inline ndAvx512Float(const ndAvx512Float& copy)
+			:m_type(copy.m_type)
+		{
+		}
+
+		// index is in ndFloat32 units from baseAddr
+		inline ndAvx512Float(const ndFloat32* const baseAddr, const ndAvx512Int& index)
+			:m_type(_mm512_i32gather_ps(index.m_type, baseAddr, sizeof (ndFloat32)))
+		{
+		}
+
+		// lanes out of the mask are set to zero
+		inline ndAvx512Float(const ndFloat32* const baseAddr, const ndAvx512Int& index, ndAvx512Mask mask)
+			:m_type(_mm512_mask_i32gather_ps(_mm512_setzero_ps(), mask, index.m_type, baseAddr, sizeof (ndFloat32)))
+		{
+		}
+
+		inline ndFloat32& operator[] (ndInt32 i)
+		{
+			ndAssert(i >= 0);
+			ndAssert(i < D_AVX512_WORK_GROUP);
+			ndFloat32* const ptr = (ndFloat32*)&m_type;
+			return ptr[i];
+		}
+
+		inline const ndFloat32& operator[] (ndInt32 i) const
+		{
+			ndAssert(i >= 0);
+			ndAssert(i < D_AVX512_WORK_GROUP);
+			const ndFloat32* const ptr = (ndFloat32*)&m_type;
+			return ptr[i];
+		}
+
+		inline ndAvx512Float& operator= (const ndAvx512Float& A)
+		{
+			m_type = A.m_type;
+			return *this;
+		}
+
+		inline ndAvx512Float operator+ (const ndAvx512Float& A) const
+		{
+			return _mm512_add_ps(m_type, A.m_type);
+		}
+
+		inline ndAvx512Float operator- (const ndAvx512Float& A) const
+		{
+			return _mm512_sub_ps(m_type, A.m_type);
+		}
+
+		inline ndAvx512Float operator* (const ndAvx512Float& A) const
+		{
+			return _mm512_mul_ps(m_type, A.m_type);
+		}
+
+		inline ndAvx512Float MulAdd(const ndAvx512Float& A, const ndAvx512Float& B) const
+		{
+			return _mm512_fmadd_ps(A.m_type, B.m_type, m_type);
+		}
+
+		// lanes out of the mask keep their value
+		inline ndAvx512Float MulAdd(const ndAvx512Float& A, const ndAvx512Float& B, ndAvx512Mask mask) const
+		{
+			return _mm512_mask3_fmadd_ps(A.m_type, B.m_type, m_type, mask);
+		}
+
+		inline ndAvx512Float MulSub(const ndAvx512Float& A, const ndAvx512Float& B) const
+		{
+			return _mm512_fnmadd_ps(A.m_type, B.m_type, m_type);
+		}
+
+		inline ndAvx512Mask operator> (const ndAvx512Float& A) const
+		{
+			return _mm512_cmp_ps_mask(m_type, A.m_type, _CMP_GT_OQ);
+		}
+
+		inline ndAvx512Mask operator< (const ndAvx512Float& A) const
+		{
+			return _mm512_cmp_ps_mask(m_type, A.m_type, _CMP_LT_OQ);
+		}
+
+		inline ndAvx512Float GetMin(const ndAvx512Float& A) const
+		{
+			return _mm512_min_ps(m_type, A.m_type);
+		}
+
+		inline ndAvx512Float GetMax(const ndAvx512Float& A) const
+		{
+			return _mm512_max_ps(m_type, A.m_type);
+		}
+
+		inline ndAvx512Float Abs() const
+		{
+			return _mm512_abs_ps(m_type);
+		}
+
+		// lanes in the mask take the value of data
+		inline ndAvx512Float Select(const ndAvx512Float& data, ndAvx512Mask mask) const
+		{
+			return _mm512_mask_blend_ps(mask, m_type, data.m_type);
+		}
+
+		inline ndFloat32 GetMax() const
+		{
+			return _mm512_reduce_max_ps(m_type);
+		}
+
+		inline void Scatter(ndFloat32* const baseAddr, const ndAvx512Int& index, ndAvx512Mask mask) const
+		{
+			_mm512_mask_i32scatter_ps(baseAddr, mask, index.m_type, m_type, sizeof (ndFloat32));
+		}
+
+		__m512 m_type;
+	};
+#endif
+
+class ndAvx512Vector3
+{
+	public:
+	ndAvx512Float m_x;
+	ndAvx512Float m_y;
+	ndAvx512Float m_z;
+};
+
+class ndAvx512Vector6
+{
+	public:
+	// each lane reads the ndJacobian at baseAddr + index
+	inline void Gather(const ndFloat32* const baseAddr, const ndAvx512Int& index, ndAvx512Mask mask)
+	{
+		m_linear.m_x = ndAvx512Float(&baseAddr[0], index, mask);
+		m_linear.m_y = ndAvx512Float(&baseAddr[1], index, mask);
+		m_linear.m_z = ndAvx512Float(&baseAddr[2], index, mask);
+		m_angular.m_x = ndAvx512Float(&baseAddr[4], index, mask);
+		m_angular.m_y = ndAvx512Float(&baseAddr[5], index, mask);
+		m_angular.m_z = ndAvx512Float(&baseAddr[6], index, mask);
+	}
+
+	inline void Scatter(ndFloat32* const baseAddr, const ndAvx512Int& index, ndAvx512Mask mask) const
+	{
+		m_linear.m_x.Scatter(&baseAddr[0], index, mask);
+		m_linear.m_y.Scatter(&baseAddr[1], index, mask);
+		m_linear.m_z.Scatter(&baseAddr[2], index, mask);
+		m_angular.m_x.Scatter(&baseAddr[4], index, mask);
+		m_angular.m_y.Scatter(&baseAddr[5], index, mask);
+		m_angular.m_z.Scatter(&baseAddr[6], index, mask);
+	}
+
+	inline void Set(const ndAvx512Float& value)
+	{
+		m_linear.m_x = value;
+		m_linear.m_y = value;
+		m_linear.m_z = value;
+		m_angular.m_x = value;
+		m_angular.m_y = value;
+		m_angular.m_z = value;
+	}
+
+	// this += A * scale
+	inline void MulAdd(const ndAvx512Vector6& A, const ndAvx512Float& scale)
+	{
+		m_linear.m_x = m_linear.m_x.MulAdd(A.m_linear.m_x, scale);
+		m_linear.m_y = m_linear.m_y.MulAdd(A.m_linear.m_y, scale);
+		m_linear.m_z = m_linear.m_z.MulAdd(A.m_linear.m_z, scale);
+		m_angular.m_x = m_angular.m_x.MulAdd(A.m_angular.m_x, scale);
+		m_angular.m_y = m_angular.m_y.MulAdd(A.m_angular.m_y, scale);
+		m_angular.m_z = m_angular.m_z.MulAdd(A.m_angular.m_z, scale);
+	}
+
+	inline ndAvx512Float DotProduct(const ndAvx512Vector6& A) const
+	{
+		ndAvx512Float dot(m_linear.m_x * A.m_linear.m_x);
+		dot = dot.MulAdd(m_angular.m_x, A.m_angular.m_x);
+		dot = dot.MulAdd(m_linear.m_y, A.m_linear.m_y);
+		dot = dot.MulAdd(m_angular.m_y, A.m_angular.m_y);
+		dot = dot.MulAdd(m_linear.m_z, A.m_linear.m_z);
+		dot = dot.MulAdd(m_angular.m_z, A.m_angular.m_z);
+		return dot;
+	}
+
+	ndAvx512Vector3 m_linear;
+	ndAvx512Vector3 m_angular;
+};
+
+class ndAvx512JacobianPair
+{
+	public:
+	ndAvx512Vector6 m_jacobianM0;
+	ndAvx512Vector6 m_jacobianM1;
+};
+
+class ndAvx512MatrixElement
+{
+	public:
+	ndAvx512JacobianPair m_Jt;
+	ndAvx512JacobianPair m_JMinv;
+
+	ndAvx512Float m_force;
+	ndAvx512Float m_diagDamp;
+	ndAvx512Float m_invJinvMJt;
+	ndAvx512Float m_coordenateAccel;
+	ndAvx512Float m_lowerBoundFrictionCoefficent;
+	ndAvx512Float m_upperBoundFrictionCoefficent;
+	ndAvx512Int m_normalForceIndex;
+};
+
+// sixteen consecutive joints of the active joint array. the joints in a group 
+// can have different row counts, lanes past the end of their joint rows are masked out.
+class ndAvx512JointGroup
+{
+	public:
+	ndAvx512Int m_body0;
+	ndAvx512Int m_body1;
+	ndAvx512Int m_rowStart;
+	ndAvx512Int m_rowCount;
+	ndAvx512Float m_preconditioner0;
+	ndAvx512Float m_preconditioner1;
+	ndInt32 m_jointStart;
+	ndInt32 m_soaRowStart;
+	ndInt32 m_soaRowCount;
+	ndAvx512Mask m_laneMask;
+};
+
+class ndAvx512MatrixArray : public ndArray<ndAvx512MatrixElement>
+{
+};
+
+class ndAvx512JointGroupArray : public ndArray<ndAvx512JointGroup>
+{
+};
+
+ndDynamicsUpdateAvx512::ndDynamicsUpdateAvx512(ndWorld* const world)
+	:ndDynamicsUpdate(world)
+	,m_jointGroups(new ndAvx512JointGroupArray)
+	,m_avxMassMatrixArray(new ndAvx512MatrixArray)
+{
+}
+
+ndDynamicsUpdateAvx512::~ndDynamicsUpdateAvx512()
+{
+	Clear();
+	delete m_jointGroups;
+	delete m_avxMassMatrixArray;
+}
+
+const char* ndDynamicsUpdateAvx512::GetStringId() const
+{
+	return "avx512";
+}
+
+void ndDynamicsUpdateAvx512::TransposeMassMatrix()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+	const ndInt32 jointCount = jointArray.GetCount();
+	const ndInt32 groupCount = (jointCount + D_AVX512_WORK_GROUP - 1) / D_AVX512_WORK_GROUP;
+
+	ndAvx512JointGroupArray& jointGroups = *m_jointGroups;
+	jointGroups.SetCount(groupCount);
+
+	ndInt32 soaRowCount = 0;
+	for (ndInt32 i = 0; i < groupCount; ++i)
+	{
+		ndInt32 rowCount = 0;
+		const ndInt32 start = i * D_AVX512_WORK_GROUP;
+		const ndInt32 count = ndMin(jointCount - start, D_AVX512_WORK_GROUP);
+		for (ndInt32 j = 0; j < count; ++j)
+		{
+			rowCount = ndMax(rowCount, jointArray[start + j]->m_rowCount);
+		}
+		ndAvx512JointGroup& group = jointGroups[i];
+		group.m_jointStart = start;
+		group.m_soaRowStart = soaRowCount;
+		group.m_soaRowCount = rowCount;
+		soaRowCount += rowCount;
+	}
+	m_avxMassMatrixArray->SetCount(soaRowCount);
+
+	auto TransposeMassMatrix = [this, &jointArray](ndInt32, ndInt32 groupIndex)
+	{
+		ndAvx512JointGroup& group = (*m_jointGroups)[groupIndex];
+		const ndInt32 count = ndMin(jointArray.GetCount() - group.m_jointStart, D_AVX512_WORK_GROUP);
+
+		ndAvx512Mask laneMask = 0;
+		for (ndInt32 i = 0; i < D_AVX512_WORK_GROUP; ++i)
+		{
+			if (i < count)
+			{
+				const ndConstraint* const joint = jointArray[group.m_jointStart + i];
+				const ndBodyKinematic* const body0 = joint->GetBody0();
+				const ndBodyKinematic* const body1 = joint->GetBody1();
+				group.m_body0[i] = body0->m_index * D_AVX512_JACOBIAN_STRIDE;
+				group.m_body1[i] = body1->m_index * D_AVX512_JACOBIAN_STRIDE;
+				group.m_rowStart[i] = joint->m_rowStart;
+				group.m_rowCount[i] = joint->m_rowCount;
+				group.m_preconditioner0[i] = body0->m_weigh;
+				group.m_preconditioner1[i] = body1->m_weigh;
+				laneMask = ndAvx512Mask(laneMask | (joint->m_rowCount ? (1 << i) : 0));
+			}
+			else
+			{
+				group.m_body0[i] = 0;
+				group.m_body1[i] = 0;
+				group.m_rowStart[i] = 0;
+				group.m_rowCount[i] = 0;
+				group.m_preconditioner0[i] = ndFloat32(0.0f);
+				group.m_preconditioner1[i] = ndFloat32(0.0f);
+			}
+		}
+		group.m_laneMask = laneMask;
+
+		const ndLeftHandSide* const lhs = &m_leftHandSide[0];
+		const ndRightHandSide* const rhs = &m_rightHandSide[0];
+		const ndFloat32* const JtM0 = &lhs->m_Jt.m_jacobianM0.m_linear.m_x;
+		const ndFloat32* const JtM1 = &lhs->m_Jt.m_jacobianM1.m_linear.m_x;
+		const ndFloat32* const JMinvM0 = &lhs->m_JMinv.m_jacobianM0.m_linear.m_x;
+		const ndFloat32* const JMinvM1 = &lhs->m_JMinv.m_jacobianM1.m_linear.m_x;
+
+		const ndAvx512Int one(1);
+		const ndAvx512Int ordinals(ndAvx512Int::Ordinals());
+		const ndAvx512Int workGroup(D_AVX512_WORK_GROUP);
+		const ndAvx512Int lhsStride(ndInt32(sizeof(ndLeftHandSide) / sizeof(ndFloat32)));
+		const ndAvx512Int rhsStride(ndInt32(sizeof(ndRightHandSide) / sizeof(ndFloat32)));
+		const ndAvx512Int rhsIntStride(ndInt32(sizeof(ndRightHandSide) / sizeof(ndInt32)));
+
+		ndAvx512MatrixElement* const massMatrix = &(*m_avxMassMatrixArray)[group.m_soaRowStart];
+		for (ndInt32 j = 0; j < group.m_soaRowCount; ++j)
+		{
+			const ndAvx512Int row(group.m_rowStart + ndAvx512Int(j));
+			const ndAvx512Mask rowMask = group.m_rowCount > ndAvx512Int(j);
+			ndAvx512MatrixElement& element = massMatrix[j];
+
+			const ndAvx512Int lhsIndex(row * lhsStride);
+			element.m_Jt.m_jacobianM0.Gather(JtM0, lhsIndex, rowMask);
+			element.m_Jt.m_jacobianM1.Gather(JtM1, lhsIndex, rowMask);
+			element.m_JMinv.m_jacobianM0.Gather(JMinvM0, lhsIndex, rowMask);
+			element.m_JMinv.m_jacobianM1.Gather(JMinvM1, lhsIndex, rowMask);
+
+			const ndAvx512Int rhsIndex(row * rhsStride);
+			element.m_force = ndAvx512Float(&rhs->m_force, rhsIndex, rowMask);
+			element.m_diagDamp = ndAvx512Float(&rhs->m_diagDamp, rhsIndex, rowMask);
+			element.m_invJinvMJt = ndAvx512Float(&rhs->m_invJinvMJt, rhsIndex, rowMask);
+			element.m_coordenateAccel = ndAvx512Float(&rhs->m_coordenateAccel, rhsIndex, rowMask);
+			element.m_lowerBoundFrictionCoefficent = ndAvx512Float(&rhs->m_lowerBoundFrictionCoefficent, rhsIndex, rowMask);
+			element.m_upperBoundFrictionCoefficent = ndAvx512Float(&rhs->m_upperBoundFrictionCoefficent, rhsIndex, rowMask);
+
+			// the friction normal of each lane is in the same lane of the normal row, 
+			// masked lanes read the unit normal in the first entry.
+			const ndAvx512Int normalIndex(&rhs->m_normalForceIndex, row * rhsIntStride, ndAvx512Int(-1), rowMask);
+			element.m_normalForceIndex = (normalIndex + one) * workGroup + ordinals;
+		}
+	};
+
+	if (jointCount)
+	{
+		scene->ParallelFor(0, groupCount, D_AVX512_GROUPS_GRAIN, TransposeMassMatrix);
+	}
+}
+
+void ndDynamicsUpdateAvx512::UpdateJointsAcceleration()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	auto UpdateAcceleration = [this](ndInt32, ndInt32 groupIndex)
+	{
+		const ndAvx512JointGroup& group = (*m_jointGroups)[groupIndex];
+		const ndRightHandSide* const rhs = &m_rightHandSide[0];
+		const ndAvx512Int rhsStride(ndInt32(sizeof(ndRightHandSide) / sizeof(ndFloat32)));
+
+		ndAvx512MatrixElement* const massMatrix = &(*m_avxMassMatrixArray)[group.m_soaRowStart];
+		for (ndInt32 j = 0; j < group.m_soaRowCount; ++j)
+		{
+			const ndAvx512Int row(group.m_rowStart + ndAvx512Int(j));
+			const ndAvx512Mask rowMask = group.m_rowCount > ndAvx512Int(j);
+			massMatrix[j].m_coordenateAccel = ndAvx512Float(&rhs->m_coordenateAccel, row * rhsStride, rowMask);
+		}
+	};
+	scene->ParallelFor(0, m_jointGroups->GetCount(), D_AVX512_GROUPS_GRAIN, UpdateAcceleration);
+}
+
+void ndDynamicsUpdateAvx512::CalculateJointsForce()
+{
+	D_TRACKTIME();
+	const ndUnsigned32 passes = m_solverPasses;
+	ndScene* const scene = m_world->GetScene();
+
+	ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
+	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+
+	auto CalculateJointsForce = [this, &jointArray](ndInt32, ndInt32 groupIndex)
+	{
+		const ndAvx512JointGroup& group = (*m_jointGroups)[groupIndex];
+		ndAvx512MatrixElement* const massMatrix = &(*m_avxMassMatrixArray)[group.m_soaRowStart];
+
+		ndAvx512Vector6 forceM0;
+		ndAvx512Vector6 forceM1;
+		ndAvx512Float normalForce[D_CONSTRAINT_MAX_ROWS + 1];
+
+		const ndFloat32* const internalForces = &m_internalForces[0].m_linear.m_x;
+		forceM0.Gather(internalForces, group.m_body0, group.m_laneMask);
+		forceM1.Gather(internalForces, group.m_body1, group.m_laneMask);
+		const ndAvx512Float preconditioner0(group.m_preconditioner0);
+		const ndAvx512Float preconditioner1(group.m_preconditioner1);
+
+		const ndAvx512Float zero(ndFloat32(0.0f));
+		const ndInt32 rowsCount = group.m_soaRowCount;
+		normalForce[0] = ndAvx512Float(ndFloat32(1.0f));
+		for (ndInt32 j = 0; j < rowsCount; ++j)
+		{
+			normalForce[j + 1] = massMatrix[j].m_force;
+		}
+
+		const ndFloat32 tol = ndFloat32(0.125f);
+		const ndFloat32 tol2 = tol * tol;
+
+		ndInt32 iterations = 0;
+		ndAvx512Float accNorm(zero);
+		do
+		{
+			accNorm = zero;
+			for (ndInt32 j = 0; j < rowsCount; ++j)
+			{
+				const ndAvx512MatrixElement* const row = &massMatrix[j];
+
+				ndAvx512Float a(row->m_JMinv.m_jacobianM0.DotProduct(forceM0) + row->m_JMinv.m_jacobianM1.DotProduct(forceM1));
+				const ndAvx512Float force(normalForce[j + 1]);
+				a = row->m_coordenateAccel.MulSub(force, row->m_diagDamp) - a;
+				ndAvx512Float f(force.MulAdd(row->m_invJinvMJt, a));
+
+				const ndAvx512Float frictionNormal(&normalForce[0][0], row->m_normalForceIndex);
+				const ndAvx512Float lowerFrictionForce(frictionNormal * row->m_lowerBoundFrictionCoefficent);
+				const ndAvx512Float upperFrictionForce(frictionNormal * row->m_upperBoundFrictionCoefficent);
+
+				// only the rows that are not clamped add to the residual
+				const ndAvx512Mask unclamped = ndAvx512Mask((f < upperFrictionForce) & (f > lowerFrictionForce));
+				accNorm = accNorm.MulAdd(a, a, unclamped);
+
+				f = f.GetMax(lowerFrictionForce).GetMin(upperFrictionForce);
+				normalForce[j + 1] = f;
+
+				const ndAvx512Float deltaForce(f - force);
+				forceM0.MulAdd(row->m_Jt.m_jacobianM0, deltaForce * preconditioner0);
+				forceM1.MulAdd(row->m_Jt.m_jacobianM1, deltaForce * preconditioner1);
+			}
+			iterations++;
+		} while ((iterations < 5) && (accNorm.GetMax() > tol2));
+
+		// joints between two resting bodies keep their forces
+		ndAvx512Mask mask = group.m_laneMask;
+		const ndConstraint* const* const jointGroup = &jointArray[group.m_jointStart];
+		for (ndInt32 i = 0; i < D_AVX512_WORK_GROUP; ++i)
+		{
+			if (mask & (1 << i))
+			{
+				const ndConstraint* const joint = jointGroup[i];
+				const ndBodyKinematic* const body0 = joint->GetBody0();
+				const ndBodyKinematic* const body1 = joint->GetBody1();
+				ndAssert(body0);
+				ndAssert(body1);
+				if (body0->m_equilibrium0 & body1->m_equilibrium0)
+				{
+					mask = ndAvx512Mask(mask & ~(1 << i));
+				}
+			}
+		}
+
+		ndRightHandSide* const rhs = &m_rightHandSide[0];
+		const ndAvx512Int rhsStride(ndInt32(sizeof(ndRightHandSide) / sizeof(ndFloat32)));
+
+		forceM0.Set(zero);
+		forceM1.Set(zero);
+		for (ndInt32 j = 0; j < rowsCount; ++j)
+		{
+			ndAvx512MatrixElement* const row = &massMatrix[j];
+			const ndAvx512Float force(row->m_force.Select(normalForce[j + 1], mask));
+			row->m_force = force;
+
+			forceM0.MulAdd(row->m_Jt.m_jacobianM0, force);
+			forceM1.MulAdd(row->m_Jt.m_jacobianM1, force);
+
+			const ndAvx512Mask rowMask = group.m_rowCount > ndAvx512Int(j);
+			const ndAvx512Int rhsIndex((group.m_rowStart + ndAvx512Int(j)) * rhsStride);
+			const ndAvx512Float maxImpact(&rhs->m_maxImpact, rhsIndex, rowMask);
+			force.Scatter(&rhs->m_force, rhsIndex, rowMask);
+			maxImpact.GetMax(force.Abs()).Scatter(&rhs->m_maxImpact, rhsIndex, rowMask);
+		}
+
+		ndFloat32* const jointPartialForces = &GetTempInternalForces()[0].m_linear.m_x;
+		const ndAvx512Int jointIndex(ndAvx512Int(group.m_jointStart) + ndAvx512Int::Ordinals());
+		const ndAvx512Int outIndex(jointIndex * ndAvx512Int(2 * D_AVX512_JACOBIAN_STRIDE));
+		forceM0.Scatter(jointPartialForces, outIndex, group.m_laneMask);
+		forceM1.Scatter(jointPartialForces + D_AVX512_JACOBIAN_STRIDE, outIndex, group.m_laneMask);
+	};
+
+	auto ApplyJacobianAccumulatePartialForces = ndMakeObject::ndFunction([this, &bodyArray](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(ApplyJacobianAccumulatePartialForces);
+		const ndVector zero(ndVector::m_zero);
+
+		ndJacobian* const internalForces = &GetInternalForces()[0];
+		const ndInt32* const bodyIndex = &GetJointForceIndexBuffer()[0];
+
+		const ndJacobian* const jointInternalForces = &GetTempInternalForces()[0];
+		const ndJointBodyPairIndex* const jointBodyPairIndexBuffer = &GetJointBodyPairIndexBuffer()[0];
+
+		const ndStartEnd startEnd(bodyArray.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndVector force(zero);
+			ndVector torque(zero);
+			const ndBodyKinematic* const body = bodyArray[i];
+
+			const ndInt32 startIndex = bodyIndex[i];
+			const ndInt32 mask = body->m_isStatic - 1;
+			const ndInt32 count = mask & (bodyIndex[i + 1] - startIndex);
+			for (ndInt32 j = 0; j < count; ++j)
+			{
+				const ndInt32 index = jointBodyPairIndexBuffer[startIndex + j].m_joint;
+				force += jointInternalForces[index].m_linear;
+				torque += jointInternalForces[index].m_angular;
+			}
+			internalForces[i].m_linear = force;
+			internalForces[i].m_angular = torque;
+		}
+	});
+
+	for (ndInt32 i = 0; i < ndInt32(passes); ++i)
+	{
+		D_TRACKTIME_NAMED(CalculateJointsForce);
+		scene->ParallelFor(0, m_jointGroups->GetCount(), D_AVX512_GROUPS_GRAIN, CalculateJointsForce);
+		scene->ParallelExecute(ApplyJacobianAccumulatePartialForces);
+	}
+}
+
+void ndDynamicsUpdateAvx512::CalculateForces()
+{
+	D_TRACKTIME();
+	if (m_world->GetScene()->GetActiveContactArray().GetCount())
+	{
+		m_firstPassCoef = ndFloat32(0.0f);
+
+		InitSkeletons();
+		for (ndInt32 step = 0; step < 4; step++)
+		{
+			CalculateJointsAcceleration();
+			UpdateJointsAcceleration();
+			CalculateJointsForce();
+			m_updatePasses += m_solverPasses;
+			UpdateSkeletons();
+			IntegrateBodiesVelocity();
+		}
+		UpdateForceFeedback();
+	}
+}
+
+void ndDynamicsUpdateAvx512::Update()
+{
+	D_TRACKTIME();
+	m_timestep = m_world->GetScene()->GetTimestep();
+
+	BuildIsland();
+	IntegrateUnconstrainedBodies();
+	InitWeights();
+	InitBodyArray();
+	InitJacobianMatrix();
+	TransposeMassMatrix();
+	CalculateForces();
+	IntegrateBodies();
+	DetermineSleepStates();
+}
@@ -319,7 +319,7 @@ void ndIkSolver::BuildMassMatrix()
 		ndBodyKinematic::ndContactMap::Iterator it(contactMap);
 		for (it.Begin(); it; it++)
 		{
-			ndContact* const contact = it.GetNode()->GetInfo();
+			ndContact* const contact = *it;
 			if (contact->IsActive())
 			{
 				bool duplicate = false;
@@ -464,7 +464,7 @@ void ndIkSolver::Solve()
 				ndBodyKinematic::ndContactMap::Iterator it(contactMap);
 				for (it.Begin(); it; it++)
 				{
-					ndContact* const fronterContact = it.GetNode()->GetInfo();
+					ndContact* const fronterContact = *it;
 					if (fronterContact->IsActive() && (fronterContact != contact))
 					{
 						if (body == fronterContact->GetBody0())
@@ -60,6 +60,10 @@ void ndBodyDynamic::SetForce(const ndVector& force)
 		ndAssert(deltaAccel.m_w == ndFloat32(0.0f));
 		ndFloat32 deltaAccel2 = deltaAccel.DotProduct(deltaAccel).GetScalar();
 		m_equilibrium = ndUnsigned8(deltaAccel2 < D_ERR_TOLERANCE2);
+		if (!m_equilibrium)
+		{
+			Unfreeze();
+		}
 	}
 }
 
@@ -77,6 +81,10 @@ void ndBodyDynamic::SetTorque(const ndVector& torque)
 		ndAssert(deltaAlpha.m_w == ndFloat32(0.0f));
 		ndFloat32 deltaAlpha2 = deltaAlpha.DotProduct(deltaAlpha).GetScalar();
 		m_equilibrium = ndUnsigned8(deltaAlpha2 < D_ERR_TOLERANCE2);
+		if (!m_equilibrium)
+		{
+			Unfreeze();
+		}
 	}
 }
 
@@ -151,7 +159,7 @@ void ndBodyDynamic::AddImpulse(const ndVector& pointDeltaVeloc, const ndVector&
 		m_impulseTorque += globalContact.CrossProduct(m_impulseForce);
 
 		m_equilibrium = false;
-		//Unfreeze();
+		Unfreeze();
 	}
 }
 
@@ -168,6 +176,7 @@ void ndBodyDynamic::ApplyImpulsePair(const ndVector& linearImpulseIn, const ndVe
 		m_impulseTorque += angularImpulse.Scale(1.0f / timestep);
 
 		m_equilibrium = false;
+		Unfreeze();
 	}
 }
 
@@ -197,6 +206,7 @@ void ndBodyDynamic::ApplyImpulsesAtPoint(ndInt32 count, const ndVector* const im
 		m_impulseTorque += angularImpulse.Scale(1.0f / timestep);
 
 		m_equilibrium = false;
+		Unfreeze();
 	}
 }
 
@@ -386,7 +396,7 @@ void ndBodyDynamic::EvaluateSleepState(ndFloat32 freezeSpeed2, ndFloat32 freezeA
 		ndContactMap::Iterator it(m_contactList);
 		for (it.Begin(); it; it++)
 		{
-			ndContact* const contact = it.GetNode()->GetInfo();
+			ndContact* const contact = *it;
 			if (contact->IsActive() && !contact->IsTestOnly())
 			{
 				checkConnection++;
@@ -91,7 +91,9 @@ class ndBodyDynamic: public ndBodyKinematic
 
 	friend class ndDynamicsUpdate;
 	friend class ndDynamicsUpdateSoa;
+	friend class ndDynamicsUpdateGaussSeidel;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 	friend class ndDynamicsUpdateSycl;
 	friend class ndDynamicsUpdateCuda;
 	friend class ndFileFormatBodyDynamic;
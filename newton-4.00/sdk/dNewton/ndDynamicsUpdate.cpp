@@ -29,6 +29,11 @@
 
 #define D_MAX_BODY_RADIX_BIT		9
 #define D_DEFAULT_BUFFER_SIZE		1024
+#define D_SOLVER_JOINTS_GRAIN		32
+#define D_SOLVER_ISLANDS_GRAIN		16
+#define D_SOLVER_ISLAND_RESIDUAL2	ndFloat32 (0.125f * 0.125f)
+#define D_DIRECT_SOLVER_ACCEL_TOL	ndFloat32 (1.0e-2f)
+#define D_MAX_DIRECT_LCP_VALUE		(D_LCP_MAX_VALUE * ndFloat32 (0.25f))
 
 ndDynamicsUpdate::ndDynamicsUpdate(ndWorld* const world)
 	:m_velocTol(ndFloat32(1.0e-8f))
@@ -40,6 +45,11 @@ ndDynamicsUpdate::ndDynamicsUpdate(ndWorld* const world)
 	,m_tempInternalForces(D_DEFAULT_BUFFER_SIZE)
 	,m_bodyIslandOrder(D_DEFAULT_BUFFER_SIZE)
 	,m_jointBodyPairIndexBuffer(D_DEFAULT_BUFFER_SIZE)
+	,m_jointIsland(nullptr)
+	,m_islandJoints(nullptr)
+	,m_jointResidual(nullptr)
+	,m_directIslands(nullptr)
+	,m_directIslandCount(0)
 	,m_world(world)
 	,m_timestep(ndFloat32(0.0f))
 	,m_invTimestep(ndFloat32(0.0f))
@@ -48,6 +58,7 @@ ndDynamicsUpdate::ndDynamicsUpdate(ndWorld* const world)
 	,m_timestepRK(ndFloat32(0.0f))
 	,m_invTimestepRK(ndFloat32(0.0f))
 	,m_solverPasses(0)
+	,m_updatePasses(0)
 	,m_activeJointCount(0)
 	,m_unConstrainedBodyCount(0)
 {
@@ -135,8 +146,7 @@ void ndDynamicsUpdate::SortBodyJointScan()
 	});
 	scene->ParallelExecute(CountJointBodyPairs);
 
-	scene->GetScratchBuffer().SetCount(bodyJointPairs.GetCount() * ndInt32 (sizeof (ndJointBodyPairIndex)));
-	ndJointBodyPairIndex* const tempBuffer = (ndJointBodyPairIndex*)&scene->GetScratchBuffer()[0];
+	ndJointBodyPairIndex* const tempBuffer = scene->GetFrameArena().Alloc<ndJointBodyPairIndex>(bodyJointPairs.GetCount());
 
 	ndCountingSort<ndJointBodyPairIndex, ndEvaluateKey0, D_MAX_BODY_RADIX_BIT>(*scene, &bodyJointPairs[0], tempBuffer, bodyJointPairs.GetCount(), nullptr, nullptr);
 	ndCountingSort<ndJointBodyPairIndex, ndEvaluateKey1, D_MAX_BODY_RADIX_BIT>(*scene, tempBuffer, &bodyJointPairs[0], bodyJointPairs.GetCount(), nullptr, nullptr);
@@ -255,6 +265,7 @@ void ndDynamicsUpdate::SortJointsScan()
 	jointArray.SetCount(jointCount);
 	
 	m_leftHandSide.SetCount(jointArray.GetCount() + 32);
+	ndConstraint** const tempJointBuffer = scene->GetFrameArena().Alloc<ndConstraint*>(jointArray.GetCount() + 32);
 	
 	ndInt32 histogram[D_MAX_THREADS_COUNT][2];
 	ndInt32 movingJoints[D_MAX_THREADS_COUNT];
@@ -316,12 +327,11 @@ void ndDynamicsUpdate::SortJointsScan()
 		movingJoints[threadIndex] = activeJointCount;
 	});
 	
-	auto Scan0 = ndMakeObject::ndFunction([&jointArray, &histogram, scene](ndInt32 threadIndex, ndInt32 threadCount)
+	auto Scan0 = ndMakeObject::ndFunction([&jointArray, &histogram, tempJointBuffer](ndInt32 threadIndex, ndInt32 threadCount)
 	{
 		D_TRACKTIME_NAMED(Scan0);
 		ndInt32* const hist = &histogram[threadIndex][0];
-		ndAssert(scene->GetScratchBuffer().GetCount() >= ndInt32 (jointArray.GetCount() * sizeof(ndConstraint*)));
-		ndConstraint** const dstBuffer = (ndConstraint**)&scene->GetScratchBuffer()[0];
+		ndConstraint** const dstBuffer = tempJointBuffer;
 	
 		hist[0] = 0;
 		hist[1] = 0;
@@ -338,12 +348,11 @@ void ndDynamicsUpdate::SortJointsScan()
 		}
 	});
 	
-	auto Sort0 = ndMakeObject::ndFunction([&jointArray, &histogram, scene](ndInt32 threadIndex, ndInt32 threadCount)
+	auto Sort0 = ndMakeObject::ndFunction([&jointArray, &histogram, tempJointBuffer](ndInt32 threadIndex, ndInt32 threadCount)
 	{
 		D_TRACKTIME_NAMED(Sort0);
 		ndInt32* const hist = &histogram[threadIndex][0];
-		ndAssert(scene->GetScratchBuffer().GetCount() >= ndInt32 (jointArray.GetCount() * sizeof (ndConstraint*)));
-		ndConstraint** const dstBuffer = (ndConstraint**)&scene->GetScratchBuffer()[0];
+		ndConstraint** const dstBuffer = tempJointBuffer;
 	
 		const ndStartEnd startEnd(jointArray.GetCount(), threadIndex, threadCount);
 		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
@@ -358,9 +367,6 @@ void ndDynamicsUpdate::SortJointsScan()
 		}
 	});
 	
-	scene->GetScratchBuffer().SetCount((jointArray.GetCount() + 32) * ndInt32 (sizeof (ndConstraint*)));
-	ndConstraint** const tempJointBuffer = (ndConstraint**)&scene->GetScratchBuffer()[0];
-	
 	scene->ParallelExecute(MarkFence0);
 	scene->ParallelExecute(MarkFence1);
 	scene->ParallelExecute(Scan0);
@@ -762,6 +768,7 @@ void ndDynamicsUpdate::GetJacobianDerivatives(ndConstraint* const joint)
 	}
 
 	joint->m_rowCount = dof;
+	joint->m_isInDirectIsland = 0;
 	const ndInt32 baseIndex = joint->m_rowStart;
 	for (ndInt32 i = 0; i < dof; ++i)
 	{
@@ -796,9 +803,8 @@ void ndDynamicsUpdate::InitJacobianMatrix()
 	ndBodyKinematic** const bodyArray = &scene->GetActiveBodyArray()[0];
 	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
 
-	auto InitJacobianMatrix = ndMakeObject::ndFunction([this, &jointArray](ndInt32 threadIndex, ndInt32 threadCount)
+	auto InitJacobianMatrix = [this, &jointArray](ndInt32, ndInt32 i)
 	{
-		D_TRACKTIME_NAMED(InitJacobianMatrix);
 		ndJacobian* const internalForces = &GetTempInternalForces()[0];
 		auto BuildJacobianMatrix = [this, &internalForces](ndConstraint* const joint, ndInt32 jointIndex)
 		{
@@ -885,14 +891,10 @@ void ndDynamicsUpdate::InitJacobianMatrix()
 			outBody1.m_angular = torqueAcc1;
 		};
 
-		const ndInt32 jointCount = jointArray.GetCount();
-		for (ndInt32 i = threadIndex; i < jointCount; i += threadCount)
-		{
-			ndConstraint* const joint = jointArray[i];
-			GetJacobianDerivatives(joint);
-			BuildJacobianMatrix(joint, i);
-		}
-	});
+		ndConstraint* const joint = jointArray[i];
+		GetJacobianDerivatives(joint);
+		BuildJacobianMatrix(joint, i);
+	};
 
 	auto InitJacobianAccumulatePartialForces = ndMakeObject::ndFunction([this, &bodyArray](ndInt32 threadIndex, ndInt32 threadCount)
 	{
@@ -935,7 +937,8 @@ void ndDynamicsUpdate::InitJacobianMatrix()
 		D_TRACKTIME();
 		m_rightHandSide[0].m_force = ndFloat32(1.0f);
 
-		scene->ParallelExecute(InitJacobianMatrix);
+		D_TRACKTIME_NAMED(InitJacobianMatrix);
+		scene->ParallelFor(0, jointArray.GetCount(), D_SOLVER_JOINTS_GRAIN, InitJacobianMatrix);
 		scene->ParallelExecute(InitJacobianAccumulatePartialForces);
 	}
 }
@@ -1217,6 +1220,320 @@ void ndDynamicsUpdate::UpdateSkeletons()
 	}
 }
 
+void ndDynamicsUpdate::FindIslands()
+{
+	D_TRACKTIME();
+	m_islands.SetCount(0);
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
+	const ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+	const ndInt32 bodyCount = bodyArray.GetCount();
+	const ndInt32 jointCount = jointArray.GetCount();
+	if (!jointCount)
+	{
+		return;
+	}
+
+	// static bodies do not connect islands, since the solver never changes their forces
+	for (ndInt32 i = 0; i < bodyCount; ++i)
+	{
+		bodyArray[i]->m_islandParent = bodyArray[i];
+	}
+	for (ndInt32 i = 0; i < jointCount; ++i)
+	{
+		const ndConstraint* const joint = jointArray[i];
+		ndBodyKinematic* const body0 = joint->GetBody0();
+		ndBodyKinematic* const body1 = joint->GetBody1();
+		if (!(body0->m_isStatic | body1->m_isStatic))
+		{
+			ndBodyKinematic* const root0 = FindRootAndSplit(body0);
+			ndBodyKinematic* const root1 = FindRootAndSplit(body1);
+			if (root0 != root1)
+			{
+				root0->m_islandParent = root1;
+			}
+		}
+	}
+
+	ndFrameArena& arena = scene->GetFrameArena();
+	ndInt32* const islandIndex = arena.Alloc<ndInt32>(bodyCount);
+	m_jointIsland = arena.Alloc<ndInt32>(jointCount);
+	m_islandJoints = arena.Alloc<ndInt32>(jointCount);
+	m_jointResidual = arena.Alloc<ndFloat32>(jointCount);
+	ndMemSet(islandIndex, -1, bodyCount);
+
+	ndInt32* const islandWeigh = arena.Alloc<ndInt32>(bodyCount);
+	for (ndInt32 i = 0; i < jointCount; ++i)
+	{
+		const ndConstraint* const joint = jointArray[i];
+		ndBodyKinematic* const body0 = joint->GetBody0();
+		ndBodyKinematic* const body1 = joint->GetBody1();
+		ndBodyKinematic* const root = FindRootAndSplit(body0->m_isStatic ? body1 : body0);
+		if (islandIndex[root->m_index] < 0)
+		{
+			islandIndex[root->m_index] = m_islands.GetCount();
+			islandWeigh[m_islands.GetCount()] = 1;
+			m_islands.PushBack(ndIsland(root));
+		}
+
+		const ndInt32 index = islandIndex[root->m_index];
+		ndIsland& island = m_islands[index];
+		island.m_count++;
+		island.m_resting = ndUnsigned8(island.m_resting & body0->m_equilibrium0 & body1->m_equilibrium0);
+		island.m_hasSkeleton = ndUnsigned8(island.m_hasSkeleton | joint->m_isInSkeletonLoop | (body0->GetSkeleton() || body1->GetSkeleton()));
+
+		const ndInt32 weigh = ndInt32(ndMax(body0->m_isStatic ? ndFloat32(0.0f) : body0->m_weigh, body1->m_isStatic ? ndFloat32(0.0f) : body1->m_weigh));
+		islandWeigh[index] = ndMax(islandWeigh[index], weigh);
+		m_jointIsland[i] = index;
+	}
+
+	// same pass count as the global one, but from the connectivity of each island.
+	const ndInt32 conectivity = 7;
+	ndInt32 start = 0;
+	for (ndInt32 i = 0; i < m_islands.GetCount(); ++i)
+	{
+		ndIsland& island = m_islands[i];
+		island.m_start = start;
+		island.m_passes = m_world->GetSolverIterations() + 2 * islandWeigh[i] / conectivity + 2;
+		start += island.m_count;
+		island.m_count = 0;
+	}
+	for (ndInt32 i = 0; i < jointCount; ++i)
+	{
+		ndIsland& island = m_islands[m_jointIsland[i]];
+		m_islandJoints[island.m_start + island.m_count] = i;
+		island.m_count++;
+	}
+}
+
+void ndDynamicsUpdate::InitDirectIslands()
+{
+	D_TRACKTIME();
+	// joints only know their rows after InitJacobianMatrix, 
+	// before that the row count is the joint max dof.
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+	for (ndInt32 i = 0; i < m_islands.GetCount(); ++i)
+	{
+		ndIsland& island = m_islands[i];
+		const ndInt32* const joints = &m_islandJoints[island.m_start];
+		island.m_rowCount = 0;
+		for (ndInt32 j = 0; j < island.m_count; ++j)
+		{
+			island.m_rowCount += jointArray[joints[j]]->m_rowCount;
+		}
+	}
+
+	m_directIslandCount = 0;
+	const ndInt32 maxRows = m_world->m_directSolverMaxRows;
+	if (!maxRows)
+	{
+		return;
+	}
+
+	// islands with skeletons are left to the skeleton solver, 
+	// and islands at rest are not solved at all.
+	ndInt32 islandCount = 0;
+	for (ndInt32 i = 0; i < m_islands.GetCount(); ++i)
+	{
+		const ndIsland& island = m_islands[i];
+		islandCount += (!island.m_resting && !island.m_hasSkeleton && (island.m_rowCount <= maxRows)) ? 1 : 0;
+	}
+	if (!islandCount)
+	{
+		return;
+	}
+
+	m_directIslands = scene->GetFrameArena().Alloc<ndDirectIsland>(islandCount);
+	for (ndInt32 i = 0; i < m_islands.GetCount(); ++i)
+	{
+		const ndIsland& island = m_islands[i];
+		if (!island.m_resting && !island.m_hasSkeleton && (island.m_rowCount <= maxRows))
+		{
+			ndDirectIsland& directIsland = m_directIslands[m_directIslandCount];
+			directIsland.m_island = i;
+			directIsland.m_rowCount = island.m_rowCount;
+			m_directIslandCount++;
+			for (ndInt32 j = 0; j < island.m_count; ++j)
+			{
+				jointArray[m_islandJoints[island.m_start + j]]->m_isInDirectIsland = 1;
+			}
+		}
+	}
+
+	auto FactorizeIsland = [this, &jointArray](ndInt32 threadIndex, ndInt32 islandIndex)
+	{
+		ndDirectIsland& island = m_directIslands[islandIndex];
+		ndFrameArena& threadArena = m_world->GetScene()->GetFrameArena(threadIndex);
+		const ndInt32 size = island.m_rowCount;
+		island.m_rows = threadArena.Alloc<ndInt32>(size);
+		island.m_bodies = threadArena.Alloc<ndInt32>(size * 2);
+		island.m_normalIndex = threadArena.Alloc<ndInt32>(size);
+		island.m_matrix = threadArena.Alloc<ndFloat32>(size * size);
+		island.m_low = threadArena.Alloc<ndFloat32>(size);
+		island.m_high = threadArena.Alloc<ndFloat32>(size);
+
+		auto IsUnbounded = [](const ndRightHandSide* const rhs)
+		{
+			return (rhs->m_lowerBoundFrictionCoefficent <= -D_MAX_DIRECT_LCP_VALUE) && (rhs->m_upperBoundFrictionCoefficent >= D_MAX_DIRECT_LCP_VALUE);
+		};
+
+		// the unbounded rows go first, so that they can be factorized
+		const ndIsland& sourceIsland = m_islands[island.m_island];
+		const ndInt32* const joints = &m_islandJoints[sourceIsland.m_start];
+		ndInt32 blockSize = 0;
+		for (ndInt32 i = 0; i < sourceIsland.m_count; ++i)
+		{
+			const ndConstraint* const joint = jointArray[joints[i]];
+			for (ndInt32 j = 0; j < joint->m_rowCount; ++j)
+			{
+				blockSize += IsUnbounded(&m_rightHandSide[joint->m_rowStart + j]) ? 1 : 0;
+			}
+		}
+
+		ndInt32 blockIndex = 0;
+		ndInt32 boundedIndex = blockSize;
+		ndInt32 position[D_CONSTRAINT_MAX_ROWS];
+		for (ndInt32 i = 0; i < sourceIsland.m_count; ++i)
+		{
+			const ndConstraint* const joint = jointArray[joints[i]];
+			const ndInt32 m0 = joint->GetBody0()->m_index;
+			const ndInt32 m1 = joint->GetBody1()->m_index;
+			for (ndInt32 j = 0; j < joint->m_rowCount; ++j)
+			{
+				const bool unbounded = IsUnbounded(&m_rightHandSide[joint->m_rowStart + j]);
+				position[j] = unbounded ? blockIndex : boundedIndex;
+				blockIndex += unbounded ? 1 : 0;
+				boundedIndex += unbounded ? 0 : 1;
+			}
+			for (ndInt32 j = 0; j < joint->m_rowCount; ++j)
+			{
+				const ndInt32 k = position[j];
+				const ndRightHandSide* const rhs = &m_rightHandSide[joint->m_rowStart + j];
+				const ndInt32 normalIndex = rhs->m_normalForceIndex;
+				island.m_rows[k] = joint->m_rowStart + j;
+				island.m_low[k] = rhs->m_lowerBoundFrictionCoefficent;
+				island.m_high[k] = rhs->m_upperBoundFrictionCoefficent;
+				island.m_bodies[k * 2 + 0] = m0;
+				island.m_bodies[k * 2 + 1] = m1;
+				island.m_normalIndex[k] = (normalIndex < 0) ? 0 : position[normalIndex] - k;
+			}
+		}
+		ndAssert(blockIndex == blockSize);
+		ndAssert(boundedIndex == size);
+
+		ndJacobian tempArray[3];
+		tempArray[0].m_linear = ndVector::m_zero;
+		tempArray[0].m_angular = ndVector::m_zero;
+		ndFloat32* const matrix = island.m_matrix;
+		ndFloat32* const diagDamp = ndAlloca(ndFloat32, size);
+		for (ndInt32 i = 0; i < size; ++i)
+		{
+			const ndLeftHandSide* const row_i = &m_leftHandSide[island.m_rows[i]];
+			const ndRightHandSide* const rhs_i = &m_rightHandSide[island.m_rows[i]];
+			const ndJacobian& JMinvM0 = row_i->m_JMinv.m_jacobianM0;
+			const ndJacobian& JMinvM1 = row_i->m_JMinv.m_jacobianM1;
+			const ndVector element(
+				JMinvM0.m_linear * row_i->m_Jt.m_jacobianM0.m_linear + JMinvM0.m_angular * row_i->m_Jt.m_jacobianM0.m_angular +
+				JMinvM1.m_linear * row_i->m_Jt.m_jacobianM1.m_linear + JMinvM1.m_angular * row_i->m_Jt.m_jacobianM1.m_angular);
+
+			// same diagonal as the iterative solver, so that both solve the same system
+			ndFloat32* const matrixRow = &matrix[size * i];
+			matrixRow[i] = element.AddHorizontal().GetScalar() + rhs_i->m_diagDamp;
+			diagDamp[i] = matrixRow[i] * ndFloat32(4.0e-3f);
+
+			const ndInt32 m0_i = island.m_bodies[i * 2 + 0];
+			const ndInt32 m1_i = island.m_bodies[i * 2 + 1];
+			tempArray[1] = JMinvM0;
+			tempArray[2] = JMinvM1;
+			for (ndInt32 j = i + 1; j < size; ++j)
+			{
+				const ndLeftHandSide* const row_j = &m_leftHandSide[island.m_rows[j]];
+				const ndInt32 m0_j = island.m_bodies[j * 2 + 0];
+				const ndInt32 m1_j = island.m_bodies[j * 2 + 1];
+
+				const ndInt32 index_m0_j = (-(m0_j == m0_i) & 1) | (-(m0_j == m1_i) & 2);
+				const ndInt32 index_m1_j = (-(m1_j == m0_i) & 1) | (-(m1_j == m1_i) & 2);
+
+				ndVector acc(row_j->m_Jt.m_jacobianM0.m_linear * tempArray[index_m0_j].m_linear);
+				acc = acc.MulAdd(row_j->m_Jt.m_jacobianM0.m_angular, tempArray[index_m0_j].m_angular);
+				acc = acc.MulAdd(row_j->m_Jt.m_jacobianM1.m_linear, tempArray[index_m1_j].m_linear);
+				acc = acc.MulAdd(row_j->m_Jt.m_jacobianM1.m_angular, tempArray[index_m1_j].m_angular);
+
+				const ndFloat32 offDiagValue = acc.AddHorizontal().GetScalar();
+				matrixRow[j] = offDiagValue;
+				matrix[j * size + i] = offDiagValue;
+			}
+		}
+
+		island.m_blockSize = blockSize;
+		ndSkeletonContainer::FactorizeBlockMatrix(size, blockSize, matrix, diagDamp);
+	};
+	scene->ParallelFor(0, m_directIslandCount, 1, FactorizeIsland);
+}
+
+void ndDynamicsUpdate::SolveDirectIslands()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
+
+	auto SolveDirectIsland = [this, &bodyArray](ndInt32, ndInt32 islandIndex)
+	{
+		const ndDirectIsland& island = m_directIslands[islandIndex];
+		const ndInt32 size = island.m_rowCount;
+		ndFloat32* const b = ndAlloca(ndFloat32, size);
+		ndFloat32* const x = ndAlloca(ndFloat32, size + 1);
+		ndFloat32* const x0 = ndAlloca(ndFloat32, size + 1);
+		ndJacobian* const internalForces = &m_internalForces[0];
+
+		// solve for the change of the forces, starting from the current ones
+		for (ndInt32 i = 0; i < size; ++i)
+		{
+			const ndLeftHandSide* const row = &m_leftHandSide[island.m_rows[i]];
+			const ndRightHandSide* const rhs = &m_rightHandSide[island.m_rows[i]];
+			const ndJacobian& y0 = internalForces[island.m_bodies[i * 2 + 0]];
+			const ndJacobian& y1 = internalForces[island.m_bodies[i * 2 + 1]];
+
+			const ndVector acc(
+				row->m_JMinv.m_jacobianM0.m_linear * y0.m_linear + row->m_JMinv.m_jacobianM0.m_angular * y0.m_angular +
+				row->m_JMinv.m_jacobianM1.m_linear * y1.m_linear + row->m_JMinv.m_jacobianM1.m_angular * y1.m_angular);
+			b[i] = rhs->m_coordenateAccel - rhs->m_force * rhs->m_diagDamp - acc.AddHorizontal().GetScalar();
+
+			x0[i] = rhs->m_force;
+		}
+		x[size] = ndFloat32(1.0f);
+		x0[size] = ndFloat32(0.0f);
+		ndSkeletonContainer::SolveBlockLcp(size, island.m_blockSize, island.m_matrix, x0, x, b, island.m_low, island.m_high, island.m_normalIndex, D_DIRECT_SOLVER_ACCEL_TOL);
+
+		for (ndInt32 i = 0; i < size; ++i)
+		{
+			const ndLeftHandSide* const row = &m_leftHandSide[island.m_rows[i]];
+			ndRightHandSide* const rhs = &m_rightHandSide[island.m_rows[i]];
+			rhs->m_force = x0[i] + x[i];
+
+			const ndVector deltaForce(x[i]);
+			const ndInt32 m0 = island.m_bodies[i * 2 + 0];
+			const ndInt32 m1 = island.m_bodies[i * 2 + 1];
+			if (!bodyArray[m0]->m_isStatic)
+			{
+				internalForces[m0].m_linear = internalForces[m0].m_linear.MulAdd(row->m_Jt.m_jacobianM0.m_linear, deltaForce);
+				internalForces[m0].m_angular = internalForces[m0].m_angular.MulAdd(row->m_Jt.m_jacobianM0.m_angular, deltaForce);
+			}
+			if (!bodyArray[m1]->m_isStatic)
+			{
+				internalForces[m1].m_linear = internalForces[m1].m_linear.MulAdd(row->m_Jt.m_jacobianM1.m_linear, deltaForce);
+				internalForces[m1].m_angular = internalForces[m1].m_angular.MulAdd(row->m_Jt.m_jacobianM1.m_angular, deltaForce);
+			}
+		}
+	};
+
+	if (m_directIslandCount)
+	{
+		scene->ParallelFor(0, m_directIslandCount, 1, SolveDirectIsland);
+	}
+}
+
 void ndDynamicsUpdate::CalculateJointsForce()
 {
 	D_TRACKTIME();
@@ -1226,37 +1543,77 @@ void ndDynamicsUpdate::CalculateJointsForce()
 	ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
 	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
 
-	auto CalculateJointsForce = ndMakeObject::ndFunction([this, &jointArray](ndInt32 threadIndex, ndInt32 threadCount)
+	auto CalculateJointsForce = [this, &jointArray](ndInt32, ndInt32 jointIndex)
 	{
-		D_TRACKTIME_NAMED(CalculateJointsForce);
-		const ndInt32 jointCount = jointArray.GetCount();
 		ndJacobian* const jointPartialForces = &GetTempInternalForces()[0];
+		ndConstraint* const joint = jointArray[jointIndex];
+		const ndVector zero(ndVector::m_zero);
+		ndVector accNorm(zero);
+		ndBodyKinematic* const body0 = joint->GetBody0();
+		ndBodyKinematic* const body1 = joint->GetBody1();
+		ndAssert(body0);
+		ndAssert(body1);
 
-		auto JointForce = [this, &jointPartialForces](ndConstraint* const joint, ndInt32 jointIndex)
+		const ndInt32 m0 = body0->m_index;
+		const ndInt32 m1 = body1->m_index;
+		const ndInt32 rowStart = joint->m_rowStart;
+		const ndInt32 rowsCount = joint->m_rowCount;
+
+		ndFloat32 residual = ndFloat32(0.0f);
+		const ndInt32 resting = body0->m_equilibrium0 & body1->m_equilibrium0;
+		const ndInt32 converged = m_islands[m_jointIsland[jointIndex]].m_converged;
+		if (!(resting | converged | joint->m_isInDirectIsland))
 		{
-			const ndVector zero(ndVector::m_zero);
-			ndVector accNorm(zero);
-			ndBodyKinematic* const body0 = joint->GetBody0();
-			ndBodyKinematic* const body1 = joint->GetBody1();
-			ndAssert(body0);
-			ndAssert(body1);
+			const ndVector preconditioner0(body0->m_weigh);
+			const ndVector preconditioner1(body1->m_weigh);
 
-			const ndInt32 m0 = body0->m_index;
-			const ndInt32 m1 = body1->m_index;
-			const ndInt32 rowStart = joint->m_rowStart;
-			const ndInt32 rowsCount = joint->m_rowCount;
+			ndVector forceM0(m_internalForces[m0].m_linear);
+			ndVector torqueM0(m_internalForces[m0].m_angular);
+			ndVector forceM1(m_internalForces[m1].m_linear);
+			ndVector torqueM1(m_internalForces[m1].m_angular);
 
-			const ndInt32 resting = body0->m_equilibrium0 & body1->m_equilibrium0;
-			if (!resting)
+			for (ndInt32 j = 0; j < rowsCount; ++j)
 			{
-				const ndVector preconditioner0(body0->m_weigh);
-				const ndVector preconditioner1(body1->m_weigh);
+				ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
+				const ndLeftHandSide* const lhs = &m_leftHandSide[rowStart + j];
+				const ndVector force(rhs->m_force);
+
+				ndVector a(lhs->m_JMinv.m_jacobianM0.m_linear * forceM0);
+				a = a.MulAdd(lhs->m_JMinv.m_jacobianM0.m_angular, torqueM0);
+				a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_linear, forceM1);
+				a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_angular, torqueM1);
+				a = ndVector(rhs->m_coordenateAccel - rhs->m_force * rhs->m_diagDamp) - a.AddHorizontal();
+
+				ndAssert(rhs->m_normalForceIndexFlat >= 0);
+				ndVector f(force + a.Scale(rhs->m_invJinvMJt));
+				const ndInt32 frictionIndex = rhs->m_normalForceIndexFlat;
+				const ndFloat32 frictionNormal = m_rightHandSide[frictionIndex].m_force;
+				const ndVector lowerFrictionForce(frictionNormal * rhs->m_lowerBoundFrictionCoefficent);
+				const ndVector upperFrictionForce(frictionNormal * rhs->m_upperBoundFrictionCoefficent);
+
+				a = a & (f < upperFrictionForce) & (f > lowerFrictionForce);
+				accNorm = accNorm.MulAdd(a, a);
+
+				f = f.GetMax(lowerFrictionForce).GetMin(upperFrictionForce);
+				rhs->m_force = f.GetScalar();
+
+				const ndVector deltaForce(f - force);
+				const ndVector deltaForce0(deltaForce * preconditioner0);
+				const ndVector deltaForce1(deltaForce * preconditioner1);
+				forceM0 = forceM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_linear, deltaForce0);
+				torqueM0 = torqueM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_angular, deltaForce0);
+				forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, deltaForce1);
+				torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, deltaForce1);
+			}
 
-				ndVector forceM0(m_internalForces[m0].m_linear);
-				ndVector torqueM0(m_internalForces[m0].m_angular);
-				ndVector forceM1(m_internalForces[m1].m_linear);
-				ndVector torqueM1(m_internalForces[m1].m_angular);
+			const ndFloat32 tol = ndFloat32(0.125f);
+			const ndFloat32 tol2 = tol * tol;
 
+			residual = accNorm.GetScalar();
+			ndVector maxAccel(accNorm);
+			for (ndInt32 k = 0; (k < 4) && (maxAccel.GetScalar() > tol2); ++k)
+			{
+				maxAccel = zero;
 				for (ndInt32 j = 0; j < rowsCount; ++j)
 				{
 					ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
@@ -1269,15 +1626,16 @@ void ndDynamicsUpdate::CalculateJointsForce()
 					a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_angular, torqueM1);
 					a = ndVector(rhs->m_coordenateAccel - rhs->m_force * rhs->m_diagDamp) - a.AddHorizontal();
 
-					ndAssert(rhs->m_normalForceIndexFlat >= 0);
 					ndVector f(force + a.Scale(rhs->m_invJinvMJt));
+					ndAssert(rhs->m_normalForceIndexFlat >= 0);
 					const ndInt32 frictionIndex = rhs->m_normalForceIndexFlat;
 					const ndFloat32 frictionNormal = m_rightHandSide[frictionIndex].m_force;
+
 					const ndVector lowerFrictionForce(frictionNormal * rhs->m_lowerBoundFrictionCoefficent);
 					const ndVector upperFrictionForce(frictionNormal * rhs->m_upperBoundFrictionCoefficent);
 
 					a = a & (f < upperFrictionForce) & (f > lowerFrictionForce);
-					accNorm = accNorm.MulAdd(a, a);
+					maxAccel = maxAccel.MulAdd(a, a);
 
 					f = f.GetMax(lowerFrictionForce).GetMin(upperFrictionForce);
 					rhs->m_force = f.GetScalar();
@@ -1290,86 +1648,38 @@ void ndDynamicsUpdate::CalculateJointsForce()
 					forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, deltaForce1);
 					torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, deltaForce1);
 				}
-
-				const ndFloat32 tol = ndFloat32(0.125f);
-				const ndFloat32 tol2 = tol * tol;
-
-				ndVector maxAccel(accNorm);
-				for (ndInt32 k = 0; (k < 4) && (maxAccel.GetScalar() > tol2); ++k)
-				{
-					maxAccel = zero;
-					for (ndInt32 j = 0; j < rowsCount; ++j)
-					{
-						ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
-						const ndLeftHandSide* const lhs = &m_leftHandSide[rowStart + j];
-						const ndVector force(rhs->m_force);
-
-						ndVector a(lhs->m_JMinv.m_jacobianM0.m_linear * forceM0);
-						a = a.MulAdd(lhs->m_JMinv.m_jacobianM0.m_angular, torqueM0);
-						a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_linear, forceM1);
-						a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_angular, torqueM1);
-						a = ndVector(rhs->m_coordenateAccel - rhs->m_force * rhs->m_diagDamp) - a.AddHorizontal();
-
-						ndVector f(force + a.Scale(rhs->m_invJinvMJt));
-						ndAssert(rhs->m_normalForceIndexFlat >= 0);
-						const ndInt32 frictionIndex = rhs->m_normalForceIndexFlat;
-						const ndFloat32 frictionNormal = m_rightHandSide[frictionIndex].m_force;
-
-						const ndVector lowerFrictionForce(frictionNormal * rhs->m_lowerBoundFrictionCoefficent);
-						const ndVector upperFrictionForce(frictionNormal * rhs->m_upperBoundFrictionCoefficent);
-
-						a = a & (f < upperFrictionForce) & (f > lowerFrictionForce);
-						maxAccel = maxAccel.MulAdd(a, a);
-
-						f = f.GetMax(lowerFrictionForce).GetMin(upperFrictionForce);
-						rhs->m_force = f.GetScalar();
-
-						const ndVector deltaForce(f - force);
-						const ndVector deltaForce0(deltaForce * preconditioner0);
-						const ndVector deltaForce1(deltaForce * preconditioner1);
-						forceM0 = forceM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_linear, deltaForce0);
-						torqueM0 = torqueM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_angular, deltaForce0);
-						forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, deltaForce1);
-						torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, deltaForce1);
-					}
-				}
 			}
+		}
 
-			ndVector forceM0(zero);
-			ndVector torqueM0(zero);
-			ndVector forceM1(zero);
-			ndVector torqueM1(zero);
-
-			for (ndInt32 j = 0; j < rowsCount; ++j)
-			{
-				ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
-				const ndLeftHandSide* const lhs = &m_leftHandSide[rowStart + j];
-
-				const ndVector f(rhs->m_force);
-				forceM0 = forceM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_linear, f);
-				torqueM0 = torqueM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_angular, f);
-				forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, f);
-				torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, f);
-				rhs->m_maxImpact = ndMax(ndAbs(f.GetScalar()), rhs->m_maxImpact);
-			}
-
-			const ndInt32 index0 = jointIndex * 2 + 0;
-			ndJacobian& outBody0 = jointPartialForces[index0];
-			outBody0.m_linear = forceM0;
-			outBody0.m_angular = torqueM0;
-
-			const ndInt32 index1 = jointIndex * 2 + 1;
-			ndJacobian& outBody1 = jointPartialForces[index1];
-			outBody1.m_linear = forceM1;
-			outBody1.m_angular = torqueM1;
-		};
+		ndVector forceM0(zero);
+		ndVector torqueM0(zero);
+		ndVector forceM1(zero);
+		ndVector torqueM1(zero);
 
-		for (ndInt32 i = threadIndex; i < jointCount; i += threadCount)
+		for (ndInt32 j = 0; j < rowsCount; ++j)
 		{
-			ndConstraint* const joint = jointArray[i];
-			JointForce(joint, i);
+			ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
+			const ndLeftHandSide* const lhs = &m_leftHandSide[rowStart + j];
+
+			const ndVector f(rhs->m_force);
+			forceM0 = forceM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_linear, f);
+			torqueM0 = torqueM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_angular, f);
+			forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, f);
+			torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, f);
+			rhs->m_maxImpact = ndMax(ndAbs(f.GetScalar()), rhs->m_maxImpact);
 		}
-	});
+
+		const ndInt32 index0 = jointIndex * 2 + 0;
+		ndJacobian& outBody0 = jointPartialForces[index0];
+		outBody0.m_linear = forceM0;
+		outBody0.m_angular = torqueM0;
+
+		const ndInt32 index1 = jointIndex * 2 + 1;
+		ndJacobian& outBody1 = jointPartialForces[index1];
+		outBody1.m_linear = forceM1;
+		outBody1.m_angular = torqueM1;
+		m_jointResidual[jointIndex] = residual;
+	};
 
 	auto ApplyJacobianAccumulatePartialForces = ndMakeObject::ndFunction([this, &bodyArray](ndInt32 threadIndex, ndInt32 threadCount)
 	{
@@ -1403,10 +1713,46 @@ void ndDynamicsUpdate::CalculateJointsForce()
 		}
 	});
 
-	for (ndInt32 i = 0; i < ndInt32(passes); ++i)
+	// an island stops when the joints residual drops below the tolerance, or it runs out of passes.
+	ndInt32 pass = 0;
+	ndAtomic<ndInt32> activeIslands(0);
+	auto UpdateIslands = [this, &pass, &activeIslands](ndInt32, ndInt32 islandIndex)
+	{
+		ndIsland& island = m_islands[islandIndex];
+		if (!island.m_converged)
+		{
+			ndFloat32 residual = ndFloat32(0.0f);
+			const ndInt32* const joints = &m_islandJoints[island.m_start];
+			for (ndInt32 j = 0; j < island.m_count; ++j)
+			{
+				residual = ndMax(residual, m_jointResidual[joints[j]]);
+			}
+			island.m_passesUsed++;
+			island.m_converged = ndUnsigned8((residual < D_SOLVER_ISLAND_RESIDUAL2) || (pass + 1 >= island.m_passes));
+			if (!island.m_converged)
+			{
+				activeIslands.fetch_add(1);
+			}
+		}
+	};
+
+	for (ndInt32 i = 0; i < m_islands.GetCount(); ++i)
+	{
+		m_islands[i].m_converged = 0;
+	}
+
+	for (pass = 0; pass < ndInt32(passes); ++pass)
 	{
-		scene->ParallelExecute(CalculateJointsForce);
+		D_TRACKTIME_NAMED(CalculateJointsForce);
+		scene->ParallelFor(0, jointArray.GetCount(), D_SOLVER_JOINTS_GRAIN, CalculateJointsForce);
 		scene->ParallelExecute(ApplyJacobianAccumulatePartialForces);
+
+		activeIslands.store(0);
+		scene->ParallelFor(0, m_islands.GetCount(), D_SOLVER_ISLANDS_GRAIN, UpdateIslands);
+		if (!activeIslands.load())
+		{
+			break;
+		}
 	}
 }
 
@@ -1418,14 +1764,21 @@ void ndDynamicsUpdate::CalculateForces()
 		m_firstPassCoef = ndFloat32(0.0f);
 
 		InitSkeletons();
+		InitDirectIslands();
 		for (ndInt32 step = 0; step < 4; step++)
 		{
 			CalculateJointsAcceleration();
+			SolveDirectIslands();
 			CalculateJointsForce();
 			UpdateSkeletons();
 			IntegrateBodiesVelocity();
 		}
 		UpdateForceFeedback();
+
+		for (ndInt32 i = 0; i < m_islands.GetCount(); ++i)
+		{
+			m_updatePasses += ndUnsigned64(m_islands[i].m_passesUsed);
+		}
 	}
 }
 
@@ -1437,6 +1790,7 @@ void ndDynamicsUpdate::Update()
 	BuildIsland();
 	IntegrateUnconstrainedBodies();
 	InitWeights();
+	FindIslands();
 	InitBodyArray();
 	InitJacobianMatrix();
 	CalculateForces();
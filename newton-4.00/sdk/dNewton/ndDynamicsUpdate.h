@@ -25,6 +25,7 @@
 #include "ndNewtonStdafx.h"
 
 #define D_MAX_BODY_RADIX_BIT		9
+#define D_MAX_DIRECT_SOLVER_ROWS	128
 
 // the solver is a RK order 4, but instead of weighting the intermediate derivative by the usual 1/6, 1/3, 1/3, 1/6 coefficients
 // I am using 1/4, 1/4, 1/4, 1/4.
@@ -58,21 +59,52 @@ class ndDynamicsUpdate : public ndClassAlloc
 		ndBodyKinematic* m_root;
 	};
 
+	// the joints connected by dynamic bodies, m_start and m_count 
+	// index the island joint array. m_passesUsed is the number of 
+	// solver passes the island took, added over the four solver steps.
 	class ndIsland
 	{
 		public:
 		ndIsland(ndBodyKinematic* const root)
 			:m_start(0)
-			, m_count(0)
-			, m_root(root)
+			,m_count(0)
+			,m_rowCount(0)
+			,m_passes(0)
+			,m_passesUsed(0)
+			,m_resting(1)
+			,m_converged(0)
+			,m_hasSkeleton(0)
+			,m_root(root)
 		{
 		}
 
 		ndInt32 m_start;
 		ndInt32 m_count;
+		ndInt32 m_rowCount;
+		ndInt32 m_passes;
+		ndInt32 m_passesUsed;
+		ndUnsigned8 m_resting;
+		ndUnsigned8 m_converged;
+		ndUnsigned8 m_hasSkeleton;
 		ndBodyKinematic* m_root;
 	};
 
+	// a small island solved with a dense lcp, rows are flat indices 
+	// in the right hand side, the unbounded rows go first.
+	class ndDirectIsland
+	{
+		public:
+		ndFloat32* m_matrix;
+		ndFloat32* m_low;
+		ndFloat32* m_high;
+		ndInt32* m_rows;
+		ndInt32* m_bodies;
+		ndInt32* m_normalIndex;
+		ndInt32 m_island;
+		ndInt32 m_rowCount;
+		ndInt32 m_blockSize;
+	};
+
 	public:
 	ndDynamicsUpdate(ndWorld* const world);
 	virtual ~ndDynamicsUpdate();
@@ -91,13 +123,16 @@ class ndDynamicsUpdate : public ndClassAlloc
 	ndArray<ndBodyKinematic*>& GetBodyIslandOrder();
 	ndArray<ndJointBodyPairIndex>& GetJointBodyPairIndexBuffer();
 
-	private:
+	protected:
 	void SortJoints();
 	void SortIslands();
 	void BuildIsland();
+	void FindIslands();
 	void InitWeights();
 	void InitBodyArray();
 	void InitSkeletons();
+	void InitDirectIslands();
+	void SolveDirectIslands();
 	void CalculateForces();
 	void IntegrateBodies();
 	void UpdateSkeletons();
@@ -111,7 +146,6 @@ class ndDynamicsUpdate : public ndClassAlloc
 	void DetermineSleepStates();
 	void GetJacobianDerivatives(ndConstraint* const joint);
 
-	protected:
 	void Clear();
 	virtual void Update();
 	void SortJointsScan();
@@ -128,6 +162,12 @@ class ndDynamicsUpdate : public ndClassAlloc
 	ndArray<ndBodyKinematic*> m_bodyIslandOrder;
 	ndArray<ndJointBodyPairIndex> m_jointBodyPairIndexBuffer;
 
+	ndInt32* m_jointIsland;
+	ndInt32* m_islandJoints;
+	ndFloat32* m_jointResidual;
+	ndDirectIsland* m_directIslands;
+	ndInt32 m_directIslandCount;
+
 	ndWorld* m_world;
 	ndFloat32 m_timestep;
 	ndFloat32 m_invTimestep;
@@ -136,6 +176,9 @@ class ndDynamicsUpdate : public ndClassAlloc
 	ndFloat32 m_timestepRK;
 	ndFloat32 m_invTimestepRK;
 	ndUnsigned32 m_solverPasses;
+	// the passes of all the sub steps of the world update, summed over the islands, 
+	// the solvers without islands count each pass over all the joints once.
+	ndUnsigned64 m_updatePasses;
 	ndInt32 m_activeJointCount;
 	ndInt32 m_unConstrainedBodyCount;
 
@@ -0,0 +1,376 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndNewtonStdafx.h"
+#include "ndWorld.h"
+#include "ndBodyDynamic.h"
+#include "ndSkeletonList.h"
+#include "ndDynamicsUpdateGaussSeidel.h"
+#include "ndJointBilateralConstraint.h"
+
+#define D_GAUSS_SEIDEL_JOINTS_GRAIN	16
+
+ndDynamicsUpdateGaussSeidel::ndDynamicsUpdateGaussSeidel(ndWorld* const world)
+	:ndDynamicsUpdate(world)
+	,m_colorJoints(nullptr)
+{
+	ndMemSet(m_colorStart, 0, ndInt32(sizeof(m_colorStart) / sizeof(m_colorStart[0])));
+}
+
+ndDynamicsUpdateGaussSeidel::~ndDynamicsUpdateGaussSeidel()
+{
+	Clear();
+}
+
+const char* ndDynamicsUpdateGaussSeidel::GetStringId() const
+{
+	return "gauss seidel";
+}
+
+void ndDynamicsUpdateGaussSeidel::InitWeights()
+{
+	D_TRACKTIME();
+	ndDynamicsUpdate::InitWeights();
+
+	ndScene* const scene = m_world->GetScene();
+	if (scene->GetActiveContactArray().GetCount())
+	{
+		m_solverPasses = ndUnsigned32(m_world->GetSolverIterations() + 2);
+	}
+}
+
+void ndDynamicsUpdateGaussSeidel::InitJacobianMatrix()
+{
+	D_TRACKTIME();
+	// the Jacobi weights are not needed, each joint sees the forces 
+	// of the joints solved before it. the weights are put back after, 
+	// since the sleep test reads them as the body joint count.
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
+	const ndInt32 bodyCount = bodyArray.GetCount();
+	ndFloat32* const weighs = scene->GetFrameArena().Alloc<ndFloat32>(bodyCount);
+	for (ndInt32 i = 0; i < bodyCount; ++i)
+	{
+		weighs[i] = bodyArray[i]->m_weigh;
+		bodyArray[i]->m_weigh = ndFloat32(1.0f);
+	}
+
+	ndDynamicsUpdate::InitJacobianMatrix();
+
+	for (ndInt32 i = 0; i < bodyCount; ++i)
+	{
+		bodyArray[i]->m_weigh = weighs[i];
+	}
+}
+
+void ndDynamicsUpdateGaussSeidel::ColorJoints()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	const ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
+	const ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+	const ndInt32 bodyCount = bodyArray.GetCount();
+	const ndInt32 jointCount = jointArray.GetCount();
+
+	// the color masks and the color lists only live for this step
+	ndFrameArena& arena = scene->GetFrameArena();
+	ndUnsigned64* const bodyColors = arena.Alloc<ndUnsigned64>(bodyCount);
+	ndInt8* const jointColors = arena.Alloc<ndInt8>(jointCount);
+	m_colorJoints = arena.Alloc<ndInt32>(jointCount);
+	ndMemSet(bodyColors, ndUnsigned64(0), bodyCount);
+
+	// greedy coloring in joint order, static bodies do not take colors 
+	// because the solver never writes their forces.
+	ndInt32 histogram[D_GAUSS_SEIDEL_MAX_COLORS + 1];
+	ndMemSet(histogram, 0, D_GAUSS_SEIDEL_MAX_COLORS + 1);
+	for (ndInt32 i = 0; i < jointCount; ++i)
+	{
+		const ndConstraint* const joint = jointArray[i];
+		const ndBodyKinematic* const body0 = joint->GetBody0();
+		const ndBodyKinematic* const body1 = joint->GetBody1();
+		const ndUnsigned64 mask0 = body0->m_isStatic ? ndUnsigned64(0) : bodyColors[body0->m_index];
+		const ndUnsigned64 mask1 = body1->m_isStatic ? ndUnsigned64(0) : bodyColors[body1->m_index];
+		const ndUnsigned64 usedColors = mask0 | mask1;
+
+		ndInt32 color = 0;
+		for (; (color < D_GAUSS_SEIDEL_MAX_COLORS) && (usedColors & (ndUnsigned64(1) << color)); ++color);
+		if (color < D_GAUSS_SEIDEL_MAX_COLORS)
+		{
+			const ndUnsigned64 bit = ndUnsigned64(1) << color;
+			if (!body0->m_isStatic)
+			{
+				bodyColors[body0->m_index] |= bit;
+			}
+			if (!body1->m_isStatic)
+			{
+				bodyColors[body1->m_index] |= bit;
+			}
+		}
+		jointColors[i] = ndInt8(color);
+		histogram[color]++;
+	}
+
+	// the last color is the overflow for bodies with too many joints
+	m_colorStart[0] = 0;
+	for (ndInt32 i = 0; i <= D_GAUSS_SEIDEL_MAX_COLORS; ++i)
+	{
+		m_colorStart[i + 1] = m_colorStart[i] + histogram[i];
+		histogram[i] = m_colorStart[i];
+	}
+	for (ndInt32 i = 0; i < jointCount; ++i)
+	{
+		const ndInt32 color = jointColors[i];
+		m_colorJoints[histogram[color]] = i;
+		histogram[color]++;
+	}
+}
+
+void ndDynamicsUpdateGaussSeidel::CalculateInternalForces()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	ndArray<ndBodyKinematic*>& bodyArray = scene->GetActiveBodyArray();
+	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+
+	auto CalculatePartialForces = [this, &jointArray](ndInt32, ndInt32 jointIndex)
+	{
+		ndJacobian* const jointPartialForces = &GetTempInternalForces()[0];
+		const ndConstraint* const joint = jointArray[jointIndex];
+		const ndInt32 rowStart = joint->m_rowStart;
+		const ndInt32 rowsCount = joint->m_rowCount;
+
+		ndVector forceM0(ndVector::m_zero);
+		ndVector torqueM0(ndVector::m_zero);
+		ndVector forceM1(ndVector::m_zero);
+		ndVector torqueM1(ndVector::m_zero);
+		for (ndInt32 j = 0; j < rowsCount; ++j)
+		{
+			const ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
+			const ndLeftHandSide* const lhs = &m_leftHandSide[rowStart + j];
+			const ndVector f(rhs->m_force);
+			forceM0 = forceM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_linear, f);
+			torqueM0 = torqueM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_angular, f);
+			forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, f);
+			torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, f);
+		}
+
+		ndJacobian& outBody0 = jointPartialForces[jointIndex * 2 + 0];
+		outBody0.m_linear = forceM0;
+		outBody0.m_angular = torqueM0;
+
+		ndJacobian& outBody1 = jointPartialForces[jointIndex * 2 + 1];
+		outBody1.m_linear = forceM1;
+		outBody1.m_angular = torqueM1;
+	};
+
+	auto AccumulatePartialForces = ndMakeObject::ndFunction([this, &bodyArray](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(AccumulatePartialForces);
+		const ndVector zero(ndVector::m_zero);
+		ndJacobian* const internalForces = &GetInternalForces()[0];
+		const ndInt32* const bodyIndex = &GetJointForceIndexBuffer()[0];
+		const ndJacobian* const jointInternalForces = &GetTempInternalForces()[0];
+		const ndJointBodyPairIndex* const jointBodyPairIndexBuffer = &GetJointBodyPairIndexBuffer()[0];
+
+		const ndStartEnd startEnd(bodyArray.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			ndVector force(zero);
+			ndVector torque(zero);
+			const ndBodyKinematic* const body = bodyArray[i];
+
+			const ndInt32 startIndex = bodyIndex[i];
+			const ndInt32 mask = body->m_isStatic - 1;
+			const ndInt32 count = mask & (bodyIndex[i + 1] - startIndex);
+			for (ndInt32 j = 0; j < count; ++j)
+			{
+				const ndInt32 index = jointBodyPairIndexBuffer[startIndex + j].m_joint;
+				force += jointInternalForces[index].m_linear;
+				torque += jointInternalForces[index].m_angular;
+			}
+			internalForces[i].m_linear = force;
+			internalForces[i].m_angular = torque;
+		}
+	});
+
+	scene->ParallelFor(0, jointArray.GetCount(), D_GAUSS_SEIDEL_JOINTS_GRAIN, CalculatePartialForces);
+	scene->ParallelExecute(AccumulatePartialForces);
+}
+
+void ndDynamicsUpdateGaussSeidel::CalculateJointsForce()
+{
+	D_TRACKTIME();
+	ndScene* const scene = m_world->GetScene();
+	ndArray<ndConstraint*>& jointArray = scene->GetActiveContactArray();
+
+	// the skeletons overwrite the forces of their bodies, 
+	// so the body forces are rebuilt from the joint forces.
+	CalculateInternalForces();
+
+	auto CalculateJointForce = [this, &jointArray](ndInt32, ndInt32 colorIndex)
+	{
+		const ndInt32 jointIndex = m_colorJoints[colorIndex];
+		ndConstraint* const joint = jointArray[jointIndex];
+		const ndVector zero(ndVector::m_zero);
+		ndBodyKinematic* const body0 = joint->GetBody0();
+		ndBodyKinematic* const body1 = joint->GetBody1();
+		ndAssert(body0);
+		ndAssert(body1);
+
+		const ndInt32 m0 = body0->m_index;
+		const ndInt32 m1 = body1->m_index;
+		const ndInt32 rowStart = joint->m_rowStart;
+		const ndInt32 rowsCount = joint->m_rowCount;
+
+		const ndInt32 resting = body0->m_equilibrium0 & body1->m_equilibrium0;
+		if (!(resting | joint->m_isInDirectIsland))
+		{
+			ndVector forceM0(m_internalForces[m0].m_linear);
+			ndVector torqueM0(m_internalForces[m0].m_angular);
+			ndVector forceM1(m_internalForces[m1].m_linear);
+			ndVector torqueM1(m_internalForces[m1].m_angular);
+
+			const ndFloat32 tol = ndFloat32(0.125f);
+			const ndFloat32 tol2 = tol * tol;
+			ndVector maxAccel(ndFloat32(1.0e10f));
+			for (ndInt32 k = 0; (k < 5) && (maxAccel.GetScalar() > tol2); ++k)
+			{
+				maxAccel = zero;
+				for (ndInt32 j = 0; j < rowsCount; ++j)
+				{
+					ndRightHandSide* const rhs = &m_rightHandSide[rowStart + j];
+					const ndLeftHandSide* const lhs = &m_leftHandSide[rowStart + j];
+					const ndVector force(rhs->m_force);
+
+					ndVector a(lhs->m_JMinv.m_jacobianM0.m_linear * forceM0);
+					a = a.MulAdd(lhs->m_JMinv.m_jacobianM0.m_angular, torqueM0);
+					a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_linear, forceM1);
+					a = a.MulAdd(lhs->m_JMinv.m_jacobianM1.m_angular, torqueM1);
+					a = ndVector(rhs->m_coordenateAccel - rhs->m_force * rhs->m_diagDamp) - a.AddHorizontal();
+
+					ndAssert(rhs->m_normalForceIndexFlat >= 0);
+					ndVector f(force + a.Scale(rhs->m_invJinvMJt));
+					const ndInt32 frictionIndex = rhs->m_normalForceIndexFlat;
+					const ndFloat32 frictionNormal = m_rightHandSide[frictionIndex].m_force;
+					const ndVector lowerFrictionForce(frictionNormal * rhs->m_lowerBoundFrictionCoefficent);
+					const ndVector upperFrictionForce(frictionNormal * rhs->m_upperBoundFrictionCoefficent);
+
+					a = a & (f < upperFrictionForce) & (f > lowerFrictionForce);
+					maxAccel = maxAccel.MulAdd(a, a);
+
+					f = f.GetMax(lowerFrictionForce).GetMin(upperFrictionForce);
+					rhs->m_force = f.GetScalar();
+					rhs->m_maxImpact = ndMax(ndAbs(rhs->m_force), rhs->m_maxImpact);
+
+					const ndVector deltaForce(f - force);
+					forceM0 = forceM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_linear, deltaForce);
+					torqueM0 = torqueM0.MulAdd(lhs->m_Jt.m_jacobianM0.m_angular, deltaForce);
+					forceM1 = forceM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_linear, deltaForce);
+					torqueM1 = torqueM1.MulAdd(lhs->m_Jt.m_jacobianM1.m_angular, deltaForce);
+				}
+			}
+
+			// no other joint of this color touches these bodies
+			if (!body0->m_isStatic)
+			{
+				m_internalForces[m0].m_linear = forceM0;
+				m_internalForces[m0].m_angular = torqueM0;
+			}
+			if (!body1->m_isStatic)
+			{
+				m_internalForces[m1].m_linear = forceM1;
+				m_internalForces[m1].m_angular = torqueM1;
+			}
+		}
+	};
+
+	const ndInt32 overflowStart = m_colorStart[D_GAUSS_SEIDEL_MAX_COLORS];
+	const ndInt32 overflowEnd = m_colorStart[D_GAUSS_SEIDEL_MAX_COLORS + 1];
+	for (ndInt32 i = 0; i < ndInt32(m_solverPasses); ++i)
+	{
+		D_TRACKTIME_NAMED(CalculateJointsForce);
+		for (ndInt32 j = 0; j < D_GAUSS_SEIDEL_MAX_COLORS; ++j)
+		{
+			const ndInt32 start = m_colorStart[j];
+			const ndInt32 end = m_colorStart[j + 1];
+			if (start == end)
+			{
+				break;
+			}
+			scene->ParallelFor(start, end, D_GAUSS_SEIDEL_JOINTS_GRAIN, CalculateJointForce);
+		}
+
+		for (ndInt32 j = overflowStart; j < overflowEnd; ++j)
+		{
+			CalculateJointForce(0, j);
+		}
+	}
+
+	// every island takes all the passes
+	for (ndInt32 i = 0; i < m_islands.GetCount(); ++i)
+	{
+		m_islands[i].m_passesUsed += ndInt32(m_solverPasses);
+	}
+}
+
+void ndDynamicsUpdateGaussSeidel::CalculateForces()
+{
+	D_TRACKTIME();
+	if (m_world->GetScene()->GetActiveContactArray().GetCount())
+	{
+		m_firstPassCoef = ndFloat32(0.0f);
+
+		InitSkeletons();
+		InitDirectIslands();
+		for (ndInt32 step = 0; step < 4; step++)
+		{
+			CalculateJointsAcceleration();
+			SolveDirectIslands();
+			CalculateJointsForce();
+			UpdateSkeletons();
+			IntegrateBodiesVelocity();
+		}
+		UpdateForceFeedback();
+
+		for (ndInt32 i = 0; i < m_islands.GetCount(); ++i)
+		{
+			m_updatePasses += ndUnsigned64(m_islands[i].m_passesUsed);
+		}
+	}
+}
+
+void ndDynamicsUpdateGaussSeidel::Update()
+{
+	D_TRACKTIME();
+	m_timestep = m_world->GetScene()->GetTimestep();
+
+	BuildIsland();
+	IntegrateUnconstrainedBodies();
+	InitWeights();
+	FindIslands();
+	ColorJoints();
+	InitBodyArray();
+	InitJacobianMatrix();
+	CalculateForces();
+	IntegrateBodies();
+	DetermineSleepStates();
+}
@@ -0,0 +1,62 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef __ND_WORLD_DYNAMICS_UPDATE_GAUSS_SEIDEL_H__
+#define __ND_WORLD_DYNAMICS_UPDATE_GAUSS_SEIDEL_H__
+
+#include "ndNewtonStdafx.h"
+#include "ndDynamicsUpdate.h"
+
+#define D_GAUSS_SEIDEL_MAX_COLORS	64
+
+// the joints are partitioned in colors, so that no two joints of the same color 
+// share a dynamic body. joints of one color are solved in parallel, and each joint 
+// reads the body forces written by the colors before it. this is a Gauss Seidel 
+// iteration, it converges in fewer passes than the Jacobi iteration of the base 
+// solver, and does not need the body weights to keep the iteration stable.
+// the few joints that do not fit in the colors are solved serially at the end.
+D_MSV_NEWTON_ALIGN_32
+class ndDynamicsUpdateGaussSeidel: public ndDynamicsUpdate
+{
+	public:
+	ndDynamicsUpdateGaussSeidel(ndWorld* const world);
+	virtual ~ndDynamicsUpdateGaussSeidel();
+
+	virtual const char* GetStringId() const;
+
+	protected:
+	virtual void Update();
+
+	private:
+	void ColorJoints();
+	void InitWeights();
+	void InitJacobianMatrix();
+	void CalculateForces();
+	void CalculateJointsForce();
+	void CalculateInternalForces();
+
+	ndInt32* m_colorJoints;
+	ndInt32 m_colorStart[D_GAUSS_SEIDEL_MAX_COLORS + 2];
+} D_GCC_NEWTON_ALIGN_32;
+
+#endif
+
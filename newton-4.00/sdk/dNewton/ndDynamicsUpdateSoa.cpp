@@ -1634,6 +1634,7 @@ void ndDynamicsUpdateSoa::CalculateForces()
 		{
 			CalculateJointsAcceleration();
 			CalculateJointsForce();
+			m_updatePasses += m_solverPasses;
 			UpdateSkeletons();
 			IntegrateBodiesVelocity();
 		}
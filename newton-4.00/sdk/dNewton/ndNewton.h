@@ -35,6 +35,8 @@
 #include <ndJointGear.h>
 #include <ndJointList.h>
 #include <ndWorldScene.h>
+#include <ndWorldGroup.h>
+#include <ndWorldSnapshot.h>
 #include <ndConstraint.h>
 #include <ndJointHinge.h>
 #include <ndJointPlane.h>
@@ -64,6 +66,7 @@
 #include <ndModelArticulation.h>
 #include <ndSkeletonContainer.h>
 #include <ndDynamicsUpdateSoa.h>
+#include <ndDynamicsUpdateGaussSeidel.h>
 #include <ndIkJointDoubleHinge.h>
 #include <ndMultiBodyVehicleMotor.h>
 #include <ndMultiBodyVehicleGearBox.h>
@@ -805,7 +805,7 @@ void ndSkeletonContainer::RebuildMassMatrix(const ndFloat32* const diagDamp) con
 	}
 }
 
-void ndSkeletonContainer::FactorizeMatrix(ndInt32 size, ndInt32 stride, ndFloat32* const matrix, ndFloat32* const diagDamp) const
+void ndSkeletonContainer::FactorizeMatrix(ndInt32 size, ndInt32 stride, ndFloat32* const matrix, ndFloat32* const diagDamp)
 {
 	D_TRACKTIME();
 	// save the matrix 
@@ -834,6 +834,83 @@ void ndSkeletonContainer::FactorizeMatrix(ndInt32 size, ndInt32 stride, ndFloat3
 	}
 }
 
+void ndSkeletonContainer::FactorizeBlockMatrix(ndInt32 size, ndInt32 blockSize, ndFloat32* const matrix, ndFloat32* const diagDamp)
+{
+	D_TRACKTIME();
+	if (!blockSize)
+	{
+		return;
+	}
+
+	FactorizeMatrix(blockSize, size, matrix, diagDamp);
+
+	ndInt32 rowStart = 0;
+	const ndInt32 boundedSize = size - blockSize;
+	ndFloat32* const acc = ndAlloca(ndFloat32, size);
+	for (ndInt32 i = 0; i < blockSize; ++i) 
+	{
+		ndMemSet(acc, ndFloat32(0.0f), boundedSize);
+		const ndFloat32* const row = &matrix[rowStart];
+		for (ndInt32 j = 0; j < i; ++j)  
+		{
+			const ndFloat32 s = row[j];
+			const ndFloat32* const x = &matrix[j * size + blockSize];
+			for (ndInt32 k = 0; k < boundedSize; ++k) 
+			{
+				acc[k] += s * x[k];
+			}
+		}
+
+		ndFloat32* const x = &matrix[rowStart + blockSize];
+		const ndFloat32 den = -ndFloat32(1.0f) / row[i];
+		for (ndInt32 j = 0; j < boundedSize; ++j)  
+		{
+			x[j] = (x[j] + acc[j]) * den;
+		}
+		rowStart += size;
+	}
+
+	for (ndInt32 i = blockSize - 1; i >= 0; i--) 
+	{
+		ndMemSet(acc, ndFloat32(0.0f), boundedSize);
+		for (ndInt32 j = i + 1; j < blockSize; ++j)  
+		{
+			const ndFloat32 s = matrix[j * size + i];
+			const ndFloat32* const x = &matrix[j * size + blockSize];
+			for (ndInt32 k = 0; k < boundedSize; ++k) 
+			{
+				acc[k] += s * x[k];
+			}
+		}
+
+		ndFloat32* const x = &matrix[i * size + blockSize];
+		const ndFloat32 den = ndFloat32(1.0f) / matrix[i * size + i];
+		for (ndInt32 j = 0; j < boundedSize; ++j)  
+		{
+			x[j] = (x[j] - acc[j]) * den;
+		}
+	}
+
+	for (ndInt32 i = 0; i < boundedSize; ++i) 
+	{
+		for (ndInt32 j = 0; j < blockSize; ++j)  
+		{
+			acc[j] = matrix[j * size + blockSize + i];
+		}
+
+		ndFloat32* const arow = &matrix[(blockSize + i) * size + blockSize];
+		for (ndInt32 j = i; j < boundedSize; ++j)  
+		{
+			const ndFloat32* const row1 = &matrix[(blockSize + j) * size];
+			ndFloat32 elem = row1[blockSize + i] + ndDotProduct(blockSize, acc, row1);
+			arow[j] = elem;
+			matrix[(blockSize + j) * size + blockSize + i] = elem;
+		}
+		arow[i] += diagDamp[blockSize + i];
+	}
+	ndAssert(ndTestPSDmatrix(size - blockSize, size, &matrix[size * blockSize + blockSize]));
+}
+
 void ndSkeletonContainer::InitLoopMassMatrix()
 {
 	CalculateBufferSizeInBytes();
@@ -948,76 +1025,7 @@ void ndSkeletonContainer::InitLoopMassMatrix()
 	ConditionMassMatrix();
 	RebuildMassMatrix(diagDamp);
 
-	if (m_blockSize) 
-	{
-		FactorizeMatrix(m_blockSize, m_auxiliaryRowCount, m_massMatrix11, diagDamp);
-
-		ndInt32 rowStart = 0;
-		const ndInt32 boundedSize = m_auxiliaryRowCount - m_blockSize;
-		ndFloat32* const acc = ndAlloca(ndFloat32, m_auxiliaryRowCount);
-		for (ndInt32 i = 0; i < m_blockSize; ++i) 
-		{
-			ndMemSet(acc, ndFloat32(0.0f), boundedSize);
-			const ndFloat32* const row = &m_massMatrix11[rowStart];
-			for (ndInt32 j = 0; j < i; ++j)  
-			{
-				const ndFloat32 s = row[j];
-				const ndFloat32* const x = &m_massMatrix11[j * m_auxiliaryRowCount + m_blockSize];
-				for (ndInt32 k = 0; k < boundedSize; ++k) 
-				{
-					acc[k] += s * x[k];
-				}
-			}
-
-			ndFloat32* const x = &m_massMatrix11[rowStart + m_blockSize];
-			const ndFloat32 den = -ndFloat32(1.0f) / row[i];
-			for (ndInt32 j = 0; j < boundedSize; ++j)  
-			{
-				x[j] = (x[j] + acc[j]) * den;
-			}
-			rowStart += m_auxiliaryRowCount;
-		}
-
-		for (ndInt32 i = m_blockSize - 1; i >= 0; i--) 
-		{
-			ndMemSet(acc, ndFloat32(0.0f), boundedSize);
-			for (ndInt32 j = i + 1; j < m_blockSize; ++j)  
-			{
-				const ndFloat32 s = m_massMatrix11[j * m_auxiliaryRowCount + i];
-				const ndFloat32* const x = &m_massMatrix11[j * m_auxiliaryRowCount + m_blockSize];
-				for (ndInt32 k = 0; k < boundedSize; ++k) 
-				{
-					acc[k] += s * x[k];
-				}
-			}
-
-			ndFloat32* const x = &m_massMatrix11[i * m_auxiliaryRowCount + m_blockSize];
-			const ndFloat32 den = ndFloat32(1.0f) / m_massMatrix11[i * m_auxiliaryRowCount + i];
-			for (ndInt32 j = 0; j < boundedSize; ++j)  
-			{
-				x[j] = (x[j] - acc[j]) * den;
-			}
-		}
-
-		for (ndInt32 i = 0; i < boundedSize; ++i) 
-		{
-			for (ndInt32 j = 0; j < m_blockSize; ++j)  
-			{
-				acc[j] = m_massMatrix11[j * m_auxiliaryRowCount + m_blockSize + i];
-			}
-
-			ndFloat32* const arow = &m_massMatrix11[(m_blockSize + i) * m_auxiliaryRowCount + m_blockSize];
-			for (ndInt32 j = i; j < boundedSize; ++j)  
-			{
-				const ndFloat32* const row1 = &m_massMatrix11[(m_blockSize + j) * m_auxiliaryRowCount];
-				ndFloat32 elem = row1[m_blockSize + i] + ndDotProduct(m_blockSize, acc, row1);
-				arow[j] = elem;
-				m_massMatrix11[(m_blockSize + j) * m_auxiliaryRowCount + m_blockSize + i] = elem;
-			}
-			arow[i] += diagDamp[m_blockSize + i];
-		}
-		ndAssert(ndTestPSDmatrix(m_auxiliaryRowCount - m_blockSize, m_auxiliaryRowCount, &m_massMatrix11[m_auxiliaryRowCount * m_blockSize + m_blockSize]));
-	}
+	FactorizeBlockMatrix(m_auxiliaryRowCount, m_blockSize, m_massMatrix11, diagDamp);
 }
 
 void ndSkeletonContainer::CalculateJointAccel(const ndJacobian* const internalForces, ndForcePair* const accel) const
@@ -1199,7 +1207,7 @@ void ndSkeletonContainer::SolveLcp0(ndInt32 stride, ndInt32 size, const ndFloat3
 }
 */
 
-void ndSkeletonContainer::SolveLcp(ndInt32 stride, ndInt32 size, const ndFloat32* const matrix, const ndFloat32* const x0, ndFloat32* const x, const ndFloat32* const b, const ndFloat32* const low, const ndFloat32* const high, const ndInt32* const normalIndex, ndFloat32 accelTol) const
+void ndSkeletonContainer::SolveLcp(ndInt32 stride, ndInt32 size, const ndFloat32* const matrix, const ndFloat32* const x0, ndFloat32* const x, const ndFloat32* const b, const ndFloat32* const low, const ndFloat32* const high, const ndInt32* const normalIndex, ndFloat32 accelTol)
 {
 	D_TRACKTIME();
 	const ndInt32 maxIterCount = 64;
@@ -1271,28 +1279,28 @@ void ndSkeletonContainer::SolveLcp(ndInt32 stride, ndInt32 size, const ndFloat32
 	}
 }
 
-void ndSkeletonContainer::SolveBlockLcp(ndInt32 size, ndInt32 blockSize, const ndFloat32* const x0, ndFloat32* const x, ndFloat32* const b, const ndFloat32* const low, const ndFloat32* const high, const ndInt32* const normalIndex, ndFloat32 accelTol) const
+void ndSkeletonContainer::SolveBlockLcp(ndInt32 size, ndInt32 blockSize, const ndFloat32* const matrix, const ndFloat32* const x0, ndFloat32* const x, ndFloat32* const b, const ndFloat32* const low, const ndFloat32* const high, const ndInt32* const normalIndex, ndFloat32 accelTol)
 {
 	if (blockSize) 
 	{
-		ndSolveCholesky(blockSize, size, m_massMatrix11, x, b);
+		ndSolveCholesky(blockSize, size, matrix, x, b);
 		if (blockSize != size) 
 		{
 			ndInt32 base = blockSize * size;
 			for (ndInt32 i = blockSize; i < size; ++i) 
 			{
-				b[i] -= ndDotProduct(blockSize, &m_massMatrix11[base], x);
+				b[i] -= ndDotProduct(blockSize, &matrix[base], x);
 				base += size;
 			}
 
 			const ndInt32 boundedSize = size - blockSize;
 			SolveLcp(
-				size, boundedSize, &m_massMatrix11[blockSize * size + blockSize],
+				size, boundedSize, &matrix[blockSize * size + blockSize],
 				&x0[blockSize], &x[blockSize], &b[blockSize], &low[blockSize], &high[blockSize], &normalIndex[blockSize], accelTol);
 
 			for (ndInt32 j = 0; j < blockSize; ++j)  
 			{
-				const ndFloat32* const row = &m_massMatrix11[j * size + blockSize];
+				const ndFloat32* const row = &matrix[j * size + blockSize];
 				ndFloat32 acc = ndFloat32(0.0f);
 				for (ndInt32 i = 0; i < boundedSize; ++i) 
 				{
@@ -1304,7 +1312,7 @@ void ndSkeletonContainer::SolveBlockLcp(ndInt32 size, ndInt32 blockSize, const n
 	}
 	else 
 	{
-		SolveLcp(size, size, m_massMatrix11, x0, x, b, low, high, normalIndex, accelTol);
+		SolveLcp(size, size, matrix, x0, x, b, low, high, normalIndex, accelTol);
 	}
 }
 
@@ -1366,7 +1374,7 @@ void ndSkeletonContainer::SolveAuxiliary(ndJacobian* const internalForces, const
 	const ndInt32* const normalIndex = &m_frictionIndex[primaryCount];
 	u[m_auxiliaryRowCount] = ndFloat32(1.0f);
 	u0[m_auxiliaryRowCount] = ndFloat32(0.0f);
-	SolveBlockLcp(m_auxiliaryRowCount, m_blockSize, u0, u, b, low, high, normalIndex, ndFloat32 (0.5f));
+	SolveBlockLcp(m_auxiliaryRowCount, m_blockSize, m_massMatrix11, u0, u, b, low, high, normalIndex, ndFloat32 (0.5f));
 
 	for (ndInt32 i = 0; i < m_auxiliaryRowCount; ++i) 
 	{
@@ -1597,7 +1605,7 @@ void ndSkeletonContainer::SolveAuxiliaryImmediate(ndArray<ndBodyKinematic*>& bod
 	u[m_auxiliaryRowCount] = ndFloat32(1.0f);
 	u0[m_auxiliaryRowCount] = ndFloat32(0.0f);
 	const ndInt32* const normalIndex = &m_frictionIndex[primaryCount];
-	SolveBlockLcp(m_auxiliaryRowCount, m_blockSize, u0, u, b, low, high, normalIndex, ndFloat32 (0.1f));
+	SolveBlockLcp(m_auxiliaryRowCount, m_blockSize, m_massMatrix11, u0, u, b, low, high, normalIndex, ndFloat32 (0.1f));
 
 	for (ndInt32 i = 0; i < m_auxiliaryRowCount; ++i)
 	{
@@ -141,10 +141,15 @@ class ndSkeletonContainer
 	void SortGraph(ndNode* const root, ndInt32& index);
 	void RebuildMassMatrix(const ndFloat32* const diagDamp) const;
 	void CalculateLoopMassMatrixCoefficients(ndFloat32* const diagDamp);
-	void FactorizeMatrix(ndInt32 size, ndInt32 stride, ndFloat32* const matrix, ndFloat32* const diagDamp) const;
 	void SolveAuxiliary(ndJacobian* const internalForces, const ndForcePair* const accel, ndForcePair* const force) const;
-	void SolveBlockLcp(ndInt32 size, ndInt32 blockSize, const ndFloat32* const x0, ndFloat32* const x, ndFloat32* const b, const ndFloat32* const low, const ndFloat32* const high, const ndInt32* const normalIndex, ndFloat32 accelTol) const;
-	void SolveLcp(ndInt32 stride, ndInt32 size, const ndFloat32* const matrix, const ndFloat32* const x0, ndFloat32* const x, const ndFloat32* const b, const ndFloat32* const low, const ndFloat32* const high, const ndInt32* const normalIndex, ndFloat32 accelTol) const;
+
+	// dense lcp helpers, they do not depend on the skeleton so the solver can use them on small islands.
+	// the matrix has the unbounded rows first, FactorizeBlockMatrix factorizes them and replaces 
+	// the bounded rows with their Schur complement, SolveBlockLcp solves the factorized matrix.
+	static void FactorizeMatrix(ndInt32 size, ndInt32 stride, ndFloat32* const matrix, ndFloat32* const diagDamp);
+	static void FactorizeBlockMatrix(ndInt32 size, ndInt32 blockSize, ndFloat32* const matrix, ndFloat32* const diagDamp);
+	static void SolveBlockLcp(ndInt32 size, ndInt32 blockSize, const ndFloat32* const matrix, const ndFloat32* const x0, ndFloat32* const x, ndFloat32* const b, const ndFloat32* const low, const ndFloat32* const high, const ndInt32* const normalIndex, ndFloat32 accelTol);
+	static void SolveLcp(ndInt32 stride, ndInt32 size, const ndFloat32* const matrix, const ndFloat32* const x0, ndFloat32* const x, const ndFloat32* const b, const ndFloat32* const low, const ndFloat32* const high, const ndInt32* const normalIndex, ndFloat32 accelTol);
 
 	inline void SolveBackward(ndForcePair* const force) const;
 	inline void CalculateForce(ndForcePair* const force, const ndForcePair* const accel) const;
@@ -186,7 +191,9 @@ class ndSkeletonContainer
 	friend class ndSkeletonQueue;
 	friend class ndDynamicsUpdate;
 	friend class ndDynamicsUpdateSoa;
+	friend class ndDynamicsUpdateGaussSeidel;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 	friend class ndDynamicsUpdateSycl;
 	friend class ndDynamicsUpdateCuda;
 };
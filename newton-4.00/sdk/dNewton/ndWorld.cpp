@@ -24,10 +24,12 @@
 #include "ndWorld.h"
 #include "ndModel.h"
 #include "ndWorldScene.h"
+#include "ndWorldSnapshot.h"
 #include "ndBodyDynamic.h"
 #include "ndSkeletonList.h"
 #include "ndDynamicsUpdate.h"
 #include "ndDynamicsUpdateSoa.h"
+#include "ndDynamicsUpdateGaussSeidel.h"
 #include "ndJointBilateralConstraint.h"
 
 #ifdef _D_USE_AVX2_SOLVER
@@ -35,6 +37,10 @@
 	#include "ndDynamicsUpdateAvx2.h"
 #endif
 
+#ifdef _D_USE_AVX512_SOLVER
+	#include "ndDynamicsUpdateAvx512.h"
+#endif
+
 #ifdef _D_NEWTON_CUDA
 	#include "ndCudaUtils.h"
 	#include "ndWorldSceneCuda.h"
@@ -102,6 +108,10 @@ ndWorld::ndWorld()
 	:ndClassAlloc()
 	,m_scene(nullptr)
 	,m_solver(nullptr)
+	,m_snapshots(nullptr)
+	,m_frameStatsCollector(nullptr)
+	,m_group(nullptr)
+	,m_frameStats()
 	,m_jointList()
 	,m_modelList()
 	,m_skeletonList()
@@ -120,12 +130,15 @@ ndWorld::ndWorld()
 	,m_subSteps(1)
 	,m_solverMode(ndStandardSolver)
 	,m_solverIterations(4)
+	,m_directSolverMaxRows(0)
 	,m_inUpdate(false)
+	,m_autoSolver(true)
 {
 	// start the engine thread;
 	ndBody::m_uniqueIdCount = 0;
 	m_solver = new ndDynamicsUpdate(this);
 	m_scene = new ndWorldScene(this);
+	ChangeSolver(GetBestSolver());
 
 	ndInt32 steps = 1;
 	ndFloat32 freezeAccel2 = m_freezeAccel2;
@@ -159,8 +172,12 @@ ndWorld::ndWorld()
 
 ndWorld::~ndWorld()
 {
+	// the world must be removed from its group before it is destroyed
+	ndAssert(!m_group);
 	CleanUp();
 
+	delete m_snapshots;
+	EnableFrameStats(false);
 	delete m_scene;
 	delete m_solver;
 	ClearCache();
@@ -231,8 +248,19 @@ ndInt32 ndWorld::GetThreadCount() const
 	return m_scene->GetThreadCount();
 }
 
+ndWorldGroup* ndWorld::GetGroup() const
+{
+	return m_group;
+}
+
 void ndWorld::SetThreadCount(ndInt32 count)
 {
+	// grouped worlds run on the group workers
+	ndAssert(!m_group);
+	if (m_group)
+	{
+		return;
+	}
 	m_scene->SetThreadCount(count);
 	m_scene->m_backgroundThread.SetThreadCount(count);
 }
@@ -252,6 +280,148 @@ ndScene* ndWorld::GetScene() const
 	return m_scene;
 }
 
+bool ndWorld::GetDeterministicMode() const
+{
+	return m_scene->m_deterministic;
+}
+
+void ndWorld::SetDeterministicMode(bool mode)
+{
+	m_scene->m_deterministic = mode;
+}
+
+ndUnsigned64 ndWorld::GetSpeculativeContactBudget() const
+{
+	return m_scene->m_speculativeBudget;
+}
+
+void ndWorld::SetSpeculativeContactBudget(ndUnsigned64 microseconds)
+{
+	m_scene->m_speculativeBudget = microseconds;
+}
+
+ndUnsigned64 ndWorld::CalculateStateHash() const
+{
+	ndUnsigned64 crc = 0;
+	const ndBodyListView& bodyList = m_scene->GetBodyList();
+	for (ndBodyListView::ndNode* node = bodyList.GetFirst(); node; node = node->GetNext())
+	{
+		const ndBodyKinematic* const body = node->GetInfo()->GetAsBodyKinematic();
+		const ndUnsigned32 id = body->GetId();
+		const ndMatrix& matrix = body->m_matrix;
+		crc = ndCRC64(&id, ndInt32(sizeof(id)), crc);
+		crc = ndCRC64(&matrix[0][0], ndInt32(sizeof(ndMatrix)), crc);
+		crc = ndCRC64(&body->m_veloc[0], ndInt32(sizeof(ndVector)), crc);
+		crc = ndCRC64(&body->m_omega[0], ndInt32(sizeof(ndVector)), crc);
+	}
+	return crc;
+}
+
+bool ndWorld::GetSnapshotsEnabled() const
+{
+	return m_snapshots ? true : false;
+}
+
+void ndWorld::EnableSnapshots(bool state)
+{
+	Sync();
+	if (state && !m_snapshots)
+	{
+		m_snapshots = new ndWorldSnapshotBuffer();
+	}
+	else if (!state && m_snapshots)
+	{
+		delete m_snapshots;
+		m_snapshots = nullptr;
+	}
+}
+
+const ndWorldSnapshot* ndWorld::AcquireSnapshot()
+{
+	return m_snapshots ? m_snapshots->Acquire() : nullptr;
+}
+
+bool ndWorld::GetFrameStatsEnabled() const
+{
+	return m_frameStatsCollector ? true : false;
+}
+
+void ndWorld::EnableFrameStats(bool state)
+{
+	Sync();
+	if (state && !m_frameStatsCollector)
+	{
+		m_frameStatsCollector = new ndFrameStatsCollector();
+		m_scene->SetFrameStatsCollector(m_frameStatsCollector);
+	}
+	else if (!state && m_frameStatsCollector)
+	{
+		m_scene->SetFrameStatsCollector(nullptr);
+		delete m_frameStatsCollector;
+		m_frameStatsCollector = nullptr;
+		m_frameStats.Clear();
+	}
+}
+
+const ndFrameStats& ndWorld::GetFrameStats() const
+{
+	return m_frameStats;
+}
+
+void ndWorld::EndFrameStats()
+{
+	m_frameStatsCollector->End(m_frameStats);
+	m_frameStats.m_frameNumber = m_scene->m_frameNumber;
+
+	// the solver counters are read from the state the update left, 
+	// the simd solvers do not split the joints in islands.
+	const ndArray<ndDynamicsUpdate::ndIsland>& islands = m_solver->GetIslands();
+
+	ndUnsigned64 awake = 0;
+	const ndArray<ndBodyKinematic*>& bodyArray = m_scene->GetActiveBodyArray();
+	for (ndInt32 i = bodyArray.GetCount() - 2; i >= 0; --i)
+	{
+		awake += bodyArray[i]->m_equilibrium ? 0 : 1;
+	}
+
+	m_frameStats.m_counters[ndFrameStats::m_solverPasses] = m_solver->m_updatePasses;
+	m_frameStats.m_counters[ndFrameStats::m_islands] = ndUnsigned64(islands.GetCount());
+	m_frameStats.m_counters[ndFrameStats::m_bodiesAwake] = awake;
+}
+
+void ndWorld::PublishSnapshot()
+{
+	D_TRACKTIME();
+	ndWorldSnapshot& snapshot = m_snapshots->GetBackBuffer();
+	const ndArray<ndBodyKinematic*>& view = m_scene->GetBodyList().GetView();
+	snapshot.m_bodies.SetCount(view.GetCount());
+	snapshot.m_timestep = m_timestep;
+	snapshot.m_frameNumber = m_scene->m_frameNumber + 1;
+
+	auto CopyBodyStates = ndMakeObject::ndFunction([this, &view, &snapshot](ndInt32 threadIndex, ndInt32 threadCount)
+	{
+		D_TRACKTIME_NAMED(CopyBodyStates);
+		ndBodyState* const states = &snapshot.m_bodies[0];
+		const ndStartEnd startEnd(view.GetCount(), threadIndex, threadCount);
+		for (ndInt32 i = startEnd.m_start; i < startEnd.m_end; ++i)
+		{
+			const ndBodyKinematic* const body = view[i];
+			ndBodyState& state = states[i];
+			state.m_matrix = body->m_matrix;
+			state.m_veloc = body->m_veloc;
+			state.m_omega = body->m_omega;
+			state.m_body = body;
+			state.m_bodyId = body->GetId();
+			state.m_sleeping = body->m_equilibrium;
+		}
+	});
+	if (view.GetCount())
+	{
+		m_scene->ParallelExecute(CopyBodyStates);
+	}
+	m_snapshots->Publish();
+}
+
 ndInt32 ndWorld::GetSolverIterations() const
 {
 	return m_solverIterations;
@@ -262,6 +432,37 @@ void ndWorld::SetSolverIterations(ndInt32 iterations)
 	m_solverIterations = ndInt32(ndMax(4, iterations));
 }
 
+ndInt32 ndWorld::GetDirectSolverMaxRows() const
+{
+	return m_directSolverMaxRows;
+}
+
+void ndWorld::SetDirectSolverMaxRows(ndInt32 rows)
+{
+	m_directSolverMaxRows = ndClamp(rows, 0, D_MAX_DIRECT_SOLVER_ROWS);
+	if (m_autoSolver)
+	{
+		// the simd solvers have no islands to solve directly
+		ChangeSolver(m_directSolverMaxRows ? ndStandardSolver : GetBestSolver());
+	}
+}
+
+ndInt32 ndWorld::GetSolverIslandStats(ndSolverIslandStats* const stats, ndInt32 maxCount) const
+{
+	const ndArray<ndDynamicsUpdate::ndIsland>& islands = m_solver->GetIslands();
+	const ndInt32 count = ndMin(islands.GetCount(), maxCount);
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		const ndDynamicsUpdate::ndIsland& island = islands[i];
+		stats[i].m_root = island.m_root;
+		stats[i].m_jointCount = island.m_count;
+		stats[i].m_rowCount = island.m_rowCount;
+		stats[i].m_passes = island.m_passes;
+		stats[i].m_passesUsed = island.m_passesUsed;
+	}
+	return islands.GetCount();
+}
+
 ndContactNotify* ndWorld::GetContactNotify() const
 {
 	return m_scene->GetContactNotify();
@@ -426,6 +627,20 @@ ndInt32 ndWorld::CompareJointByInvMass(const ndJointBilateralConstraint* const j
 }
 
 void ndWorld::ThreadFunction()
+{
+	if (m_frameStatsCollector)
+	{
+		m_frameStatsCollector->Begin(m_scene->GetThreadCount());
+		ThreadUpdate();
+		EndFrameStats();
+	}
+	else
+	{
+		ThreadUpdate();
+	}
+}
+
+void ndWorld::ThreadUpdate()
 {
 	D_TRACKTIME();
 	ndUnsigned64 timeAcc = ndGetTimeInMicroseconds();
@@ -484,6 +699,7 @@ void ndWorld::ThreadFunction()
 
 	PreUpdate(m_timestep);
 
+	m_solver->m_updatePasses = 0;
 	ndInt32 const steps = m_subSteps;
 	ndFloat32 timestep = m_timestep / (ndFloat32)steps;
 	for (ndInt32 i = 0; i < steps; ++i)
@@ -493,6 +709,9 @@ void ndWorld::ThreadFunction()
 
 	m_scene->SetTimestep(m_timestep);
 		
+	// not a node of the substep graph, each particle set hands its update to the scene 
+	// background worker, which has its own threads, so unless the set asks to wait the 
+	// particles already run at the same time as the next rigid body steps.
 	ParticleUpdate(m_timestep);
 		
 	UpdateTransforms();
@@ -500,6 +719,14 @@ void ndWorld::ThreadFunction()
 	PostUpdate(m_timestep);
 	m_inUpdate = false;
 
+	// scratch memory of this update is no longer referenced
+	m_scene->ResetFrameArenas();
+
+	if (m_snapshots)
+	{
+		PublishSnapshot();
+	}
+
 	m_scene->End();
 	
 	m_lastExecutionTime = (ndFloat32)(ndGetTimeInMicroseconds() - timeAcc) * ndFloat32(1.0e-6f);
@@ -529,35 +756,69 @@ void ndWorld::SubStepUpdate(ndFloat32 timestep)
 	// do physics step
 	m_scene->m_lru = m_scene->m_lru + 1;
 	m_scene->SetTimestep(timestep);
-
-	m_scene->BalanceScene();
-	m_scene->ApplyExtForce();
-	m_scene->InitBodyArray();
+	m_modelList.UpdateDirtyList();
+	const ndArray<ndModel*>& modelList = m_modelList.GetUpdateList();
+
+	// the collision and solver passes are fork/join stages that run one after 
+	// the other. special bodies and the skeleton topology do not share state and 
+	// run concurrently once the contacts are ready (trigger callbacks must not add 
+	// or remove joints), the models come after both, because articulation models 
+	// write the skeleton marks of their bodies.
+	ndTaskGraph graph(m_scene);
+	ndTaskGraph::ndNode* const balanceScene = graph.AddStage([this]() { m_scene->BalanceScene(); });
+	ndTaskGraph::ndNode* const applyExtForce = graph.AddStage([this]() { m_scene->ApplyExtForce(); });
+	ndTaskGraph::ndNode* const initBodyArray = graph.AddStage([this]() { m_scene->InitBodyArray(); });
 
 	// update the collision system
-	m_scene->FindCollidingPairs();
-	m_scene->CreateNewContacts();
-	m_scene->CalculateContacts();
-	m_scene->DeleteDeadContacts();
+	ndTaskGraph::ndNode* const findPairs = graph.AddStage([this]() { m_scene->FindCollidingPairs(); });
+	ndTaskGraph::ndNode* const newContacts = graph.AddStage([this]() { m_scene->CreateNewContacts(); });
+	ndTaskGraph::ndNode* const calculateContacts = graph.AddStage([this]() { m_scene->CalculateContacts(); });
+	ndTaskGraph::ndNode* const deadContacts = graph.AddStage([this]() { m_scene->DeleteDeadContacts(); });
 
 	// update all special bodies.
-	m_scene->UpdateSpecial();
-
-	// Update Particle base physics
-	//ParticleUpdate();
+	ndTaskGraph::ndNode* const updateSpecial = graph.AddJob([this](ndInt32)
+	{
+		D_TRACKTIME_NAMED(UpdateSpecial);
+		m_scene->UpdateSpecial();
+	});
 
 	// update skeletons topologies
-	UpdateSkeletons();
+	ndTaskGraph::ndNode* const updateSkeletons = graph.AddJob([this](ndInt32)
+	{
+		UpdateSkeletons();
+	});
 
 	// Update all models
-	ModelUpdate();
+	ndTaskGraph::ndNode* const modelUpdate = graph.AddParallelFor(modelList.GetCount(), 1, [this, &modelList, timestep](ndInt32, ndInt32 i)
+	{
+		D_TRACKTIME_NAMED(ModelUpdate);
+		modelList[i]->Update(this, timestep);
+	});
 
 	// calculate internal forces, integrate bodies and update matrices.
 	ndAssert(m_solver);
-	m_solver->Update();
+	ndTaskGraph::ndNode* const solverUpdate = graph.AddStage([this]() { m_solver->Update(); });
 
 	// second pass on models
-	ModelPostUpdate();
+	ndTaskGraph::ndNode* const modelPostUpdate = graph.AddParallelFor(modelList.GetCount(), 1, [this, &modelList, timestep](ndInt32, ndInt32 i)
+	{
+		D_TRACKTIME_NAMED(ModelPostUpdate);
+		modelList[i]->PostUpdate(this, timestep);
+	});
+
+	graph.AddDependency(applyExtForce, balanceScene);
+	graph.AddDependency(initBodyArray, applyExtForce);
+	graph.AddDependency(findPairs, initBodyArray);
+	graph.AddDependency(newContacts, findPairs);
+	graph.AddDependency(calculateContacts, newContacts);
+	graph.AddDependency(deadContacts, calculateContacts);
+	graph.AddDependency(updateSpecial, deadContacts);
+	graph.AddDependency(updateSkeletons, deadContacts);
+	graph.AddDependency(modelUpdate, updateSpecial);
+	graph.AddDependency(modelUpdate, updateSkeletons);
+	graph.AddDependency(solverUpdate, modelUpdate);
+	graph.AddDependency(modelPostUpdate, solverUpdate);
+	graph.Execute();
 
 	m_scene->m_subStepNumber++;
 }
@@ -568,47 +829,6 @@ void ndWorld::ParticleUpdate(ndFloat32 timestep)
 	m_scene->ParticleUpdate(timestep);
 }
 
-void ndWorld::ModelUpdate()
-{
-	D_TRACKTIME();
-	ndAtomic<ndInt32> counter(0);
-	auto ModelUpdate = ndMakeObject::ndFunction([this, &counter](ndInt32, ndInt32)
-	{
-		D_TRACKTIME_NAMED(ModelUpdate);
-		const ndFloat32 timestep = m_scene->GetTimestep();
-		ndArray<ndModel*> modelList = m_modelList.GetUpdateList();
-		const ndInt32 modelCount = modelList.GetCount();
-		for (ndInt32 i = counter.fetch_add(1); i < modelCount; i = counter.fetch_add(1))
-		{
-			ndModel* const model = modelList[i];
-			model->Update(this, timestep);
-		}
-	});
-
-	m_modelList.UpdateDirtyList();
-	m_scene->ParallelExecute(ModelUpdate);
-}
-
-void ndWorld::ModelPostUpdate()
-{
-	D_TRACKTIME();
-	ndAtomic<ndInt32> counter(0);
-	auto ModelPostUpdate = ndMakeObject::ndFunction([this, &counter](ndInt32, ndInt32)
-	{
-		D_TRACKTIME_NAMED(ModelPostUpdate);
-		const ndFloat32 timestep = m_scene->GetTimestep();
-		ndArray<ndModel*> modelList = m_modelList.GetUpdateList();
-
-		const ndInt32 modelCount = modelList.GetCount();
-		for (ndInt32 i = counter.fetch_add(1); i < modelCount; i = counter.fetch_add(1))
-		{
-			ndModel* const model = modelList[i];
-			model->PostUpdate(this, timestep);
-		}
-	});
-	m_scene->ParallelExecute(ModelPostUpdate);
-}
-
 void ndWorld::PostModelTransform()
 {
 	D_TRACKTIME();
@@ -916,13 +1136,53 @@ bool ndWorld::ConvexCast(ndConvexCastNotify& callback, const ndShapeInstance& co
 	return m_scene->ConvexCast(callback, convexShape, globalOrigin, globalDest);
 }
 
+void ndWorld::RayCastBatch(const ndFastRay* const rays, ndInt32 count, ndRayCastHit* const results)
+{
+	m_scene->RayCastBatch(rays, count, results);
+}
+
 void ndWorld::BodiesInAabb(ndBodiesInAabbNotify& callback, const ndVector& minBox, const ndVector& maxBox) const
 {
 	m_scene->BodiesInAabb(callback, minBox, maxBox);
 }
 
+ndWorld::ndSolverModes ndWorld::GetBestSolver()
+{
+	#ifdef _D_USE_AVX512_SOLVER
+	if (ndCpuFeatures::HasFeatures(ndCpuFeatures::m_avx512))
+	{
+		return ndSimdAvx512Solver;
+	}
+	#endif
+
+	#ifdef _D_USE_AVX2_SOLVER
+	if (ndCpuFeatures::HasFeatures(ndCpuFeatures::m_avx2 | ndCpuFeatures::m_fma))
+	{
+		return ndSimdAvx2Solver;
+	}
+	#endif
+	return ndSimdSoaSolver;
+}
+
 void ndWorld::SelectSolver(ndSolverModes solverMode)
 {
+	m_autoSolver = false;
+	ChangeSolver(solverMode);
+}
+
+void ndWorld::ChangeSolver(ndSolverModes solverMode)
+{
+	// the avx libraries can not run on older cpus, 
+	// they fall back to the next best solver
+	if ((solverMode == ndSimdAvx512Solver) && !ndCpuFeatures::HasFeatures(ndCpuFeatures::m_avx512))
+	{
+		solverMode = ndSimdAvx2Solver;
+	}
+	if ((solverMode == ndSimdAvx2Solver) && !ndCpuFeatures::HasFeatures(ndCpuFeatures::m_avx2 | ndCpuFeatures::m_fma))
+	{
+		solverMode = ndSimdSoaSolver;
+	}
+
 	if (solverMode != m_solverMode)
 	{
 		Sync();
@@ -940,6 +1200,17 @@ void ndWorld::SelectSolver(ndSolverModes solverMode)
 				break;
 			}
 
+			case ndGaussSeidelSolver:
+			{
+				ndWorldScene* const newScene = new ndWorldScene(*((ndWorldScene*)m_scene));
+				delete m_scene;
+				m_scene = newScene;
+
+				m_solverMode = solverMode;
+				m_solver = new ndDynamicsUpdateGaussSeidel(this);
+				break;
+			}
+
 			case ndSimdAvx2Solver:
 			{
 				#ifdef _D_USE_AVX2_SOLVER
@@ -960,6 +1231,21 @@ void ndWorld::SelectSolver(ndSolverModes solverMode)
 				break;
 			}
 
+			case ndSimdAvx512Solver:
+			{
+				ndWorldScene* const newScene = new ndWorldScene(*((ndWorldScene*)m_scene));
+				delete m_scene;
+				m_scene = newScene;
+				#ifdef _D_USE_AVX512_SOLVER
+					m_solverMode = solverMode;
+					m_solver = new ndDynamicsUpdateAvx512(this);
+				#else
+					m_solverMode = ndSimdSoaSolver;
+					m_solver = new ndDynamicsUpdateSoa(this);
+				#endif
+				break;
+			}
+
 			case ndSyclSolverCpu:
 			{
 				#ifdef _D_NEWTON_SYCL
@@ -1085,6 +1371,13 @@ void ndWorld::SelectSolver(ndSolverModes solverMode)
 
 void ndWorld::CollisionUpdate(ndFloat32 timestep)
 {
+	// grouped worlds are only stepped by their group
+	ndAssert(!m_group);
+	if (m_group)
+	{
+		return;
+	}
+
 	// wait until previous update complete.
 	Sync();
 	m_timestep = timestep;
@@ -1095,6 +1388,13 @@ void ndWorld::CollisionUpdate(ndFloat32 timestep)
 
 void ndWorld::Update(ndFloat32 timestep)
 {
+	// grouped worlds are only stepped by their group
+	ndAssert(!m_group);
+	if (m_group)
+	{
+		return;
+	}
+
 	// wait until previous update complete.
 	Sync();
 
@@ -1181,5 +1481,5 @@ void ndWorld::CalculateJointContacts(ndContact* const contact)
 	body0->UpdateCollisionMatrix();
 	body1->UpdateCollisionMatrix();
 
-	m_scene->CalculateJointContacts(0, contact);
+	m_scene->CalculateJointContacts(0, contact, true);
 }
\ No newline at end of file
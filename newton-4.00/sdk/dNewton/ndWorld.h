@@ -30,11 +30,15 @@
 class ndWorld;
 class ndModel;
 class ndJointList;
+class ndWorldGroup;
+class ndWorldSnapshot;
 class ndBodyDynamic;
+class ndRayCastHit;
 class ndRayCastNotify;
 class ndDynamicsUpdate;
 class ndConvexCastNotify;
 class ndBodiesInAabbNotify;
+class ndWorldSnapshotBuffer;
 class ndJointBilateralConstraint;
 
 #define D_NEWTON_ENGINE_MAJOR_VERSION 4
@@ -42,6 +46,17 @@ class ndJointBilateralConstraint;
 
 #define D_SLEEP_ENTRIES			8
 
+// solver statistics of one island of the last update
+class ndSolverIslandStats
+{
+	public:
+	ndBodyKinematic* m_root;
+	ndInt32 m_jointCount;
+	ndInt32 m_rowCount;
+	ndInt32 m_passes;
+	ndInt32 m_passesUsed;
+};
+
 D_MSV_NEWTON_ALIGN_32
 class ndWorld: public ndClassAlloc
 {
@@ -54,6 +69,8 @@ class ndWorld: public ndClassAlloc
 		ndCudaSolver,
 		ndSyclSolverCpu,
 		ndSyclSolverGpu,
+		ndGaussSeidelSolver,
+		ndSimdAvx512Solver,
 	};
 
 	D_BASE_CLASS_REFLECTION(ndWorld)
@@ -71,11 +88,21 @@ class ndWorld: public ndClassAlloc
 	D_NEWTON_API ndInt32 GetThreadCount() const;
 	D_NEWTON_API void SetThreadCount(ndInt32 count);
 
+	// the group stepping this world, worlds in a group can not be 
+	// updated on their own and can not change their thread count.
+	D_NEWTON_API ndWorldGroup* GetGroup() const;
+
 	D_NEWTON_API ndInt32 GetSubSteps() const;
 	D_NEWTON_API void SetSubSteps(ndInt32 subSteps);
 
+	// until a solver is selected the world runs GetBestSolver, the fastest simd 
+	// solver the cpu supports, or the standard solver while the direct islands 
+	// are enabled, the simd solvers have no islands. see ndCpuFeatures to hide 
+	// cpu features for testing. selecting a solver the cpu does not support 
+	// selects the next best one.
 	D_NEWTON_API ndSolverModes GetSelectedSolver() const;
 	D_NEWTON_API void SelectSolver(ndSolverModes solverMode);
+	D_NEWTON_API static ndSolverModes GetBestSolver();
 
 	D_NEWTON_API ndScene* GetScene() const;
 	D_NEWTON_API bool IsHighPerformanceCompute() const;
@@ -103,6 +130,56 @@ class ndWorld: public ndClassAlloc
 
 	D_NEWTON_API ndInt32 GetSolverIterations() const;
 	D_NEWTON_API void SetSolverIterations(ndInt32 iterations);
+
+	// islands with up to this many rows are solved with a direct block lcp 
+	// instead of the iterative passes, zero (the default) disables it.
+	// it is only used by the standard and the Gauss Seidel solvers.
+	D_NEWTON_API ndInt32 GetDirectSolverMaxRows() const;
+	D_NEWTON_API void SetDirectSolverMaxRows(ndInt32 rows);
+
+	// each island stops iterating when its residual is small enough, or when it used 
+	// the passes its connectivity calls for. the islands are found again on every sub 
+	// step, so the stats are those of the last sub step of the update, m_passesUsed 
+	// adds the passes of the four solver steps run in it. returns the island count, 
+	// fills up to maxCount entries. the simd solvers have no islands.
+	D_NEWTON_API ndInt32 GetSolverIslandStats(ndSolverIslandStats* const stats, ndInt32 maxCount) const;
+	
+	// in deterministic mode the results are bit exact for any thread count, the new 
+	// pairs and the bodies woken up are sorted, and the speculative contact budget 
+	// is ignored. simulations compared across machines must also select the same solver.
+	D_NEWTON_API bool GetDeterministicMode() const;
+	D_NEWTON_API void SetDeterministicMode(bool mode);
+
+	// time in microseconds each step can spend on the narrow phase of the pairs with 
+	// a speculative contacts body, zero means no limit. with a budget these pairs run 
+	// in their own pass after the other pairs, past the budget the remaining pairs 
+	// get plain discrete contacts, so fast bodies can tunnel again. 
+	// the budget is ignored in deterministic mode.
+	D_NEWTON_API ndUnsigned64 GetSpeculativeContactBudget() const;
+	D_NEWTON_API void SetSpeculativeContactBudget(ndUnsigned64 microseconds);
+
+	// crc of the matrix and velocities of all bodies, call it after Sync 
+	// to compare two simulations frame by frame.
+	D_NEWTON_API ndUnsigned64 CalculateStateHash() const;
+
+	// with snapshots enabled each update ends publishing the matrix, velocities and 
+	// sleep state of all bodies. AcquireSnapshot never waits for the update in flight, 
+	// it returns the last published snapshot, or nullptr before the first one. 
+	// a single thread should acquire them, the snapshot stays valid until its next call.
+	D_NEWTON_API bool GetSnapshotsEnabled() const;
+	D_NEWTON_API void EnableSnapshots(bool state);
+	D_NEWTON_API const ndWorldSnapshot* AcquireSnapshot();
+
+	// with frame stats enabled each update collects the time of all D_TRACKTIME zones, 
+	// the contact and solver counters and the busy time of every thread, this does 
+	// not need a profiler build. GetFrameStats is the last update, read it after Sync.
+	// the pass counter adds the passes of all islands over all sub steps, the simd 
+	// solvers have no islands, they count each pass over all the joints once. 
+	// the pair query counter is the bodies that walked the bvh for new pairs, 
+	// bodies that stay inside their fat leaf box skip the walk.
+	D_NEWTON_API bool GetFrameStatsEnabled() const;
+	D_NEWTON_API void EnableFrameStats(bool state);
+	D_NEWTON_API const ndFrameStats& GetFrameStats() const;
 	
 	D_NEWTON_API ndFloat32 GetUpdateTime() const;
 	D_NEWTON_API ndUnsigned32 GetFrameNumber() const;
@@ -119,10 +196,12 @@ class ndWorld: public ndClassAlloc
 	D_NEWTON_API void BodiesInAabb(ndBodiesInAabbNotify& callback, const ndVector& minBox, const ndVector& maxBox) const;
 	D_NEWTON_API bool RayCast(ndRayCastNotify& callback, const ndVector& globalOrigin, const ndVector& globalDest) const;
 	D_NEWTON_API bool ConvexCast(ndConvexCastNotify& callback, const ndShapeInstance& convexShape, const ndMatrix& globalOrigin, const ndVector& globalDest) const;
+	D_NEWTON_API void RayCastBatch(const ndFastRay* const rays, ndInt32 count, ndRayCastHit* const results);
 
 	D_NEWTON_API void CalculateJointContacts(ndContact* const contact);
 
 	private:
+	void ThreadUpdate();
 	void ThreadFunction();
 	
 	protected:
@@ -153,8 +232,9 @@ class ndWorld: public ndClassAlloc
 		ndBodyKinematic* m_body;
 	};
 
-	void ModelUpdate();
-	void ModelPostUpdate();
+	void PublishSnapshot();
+	void EndFrameStats();
+	void ChangeSolver(ndSolverModes solverMode);
 	void CalculateAverageUpdateTime();
 	void SubStepUpdate(ndFloat32 timestep);
 	void ParticleUpdate(ndFloat32 timestep);
@@ -164,6 +244,10 @@ class ndWorld: public ndClassAlloc
 
 	ndScene* m_scene;
 	ndDynamicsUpdate* m_solver;
+	ndWorldSnapshotBuffer* m_snapshots;
+	ndFrameStatsCollector* m_frameStatsCollector;
+	ndWorldGroup* m_group;
+	ndFrameStats m_frameStats;
 	ndJointList m_jointList;
 	ndModelList m_modelList;
 	ndSkeletonList m_skeletonList;
@@ -185,16 +269,21 @@ class ndWorld: public ndClassAlloc
 	ndInt32 m_subSteps;
 	ndSolverModes m_solverMode;
 	ndInt32 m_solverIterations;
+	ndInt32 m_directSolverMaxRows;
 	bool m_inUpdate;
+	bool m_autoSolver;
 	
 	friend class ndScene;
 	friend class ndWorldScene;
+	friend class ndWorldGroup;
 	friend class ndBodyDynamic;
 	friend class ndDynamicsUpdate;
 	friend class ndSkeletonContainer;
 	friend class ndModelArticulation;
 	friend class ndDynamicsUpdateSoa;
+	friend class ndDynamicsUpdateGaussSeidel;
 	friend class ndDynamicsUpdateAvx2;
+	friend class ndDynamicsUpdateAvx512;
 	friend class ndDynamicsUpdateSycl;
 	friend class ndDynamicsUpdateCuda;
 } D_GCC_NEWTON_ALIGN_32;
@@ -0,0 +1,122 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndNewtonStdafx.h"
+#include "ndWorldGroup.h"
+
+ndWorldGroup::ndWorldGroup()
+	:ndThreadPool("newtonGroupWorker")
+	,m_worlds()
+	,m_timestep(ndFloat32(0.0f))
+{
+	SetThreadCount(GetMaxThreads());
+}
+
+ndWorldGroup::~ndWorldGroup()
+{
+	Sync();
+	Finish();
+	for (ndInt32 i = 0; i < m_worlds.GetCount(); ++i)
+	{
+		m_worlds[i]->m_group = nullptr;
+	}
+}
+
+ndInt32 ndWorldGroup::GetWorldCount() const
+{
+	return m_worlds.GetCount();
+}
+
+ndWorld* ndWorldGroup::GetWorld(ndInt32 index) const
+{
+	return m_worlds[index];
+}
+
+void ndWorldGroup::AddWorld(ndWorld* const world)
+{
+	Sync();
+	world->Sync();
+	for (ndInt32 i = 0; i < m_worlds.GetCount(); ++i)
+	{
+		if (m_worlds[i] == world)
+		{
+			return;
+		}
+	}
+	// a world can only be stepped by one group
+	ndAssert(!world->m_group);
+	if (world->m_group)
+	{
+		return;
+	}
+
+	// the world is only stepped by the group workers, 
+	// so it releases its own pool workers.
+	world->SetThreadCount(1);
+	world->m_group = this;
+	m_worlds.PushBack(world);
+}
+
+void ndWorldGroup::RemoveWorld(ndWorld* const world)
+{
+	Sync();
+	for (ndInt32 i = 0; i < m_worlds.GetCount(); ++i)
+	{
+		if (m_worlds[i] == world)
+		{
+			world->m_group = nullptr;
+			m_worlds[i] = m_worlds[m_worlds.GetCount() - 1];
+			m_worlds.SetCount(m_worlds.GetCount() - 1);
+			break;
+		}
+	}
+}
+
+void ndWorldGroup::Update(ndFloat32 timestep)
+{
+	// wait until previous update complete.
+	Sync();
+
+	m_timestep = timestep;
+	for (ndInt32 i = 0; i < m_worlds.GetCount(); ++i)
+	{
+		m_worlds[i]->Sync();
+	}
+
+	// update the next frame asynchronous 
+	TickOne();
+}
+
+void ndWorldGroup::ThreadFunction()
+{
+	D_TRACKTIME();
+	Begin();
+	auto UpdateWorld = [this](ndInt32, ndInt32 i)
+	{
+		D_TRACKTIME_NAMED(UpdateWorld);
+		ndWorld* const world = m_worlds[i];
+		world->m_timestep = m_timestep;
+		world->ThreadFunction();
+	};
+	ParallelFor(0, m_worlds.GetCount(), 1, UpdateWorld);
+	End();
+}
@@ -0,0 +1,54 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __ND_WORLD_GROUP_H__
+#define __ND_WORLD_GROUP_H__
+
+#include "ndNewtonStdafx.h"
+#include "ndWorld.h"
+
+// a set of independent worlds stepped together by one shared thread pool.
+// each world in the group is reduced to a single thread, 
+// and the group workers update as many worlds concurrently as they can.
+class ndWorldGroup: public ndThreadPool
+{
+	public:
+	D_NEWTON_API ndWorldGroup();
+	D_NEWTON_API virtual ~ndWorldGroup();
+
+	D_NEWTON_API void AddWorld(ndWorld* const world);
+	D_NEWTON_API void RemoveWorld(ndWorld* const world);
+
+	D_NEWTON_API ndInt32 GetWorldCount() const;
+	D_NEWTON_API ndWorld* GetWorld(ndInt32 index) const;
+
+	// step all worlds, like ndWorld::Update the call returns immediately,
+	// call Sync to wait for the step to complete.
+	D_NEWTON_API void Update(ndFloat32 timestep);
+
+	private:
+	virtual void ThreadFunction();
+
+	ndArray<ndWorld*> m_worlds;
+	ndFloat32 m_timestep;
+};
+
+#endif
@@ -0,0 +1,66 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "ndCoreStdafx.h"
+#include "ndNewtonStdafx.h"
+#include "ndWorldSnapshot.h"
+
+#define D_SNAPSHOT_FRESH	4
+#define D_SNAPSHOT_INDEX	3
+
+ndWorldSnapshot::ndWorldSnapshot()
+	:ndClassAlloc()
+	,m_bodies(256)
+	,m_timestep(ndFloat32(0.0f))
+	,m_frameNumber(0)
+{
+}
+
+ndWorldSnapshotBuffer::ndWorldSnapshotBuffer()
+	:ndClassAlloc()
+	,m_middle(1)
+	,m_back(0)
+	,m_front(2)
+	,m_hasFront(false)
+{
+}
+
+ndWorldSnapshot& ndWorldSnapshotBuffer::GetBackBuffer()
+{
+	return m_buffers[m_back];
+}
+
+void ndWorldSnapshotBuffer::Publish()
+{
+	const ndInt32 middle = m_middle.exchange(m_back | D_SNAPSHOT_FRESH);
+	m_back = middle & D_SNAPSHOT_INDEX;
+}
+
+const ndWorldSnapshot* ndWorldSnapshotBuffer::Acquire()
+{
+	if (m_middle.load() & D_SNAPSHOT_FRESH)
+	{
+		const ndInt32 middle = m_middle.exchange(m_front);
+		m_front = middle & D_SNAPSHOT_INDEX;
+		m_hasFront = true;
+	}
+	return m_hasFront ? &m_buffers[m_front] : nullptr;
+}
@@ -0,0 +1,74 @@
+/* Copyright (c) <2003-2022> <Julio Jerez, Newton Game Dynamics>
+* 
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+* 
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+* 
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+* 
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+* 
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __ND_WORLD_SNAPSHOT_H__
+#define __ND_WORLD_SNAPSHOT_H__
+
+#include "ndNewtonStdafx.h"
+
+class ndBodyKinematic;
+
+// the state of one body at the end of a step, m_body is only 
+// a key, the body may be gone by the time the snapshot is read.
+D_MSV_NEWTON_ALIGN_32
+class ndBodyState
+{
+	public:
+	ndMatrix m_matrix;
+	ndVector m_veloc;
+	ndVector m_omega;
+	const ndBodyKinematic* m_body;
+	ndUnsigned32 m_bodyId;
+	ndUnsigned8 m_sleeping;
+} D_GCC_NEWTON_ALIGN_32;
+
+// the body states published by the world at the end of an update
+class ndWorldSnapshot: public ndClassAlloc
+{
+	public:
+	ndWorldSnapshot();
+
+	ndArray<ndBodyState> m_bodies;
+	ndFloat32 m_timestep;
+	ndUnsigned32 m_frameNumber;
+};
+
+// triple buffer of snapshots, the world fills the back buffer while the 
+// reader holds the front one, publishing and acquiring a snapshot are a 
+// single atomic exchange of the middle buffer, so neither side ever waits.
+class ndWorldSnapshotBuffer: public ndClassAlloc
+{
+	public:
+	ndWorldSnapshotBuffer();
+
+	ndWorldSnapshot& GetBackBuffer();
+	void Publish();
+	const ndWorldSnapshot* Acquire();
+
+	private:
+	ndWorldSnapshot m_buffers[3];
+	ndAtomic<ndInt32> m_middle;
+	ndInt32 m_back;
+	ndInt32 m_front;
+	bool m_hasFront;
+};
+
+#endif
@@ -0,0 +1,190 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static ndFloat32 BoxHeight(ndInt32 i, ndInt32 j)
+{
+	return ndFloat32((i * 7 + j * 3) % 11) * ndFloat32(0.5f);
+}
+
+static void BuildFloatingBoxes(ndWorld& world, ndInt32 rows)
+{
+	ndShapeInstance shape(new ndShapeBox(ndFloat32(1.0f), ndFloat32(1.0f), ndFloat32(1.0f)));
+	for (ndInt32 i = 0; i < rows; ++i)
+	{
+		for (ndInt32 j = 0; j < rows; ++j)
+		{
+			ndMatrix matrix(ndGetIdentityMatrix());
+			matrix.m_posit.m_x = ndFloat32(i * 2);
+			matrix.m_posit.m_y = BoxHeight(i, j);
+			matrix.m_posit.m_z = ndFloat32(j * 2);
+
+			ndBodyDynamic* const box = new ndBodyDynamic();
+			box->SetNotifyCallback(new ndBodyNotify(ndVector::m_zero));
+			box->SetCollisionShape(shape);
+			box->SetMatrix(matrix);
+			box->SetMassMatrix(ndFloat32(1.0f), shape);
+			ndSharedPtr<ndBody> boxPtr(box);
+			world.AddBody(boxPtr);
+		}
+	}
+}
+
+/* Both bvh builds must produce trees where a ray
+   dropped on top of each box finds that box. */
+TEST(BvhBuild, RayCastFindsEveryBody)
+{
+	const ndInt32 rows = 24;
+	const ndBvhSceneManager::ndBuildMethod methods[] = { ndBvhSceneManager::m_gridCells, ndBvhSceneManager::m_mortonCodes };
+	for (ndInt32 k = 0; k < ndInt32(sizeof(methods) / sizeof(methods[0])); ++k)
+	{
+		ndWorld world;
+		world.SetThreadCount(1);
+		world.GetScene()->SetBvhBuildMethod(methods[k]);
+		BuildFloatingBoxes(world, rows);
+		for (ndInt32 i = 0; i < 4; ++i)
+		{
+			world.Update(1.0f / 60.0f);
+			world.Sync();
+		}
+		EXPECT_EQ(world.GetScene()->GetBvhBuildMethod(), methods[k]);
+		EXPECT_GE(world.GetScene()->GetBvhCost(), ndFloat32(1.0f));
+
+		for (ndInt32 i = 0; i < rows; ++i)
+		{
+			for (ndInt32 j = 0; j < rows; ++j)
+			{
+				const ndVector p0(ndFloat32(i * 2), ndFloat32(20.0f), ndFloat32(j * 2), ndFloat32(1.0f));
+				const ndVector p1(ndFloat32(i * 2), ndFloat32(-20.0f), ndFloat32(j * 2), ndFloat32(1.0f));
+				ndRayCastClosestHitCallback callback;
+				EXPECT_TRUE(world.RayCast(callback, p0, p1));
+				EXPECT_NEAR(callback.m_contact.m_point.m_y, BoxHeight(i, j) + ndFloat32(0.5f), ndFloat32(1.0e-3f));
+			}
+		}
+	}
+}
+
+/* After a step the scene queries go through the flat
+   tree, an aabb around each box must report that box. */
+TEST(BvhBuild, FlatTreeBodiesInAabb)
+{
+	const ndInt32 rows = 16;
+	ndWorld world;
+	world.SetThreadCount(1);
+	BuildFloatingBoxes(world, rows);
+	world.Update(1.0f / 60.0f);
+	world.Sync();
+
+	for (ndInt32 i = 0; i < rows; ++i)
+	{
+		for (ndInt32 j = 0; j < rows; ++j)
+		{
+			const ndVector center(ndFloat32(i * 2), BoxHeight(i, j), ndFloat32(j * 2), ndFloat32(1.0f));
+			const ndVector size(ndFloat32(0.25f), ndFloat32(0.25f), ndFloat32(0.25f), ndFloat32(0.0f));
+			ndBodiesInAabbNotify callback;
+			world.GetScene()->BodiesInAabb(callback, center - size, center + size);
+			EXPECT_EQ(callback.m_bodyArray.GetCount(), 1);
+		}
+	}
+}
+
+/* A batch of rays must report the same closest hits
+   as casting the rays one at the time. */
+TEST(BvhBuild, RayCastBatchMatchesRayCast)
+{
+	const ndInt32 rows = 16;
+	ndWorld world;
+	world.SetThreadCount(4);
+	BuildFloatingBoxes(world, rows);
+	world.Update(1.0f / 60.0f);
+	world.Sync();
+
+	std::vector<ndFastRay> rays;
+	for (ndInt32 i = 0; i < 4 * rows; ++i)
+	{
+		for (ndInt32 j = 0; j < 4 * rows; ++j)
+		{
+			const ndVector p0(ndFloat32(i) * ndFloat32(0.5f) - ndFloat32(1.0f), ndFloat32(20.0f), ndFloat32(j) * ndFloat32(0.5f) - ndFloat32(1.0f), ndFloat32(0.0f));
+			const ndVector p1(p0.m_x + ndFloat32(3.0f), ndFloat32(-20.0f), p0.m_z + ndFloat32((i + j) % 3), ndFloat32(0.0f));
+			rays.push_back(ndFastRay(p0, p1));
+		}
+	}
+
+	const ndInt32 count = ndInt32(rays.size());
+	std::vector<ndRayCastHit> results(rays.size());
+	world.RayCastBatch(&rays[0], count, &results[0]);
+
+	ndInt32 hits = 0;
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		ndRayCastClosestHitCallback callback;
+		const bool hit = world.RayCast(callback, rays[i].m_p0, rays[i].m_p1);
+		EXPECT_EQ(hit, results[i].m_body != nullptr);
+		if (hit && results[i].m_body)
+		{
+			hits++;
+			EXPECT_EQ(results[i].m_body, callback.m_contact.m_body0);
+			EXPECT_NEAR(results[i].m_param, callback.m_param, ndFloat32(1.0e-4f));
+		}
+	}
+	EXPECT_GT(hits, 0);
+	EXPECT_LT(hits, count);
+}
+
+/* Boxes drifting across the scene degrade the tree, the scene must fix it
+   with rotation passes and rebuilds, and still find every box afterwards. */
+TEST(BvhBuild, RotatesAndRebuildsMovingScene)
+{
+	const ndInt32 rows = 16;
+	ndWorld world;
+	world.SetThreadCount(1);
+	BuildFloatingBoxes(world, rows);
+
+	ndArray<ndBodyDynamic*> boxes;
+	const ndBodyListView& bodyList = world.GetBodyList();
+	for (ndBodyListView::ndNode* node = bodyList.GetFirst(); node; node = node->GetNext())
+	{
+		ndBodyDynamic* const box = node->GetInfo()->GetAsBodyDynamic();
+		const ndInt32 index = boxes.GetCount();
+		const ndFloat32 vx = ndFloat32((index * 37) % 17 - 8) * ndFloat32(0.5f);
+		const ndFloat32 vz = ndFloat32((index * 53) % 13 - 6) * ndFloat32(0.5f);
+		box->SetVelocity(ndVector(vx, ndFloat32(0.0f), vz, ndFloat32(0.0f)));
+		boxes.PushBack(box);
+	}
+
+	const ndInt32 steps = 300;
+	for (ndInt32 i = 0; i < steps; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+	}
+
+	const ndScene* const scene = world.GetScene();
+	EXPECT_GT(scene->GetBvhRotationCount(), 0u);
+	EXPECT_GE(scene->GetBvhBuildCount(), 2u);
+	EXPECT_LT(scene->GetBvhBuildCount(), ndUnsigned32(steps / 2));
+
+	for (ndInt32 i = 0; i < boxes.GetCount(); ++i)
+	{
+		const ndVector center(boxes[i]->GetMatrix().m_posit);
+		const ndVector size(ndFloat32(0.25f), ndFloat32(0.25f), ndFloat32(0.25f), ndFloat32(0.0f));
+		ndBodiesInAabbNotify callback;
+		world.GetScene()->BodiesInAabb(callback, center - size, center + size);
+		bool found = false;
+		for (ndInt32 j = 0; j < callback.m_bodyArray.GetCount(); ++j)
+		{
+			found = found || (callback.m_bodyArray[j] == boxes[i]);
+		}
+		EXPECT_TRUE(found);
+	}
+}
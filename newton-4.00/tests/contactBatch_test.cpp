@@ -0,0 +1,127 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static ndBodyKinematic* AddBody(ndWorld& world, const ndShapeInstance& shape, const ndMatrix& matrix)
+{
+	ndBodyDynamic* const body = new ndBodyDynamic();
+	body->SetNotifyCallback(new ndBodyNotify(ndVector(ndFloat32(0.0f), ndFloat32(-10.0f), ndFloat32(0.0f), ndFloat32(0.0f))));
+	body->SetCollisionShape(shape);
+	body->SetMatrix(matrix);
+	body->SetMassMatrix(ndFloat32(1.0f), shape);
+	ndSharedPtr<ndBody> bodyPtr(body);
+	world.AddBody(bodyPtr);
+	return body;
+}
+
+/* Sphere to sphere and sphere to box pairs, in either body order, go through 
+   the batched narrow phase and get the same contacts as the single pair 
+   contact solver. */
+TEST(ContactBatch, MatchesSinglePairContacts)
+{
+	ndWorld world;
+	world.SetThreadCount(2);
+
+	ndShapeInstance floorShape(new ndShapeBox(ndFloat32(20.0f), ndFloat32(1.0f), ndFloat32(20.0f)));
+	ndMatrix floorMatrix(ndYawMatrix(ndFloat32(0.4f)));
+	floorMatrix.m_posit.m_y = ndFloat32(-0.5f);
+	ndBodyKinematic* const floor = new ndBodyKinematic();
+	floor->SetCollisionShape(floorShape);
+	floor->SetMatrix(floorMatrix);
+	ndSharedPtr<ndBody> floorPtr(floor);
+	world.AddBody(floorPtr);
+
+	// a dynamic box added before the spheres is the first body of its pairs
+	ndShapeInstance boxShape(new ndShapeBox(ndFloat32(1.0f), ndFloat32(1.0f), ndFloat32(1.0f)));
+	ndMatrix boxMatrix(ndGetIdentityMatrix());
+	boxMatrix.m_posit.m_y = ndFloat32(3.42f);
+	ndBodyKinematic* const box = AddBody(world, boxShape, boxMatrix);
+
+	// 27 slightly overlapping spheres, so that some batches are not full
+	ndShapeInstance sphere(new ndShapeSphere(ndFloat32(0.5f)));
+	ndFixSizeArray<ndMatrix, 32> matrices;
+	ndFixSizeArray<ndBodyKinematic*, 32> bodies;
+	for (ndInt32 i = 0; i < 27; ++i)
+	{
+		ndMatrix matrix(ndPitchMatrix(ndFloat32(i) * ndFloat32(0.3f)));
+		matrix.m_posit = ndVector(ndFloat32(i % 3) * ndFloat32(0.98f), ndFloat32(0.49f) + ndFloat32(i / 9) * ndFloat32(0.97f), ndFloat32((i / 3) % 3) * ndFloat32(0.99f), ndFloat32(1.0f));
+		matrices.PushBack(matrix);
+		bodies.PushBack(AddBody(world, sphere, matrix));
+	}
+
+	bodies.PushBack(floor);
+	matrices.PushBack(floorMatrix);
+	bodies.PushBack(box);
+	matrices.PushBack(boxMatrix);
+
+	// the contacts of the first step are calculated with the initial matrices
+	world.Update(1.0f / 60.0f);
+	world.Sync();
+
+	auto InitialMatrix = [&bodies, &matrices](const ndBodyKinematic* const body)
+	{
+		ndInt32 index = 0;
+		while (bodies[index] != body)
+		{
+			index++;
+		}
+		return matrices[index];
+	};
+
+	ndInt32 sphereSphere = 0;
+	ndInt32 sphereBox = 0;
+	ndInt32 boxSphere = 0;
+	const ndContactArray& contacts = world.GetContactList();
+	for (ndInt32 i = 0; i < contacts.GetCount(); ++i)
+	{
+		const ndContact* const contact = contacts[i];
+		if (!contact->IsActive() || !contact->GetContactPoints().GetCount())
+		{
+			continue;
+		}
+
+		const ndBodyKinematic* const body0 = contact->GetBody0();
+		const ndBodyKinematic* const body1 = contact->GetBody1();
+		const ndMatrix matrix0(InitialMatrix(body0));
+		const ndMatrix matrix1(InitialMatrix(body1));
+
+		ndContactSolver solver;
+		ndFixSizeArray<ndContactPoint, 16> expected;
+		solver.CalculateContacts(&body0->GetCollisionShape(), matrix0, ndVector::m_zero, &body1->GetCollisionShape(), matrix1, ndVector::m_zero, expected, nullptr);
+		ASSERT_EQ(contact->GetContactPoints().GetCount(), 1);
+		ASSERT_EQ(expected.GetCount(), 1);
+
+		const ndContactMaterial& point = contact->GetContactPoints().GetFirst()->GetInfo();
+		const ndVector pointError(point.m_point - expected[0].m_point);
+		const ndVector normalError(point.m_normal - expected[0].m_normal);
+		EXPECT_LT(pointError.DotProduct(pointError & ndVector::m_triplexMask).GetScalar(), ndFloat32(1.0e-8f));
+		EXPECT_LT(normalError.DotProduct(normalError).GetScalar(), ndFloat32(1.0e-8f));
+		EXPECT_NEAR(point.m_penetration, expected[0].m_penetration, ndFloat32(1.0e-5f));
+
+		if (body0->GetCollisionShape().GetShape()->GetCollisionId() == m_box)
+		{
+			boxSphere++;
+		}
+		else if (body1->GetCollisionShape().GetShape()->GetCollisionId() == m_box)
+		{
+			sphereBox++;
+		}
+		else
+		{
+			sphereSphere++;
+		}
+	}
+	EXPECT_GT(sphereBox, 4);
+	EXPECT_GT(sphereSphere, 4);
+	EXPECT_GT(boxSphere, 0);
+}
@@ -0,0 +1,102 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static void CheckContacts(ndWorld& world, const ndFixSizeArray<ndBodyKinematic*, 128>& bodies)
+{
+	const ndContactArray& contacts = world.GetContactList();
+	for (ndInt32 i = 0; i < contacts.GetCount(); ++i)
+	{
+		ndContact* const contact = contacts[i];
+		EXPECT_EQ(contact->GetBody0()->FindContact(contact->GetBody1()), contact);
+		EXPECT_EQ(contact->GetBody1()->FindContact(contact->GetBody0()), contact);
+	}
+
+	// every contact is in the map of its two bodies, and only once per pair
+	ndInt32 mapCount = 0;
+	for (ndInt32 i = 0; i < bodies.GetCount(); ++i)
+	{
+		const ndBodyKinematic::ndContactMap& contactMap = bodies[i]->GetContactMap();
+		EXPECT_TRUE(contactMap.SanityCheck());
+		mapCount += contactMap.GetCount();
+		for (ndInt32 j = 0; j < contactMap.GetCount(); ++j)
+		{
+			for (ndInt32 k = j + 1; k < contactMap.GetCount(); ++k)
+			{
+				const bool samePair = 
+					((contactMap[j]->GetBody0() == contactMap[k]->GetBody0()) && (contactMap[j]->GetBody1() == contactMap[k]->GetBody1())) ||
+					((contactMap[j]->GetBody0() == contactMap[k]->GetBody1()) && (contactMap[j]->GetBody1() == contactMap[k]->GetBody0()));
+				EXPECT_FALSE(samePair);
+			}
+		}
+	}
+	EXPECT_EQ(mapCount, 2 * contacts.GetCount());
+}
+
+/* New pairs are found through the scene pair map, each body keeps 
+   a flat array of its contacts, and removing a body drops its pairs. */
+TEST(ContactPairMap, PairsAreUniqueAndMapsConsistent)
+{
+	ndWorld world;
+	world.SetThreadCount(4);
+	ndFixSizeArray<ndBodyKinematic*, 128> bodies;
+
+	ndShapeInstance floorShape(new ndShapeBox(ndFloat32(40.0f), ndFloat32(1.0f), ndFloat32(40.0f)));
+	ndMatrix floorMatrix(ndGetIdentityMatrix());
+	floorMatrix.m_posit.m_y = ndFloat32(-0.5f);
+	ndBodyKinematic* const floor = new ndBodyKinematic();
+	floor->SetCollisionShape(floorShape);
+	floor->SetMatrix(floorMatrix);
+	ndSharedPtr<ndBody> floorPtr(floor);
+	world.AddBody(floorPtr);
+	bodies.PushBack(floor);
+
+	ndShapeInstance boxShape(new ndShapeBox(ndFloat32(0.9f), ndFloat32(0.9f), ndFloat32(0.9f)));
+	for (ndInt32 i = 0; i < 64; ++i)
+	{
+		ndMatrix matrix(ndYawMatrix(ndFloat32(i) * ndFloat32(0.2f)));
+		matrix.m_posit = ndVector(ndFloat32(i % 4), ndFloat32(0.5f) + ndFloat32(i / 16), ndFloat32((i / 4) % 4), ndFloat32(1.0f));
+
+		ndBodyDynamic* const body = new ndBodyDynamic();
+		body->SetNotifyCallback(new ndBodyNotify(ndVector(ndFloat32(0.0f), ndFloat32(-10.0f), ndFloat32(0.0f), ndFloat32(0.0f))));
+		body->SetCollisionShape(boxShape);
+		body->SetMatrix(matrix);
+		body->SetMassMatrix(ndFloat32(1.0f), boxShape);
+		body->SetAutoSleep(false);
+		ndSharedPtr<ndBody> bodyPtr(body);
+		world.AddBody(bodyPtr);
+		bodies.PushBack(body);
+	}
+
+	for (ndInt32 i = 0; i < 60; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+	}
+	EXPECT_GT(world.GetContactList().GetCount(), 64);
+	CheckContacts(world, bodies);
+
+	// remove the lower boxes, the boxes above fall on the floor
+	for (ndInt32 i = 16; i >= 1; --i)
+	{
+		world.RemoveBody(bodies[i]);
+		bodies[i] = bodies[bodies.GetCount() - 1];
+		bodies.SetCount(bodies.GetCount() - 1);
+	}
+	for (ndInt32 i = 0; i < 60; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+	}
+	CheckContacts(world, bodies);
+}
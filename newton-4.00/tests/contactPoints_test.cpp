@@ -0,0 +1,67 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+/* The contact points of a pair are contiguous, iterate in array order
+   and keep their forces from one frame to the next. */
+TEST(ContactPoints, ContiguousManifoldKeepsForces)
+{
+	ndWorld world;
+	world.SetThreadCount(1);
+
+	ndShapeInstance floorShape(new ndShapeBox(ndFloat32(20.0f), ndFloat32(1.0f), ndFloat32(20.0f)));
+	ndMatrix floorMatrix(ndGetIdentityMatrix());
+	floorMatrix.m_posit.m_y = ndFloat32(-0.5f);
+	ndBodyKinematic* const floor = new ndBodyKinematic();
+	floor->SetCollisionShape(floorShape);
+	floor->SetMatrix(floorMatrix);
+	ndSharedPtr<ndBody> floorPtr(floor);
+	world.AddBody(floorPtr);
+
+	ndShapeInstance boxShape(new ndShapeBox(ndFloat32(1.0f), ndFloat32(1.0f), ndFloat32(1.0f)));
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit.m_y = ndFloat32(0.75f);
+	ndBodyDynamic* const box = new ndBodyDynamic();
+	box->SetNotifyCallback(new ndBodyNotify(ndVector(ndFloat32(0.0f), ndFloat32(-10.0f), ndFloat32(0.0f), ndFloat32(0.0f))));
+	box->SetCollisionShape(boxShape);
+	box->SetMatrix(matrix);
+	box->SetMassMatrix(ndFloat32(1.0f), boxShape);
+	box->SetAutoSleep(false);
+	ndSharedPtr<ndBody> boxPtr(box);
+	world.AddBody(boxPtr);
+
+	for (ndInt32 i = 0; i < 30; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+	}
+
+	const ndContactArray& contacts = world.GetContactList();
+	ASSERT_EQ(contacts.GetCount(), 1);
+	const ndContactPointList& points = contacts[0]->GetContactPoints();
+	ASSERT_EQ(points.GetCount(), 4);
+
+	ndInt32 index = 0;
+	ndFloat32 normalForce = ndFloat32(0.0f);
+	for (ndContactPointList::ndNode* node = points.GetFirst(); node; node = node->GetNext())
+	{
+		EXPECT_EQ(&node->GetInfo(), &points[index]);
+		normalForce += node->GetInfo().m_normal_Force.m_force;
+		index++;
+	}
+	EXPECT_EQ(index, 4);
+
+	// the box rests, the warm started normal forces hold its weight
+	EXPECT_NEAR(normalForce, ndFloat32(10.0f), ndFloat32(0.5f));
+	EXPECT_EQ((const char*)&points[3] - (const char*)&points[0], ptrdiff_t(3 * sizeof(ndContactPointList::ndNode)));
+}
@@ -0,0 +1,66 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+/* A new world must run the best solver the cpu supports, and fall back to
+   the standard solver while the direct islands are enabled, unless the
+   application selected a solver. */
+TEST(CpuDispatch, SelectsBestSolver)
+{
+	ndWorld world;
+	EXPECT_EQ(world.GetSelectedSolver(), ndWorld::GetBestSolver());
+	if (ndCpuFeatures::HasFeatures(ndCpuFeatures::m_avx2 | ndCpuFeatures::m_fma))
+	{
+		EXPECT_NE(world.GetSelectedSolver(), ndWorld::ndSimdSoaSolver);
+	}
+
+	world.SetDirectSolverMaxRows(64);
+	EXPECT_EQ(world.GetSelectedSolver(), ndWorld::ndStandardSolver);
+	world.SetDirectSolverMaxRows(0);
+	EXPECT_EQ(world.GetSelectedSolver(), ndWorld::GetBestSolver());
+
+	world.SelectSolver(ndWorld::ndGaussSeidelSolver);
+	world.SetDirectSolverMaxRows(64);
+	EXPECT_EQ(world.GetSelectedSolver(), ndWorld::ndGaussSeidelSolver);
+	world.SetDirectSolverMaxRows(0);
+	EXPECT_EQ(world.GetSelectedSolver(), ndWorld::ndGaussSeidelSolver);
+}
+
+/* Hiding cpu features must make the best solver, and explicit
+   selections, fall back to the solvers older cpus can run. */
+TEST(CpuDispatch, FeatureMaskOverride)
+{
+	const ndUnsigned32 mask = ndCpuFeatures::GetFeatureMask();
+
+	ndCpuFeatures::SetFeatureMask(mask & ~ndUnsigned32(ndCpuFeatures::m_avx512));
+	{
+		ndWorld world;
+		EXPECT_NE(world.GetSelectedSolver(), ndWorld::ndSimdAvx512Solver);
+		world.SelectSolver(ndWorld::ndSimdAvx512Solver);
+		EXPECT_NE(world.GetSelectedSolver(), ndWorld::ndSimdAvx512Solver);
+	}
+
+	ndCpuFeatures::SetFeatureMask(mask & ~ndUnsigned32(ndCpuFeatures::m_avx512 | ndCpuFeatures::m_avx2));
+	{
+		ndWorld world;
+		EXPECT_EQ(world.GetSelectedSolver(), ndWorld::ndSimdSoaSolver);
+		world.SelectSolver(ndWorld::ndSimdAvx2Solver);
+		EXPECT_EQ(world.GetSelectedSolver(), ndWorld::ndSimdSoaSolver);
+		world.SelectSolver(ndWorld::ndStandardSolver);
+		EXPECT_EQ(world.GetSelectedSolver(), ndWorld::ndStandardSolver);
+	}
+
+	ndCpuFeatures::SetFeatureMask(mask);
+	ndWorld world;
+	EXPECT_EQ(world.GetSelectedSolver(), ndWorld::GetBestSolver());
+}
@@ -0,0 +1,81 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static void AddBody(ndWorld& world, const ndShapeInstance& shape, const ndVector& posit)
+{
+	ndMatrix matrix(ndPitchMatrix(posit.m_x) * ndYawMatrix(posit.m_z));
+	matrix.m_posit = posit;
+	matrix.m_posit.m_w = ndFloat32(1.0f);
+
+	ndBodyDynamic* const body = new ndBodyDynamic();
+	body->SetNotifyCallback(new ndBodyNotify(ndVector(ndFloat32(0.0f), ndFloat32(-10.0f), ndFloat32(0.0f), ndFloat32(0.0f))));
+	body->SetCollisionShape(shape);
+	body->SetMatrix(matrix);
+	body->SetMassMatrix(ndFloat32(1.0f), shape);
+	ndSharedPtr<ndBody> bodyPtr(body);
+	world.AddBody(bodyPtr);
+}
+
+static void BuildScene(ndWorld& world)
+{
+	ndShapeInstance floorShape(new ndShapeBox(ndFloat32(100.0f), ndFloat32(1.0f), ndFloat32(100.0f)));
+	ndMatrix floorMatrix(ndGetIdentityMatrix());
+	floorMatrix.m_posit.m_y = ndFloat32(-0.5f);
+	ndBodyKinematic* const floor = new ndBodyKinematic();
+	floor->SetCollisionShape(floorShape);
+	floor->SetMatrix(floorMatrix);
+	ndSharedPtr<ndBody> floorPtr(floor);
+	world.AddBody(floorPtr);
+
+	ndShapeInstance box(new ndShapeBox(ndFloat32(1.0f), ndFloat32(0.5f), ndFloat32(0.75f)));
+	ndShapeInstance sphere(new ndShapeSphere(ndFloat32(0.4f)));
+	for (ndInt32 i = 0; i < 8; ++i)
+	{
+		for (ndInt32 j = 0; j < 8; ++j)
+		{
+			for (ndInt32 k = 0; k < 4; ++k)
+			{
+				const ndVector posit(ndFloat32(i) * ndFloat32(0.9f), ndFloat32(1.0f + k * 1.2f), ndFloat32(j) * ndFloat32(0.8f), ndFloat32(1.0f));
+				AddBody(world, ((i + j + k) & 1) ? box : sphere, posit);
+			}
+		}
+	}
+}
+
+static ndUnsigned64 RunScene(ndInt32 threadCount, ndInt32 frames)
+{
+	ndWorld world;
+	world.SetThreadCount(threadCount);
+	world.SetDeterministicMode(true);
+	BuildScene(world);
+	for (ndInt32 i = 0; i < frames; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+	}
+	world.Sync();
+	return world.CalculateStateHash();
+}
+
+/* A pile of bodies falling on each other ends in the
+   same state for any number of threads. */
+TEST(Determinism, SameStateForAnyThreadCount)
+{
+	const ndUnsigned64 hash = RunScene(1, 90);
+	EXPECT_NE(hash, RunScene(1, 89));
+	EXPECT_EQ(hash, RunScene(1, 90));
+	EXPECT_EQ(hash, RunScene(2, 90));
+	EXPECT_EQ(hash, RunScene(3, 90));
+	EXPECT_EQ(hash, RunScene(4, 90));
+	EXPECT_EQ(hash, RunScene(8, 90));
+}
@@ -0,0 +1,134 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static ndBodyDynamic* AddBox(ndWorld& world, const ndVector& size, ndFloat32 mass, ndFloat32 height)
+{
+	ndShapeInstance shape(new ndShapeBox(size.m_x, size.m_y, size.m_z));
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit.m_y = height;
+
+	ndBodyDynamic* const box = new ndBodyDynamic();
+	box->SetNotifyCallback(new ndBodyNotify(ndVector(ndFloat32(0.0f), ndFloat32(-10.0f), ndFloat32(0.0f), ndFloat32(0.0f))));
+	box->SetCollisionShape(shape);
+	box->SetMatrix(matrix);
+	box->SetMassMatrix(mass, shape);
+	ndSharedPtr<ndBody> boxPtr(box);
+	world.AddBody(boxPtr);
+	return box;
+}
+
+static ndBodyDynamic* BuildHeavyCrate(ndWorld& world)
+{
+	ndShapeInstance floorShape(new ndShapeBox(ndFloat32(20.0f), ndFloat32(1.0f), ndFloat32(20.0f)));
+	ndMatrix floorMatrix(ndGetIdentityMatrix());
+	floorMatrix.m_posit.m_y = ndFloat32(-0.5f);
+	ndBodyKinematic* const floor = new ndBodyKinematic();
+	floor->SetCollisionShape(floorShape);
+	floor->SetMatrix(floorMatrix);
+	ndSharedPtr<ndBody> floorPtr(floor);
+	world.AddBody(floorPtr);
+
+	// a heavy crate on top of a light pallet
+	const ndVector palletSize(ndFloat32(2.0f), ndFloat32(0.25f), ndFloat32(2.0f), ndFloat32(0.0f));
+	const ndVector crateSize(ndFloat32(1.5f), ndFloat32(1.5f), ndFloat32(1.5f), ndFloat32(0.0f));
+	AddBox(world, palletSize, ndFloat32(1.0f), ndFloat32(0.125f));
+	return AddBox(world, crateSize, ndFloat32(500.0f), ndFloat32(0.25f + 0.75f));
+}
+
+static ndFloat32 SimulateHeavyCrate(ndInt32 directRows)
+{
+	ndWorld world;
+	world.SetThreadCount(2);
+	world.SelectSolver(ndWorld::ndStandardSolver);
+	world.SetDirectSolverMaxRows(directRows);
+	ndBodyDynamic* const crate = BuildHeavyCrate(world);
+	ndFloat32 error = ndFloat32(0.0f);
+	for (ndInt32 i = 0; i < 120; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+		error = ndMax(error, ndAbs(crate->GetMatrix().m_posit.m_y - ndFloat32(1.0f)));
+	}
+	return error;
+}
+
+/* A crate hundreds of times heavier than the pallet under it sinks
+   into it with the iterative passes, the direct solver must hold it. */
+TEST(DirectSolver, HeavyCrateOnLightPallet)
+{
+	const ndFloat32 iterativeError = SimulateHeavyCrate(0);
+	const ndFloat32 directError = SimulateHeavyCrate(64);
+	EXPECT_LT(directError, ndFloat32(0.05f));
+	EXPECT_LT(directError, iterativeError * ndFloat32(0.5f));
+}
+
+/* Joints submit fewer rows than their max dof, a chain of hinges solved 
+   by the direct solver must size its matrix from the rows of the step. */
+TEST(DirectSolver, HingeChainKeepsItsPivots)
+{
+	const ndInt32 links = 3;
+	ndWorld world;
+	world.SetThreadCount(1);
+	world.SelectSolver(ndWorld::ndStandardSolver);
+	world.SetDirectSolverMaxRows(64);
+
+	// a chain of boards hanging sideways from the world, so that it swings
+	ndBodyDynamic* bodies[links];
+	ndUnsigned32 maxRows = 0;
+	ndBodyKinematic* parent = world.GetSentinelBody();
+	const ndVector size(ndFloat32(1.0f), ndFloat32(0.1f), ndFloat32(0.5f), ndFloat32(0.0f));
+	for (ndInt32 i = 0; i < links; ++i)
+	{
+		bodies[i] = AddBox(world, size, ndFloat32(1.0f), ndFloat32(10.0f));
+		ndMatrix matrix(bodies[i]->GetMatrix());
+		matrix.m_posit.m_x = ndFloat32(i) + ndFloat32(0.5f);
+		bodies[i]->SetMatrix(matrix);
+
+		ndMatrix pivot(ndGetIdentityMatrix());
+		pivot.m_front = ndVector(ndFloat32(0.0f), ndFloat32(0.0f), ndFloat32(1.0f), ndFloat32(0.0f));
+		pivot.m_up = ndVector(ndFloat32(0.0f), ndFloat32(1.0f), ndFloat32(0.0f), ndFloat32(0.0f));
+		pivot.m_right = ndVector(ndFloat32(-1.0f), ndFloat32(0.0f), ndFloat32(0.0f), ndFloat32(0.0f));
+		pivot.m_posit = ndVector(ndFloat32(i), ndFloat32(10.0f), ndFloat32(0.0f), ndFloat32(1.0f));
+		ndJointBilateralConstraint* const hinge = new ndJointHinge(pivot, bodies[i], parent);
+		ndSharedPtr<ndJointBilateralConstraint> hingePtr(hinge);
+		world.AddJoint(hingePtr);
+		maxRows += hinge->GetRowsCount();
+		parent = bodies[i];
+	}
+
+	ndFloat32 error = ndFloat32(0.0f);
+	for (ndInt32 i = 0; i < 60; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+		ndVector pivot(ndFloat32(0.0f), ndFloat32(10.0f), ndFloat32(0.0f), ndFloat32(1.0f));
+		for (ndInt32 j = 0; j < links; ++j)
+		{
+			// the link is centered half a length away from its pivot
+			const ndMatrix& matrix = bodies[j]->GetMatrix();
+			const ndVector end(matrix.TransformVector(ndVector(ndFloat32(-0.5f), ndFloat32(0.0f), ndFloat32(0.0f), ndFloat32(1.0f))));
+			const ndVector step(end - pivot);
+			error = ndMax(error, ndSqrt(step.DotProduct(step & ndVector::m_triplexMask).GetScalar()));
+			pivot = matrix.TransformVector(ndVector(ndFloat32(0.5f), ndFloat32(0.0f), ndFloat32(0.0f), ndFloat32(1.0f)));
+		}
+	}
+	EXPECT_LT(error, ndFloat32(0.05f));
+	EXPECT_LT(bodies[links - 1]->GetMatrix().m_posit.m_y, ndFloat32(9.0f));
+
+	ndSolverIslandStats stats[4];
+	EXPECT_EQ(world.GetSolverIslandStats(stats, 4), 1);
+	EXPECT_EQ(stats[0].m_jointCount, links);
+	EXPECT_GT(stats[0].m_rowCount, 0);
+	EXPECT_LT(ndUnsigned32(stats[0].m_rowCount), maxRows);
+}
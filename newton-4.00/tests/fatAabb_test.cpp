@@ -0,0 +1,81 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static ndBodyDynamic* AddSphere(ndWorld& world, const ndShapeInstance& shape, ndFloat32 x, ndFloat32 z)
+{
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit.m_x = x;
+	matrix.m_posit.m_z = z;
+
+	ndBodyDynamic* const body = new ndBodyDynamic();
+	body->SetNotifyCallback(new ndBodyNotify(ndVector::m_zero));
+	body->SetCollisionShape(shape);
+	body->SetMatrix(matrix);
+	body->SetMassMatrix(ndFloat32(1.0f), shape);
+	ndSharedPtr<ndBody> bodyPtr(body);
+	world.AddBody(bodyPtr);
+	return body;
+}
+
+/* A slow body inside its fat leaf box must not walk the bvh for new pairs,
+   once it leaves the box it walks it again and finds the pair it moves into. */
+TEST(FatAabb, SlowBodySkipsPairQueries)
+{
+	ndWorld world;
+	world.SetThreadCount(1);
+
+	ndShapeInstance shape(new ndShapeSphere(ndFloat32(0.5f)));
+	for (ndInt32 i = 0; i < 8; ++i)
+	{
+		AddSphere(world, shape, ndFloat32(i * 4), ndFloat32(10.0f));
+	}
+	ndBodyDynamic* const target = AddSphere(world, shape, ndFloat32(1.6f), ndFloat32(0.0f));
+	ndBodyDynamic* const mover = AddSphere(world, shape, ndFloat32(0.0f), ndFloat32(0.0f));
+	mover->SetVelocity(ndVector(ndFloat32(0.5f), ndFloat32(0.0f), ndFloat32(0.0f), ndFloat32(0.0f)));
+
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+	}
+
+	// the padding is about 0.14, at half a meter per second 
+	// the body leaves its box about every 17 steps.
+	world.EnableFrameStats(true);
+	const ndInt32 steps = 51;
+	ndInt32 queries = 0;
+	for (ndInt32 i = 0; i < steps; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+		queries += ndInt32(world.GetFrameStats().m_counters[ndFrameStats::m_pairQueries]);
+	}
+	EXPECT_GT(queries, 0);
+	EXPECT_LE(queries, 4);
+
+	bool touching = false;
+	for (ndInt32 i = 0; (i < 120) && !touching; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+		const ndContactArray& contacts = world.GetContactList();
+		for (ndInt32 j = 0; j < contacts.GetCount(); ++j)
+		{
+			const ndContact* const contact = contacts[j];
+			const bool pair = ((contact->GetBody0() == mover) && (contact->GetBody1() == target)) || ((contact->GetBody0() == target) && (contact->GetBody1() == mover));
+			touching = touching || (pair && contact->IsActive() && contact->GetContactPoints().GetCount());
+		}
+	}
+	EXPECT_TRUE(touching);
+}
@@ -0,0 +1,42 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+/* Arena memory must be aligned, and after a frame that overflowed
+   the first block a reset must leave room for the whole frame. */
+TEST(FrameArena, ResetKeepsPeakCapacity)
+{
+	ndFrameArena arena;
+	const ndInt32 allocations = 64;
+	const ndInt32 size = 4000;
+	for (ndInt32 frame = 0; frame < 3; ++frame)
+	{
+		ndInt8* previous = nullptr;
+		for (ndInt32 i = 0; i < allocations; ++i)
+		{
+			ndInt8* const ptr = arena.Alloc<ndInt8>(size - i);
+			EXPECT_EQ(ndUnsigned64(ptr) & (D_FRAME_ARENA_ALIGNMENT - 1), ndUnsigned64(0));
+			if (frame && previous)
+			{
+				// after the first reset all allocations come from one block
+				EXPECT_GT(ptr, previous);
+			}
+			previous = ptr;
+			memset(ptr, i, size_t(size - i));
+		}
+		EXPECT_GE(arena.GetUsedSize(), allocations * (size - allocations));
+		arena.Reset();
+		EXPECT_EQ(arena.GetUsedSize(), 0);
+		EXPECT_GE(arena.GetPeakSize(), allocations * (size - allocations));
+	}
+}
@@ -0,0 +1,153 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static void BuildScene(ndWorld& world)
+{
+	ndShapeInstance floorShape(new ndShapeBox(ndFloat32(100.0f), ndFloat32(1.0f), ndFloat32(100.0f)));
+	ndMatrix floorMatrix(ndGetIdentityMatrix());
+	floorMatrix.m_posit.m_y = ndFloat32(-0.5f);
+	ndBodyKinematic* const floor = new ndBodyKinematic();
+	floor->SetCollisionShape(floorShape);
+	floor->SetMatrix(floorMatrix);
+	ndSharedPtr<ndBody> floorPtr(floor);
+	world.AddBody(floorPtr);
+
+	// cylinders, sphere to box pairs do not use gjk
+	ndShapeInstance shape(new ndShapeCylinder(ndFloat32(0.5f), ndFloat32(0.5f), ndFloat32(1.0f)));
+	for (ndInt32 i = 0; i < 32; ++i)
+	{
+		ndMatrix matrix(ndGetIdentityMatrix());
+		matrix.m_posit.m_x = ndFloat32(i % 8) * ndFloat32(1.5f);
+		matrix.m_posit.m_y = ndFloat32(1.0f);
+		matrix.m_posit.m_z = ndFloat32(i / 8) * ndFloat32(1.5f);
+
+		ndBodyDynamic* const body = new ndBodyDynamic();
+		body->SetNotifyCallback(new ndBodyNotify(ndVector(ndFloat32(0.0f), ndFloat32(-10.0f), ndFloat32(0.0f), ndFloat32(0.0f))));
+		body->SetCollisionShape(shape);
+		body->SetMatrix(matrix);
+		body->SetMassMatrix(ndFloat32(1.0f), shape);
+		ndSharedPtr<ndBody> bodyPtr(body);
+		world.AddBody(bodyPtr);
+	}
+}
+
+static ndInt32 FindZone(const ndFrameStats& stats, const char* const name)
+{
+	for (ndInt32 i = 0; i < stats.m_zones.GetCount(); ++i)
+	{
+		if (!strcmp(stats.m_zones[i].m_name, name))
+		{
+			return i;
+		}
+	}
+	return -1;
+}
+
+/* The stats of an update have the zones of all threads under
+   one tree, the contact counters and the time of every thread. */
+TEST(FrameStats, CollectsZonesCountersAndThreads)
+{
+	// the simd solvers count no islands
+	ndWorld world;
+	world.SelectSolver(ndWorld::ndStandardSolver);
+	world.SetThreadCount(2);
+	BuildScene(world);
+
+	world.Update(1.0f / 60.0f);
+	world.Sync();
+	EXPECT_EQ(world.GetFrameStats().m_zones.GetCount(), 0);
+
+	// run until the spheres land
+	world.EnableFrameStats(true);
+	for (ndInt32 i = 0; i < 20; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+	}
+
+	const ndFrameStats& stats = world.GetFrameStats();
+	EXPECT_EQ(stats.m_frameNumber, world.GetFrameNumber());
+	ASSERT_GT(stats.m_zones.GetCount(), 1);
+
+	// a single root, parents come before their children
+	EXPECT_STREQ(stats.m_zones[0].m_name, "ThreadUpdate");
+	EXPECT_EQ(stats.m_zones[0].m_calls, 1u);
+	EXPECT_LE(stats.m_zones[0].m_time, stats.m_frameTime);
+	for (ndInt32 i = 1; i < stats.m_zones.GetCount(); ++i)
+	{
+		const ndFrameStats::ndZone& zone = stats.m_zones[i];
+		ASSERT_GE(zone.m_parent, 0);
+		ASSERT_LT(zone.m_parent, i);
+		EXPECT_EQ(zone.m_depth, stats.m_zones[zone.m_parent].m_depth + 1);
+	}
+
+	// jobs run by the workers are merged under the zone that dispatched them
+	const ndInt32 transforms = FindZone(stats, "TransformUpdate");
+	ASSERT_GE(transforms, 0);
+	EXPECT_GE(stats.m_zones[transforms].m_calls, ndUnsigned32(world.GetThreadCount()));
+	EXPECT_GE(stats.m_zones[transforms].m_parent, 0);
+
+	EXPECT_GT(stats.m_counters[ndFrameStats::m_pairsTested], 0u);
+	EXPECT_GT(stats.m_counters[ndFrameStats::m_contactsGenerated], 0u);
+	EXPECT_GT(stats.m_counters[ndFrameStats::m_gjkIterations], 0u);
+	EXPECT_GT(stats.m_counters[ndFrameStats::m_islands], 0u);
+	EXPECT_GT(stats.m_counters[ndFrameStats::m_solverPasses], 0u);
+	EXPECT_GT(stats.m_counters[ndFrameStats::m_bodiesAwake], 0u);
+	EXPECT_LE(stats.m_counters[ndFrameStats::m_bodiesAwake], 32u);
+
+	ASSERT_EQ(stats.m_threads.GetCount(), world.GetThreadCount());
+	for (ndInt32 i = 0; i < stats.m_threads.GetCount(); ++i)
+	{
+		EXPECT_GT(stats.m_threads[i].m_busy, 0.0);
+		EXPECT_NEAR(stats.m_threads[i].m_busy + stats.m_threads[i].m_idle, stats.m_frameTime, 1.0e-3);
+	}
+
+	EXPECT_TRUE(stats.ExportCsv("frameStats_test.csv"));
+	EXPECT_TRUE(stats.ExportJson("frameStats_test.json"));
+	remove("frameStats_test.csv");
+	remove("frameStats_test.json");
+
+	world.EnableFrameStats(false);
+	EXPECT_EQ(world.GetFrameStats().m_zones.GetCount(), 0);
+}
+
+/* Every solver reports the passes of all sub steps, only the
+   standard and Gauss Seidel solvers split the joints in islands. */
+TEST(FrameStats, EverySolverCountsIslandsAndPasses)
+{
+	const ndWorld::ndSolverModes solvers[] = { ndWorld::ndStandardSolver, ndWorld::ndGaussSeidelSolver, ndWorld::ndSimdSoaSolver, ndWorld::GetBestSolver() };
+	for (ndInt32 i = 0; i < ndInt32(sizeof(solvers) / sizeof(solvers[0])); ++i)
+	{
+		ndWorld world;
+		world.SetThreadCount(2);
+		world.SetSubSteps(2);
+		world.SelectSolver(solvers[i]);
+		world.EnableFrameStats(true);
+		BuildScene(world);
+		for (ndInt32 j = 0; j < 20; ++j)
+		{
+			world.Update(1.0f / 60.0f);
+			world.Sync();
+		}
+
+		// each cylinder rests alone on the floor, and every island 
+		// runs at least one pass in each of the four solver steps.
+		const ndFrameStats& stats = world.GetFrameStats();
+		const bool hasIslands = (solvers[i] == ndWorld::ndStandardSolver) || (solvers[i] == ndWorld::ndGaussSeidelSolver);
+		const ndUnsigned64 islands = hasIslands ? 32u : 0u;
+		EXPECT_EQ(stats.m_counters[ndFrameStats::m_islands], islands) << world.GetSolverString();
+		EXPECT_GE(stats.m_counters[ndFrameStats::m_solverPasses], 2 * 4 * ndMax(islands, ndUnsigned64(1))) << world.GetSolverString();
+	}
+}
@@ -0,0 +1,111 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static ndBodyDynamic* BuildBoxStack(ndWorld& world, ndInt32 height)
+{
+	ndShapeInstance floorShape(new ndShapeBox(ndFloat32(20.0f), ndFloat32(1.0f), ndFloat32(20.0f)));
+	ndMatrix floorMatrix(ndGetIdentityMatrix());
+	floorMatrix.m_posit.m_y = ndFloat32(-0.5f);
+	ndBodyKinematic* const floor = new ndBodyKinematic();
+	floor->SetCollisionShape(floorShape);
+	floor->SetMatrix(floorMatrix);
+	ndSharedPtr<ndBody> floorPtr(floor);
+	world.AddBody(floorPtr);
+
+	ndBodyDynamic* top = nullptr;
+	ndShapeInstance boxShape(new ndShapeBox(ndFloat32(1.0f), ndFloat32(1.0f), ndFloat32(1.0f)));
+	for (ndInt32 i = 0; i < height; ++i)
+	{
+		ndMatrix matrix(ndGetIdentityMatrix());
+		matrix.m_posit.m_y = ndFloat32(0.5f) + ndFloat32(i);
+
+		top = new ndBodyDynamic();
+		top->SetNotifyCallback(new ndBodyNotify(ndVector(ndFloat32(0.0f), ndFloat32(-10.0f), ndFloat32(0.0f), ndFloat32(0.0f))));
+		top->SetCollisionShape(boxShape);
+		top->SetMatrix(matrix);
+		top->SetMassMatrix(ndFloat32(1.0f), boxShape);
+		ndSharedPtr<ndBody> boxPtr(top);
+		world.AddBody(boxPtr);
+	}
+	return top;
+}
+
+/* A stack of boxes resting on the floor must stay
+   standing when solved with the graph colored solver. */
+TEST(GaussSeidelSolver, BoxStackStaysStanding)
+{
+	const ndInt32 height = 10;
+	ndWorld world;
+	world.SetThreadCount(2);
+	world.SelectSolver(ndWorld::ndGaussSeidelSolver);
+	EXPECT_EQ(world.GetSelectedSolver(), ndWorld::ndGaussSeidelSolver);
+
+	ndBodyDynamic* const top = BuildBoxStack(world, height);
+	for (ndInt32 i = 0; i < 240; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+	}
+
+	const ndVector posit(top->GetMatrix().m_posit);
+	EXPECT_NEAR(posit.m_y, ndFloat32(height) - ndFloat32(0.5f), ndFloat32(0.05f));
+	EXPECT_NEAR(posit.m_x, ndFloat32(0.0f), ndFloat32(0.25f));
+	EXPECT_NEAR(posit.m_z, ndFloat32(0.0f), ndFloat32(0.25f));
+}
+
+// sum of the box speeds of a stack resting on the floor after a few steps, 
+// a solver that converges stops all the boxes. sleeping is off, so that 
+// bodies at rest do not skip the joints of the boxes above them.
+static ndFloat32 StackVelocityResidual(ndWorld::ndSolverModes solver, ndInt32 iterations)
+{
+	const ndInt32 height = 16;
+	ndWorld world;
+	world.SetThreadCount(1);
+	world.SelectSolver(solver);
+	world.SetSolverIterations(iterations);
+	BuildBoxStack(world, height);
+
+	const ndBodyListView& bodyList = world.GetBodyList();
+	for (ndBodyListView::ndNode* node = bodyList.GetFirst(); node; node = node->GetNext())
+	{
+		node->GetInfo()->GetAsBodyKinematic()->SetAutoSleep(false);
+	}
+
+	for (ndInt32 i = 0; i < 10; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+	}
+
+	ndFloat32 residual = ndFloat32(0.0f);
+	for (ndBodyListView::ndNode* node = bodyList.GetFirst(); node; node = node->GetNext())
+	{
+		const ndVector veloc(node->GetInfo()->GetVelocity() & ndVector::m_triplexMask);
+		residual += ndSqrt(veloc.DotProduct(veloc).GetScalar());
+	}
+	return residual;
+}
+
+/* Each joint of the colored solver sees the forces of the joints solved before it, 
+   so it must leave a smaller error than the Jacobi solver. The standard solver runs 
+   at least as many passes, the iterations plus the extra passes of the stack. */
+TEST(GaussSeidelSolver, ConvergesFasterThanJacobi)
+{
+	for (ndInt32 iterations = 4; iterations <= 16; iterations *= 2)
+	{
+		const ndFloat32 jacobi = StackVelocityResidual(ndWorld::ndStandardSolver, iterations);
+		const ndFloat32 gaussSeidel = StackVelocityResidual(ndWorld::ndGaussSeidelSolver, iterations);
+		EXPECT_LT(gaussSeidel, jacobi);
+	}
+}
@@ -0,0 +1,96 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static ndMatrix Location(ndFloat32 x, ndFloat32 y, ndFloat32 z, ndFloat32 yaw = ndFloat32(0.0f))
+{
+	ndMatrix matrix(ndYawMatrix(yaw));
+	matrix.m_posit = ndVector(x, y, z, ndFloat32(1.0f));
+	return matrix;
+}
+
+static ndInt32 Collide(const ndShapeInstance& shape0, const ndMatrix& matrix0, const ndShapeInstance& shape1, const ndMatrix& matrix1, ndFixSizeArray<ndContactPoint, 16>& contacts)
+{
+	ndContactSolver solver;
+	contacts.SetCount(0);
+	solver.CalculateContacts(&shape0, matrix0, ndVector::m_zero, &shape1, matrix1, ndVector::m_zero, contacts, nullptr);
+	return contacts.GetCount();
+}
+
+static ndShapeInstance BoxHull(ndFloat32 x, ndFloat32 y, ndFloat32 z)
+{
+	ndFloat32 points[8][3];
+	for (ndInt32 i = 0; i < 8; ++i)
+	{
+		points[i][0] = (i & 1) ? x * ndFloat32(0.5f) : x * ndFloat32(-0.5f);
+		points[i][1] = (i & 2) ? y * ndFloat32(0.5f) : y * ndFloat32(-0.5f);
+		points[i][2] = (i & 4) ? z * ndFloat32(0.5f) : z * ndFloat32(-0.5f);
+	}
+	return ndShapeInstance(new ndShapeConvexHull(8, 3 * sizeof(ndFloat32), ndFloat32(0.0f), &points[0][0]));
+}
+
+/* Sphere, capsule and box pairs get the same contacts in both shape
+   orders, and match what gjk finds on an equivalent convex hull. */
+TEST(PrimitiveContacts, MatchGjkResults)
+{
+	const ndShapeInstance box(new ndShapeBox(ndFloat32(2.0f), ndFloat32(1.0f), ndFloat32(2.0f)));
+	const ndShapeInstance hull(BoxHull(ndFloat32(2.0f), ndFloat32(1.0f), ndFloat32(2.0f)));
+	const ndShapeInstance sphere(new ndShapeSphere(ndFloat32(0.5f)));
+	const ndMatrix boxMatrix(Location(ndFloat32(0.0f), ndFloat32(-0.5f), ndFloat32(0.0f), ndFloat32(0.3f)));
+	const ndMatrix sphereMatrix(Location(ndFloat32(0.2f), ndFloat32(0.45f), ndFloat32(0.1f)));
+
+	ndFixSizeArray<ndContactPoint, 16> contacts;
+	ndFixSizeArray<ndContactPoint, 16> gjkContacts;
+	ASSERT_EQ(Collide(sphere, sphereMatrix, box, boxMatrix, contacts), 1);
+	ASSERT_EQ(Collide(sphere, sphereMatrix, hull, boxMatrix, gjkContacts), 1);
+	EXPECT_NEAR(contacts[0].m_normal.m_y, ndFloat32(1.0f), ndFloat32(1.0e-4f));
+	EXPECT_NEAR(contacts[0].m_penetration, gjkContacts[0].m_penetration, ndFloat32(1.0e-3f));
+	EXPECT_NEAR(contacts[0].m_point.m_x, ndFloat32(0.2f), ndFloat32(1.0e-3f));
+
+	// the other order flips the normal
+	ASSERT_EQ(Collide(box, boxMatrix, sphere, sphereMatrix, contacts), 1);
+	EXPECT_NEAR(contacts[0].m_normal.m_y, ndFloat32(-1.0f), ndFloat32(1.0e-4f));
+
+	// a capsule resting on a box face touches at both ends
+	const ndShapeInstance capsule(new ndShapeCapsule(ndFloat32(0.25f), ndFloat32(0.25f), ndFloat32(1.0f)));
+	const ndMatrix capsuleMatrix(Location(ndFloat32(0.0f), ndFloat32(0.24f), ndFloat32(0.0f), ndFloat32(0.5f)));
+	ASSERT_EQ(Collide(capsule, capsuleMatrix, box, boxMatrix, contacts), 2);
+	ASSERT_EQ(Collide(capsule, capsuleMatrix, hull, boxMatrix, gjkContacts), 2);
+	for (ndInt32 i = 0; i < 2; ++i)
+	{
+		EXPECT_NEAR(contacts[i].m_normal.m_y, ndFloat32(1.0f), ndFloat32(1.0e-4f));
+		EXPECT_NEAR(contacts[i].m_penetration, gjkContacts[0].m_penetration, ndFloat32(1.0e-3f));
+		EXPECT_NEAR(ndAbs(contacts[i].m_point.DotProduct(capsuleMatrix.m_front).GetScalar()), ndFloat32(0.5f), ndFloat32(1.0e-3f));
+	}
+
+	// tilted, only the lower end touches
+	const ndMatrix tiltedMatrix(ndRollMatrix(ndFloat32(0.2f)) * Location(ndFloat32(0.0f), ndFloat32(0.33f), ndFloat32(0.0f)));
+	ASSERT_EQ(Collide(capsule, tiltedMatrix, box, boxMatrix, contacts), 1);
+	ASSERT_EQ(Collide(capsule, tiltedMatrix, hull, boxMatrix, gjkContacts), 1);
+	EXPECT_NEAR(contacts[0].m_penetration, gjkContacts[0].m_penetration, ndFloat32(1.0e-3f));
+	EXPECT_NEAR(contacts[0].m_point.m_x, gjkContacts[0].m_point.m_x, ndFloat32(1.0e-2f));
+
+	// parallel capsules touch along the overlap, crossed capsules at one point
+	const ndMatrix sideMatrix(Location(ndFloat32(0.498f), ndFloat32(0.24f), ndFloat32(0.286f), ndFloat32(0.5f)));
+	ASSERT_EQ(Collide(capsule, capsuleMatrix, capsule, sideMatrix, contacts), 2);
+	EXPECT_NEAR(contacts[0].m_penetration, contacts[1].m_penetration, ndFloat32(1.0e-5f));
+	const ndMatrix crossMatrix(Location(ndFloat32(0.0f), ndFloat32(0.7f), ndFloat32(0.0f), ndFloat32(2.0f)));
+	ASSERT_EQ(Collide(capsule, capsuleMatrix, capsule, crossMatrix, contacts), 1);
+	EXPECT_NEAR(contacts[0].m_normal.m_y, ndFloat32(-1.0f), ndFloat32(1.0e-4f));
+	EXPECT_NEAR(contacts[0].m_point.m_y, ndFloat32(0.47f), ndFloat32(1.0e-3f));
+
+	// separated spheres have no contacts
+	EXPECT_EQ(Collide(sphere, sphereMatrix, sphere, Location(ndFloat32(1.25f), ndFloat32(0.45f), ndFloat32(0.1f)), contacts), 0);
+	EXPECT_EQ(Collide(sphere, sphereMatrix, sphere, Location(ndFloat32(1.1f), ndFloat32(0.45f), ndFloat32(0.1f)), contacts), 1);
+	EXPECT_NEAR(contacts[0].m_normal.m_x, ndFloat32(-1.0f), ndFloat32(1.0e-4f));
+}
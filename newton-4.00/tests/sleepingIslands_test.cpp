@@ -0,0 +1,131 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static ndBodyDynamic* AddBox(ndWorld& world, ndFloat32 x, ndFloat32 y, ndFloat32 z)
+{
+	ndShapeInstance shape(new ndShapeBox(ndFloat32(1.0f), ndFloat32(1.0f), ndFloat32(1.0f)));
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit.m_x = x;
+	matrix.m_posit.m_y = y;
+	matrix.m_posit.m_z = z;
+
+	ndBodyDynamic* const box = new ndBodyDynamic();
+	box->SetNotifyCallback(new ndBodyNotify(ndVector(ndFloat32(0.0f), ndFloat32(-10.0f), ndFloat32(0.0f), ndFloat32(0.0f))));
+	box->SetCollisionShape(shape);
+	box->SetMatrix(matrix);
+	box->SetMassMatrix(ndFloat32(1.0f), shape);
+	ndSharedPtr<ndBody> boxPtr(box);
+	world.AddBody(boxPtr);
+	return box;
+}
+
+static void BuildScene(ndWorld& world, ndBodyDynamic** const stack, ndInt32 stackHigh)
+{
+	ndShapeInstance floorShape(new ndShapeBox(ndFloat32(100.0f), ndFloat32(1.0f), ndFloat32(100.0f)));
+	ndMatrix floorMatrix(ndGetIdentityMatrix());
+	floorMatrix.m_posit.m_y = ndFloat32(-0.5f);
+	ndBodyKinematic* const floor = new ndBodyKinematic();
+	floor->SetCollisionShape(floorShape);
+	floor->SetMatrix(floorMatrix);
+	ndSharedPtr<ndBody> floorPtr(floor);
+	world.AddBody(floorPtr);
+
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		AddBox(world, ndFloat32(i * 4 - 8), ndFloat32(0.5f), ndFloat32(6.0f));
+	}
+	for (ndInt32 i = 0; i < stackHigh; ++i)
+	{
+		stack[i] = AddBox(world, ndFloat32(0.0f), ndFloat32(0.5f) + ndFloat32(i), ndFloat32(0.0f));
+	}
+}
+
+static bool RunUntilFrozen(ndWorld& world, ndInt32 frozenCount, ndInt32 maxSteps)
+{
+	for (ndInt32 i = 0; i < maxSteps; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+		if (world.GetScene()->GetFrozenBodyCount() == frozenCount)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/* Resting islands leave the active arrays, and setting the velocity
+   of one body puts its whole island back. */
+TEST(SleepingIslands, RestingIslandsLeaveActiveArrays)
+{
+	ndWorld world;
+	world.SetThreadCount(2);
+
+	ndBodyDynamic* stack[4];
+	BuildScene(world, stack, 4);
+
+	ndScene* const scene = world.GetScene();
+	ASSERT_TRUE(RunUntilFrozen(world, 8, 600));
+
+	// only the floor and the sentinel are left
+	EXPECT_EQ(scene->GetActiveBodyArray().GetCount(), 2);
+	EXPECT_EQ(scene->GetActiveContactArray().GetCount(), 0);
+
+	const ndVector restPosit(stack[3]->GetMatrix().m_posit);
+	stack[1]->SetVelocity(ndVector(ndFloat32(0.0f), ndFloat32(0.1f), ndFloat32(0.0f), ndFloat32(0.0f)));
+	world.Update(1.0f / 60.0f);
+	world.Sync();
+	EXPECT_EQ(scene->GetFrozenBodyCount(), 4);
+	EXPECT_EQ(scene->GetActiveBodyArray().GetCount(), 6);
+	EXPECT_TRUE(scene->GetActiveContactArray().GetCount() >= 4);
+
+	ASSERT_TRUE(RunUntilFrozen(world, 8, 600));
+	const ndVector step(stack[3]->GetMatrix().m_posit - restPosit);
+	EXPECT_LT(step.DotProduct(step).GetScalar(), ndFloat32(1.0e-2f));
+}
+
+/* A body falling on a frozen pile and the removal of a body
+   in a frozen pile both wake the pile up. */
+TEST(SleepingIslands, EventsWakeFrozenIslands)
+{
+	ndWorld world;
+	world.SetThreadCount(2);
+
+	ndBodyDynamic* stack[3];
+	BuildScene(world, stack, 3);
+
+	ndScene* const scene = world.GetScene();
+	ASSERT_TRUE(RunUntilFrozen(world, 7, 600));
+
+	ndBodyDynamic* const box = AddBox(world, ndFloat32(0.0f), ndFloat32(6.0f), ndFloat32(0.0f));
+	bool pileWoke = false;
+	for (ndInt32 i = 0; (i < 120) && !pileWoke; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+		pileWoke = scene->GetFrozenBodyCount() < 7;
+	}
+	EXPECT_TRUE(pileWoke);
+	ASSERT_TRUE(RunUntilFrozen(world, 8, 600));
+	EXPECT_GT(box->GetMatrix().m_posit.m_y, ndFloat32(3.0f));
+
+	world.RemoveBody(stack[0]);
+	world.Update(1.0f / 60.0f);
+	world.Sync();
+	EXPECT_EQ(scene->GetFrozenBodyCount(), 4);
+
+	// the pile falls one box down and comes to rest again
+	ASSERT_TRUE(RunUntilFrozen(world, 7, 600));
+	EXPECT_LT(box->GetMatrix().m_posit.m_y, ndFloat32(3.0f));
+}
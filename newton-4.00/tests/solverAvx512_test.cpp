@@ -0,0 +1,81 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static void BuildBoxPiles(ndWorld& world, ndInt32 piles, ndInt32 height, ndArray<ndBodyDynamic*>& tops)
+{
+	ndShapeInstance floorShape(new ndShapeBox(ndFloat32(200.0f), ndFloat32(1.0f), ndFloat32(200.0f)));
+	ndMatrix floorMatrix(ndGetIdentityMatrix());
+	floorMatrix.m_posit.m_y = ndFloat32(-0.5f);
+	ndBodyKinematic* const floor = new ndBodyKinematic();
+	floor->SetCollisionShape(floorShape);
+	floor->SetMatrix(floorMatrix);
+	ndSharedPtr<ndBody> floorPtr(floor);
+	world.AddBody(floorPtr);
+
+	ndShapeInstance boxShape(new ndShapeBox(ndFloat32(1.0f), ndFloat32(1.0f), ndFloat32(1.0f)));
+	for (ndInt32 i = 0; i < piles; ++i)
+	{
+		for (ndInt32 j = 0; j < piles; ++j)
+		{
+			ndBodyDynamic* top = nullptr;
+			for (ndInt32 k = 0; k < height; ++k)
+			{
+				ndMatrix matrix(ndGetIdentityMatrix());
+				matrix.m_posit.m_x = ndFloat32(i * 3);
+				matrix.m_posit.m_y = ndFloat32(0.5f) + ndFloat32(k);
+				matrix.m_posit.m_z = ndFloat32(j * 3);
+
+				top = new ndBodyDynamic();
+				top->SetNotifyCallback(new ndBodyNotify(ndVector(ndFloat32(0.0f), ndFloat32(-10.0f), ndFloat32(0.0f), ndFloat32(0.0f))));
+				top->SetCollisionShape(boxShape);
+				top->SetMatrix(matrix);
+				top->SetMassMatrix(ndFloat32(1.0f), boxShape);
+				ndSharedPtr<ndBody> boxPtr(top);
+				world.AddBody(boxPtr);
+			}
+			tops.PushBack(top);
+		}
+	}
+}
+
+/* Piles of boxes resting on the floor must stay standing when solved 
+   sixteen joints at the time, the piles do not fill the last group. */
+TEST(Avx512Solver, BoxPilesStayStanding)
+{
+	const ndInt32 piles = 3;
+	const ndInt32 height = 8;
+	ndWorld world;
+	world.SetThreadCount(2);
+	world.SelectSolver(ndWorld::ndSimdAvx512Solver);
+	if (world.GetSelectedSolver() != ndWorld::ndSimdAvx512Solver)
+	{
+		GTEST_SKIP() << "avx512 solver not supported on this cpu";
+	}
+
+	ndArray<ndBodyDynamic*> tops;
+	BuildBoxPiles(world, piles, height, tops);
+	for (ndInt32 i = 0; i < 240; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+	}
+
+	for (ndInt32 i = 0; i < tops.GetCount(); ++i)
+	{
+		const ndVector posit(tops[i]->GetMatrix().m_posit);
+		EXPECT_NEAR(posit.m_y, ndFloat32(height) - ndFloat32(0.5f), ndFloat32(0.05f));
+		EXPECT_NEAR(posit.m_x, ndFloat32((i / piles) * 3), ndFloat32(0.25f));
+		EXPECT_NEAR(posit.m_z, ndFloat32((i % piles) * 3), ndFloat32(0.25f));
+	}
+}
@@ -0,0 +1,87 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static void AddBox(ndWorld& world, ndFloat32 x, ndFloat32 y, ndFloat32 z)
+{
+	ndShapeInstance shape(new ndShapeBox(ndFloat32(1.0f), ndFloat32(1.0f), ndFloat32(1.0f)));
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit.m_x = x;
+	matrix.m_posit.m_y = y;
+	matrix.m_posit.m_z = z;
+
+	ndBodyDynamic* const box = new ndBodyDynamic();
+	box->SetNotifyCallback(new ndBodyNotify(ndVector(ndFloat32(0.0f), ndFloat32(-10.0f), ndFloat32(0.0f), ndFloat32(0.0f))));
+	box->SetCollisionShape(shape);
+	box->SetMatrix(matrix);
+	box->SetMassMatrix(ndFloat32(1.0f), shape);
+	ndSharedPtr<ndBody> boxPtr(box);
+	world.AddBody(boxPtr);
+}
+
+/* Single boxes on the floor converge in fewer passes than a
+   pile, and no island may use more passes than its budget. */
+TEST(SolverIslands, PassesFollowIslandSize)
+{
+	ndWorld world;
+	world.SetThreadCount(2);
+	world.SelectSolver(ndWorld::ndStandardSolver);
+
+	ndShapeInstance floorShape(new ndShapeBox(ndFloat32(100.0f), ndFloat32(1.0f), ndFloat32(100.0f)));
+	ndMatrix floorMatrix(ndGetIdentityMatrix());
+	floorMatrix.m_posit.m_y = ndFloat32(-0.5f);
+	ndBodyKinematic* const floor = new ndBodyKinematic();
+	floor->SetCollisionShape(floorShape);
+	floor->SetMatrix(floorMatrix);
+	ndSharedPtr<ndBody> floorPtr(floor);
+	world.AddBody(floorPtr);
+
+	for (ndInt32 i = 0; i < 8; ++i)
+	{
+		AddBox(world, ndFloat32(i * 3 - 12), ndFloat32(0.5f), ndFloat32(-10.0f));
+	}
+	for (ndInt32 i = 0; i < 4; ++i)
+	{
+		for (ndInt32 j = 0; j < 4; ++j)
+		{
+			for (ndInt32 k = 0; k < 6; ++k)
+			{
+				AddBox(world, ndFloat32(i), ndFloat32(0.5f) + ndFloat32(k), ndFloat32(j));
+			}
+		}
+	}
+
+	// the lone boxes go to sleep quickly, so only the first step sees all islands
+	world.Update(1.0f / 60.0f);
+	world.Sync();
+
+	ndSolverIslandStats stats[64];
+	const ndInt32 count = world.GetSolverIslandStats(stats, 64);
+	ASSERT_EQ(count, 9);
+
+	ndInt32 pileIndex = 0;
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		pileIndex = (stats[i].m_jointCount > stats[pileIndex].m_jointCount) ? i : pileIndex;
+		EXPECT_GT(stats[i].m_passesUsed, 0);
+		EXPECT_LE(stats[i].m_passesUsed, stats[i].m_passes * 4);
+	}
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		if (i != pileIndex)
+		{
+			EXPECT_EQ(stats[i].m_jointCount, 1);
+			EXPECT_LT(stats[i].m_passesUsed, stats[pileIndex].m_passesUsed);
+		}
+	}
+}
@@ -0,0 +1,59 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+// fires a small sphere at a thin wall, and returns where the sphere ends
+static ndFloat32 FireAtWall(bool speculative, ndUnsigned64 budget)
+{
+	ndWorld world;
+	world.SetThreadCount(1);
+	world.SetSpeculativeContactBudget(budget);
+
+	ndShapeInstance wallShape(new ndShapeBox(ndFloat32(0.1f), ndFloat32(4.0f), ndFloat32(4.0f)));
+	ndMatrix wallMatrix(ndGetIdentityMatrix());
+	wallMatrix.m_posit.m_x = ndFloat32(10.0f);
+	ndBodyKinematic* const wall = new ndBodyKinematic();
+	wall->SetCollisionShape(wallShape);
+	wall->SetMatrix(wallMatrix);
+	ndSharedPtr<ndBody> wallPtr(wall);
+	world.AddBody(wallPtr);
+
+	ndShapeInstance sphere(new ndShapeSphere(ndFloat32(0.1f)));
+	ndBodyDynamic* const bullet = new ndBodyDynamic();
+	bullet->SetNotifyCallback(new ndBodyNotify(ndVector(ndFloat32(0.0f), ndFloat32(-10.0f), ndFloat32(0.0f), ndFloat32(0.0f))));
+	bullet->SetCollisionShape(sphere);
+	bullet->SetMatrix(ndGetIdentityMatrix());
+	bullet->SetMassMatrix(ndFloat32(1.0f), sphere);
+	bullet->SetVelocity(ndVector(ndFloat32(150.0f), ndFloat32(0.0f), ndFloat32(0.0f), ndFloat32(0.0f)));
+	bullet->SetSpeculativeContacts(speculative);
+	ndSharedPtr<ndBody> bulletPtr(bullet);
+	world.AddBody(bulletPtr);
+
+	for (ndInt32 i = 0; i < 20; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+	}
+	world.Sync();
+	return bullet->GetMatrix().m_posit.m_x;
+}
+
+/* A body moving several times its size per step goes through a thin
+   wall with discrete contacts, speculative contacts stop it in front. */
+TEST(SpeculativeContacts, StopsFastBodyAtThinWall)
+{
+	EXPECT_GT(FireAtWall(false, 0), ndFloat32(10.0f));
+	EXPECT_LT(FireAtWall(true, 0), ndFloat32(10.0f));
+
+	// with a budget the pair runs in the speculative pass
+	EXPECT_LT(FireAtWall(true, 1000000), ndFloat32(10.0f));
+}
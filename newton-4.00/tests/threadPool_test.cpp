@@ -0,0 +1,207 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+class ndTestThreadPool : public ndThreadPool
+{
+	public:
+	ndTestThreadPool()
+		:ndThreadPool("testWorker")
+	{
+	}
+
+	~ndTestThreadPool()
+	{
+		Finish();
+	}
+
+	virtual void ThreadFunction()
+	{
+	}
+};
+
+/* Each index of a ParallelFor range must be visited exactly once,
+   independently of how the work stealing splits the range. */
+TEST(ThreadPool, ParallelForVisitsEachIndexOnce)
+{
+	ndTestThreadPool pool;
+	pool.SetThreadCount(ndThreadPool::GetMaxThreads());
+
+	const ndInt32 count = 10007;
+	ndAtomic<ndInt32>* const visits = new ndAtomic<ndInt32>[count];
+
+	pool.Begin();
+	for (ndInt32 grain = 1; grain < 64; grain = grain * 2 + 1)
+	{
+		pool.ParallelFor(0, count, grain, [visits](ndInt32, ndInt32 i)
+		{
+			visits[i].fetch_add(1);
+		});
+	}
+	pool.End();
+
+	ndInt32 passes = 0;
+	for (ndInt32 grain = 1; grain < 64; grain = grain * 2 + 1)
+	{
+		passes++;
+	}
+	for (ndInt32 i = 0; i < count; ++i)
+	{
+		EXPECT_EQ(visits[i].load(), passes);
+	}
+	delete[] visits;
+}
+
+/* Nodes of a task graph must run after all their dependencies. */
+TEST(ThreadPool, TaskGraphRespectsDependencies)
+{
+	ndTestThreadPool pool;
+	pool.SetThreadCount(ndThreadPool::GetMaxThreads());
+
+	const ndInt32 count = 1000;
+	ndAtomic<ndInt32> order(0);
+	ndAtomic<ndInt32> stageOrder(-1);
+	ndAtomic<ndInt32> jobOrder(-1);
+	ndAtomic<ndInt32> loopItems(0);
+	ndAtomic<ndInt32> loopLast(-1);
+	ndAtomic<ndInt32> finalOrder(-1);
+
+	pool.Begin();
+	ndTaskGraph graph(&pool);
+	ndTaskGraph::ndNode* const stage = graph.AddStage([&]() { stageOrder.store(order.fetch_add(1)); });
+	ndTaskGraph::ndNode* const job = graph.AddJob([&](ndInt32) { jobOrder.store(order.fetch_add(1)); });
+	ndTaskGraph::ndNode* const loop = graph.AddParallelFor(count, 7, [&](ndInt32, ndInt32)
+	{
+		loopItems.fetch_add(1);
+		loopLast.store(order.fetch_add(1));
+	});
+	ndTaskGraph::ndNode* const empty = graph.AddParallelFor(0, 1, [](ndInt32, ndInt32) {});
+	ndTaskGraph::ndNode* const last = graph.AddStage([&]() { finalOrder.store(order.fetch_add(1)); });
+	graph.AddDependency(job, stage);
+	graph.AddDependency(loop, stage);
+	graph.AddDependency(empty, job);
+	graph.AddDependency(last, empty);
+	graph.AddDependency(last, loop);
+	graph.Execute();
+	pool.End();
+
+	EXPECT_EQ(stageOrder.load(), 0);
+	EXPECT_GT(jobOrder.load(), 0);
+	EXPECT_EQ(loopItems.load(), count);
+	EXPECT_EQ(finalOrder.load(), count + 2);
+}
+
+/* A ParallelFor called from inside a graph job runs on the thread of the
+   job, and gets that thread index, so per thread scratch is not shared. */
+TEST(ThreadPool, NestedParallelForKeepsThreadIndex)
+{
+	ndTestThreadPool pool;
+	pool.SetThreadCount(ndThreadPool::GetMaxThreads());
+	const ndInt32 threadCount = pool.GetThreadCount();
+
+	const ndInt32 jobCount = D_TASK_GRAPH_MAX_EDGES;
+	const ndInt32 count = 256;
+	ndAtomic<ndInt32> owners[D_MAX_THREADS_COUNT];
+	ndAtomic<ndInt32> errors(0);
+	ndAtomic<ndInt32> items(0);
+	for (ndInt32 i = 0; i < D_MAX_THREADS_COUNT; ++i)
+	{
+		owners[i].store(-1);
+	}
+
+	pool.Begin();
+	ndTaskGraph graph(&pool);
+	ndTaskGraph::ndNode* const start = graph.AddStage([]() {});
+	for (ndInt32 job = 0; job < jobCount; ++job)
+	{
+		ndTaskGraph::ndNode* const node = graph.AddJob([&, job](ndInt32 threadIndex)
+		{
+			// claim the scratch of this thread for the duration of the job
+			if ((threadIndex < 0) || (threadIndex >= threadCount) || (owners[threadIndex].exchange(job) != -1))
+			{
+				errors.fetch_add(1);
+				return;
+			}
+			if (pool.GetCallerThreadIndex() != threadIndex)
+			{
+				errors.fetch_add(1);
+			}
+			pool.ParallelFor(0, count, 1, [&, job, threadIndex](ndInt32 nestedThreadIndex, ndInt32)
+			{
+				items.fetch_add(1);
+				if ((nestedThreadIndex != threadIndex) || (owners[nestedThreadIndex].load() != job))
+				{
+					errors.fetch_add(1);
+				}
+			});
+			owners[threadIndex].store(-1);
+		});
+		graph.AddDependency(node, start);
+	}
+	graph.Execute();
+	pool.End();
+
+	EXPECT_EQ(errors.load(), 0);
+	EXPECT_EQ(items.load(), jobCount * count);
+	EXPECT_EQ(pool.GetCallerThreadIndex(), -1);
+}
+
+/* Free list chunks allocated on one thread and freed on another
+   must move through the depot and show up in the class stats. */
+TEST(ThreadPool, FreeListAllocAcrossThreads)
+{
+	class ndTestChunk : public ndFreeListAlloc
+	{
+		public:
+		ndInt32 m_data[50];
+	};
+
+	ndTestThreadPool pool;
+	pool.SetThreadCount(ndMin(ndThreadPool::GetMaxThreads(), 4));
+
+	const ndInt32 count = 4096;
+	ndTestChunk** const chunks = new ndTestChunk*[count];
+
+	pool.Begin();
+	for (ndInt32 pass = 0; pass < 4; ++pass)
+	{
+		pool.ParallelFor(0, count, 16, [chunks](ndInt32, ndInt32 i)
+		{
+			chunks[i] = new ndTestChunk;
+			chunks[i]->m_data[0] = i;
+		});
+		// free in reverse order so that the chunks change hands
+		pool.ParallelFor(0, count, 16, [chunks, count](ndInt32, ndInt32 i)
+		{
+			ndTestChunk* const chunk = chunks[count - 1 - i];
+			EXPECT_EQ(chunk->m_data[0], count - 1 - i);
+			delete chunk;
+		});
+	}
+	pool.End();
+	delete[] chunks;
+
+	ndMemoryFreeListStats stats[128];
+	const ndInt32 classCount = ndMemory::GetFreeListStats(stats, 128);
+	bool found = false;
+	for (ndInt32 i = 0; i < classCount; ++i)
+	{
+		EXPECT_GE(stats[i].m_heapChunks, stats[i].m_depotChunks);
+		if (stats[i].m_chunkSize == 224)
+		{
+			found = true;
+			EXPECT_GT(stats[i].m_returns, 0);
+		}
+	}
+	EXPECT_TRUE(found);
+}
@@ -0,0 +1,94 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static ndBodyDynamic* AddFallingBox(ndWorld& world, ndFloat32 height)
+{
+	ndShapeInstance shape(new ndShapeBox(ndFloat32(1.0f), ndFloat32(1.0f), ndFloat32(1.0f)));
+	ndMatrix matrix(ndGetIdentityMatrix());
+	matrix.m_posit.m_y = height;
+
+	ndBodyDynamic* const box = new ndBodyDynamic();
+	box->SetNotifyCallback(new ndBodyNotify(ndVector(ndFloat32(0.0f), ndFloat32(-10.0f), ndFloat32(0.0f), ndFloat32(0.0f))));
+	box->SetCollisionShape(shape);
+	box->SetMatrix(matrix);
+	box->SetMassMatrix(ndFloat32(1.0f), shape);
+	ndSharedPtr<ndBody> boxPtr(box);
+	world.AddBody(boxPtr);
+	return box;
+}
+
+/* Worlds stepped by a group must end up exactly where
+   the same worlds end up when stepped one at the time. */
+TEST(WorldGroup, MatchesStandaloneUpdate)
+{
+	const ndInt32 worldCount = 8;
+	const ndInt32 steps = 30;
+
+	ndWorld reference;
+	reference.SetThreadCount(1);
+	ndBodyDynamic* const referenceBox = AddFallingBox(reference, ndFloat32(10.0f));
+	for (ndInt32 i = 0; i < steps; ++i)
+	{
+		reference.Update(1.0f / 60.0f);
+		reference.Sync();
+	}
+
+	ndWorld* worlds[worldCount];
+	ndBodyDynamic* boxes[worldCount];
+	ndWorldGroup group;
+	for (ndInt32 i = 0; i < worldCount; ++i)
+	{
+		worlds[i] = new ndWorld();
+		boxes[i] = AddFallingBox(*worlds[i], ndFloat32(10.0f));
+		group.AddWorld(worlds[i]);
+	}
+	EXPECT_EQ(group.GetWorldCount(), worldCount);
+
+	for (ndInt32 i = 0; i < steps; ++i)
+	{
+		group.Update(1.0f / 60.0f);
+	}
+	group.Sync();
+
+	for (ndInt32 i = 0; i < worldCount; ++i)
+	{
+		EXPECT_EQ(worlds[i]->GetFrameNumber(), reference.GetFrameNumber());
+		EXPECT_EQ(boxes[i]->GetMatrix().m_posit.m_y, referenceBox->GetMatrix().m_posit.m_y);
+		group.RemoveWorld(worlds[i]);
+		delete worlds[i];
+	}
+	EXPECT_EQ(group.GetWorldCount(), 0);
+}
+
+/* A grouped world runs on the group workers only, it gives up its own 
+   workers and keeps them released until it leaves the group. */
+TEST(WorldGroup, GroupedWorldReleasesItsWorkers)
+{
+	ndWorld* const world = new ndWorld();
+	world->SetThreadCount(ndThreadPool::GetMaxThreads());
+	EXPECT_EQ(world->GetGroup(), nullptr);
+
+	ndWorldGroup group;
+	group.AddWorld(world);
+	group.AddWorld(world);
+	EXPECT_EQ(group.GetWorldCount(), 1);
+	EXPECT_EQ(world->GetGroup(), &group);
+	EXPECT_EQ(world->GetThreadCount(), 1);
+
+	group.RemoveWorld(world);
+	EXPECT_EQ(world->GetGroup(), nullptr);
+	world->SetThreadCount(ndThreadPool::GetMaxThreads());
+	EXPECT_EQ(world->GetThreadCount(), ndThreadPool::GetMaxThreads());
+	delete world;
+}
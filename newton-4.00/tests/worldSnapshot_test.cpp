@@ -0,0 +1,128 @@
+/* Copyright (c) <2003-2019> <Newton Game Dynamics>
+ *
+ * This software is provided 'as-is', without any express or implied
+ * warranty. In no event will the authors be held liable for any damages
+ * arising from the use of this software.
+ *
+ * Permission is granted to anyone to use this software for any purpose,
+ * including commercial applications, and to alter it and redistribute it
+ * freely
+ */
+
+
+#include "ndNewton.h"
+#include <gtest/gtest.h>
+
+static void BuildScene(ndWorld& world)
+{
+	ndShapeInstance floorShape(new ndShapeBox(ndFloat32(100.0f), ndFloat32(1.0f), ndFloat32(100.0f)));
+	ndMatrix floorMatrix(ndGetIdentityMatrix());
+	floorMatrix.m_posit.m_y = ndFloat32(-0.5f);
+	ndBodyKinematic* const floor = new ndBodyKinematic();
+	floor->SetCollisionShape(floorShape);
+	floor->SetMatrix(floorMatrix);
+	ndSharedPtr<ndBody> floorPtr(floor);
+	world.AddBody(floorPtr);
+
+	ndShapeInstance shape(new ndShapeBox(ndFloat32(1.0f), ndFloat32(1.0f), ndFloat32(1.0f)));
+	for (ndInt32 i = 0; i < 16; ++i)
+	{
+		ndMatrix matrix(ndGetIdentityMatrix());
+		matrix.m_posit.m_x = ndFloat32(i % 4) * ndFloat32(2.0f);
+		matrix.m_posit.m_y = ndFloat32(2.0f + i / 4);
+		matrix.m_posit.m_z = ndFloat32(i / 4) * ndFloat32(2.0f);
+
+		ndBodyDynamic* const box = new ndBodyDynamic();
+		box->SetNotifyCallback(new ndBodyNotify(ndVector(ndFloat32(0.0f), ndFloat32(-10.0f), ndFloat32(0.0f), ndFloat32(0.0f))));
+		box->SetCollisionShape(shape);
+		box->SetMatrix(matrix);
+		box->SetMassMatrix(ndFloat32(1.0f), shape);
+		ndSharedPtr<ndBody> boxPtr(box);
+		world.AddBody(boxPtr);
+	}
+}
+
+static void ExpectSameState(ndWorld& world, const ndWorldSnapshot* const snapshot)
+{
+	const ndArray<ndBodyKinematic*>& view = world.GetScene()->GetBodyList().GetView();
+	ASSERT_EQ(snapshot->m_bodies.GetCount(), view.GetCount());
+	for (ndInt32 i = 0; i < view.GetCount(); ++i)
+	{
+		const ndBodyState& state = snapshot->m_bodies[i];
+		const ndBodyKinematic* const body = view[i];
+		EXPECT_EQ(state.m_body, body);
+		EXPECT_EQ(state.m_bodyId, body->GetId());
+		EXPECT_EQ(state.m_sleeping ? true : false, body->GetSleepState());
+		const ndVector posit(state.m_matrix.m_posit - body->GetMatrix().m_posit);
+		const ndVector veloc(state.m_veloc - body->GetVelocity());
+		EXPECT_EQ(posit.DotProduct(posit).GetScalar(), ndFloat32(0.0f));
+		EXPECT_EQ(veloc.DotProduct(veloc).GetScalar(), ndFloat32(0.0f));
+	}
+}
+
+/* The snapshot published by an update is the state of
+   the bodies when the update ends. */
+TEST(WorldSnapshot, MatchesBodiesAfterSync)
+{
+	ndWorld world;
+	world.SetThreadCount(2);
+	BuildScene(world);
+
+	EXPECT_EQ(world.AcquireSnapshot(), nullptr);
+	world.EnableSnapshots(true);
+	EXPECT_EQ(world.AcquireSnapshot(), nullptr);
+
+	for (ndInt32 i = 0; i < 30; ++i)
+	{
+		world.Update(1.0f / 60.0f);
+		world.Sync();
+		const ndWorldSnapshot* const snapshot = world.AcquireSnapshot();
+		ASSERT_TRUE(snapshot != nullptr);
+		EXPECT_EQ(snapshot->m_frameNumber, world.GetFrameNumber());
+		ExpectSameState(world, snapshot);
+
+		// nothing new was published
+		EXPECT_EQ(world.AcquireSnapshot(), snapshot);
+	}
+
+	world.EnableSnapshots(false);
+	world.Update(1.0f / 60.0f);
+	world.Sync();
+	EXPECT_EQ(world.AcquireSnapshot(), nullptr);
+}
+
+/* Acquiring a snapshot while the update runs never waits, it
+   returns the last published frame, and the held snapshot is
+   not written until the reader acquires the next one. */
+TEST(WorldSnapshot, AcquireDuringUpdate)
+{
+	ndWorld world;
+	world.SetThreadCount(2);
+	BuildScene(world);
+	world.EnableSnapshots(true);
+
+	world.Update(1.0f / 60.0f);
+	world.Sync();
+
+	ndUnsigned32 lastFrame = 0;
+	for (ndInt32 i = 0; i < 60; ++i)
+	{
+		const ndWorldSnapshot* const snapshot = world.AcquireSnapshot();
+		ASSERT_TRUE(snapshot != nullptr);
+		EXPECT_GE(snapshot->m_frameNumber, lastFrame);
+		lastFrame = snapshot->m_frameNumber;
+
+		const ndUnsigned32 frame = snapshot->m_frameNumber;
+		const ndMatrix matrix(snapshot->m_bodies[1].m_matrix);
+		world.Update(1.0f / 60.0f);
+		for (ndInt32 j = 0; j < 8; ++j)
+		{
+			// the update in flight publishes into one of the other two buffers
+			EXPECT_EQ(snapshot->m_frameNumber, frame);
+			EXPECT_EQ(snapshot->m_bodies[1].m_matrix.m_posit.m_y, matrix.m_posit.m_y);
+			std::this_thread::yield();
+		}
+		world.Sync();
+	}
+	EXPECT_EQ(world.AcquireSnapshot()->m_frameNumber, world.GetFrameNumber());
+}